@@ -15,6 +15,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include "../common/ffs.h"
 #include "../common/utility.h"
 #include "../common/filesystem.h"
+#include "../common/digest/sha2.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -26,16 +27,28 @@ USTATUS UEFIDumper::dump(const UByteArray & buffer, const UString & inPath, cons
     UString reportPath = UString(inPath) + UString(".report.txt");
 
     if (initialized) {
-        // Check if called with a different buffer as before
-        if (buffer != currentBuffer) {
+        // Check if called with a different image as before, the same storage always holds the same image
+        if (buffer.size() != currentBuffer.size()) {
             // Reinitalize if so
             initialized = false;
         }
+        else if (buffer.constData() != currentBuffer.constData()) {
+            // Different storage, compare image hashes
+            UByteArray hash(SHA256_HASH_SIZE, '\x00');
+            sha256(buffer.constData(), buffer.size(), hash.data());
+            if (currentHash.isEmpty()) {
+                currentHash = UByteArray(SHA256_HASH_SIZE, '\x00');
+                sha256(currentBuffer.constData(), currentBuffer.size(), currentHash.data());
+            }
+            if (hash != currentHash)
+                initialized = false;
+        }
     }
 
     if (!initialized) {
-        // Fill currentBuffer
+        // Share storage of the image, its hash is calculated only when needed
         currentBuffer = buffer;
+        currentHash.clear();
 
         // Parse FFS structure
         USTATUS result = ffsParser.parse(buffer);
@@ -23,7 +23,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 class UEFIDumper
 {
 public:
-    explicit UEFIDumper() : model(), ffsParser(&model), ffsReport(&model), currentBuffer(), initialized(false), dumped(false) {}
+    explicit UEFIDumper() : model(), ffsParser(&model), ffsReport(&model), currentBuffer(), currentHash(), initialized(false), dumped(false) {}
     ~UEFIDumper() {}
 
     USTATUS dump(const UByteArray & buffer, const UString & path, const UString & guid = UString());
@@ -35,7 +35,8 @@ private:
     FfsParser ffsParser;
     FfsReport ffsReport;
     
-    UByteArray currentBuffer;
+    UByteArray currentBuffer;                                                  // Shares storage with the parsed image, no copy is made
+    UByteArray currentHash;                                                    // Calculated on first comparison with a different storage
     bool initialized;
     bool dumped;
 };
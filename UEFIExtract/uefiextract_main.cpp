@@ -20,6 +20,9 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include "../common/ffsparser.h"
 #include "../common/ffsreport.h"
 #include "../common/guiddatabase.h"
+#include "../common/parsecache.h"
+#include "../common/decompressioncache.h"
+#include "../common/taskpool.h"
 #include "ffsdumper.h"
 #include "uefidump.h"
 
@@ -43,13 +46,59 @@ void print_usage()
         << "       UEFIExtract imagefile GUID_1 ... [ -o FILE_1 ... ] [ -m MODE_1 ... ] [ -t TYPE_1 ... ] -" << std::endl
         << "         Dump only FFS file(s) with specific GUID(s), without report or GUID database." << std::endl
         << "         Type is section type or FF to ignore. Mode is one of: all, body, unc_data, header, info, file." << std::endl
-        << "         Return value is a bit mask where 0 at position N means that file with GUID_N was found and unpacked, 1 otherwise." << std::endl;
+        << "         Return value is a bit mask where 0 at position N means that file with GUID_N was found and unpacked, 1 otherwise." << std::endl
+        << "       Add --stats to any of the above to print parser statistics to stderr." << std::endl
+        << "       Add --threads N to any of the above to parse the image using N threads." << std::endl
+        << "       Add --decompression-cache N to any of the above to reuse up to N MiB of decompressed data for identical compressed sections." << std::endl
+        << "Set UEFITOOL_CACHE_DIR environment variable to a directory to cache parsing results there." << std::endl;
 }
 
 int main(int argc, char *argv[])
 {
     initGuidDatabase("guids.csv");
 
+    // Parser statistics can be requested in any mode, remove the option from arguments
+    bool showStats = false;
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--stats")) {
+            showStats = true;
+            for (int j = i; j < argc - 1; j++)
+                argv[j] = argv[j + 1];
+            argc--;
+            break;
+        }
+    }
+    
+    // Same for the number of parsing threads
+    UINT32 threadCount = 1;
+    for (int i = 1; i < argc - 1; i++) {
+        if (!std::strcmp(argv[i], "--threads")) {
+            if (!TaskPool::parseThreadCount(argv[i + 1], threadCount)) {
+                std::cerr << "Invalid number of threads: " << argv[i + 1] << std::endl;
+                return U_INVALID_PARAMETER;
+            }
+            for (int j = i; j < argc - 2; j++)
+                argv[j] = argv[j + 2];
+            argc -= 2;
+            break;
+        }
+    }
+    
+    // Same for the decompression cache size
+    UINT64 decompressionCacheSize = 0;
+    for (int i = 1; i < argc - 1; i++) {
+        if (!std::strcmp(argv[i], "--decompression-cache")) {
+            if (!DecompressionCache::parseMaxSize(argv[i + 1], decompressionCacheSize)) {
+                std::cerr << "Invalid decompression cache size: " << argv[i + 1] << std::endl;
+                return U_INVALID_PARAMETER;
+            }
+            for (int j = i; j < argc - 2; j++)
+                argv[j] = argv[j + 2];
+            argc -= 2;
+            break;
+        }
+    }
+
     if (argc <= 1) {
         print_usage();
         return 1;
@@ -72,7 +121,7 @@ int main(int argc, char *argv[])
     USTATUS result;
     UByteArray buffer;
     UString path = getAbsPath(argv[1]);
-    if (false == readFileIntoBuffer(path, buffer))
+    if (false == mapFileIntoBuffer(path, buffer))
         return U_FILE_OPEN;
     
     // Hack to support legacy UEFIDump mode
@@ -84,8 +133,21 @@ int main(int argc, char *argv[])
     // Create model and ffsParser
     TreeModel model;
     FfsParser ffsParser(&model);
-    // Parse input buffer
-    result = ffsParser.parse(buffer);
+    // Item info is only written by dumps
+    if (argc == 3 && (!std::strcmp(argv[2], "guids") || !std::strcmp(argv[2], "report")))
+        model.setInfoEnabled(false);
+    ffsParser.setStatsEnabled(showStats);
+    ffsParser.setThreadCount(threadCount);
+    if (decompressionCacheSize)
+        ffsParser.setDecompressionCache(std::make_shared<DecompressionCache>(decompressionCacheSize));
+    // Parse input buffer, or restore parsing results from cache
+    const char* cacheDirectory = getenv("UEFITOOL_CACHE_DIR");
+    if (cacheDirectory && *cacheDirectory)
+        result = ParseCache(UString(cacheDirectory), UString(PROGRAM_VERSION), buffer).parse(&model, &ffsParser);
+    else
+        result = ffsParser.parse(buffer);
+    if (showStats)
+        std::cerr << ffsParser.getStats().toString().toLocal8Bit();
     if (result)
         return (int)result;
     
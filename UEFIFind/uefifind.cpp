@@ -12,6 +12,9 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 */
 
 #include "uefifind.h"
+#include "../version.h"
+#include "../common/parsecache.h"
+#include <cstdlib>
 #include <fstream>
 #include <set>
 
@@ -19,6 +22,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 UEFIFind::UEFIFind()
 {
     model = new TreeModel();
+    model->setInfoEnabled(false); // Item info is never shown
     ffsParser = new FfsParser(model);
     initDone = false;
 }
@@ -33,10 +37,15 @@ UEFIFind::~UEFIFind()
 USTATUS UEFIFind::init(const UString & path)
 {
     UByteArray buffer;
-    if (false == readFileIntoBuffer(path, buffer))
+    if (false == mapFileIntoBuffer(path, buffer))
         return U_FILE_OPEN;
 
-    USTATUS result = ffsParser->parse(buffer);
+    USTATUS result;
+    const char* cacheDirectory = getenv("UEFITOOL_CACHE_DIR");
+    if (cacheDirectory && *cacheDirectory)
+        result = ParseCache(UString(cacheDirectory), UString(PROGRAM_VERSION), buffer).parse(model, ffsParser);
+    else
+        result = ffsParser->parse(buffer);
     if (result)
         return result;
 
@@ -21,6 +21,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include "../common/ustring.h"
 #include "../common/filesystem.h"
 #include "../common/ffsparser.h"
+#include "../common/decompressioncache.h"
 #include "../common/ffs.h"
 #include "../common/utility.h"
 
@@ -31,6 +32,10 @@ public:
     ~UEFIFind();
 
     USTATUS init(const UString & path);
+    void setStatsEnabled(const bool enabled) { ffsParser->setStatsEnabled(enabled); }
+    void setThreadCount(const UINT32 count) { ffsParser->setThreadCount(count); }
+    void setDecompressionCacheSize(const UINT64 size) { if (size) ffsParser->setDecompressionCache(std::make_shared<DecompressionCache>(size)); }
+    UString getStats() const { return ffsParser->getStats().toString(); }
     USTATUS find(const UINT8 mode, const bool count, const UString & hexPattern, UString & result);
 
 private:
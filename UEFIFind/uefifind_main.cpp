@@ -11,12 +11,16 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 
 */
 #include <iostream>
+#include <cstring>
+#include <cstdlib>
 #include <fstream>
 #include <string>
 #include <vector>
 
 #include "../version.h"
 #include "../common/guiddatabase.h"
+#include "../common/decompressioncache.h"
+#include "../common/taskpool.h"
 #include "uefifind.h"
 
 void print_usage()
@@ -24,7 +28,11 @@ void print_usage()
     std::cout << "UEFIFind " PROGRAM_VERSION << std::endl <<
         "Usage: UEFIFind {-h | --help | -v | -version}" << std::endl <<
         "       UEFIFind imagefile {header | body | all} {list | count} pattern" << std::endl <<
-        "       UEFIFind imagefile file patternsfile" << std::endl;
+        "       UEFIFind imagefile file patternsfile" << std::endl <<
+        "       Add --stats to any of the above to print parser statistics to stderr." << std::endl <<
+        "       Add --threads N to any of the above to parse the image using N threads." << std::endl <<
+        "       Add --decompression-cache N to any of the above to reuse up to N MiB of decompressed data for identical compressed sections." << std::endl <<
+        "Set UEFITOOL_CACHE_DIR environment variable to a directory to cache parsing results there." << std::endl;
 }
 
 int main(int argc, char *argv[])
@@ -32,6 +40,51 @@ int main(int argc, char *argv[])
     UEFIFind w;
     USTATUS result;
 
+    // Parser statistics can be requested in any mode, remove the option from arguments
+    bool showStats = false;
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--stats")) {
+            showStats = true;
+            for (int j = i; j < argc - 1; j++)
+                argv[j] = argv[j + 1];
+            argc--;
+            break;
+        }
+    }
+    w.setStatsEnabled(showStats);
+
+    // Same for the number of parsing threads
+    for (int i = 1; i < argc - 1; i++) {
+        if (!std::strcmp(argv[i], "--threads")) {
+            UINT32 threadCount;
+            if (!TaskPool::parseThreadCount(argv[i + 1], threadCount)) {
+                std::cerr << "Invalid number of threads: " << argv[i + 1] << std::endl;
+                return U_INVALID_PARAMETER;
+            }
+            w.setThreadCount(threadCount);
+            for (int j = i; j < argc - 2; j++)
+                argv[j] = argv[j + 2];
+            argc -= 2;
+            break;
+        }
+    }
+
+    // Same for the decompression cache size
+    for (int i = 1; i < argc - 1; i++) {
+        if (!std::strcmp(argv[i], "--decompression-cache")) {
+            UINT64 decompressionCacheSize;
+            if (!DecompressionCache::parseMaxSize(argv[i + 1], decompressionCacheSize)) {
+                std::cerr << "Invalid decompression cache size: " << argv[i + 1] << std::endl;
+                return U_INVALID_PARAMETER;
+            }
+            w.setDecompressionCacheSize(decompressionCacheSize);
+            for (int j = i; j < argc - 2; j++)
+                argv[j] = argv[j + 2];
+            argc -= 2;
+            break;
+        }
+    }
+
     if (argc == 1) {
         print_usage();
         return U_SUCCESS;
@@ -75,6 +128,8 @@ int main(int argc, char *argv[])
 
         // Parse input file
         result = w.init(inputArg);
+        if (showStats)
+            std::cerr << w.getStats().toLocal8Bit();
         if (result)
             return result;
 
@@ -111,6 +166,8 @@ int main(int argc, char *argv[])
 
         // Parse input file
         result = w.init(inputArg);
+        if (showStats)
+            std::cerr << w.getStats().toLocal8Bit();
         if (result)
             return result;
 
@@ -23,7 +23,10 @@ UEFITool::UEFITool(QWidget *parent) :
 QMainWindow(parent),
 ui(new Ui::UEFITool),
 version(tr(PROGRAM_VERSION)),
-markingEnabled(true)
+markingEnabled(true),
+decompressionCacheEnabled(true),
+lazyDecompressionEnabled(false),
+parseCacheEnabled(false)
 {
     clipboard = QApplication::clipboard();
     
@@ -39,6 +42,8 @@ markingEnabled(true)
     ffsOps = NULL;
     ffsBuilder = NULL;
     ffsReport = NULL;
+    // Decompression results are kept between opened images, so other versions of the same firmware reuse their common modules
+    decompressionCache = std::make_shared<DecompressionCache>(256 * 1024 * 1024);
     
     // Connect signals to slots
     connect(ui->actionOpenImageFile, SIGNAL(triggered()), this, SLOT(openImageFile()));
@@ -73,6 +78,9 @@ markingEnabled(true)
     connect(ui->actionExportDiscoveredGuids, SIGNAL(triggered()), this, SLOT(exportDiscoveredGuids()));
     connect(ui->actionGenerateReport, SIGNAL(triggered()), this, SLOT(generateReport()));
     connect(ui->actionToggleBootGuardMarking, SIGNAL(toggled(bool)), this, SLOT(toggleBootGuardMarking(bool)));
+    connect(ui->actionToggleDecompressionCache, SIGNAL(toggled(bool)), this, SLOT(toggleDecompressionCache(bool)));
+    connect(ui->actionToggleLazyDecompression, SIGNAL(toggled(bool)), this, SLOT(toggleLazyDecompression(bool)));
+    connect(ui->actionToggleParseCache, SIGNAL(toggled(bool)), this, SLOT(toggleParseCache(bool)));
     connect(QCoreApplication::instance(), SIGNAL(aboutToQuit()), this, SLOT(writeSettings()));
     
     // Enable Drag-and-Drop actions
@@ -147,6 +155,10 @@ void UEFITool::init()
     // ... and ffsParser
     delete ffsParser;
     ffsParser = new FfsParser(model);
+    if (decompressionCacheEnabled)
+        ffsParser->setDecompressionCache(decompressionCache);
+    // Compressed sections are decompressed when expanded, viewed or searched
+    ffsParser->setLazyDecompression(lazyDecompressionEnabled);
     
     // Set proper marking state
     model->setMarkingEnabled(markingEnabled);
@@ -279,7 +291,7 @@ void UEFITool::populateUi(const QModelIndex &current)
     // Enable actions
     ui->actionHexView->setDisabled(model->hasEmptyHeader(current) && model->hasEmptyBody(current) && model->hasEmptyTail(current));
     ui->actionBodyHexView->setDisabled(model->hasEmptyBody(current));
-    ui->actionUncompressedHexView->setDisabled(model->hasEmptyUncompressedData(current));
+    ui->actionUncompressedHexView->setDisabled(model->hasEmptyUncompressedData(current) && !model->canFetchMore(current));
     ui->actionExtract->setDisabled(model->hasEmptyHeader(current) && model->hasEmptyBody(current) && model->hasEmptyTail(current));
     ui->actionGoToData->setEnabled(type == Types::NvarEntry && subtype == Subtypes::LinkNvarEntry);
     
@@ -289,7 +301,7 @@ void UEFITool::populateUi(const QModelIndex &current)
     
     //ui->actionRebuild->setEnabled(type == Types::Volume || type == Types::File || type == Types::Section);
     ui->actionExtractBody->setDisabled(model->hasEmptyBody(current));
-    ui->actionExtractBodyUncompressed->setDisabled(model->hasEmptyUncompressedData(current));
+    ui->actionExtractBodyUncompressed->setDisabled(model->hasEmptyUncompressedData(current) && !model->canFetchMore(current));
     //ui->actionRemove->setEnabled(type == Types::Volume || type == Types::File || type == Types::Section);
     //ui->actionInsertInto->setEnabled((type == Types::Volume && subtype != Subtypes::UnknownVolume) ||
     //    (type == Types::File && subtype != EFI_FV_FILETYPE_ALL && subtype != EFI_FV_FILETYPE_RAW && subtype != EFI_FV_FILETYPE_PAD) ||
@@ -307,6 +319,9 @@ void UEFITool::search()
     if (searchDialog->exec() != QDialog::Accepted)
         return;
     
+    // Search covers contents of lazily decompressed sections
+    model->fetchAll();
+    
     int index = searchDialog->ui->tabWidget->currentIndex();
     if (index == 0) { // Hex pattern
         searchDialog->ui->hexEdit->setFocus();
@@ -383,6 +398,8 @@ void UEFITool::uncompressedHexView()
     if (!index.isValid())
         return;
     
+    if (model->canFetchMore(index))
+        model->fetchMore(index);
     hexViewDialog->setItem(index, HexViewDialog::HexViewType::uncompressedHexView);
     hexViewDialog->exec();
 }
@@ -427,11 +444,10 @@ void UEFITool::goToData()
     QModelIndex parent = model->parent(index);
     
     for (int i = index.row(); i < model->rowCount(parent); i++) {
-        if (model->hasEmptyParsingData(index))
+        const NVAR_ENTRY_PARSING_DATA* pdata = model->nvarEntryParsingData(index);
+        if (!pdata)
             continue;
         
-        UByteArray rdata = model->parsingData(index);
-        const NVAR_ENTRY_PARSING_DATA* pdata = (const NVAR_ENTRY_PARSING_DATA*)rdata.constData();
         UINT32 offset = model->offset(index);
         if (pdata->next == 0xFFFFFF) {
             ui->structureTreeView->scrollTo(index, QAbstractItemView::PositionAtCenter);
@@ -657,9 +673,16 @@ void UEFITool::openImageFile(QString path)
     init();
     setWindowTitle(tr("UEFITool %1 - %2").arg(version).arg(fileInfo.fileName()));
     
-    // Parse the image
-    USTATUS result = ffsParser->parse(buffer);
+    // Parse the image, or restore parsing results from cache
+    USTATUS result;
+    if (parseCacheEnabled)
+        result = ParseCache(parseCacheDirectory(), version, buffer).parse(model, ffsParser);
+    else
+        result = ffsParser->parse(buffer);
     showParserMessages();
+    // Messages of lazily decompressed sections are produced when their contents are fetched
+    if (lazyDecompressionEnabled)
+        connect(model, SIGNAL(dataChanged(const QModelIndex &, const QModelIndex &)), this, SLOT(appendParserMessages()));
     if (result) {
         QMessageBox::critical(this, tr("Image parsing failed"), errorCodeToUString(result), QMessageBox::Ok);
         return;
@@ -771,6 +794,38 @@ void UEFITool::toggleBootGuardMarking(bool enabled)
     markingEnabled = enabled;
 }
 
+void UEFITool::toggleDecompressionCache(bool enabled)
+{
+    // Cached results are dropped right away, the setting is used for images opened afterwards
+    decompressionCacheEnabled = enabled;
+    if (!enabled)
+        decompressionCache->clear();
+}
+
+void UEFITool::toggleLazyDecompression(bool enabled)
+{
+    // The setting is used for images opened afterwards
+    lazyDecompressionEnabled = enabled;
+}
+
+void UEFITool::toggleParseCache(bool enabled)
+{
+    // The setting is used for images opened afterwards
+    parseCacheEnabled = enabled;
+}
+
+QString UEFITool::parseCacheDirectory() const
+{
+    // Same directory as the one used by command line tools, if set, otherwise a per-user cache directory
+    QString directory = QString::fromLocal8Bit(qgetenv("UEFITOOL_CACHE_DIR"));
+    if (directory.isEmpty())
+        directory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/parsecache";
+    
+    // Only the last level of the directory is created by the parse cache
+    QDir().mkpath(directory);
+    return directory;
+}
+
 // Emit double click signal of QListWidget on enter/return key pressed
 bool UEFITool::eventFilter(QObject* obj, QEvent* event)
 {
@@ -818,6 +873,21 @@ void UEFITool::showParserMessages()
     ui->parserMessagesListWidget->scrollToBottom();
 }
 
+void UEFITool::appendParserMessages()
+{
+    if (!ffsParser)
+        return;
+    
+    std::vector<std::pair<QString, QModelIndex> > messages = ffsParser->getMessages();
+    
+    // Messages already shown are kept, so the list stays where the user left it
+    for (size_t i = (size_t)ui->parserMessagesListWidget->count(); i < messages.size(); i++) {
+        QListWidgetItem* item = new QListWidgetItem(messages[i].first, NULL, 0);
+        item->setData(Qt::UserRole, QByteArray((const char*)&messages[i].second, sizeof(messages[i].second)));
+        ui->parserMessagesListWidget->addItem(item);
+    }
+}
+
 void UEFITool::showFinderMessages()
 {
     ui->finderMessagesListWidget->clear();
@@ -942,6 +1012,12 @@ void UEFITool::readSettings()
     ui->structureTreeView->setColumnWidth(3, settings.value("tree/columnWidth3", ui->structureTreeView->columnWidth(3)).toInt());
     markingEnabled = settings.value("tree/markingEnabled", true).toBool();
     ui->actionToggleBootGuardMarking->setChecked(markingEnabled);
+    decompressionCacheEnabled = settings.value("parser/decompressionCacheEnabled", true).toBool();
+    ui->actionToggleDecompressionCache->setChecked(decompressionCacheEnabled);
+    lazyDecompressionEnabled = settings.value("parser/lazyDecompressionEnabled", false).toBool();
+    ui->actionToggleLazyDecompression->setChecked(lazyDecompressionEnabled);
+    parseCacheEnabled = settings.value("parser/parseCacheEnabled", false).toBool();
+    ui->actionToggleParseCache->setChecked(parseCacheEnabled);
     
     // Set monospace font
     QString fontName;
@@ -975,6 +1051,9 @@ void UEFITool::writeSettings()
     settings.setValue("tree/columnWidth2", ui->structureTreeView->columnWidth(2));
     settings.setValue("tree/columnWidth3", ui->structureTreeView->columnWidth(3));
     settings.setValue("tree/markingEnabled", markingEnabled);
+    settings.setValue("parser/decompressionCacheEnabled", decompressionCacheEnabled);
+    settings.setValue("parser/lazyDecompressionEnabled", lazyDecompressionEnabled);
+    settings.setValue("parser/parseCacheEnabled", parseCacheEnabled);
     settings.setValue("mainWindow/fontName", currentFont.family());
     settings.setValue("mainWindow/fontSize", currentFont.pointSize());
 }
@@ -1065,6 +1144,7 @@ void UEFITool::loadDefaultGuidDatabase()
 
 void UEFITool::exportDiscoveredGuids()
 {
+    model->fetchAll();
     GuidDatabase db = guidDatabaseFromTreeRecursive(model, model->index(0, 0));
     if (!db.empty()) {
         QString path = QFileDialog::getSaveFileName(this, tr("Save parsed GUIDs to database"), currentPath + ".guids.csv", tr("Comma-separated values files (*.csv);;All files (*)"));
@@ -32,6 +32,7 @@
 #include <QProcess>
 #include <QSettings>
 #include <QSplitter>
+#include <QStandardPaths>
 #include <QStyleFactory>
 #include <QString>
 #include <QTableWidget>
@@ -42,6 +43,8 @@
 #include "../common/utility.h"
 #include "../common/ffs.h"
 #include "../common/ffsparser.h"
+#include "../common/decompressioncache.h"
+#include "../common/parsecache.h"
 #include "../common/ffsops.h"
 #include "../common/ffsbuilder.h"
 #include "../common/ffsreport.h"
@@ -110,8 +113,12 @@ private slots:
     void copyAllMessages();
     void enableMessagesCopyActions(QListWidgetItem* item);
     void clearMessages();
+    void appendParserMessages();
 
     void toggleBootGuardMarking(bool enabled);
+    void toggleDecompressionCache(bool enabled);
+    void toggleLazyDecompression(bool enabled);
+    void toggleParseCache(bool enabled);
 
     void about();
     void aboutQt();
@@ -139,6 +146,7 @@ private:
     FfsReport* ffsReport;
     FfsOperations* ffsOps;
     FfsBuilder* ffsBuilder;
+    std::shared_ptr<DecompressionCache> decompressionCache;
     SearchDialog* searchDialog;
     HexViewDialog* hexViewDialog;
     GoToBaseDialog* goToBaseDialog;
@@ -150,6 +158,9 @@ private:
     QFont currentFont;
     const QString version;
     bool markingEnabled;
+    bool decompressionCacheEnabled;
+    bool lazyDecompressionEnabled;
+    bool parseCacheEnabled;
 
     bool eventFilter(QObject* obj, QEvent* event);
     void dragEnterEvent(QDragEnterEvent* event);
@@ -157,6 +168,7 @@ private:
     void contextMenuEvent(QContextMenuEvent* event);
     void readSettings();
     void showParserMessages();
+    QString parseCacheDirectory() const;
     void showFinderMessages();
     void showFitTable();
     void showSecurityInfo();
@@ -35,11 +35,18 @@ HEADERS += uefitool.h \
  ../common/parsingdata.h \
  ../common/ffsbuilder.h \
  ../common/ffsparser.h \
+ ../common/parserstats.h \
+ ../common/signaturescanner.h \
+ ../common/taskpool.h \
+ ../common/decompressioncache.h \
+ ../common/kaitaiprobe.h \
  ../common/ffsreport.h \
  ../common/treeitem.h \
  ../common/intel_fit.h \
  ../common/intel_microcode.h \
  ../common/treemodel.h \
+ ../common/parsecache.h \
+ ../common/filesystem.h \
  ../common/LZMA/LzmaCompress.h \
  ../common/LZMA/LzmaDecompress.h \
  ../common/Tiano/EfiTianoDecompress.h \
@@ -50,6 +57,8 @@ HEADERS += uefitool.h \
  ../common/digest/sha1.h \
  ../common/digest/sha2.h \
  ../common/digest/sm3.h \
+ ../common/digest/multidigest.h \
+ ../common/digest/shaext.h \
  ../common/generated/ami_nvar.h \
  ../common/generated/apple_sysf.h \
  ../common/generated/edk2_vss.h \
@@ -108,9 +117,16 @@ SOURCES += uefitool_main.cpp \
  ../common/utility.cpp \
  ../common/ffsbuilder.cpp \
  ../common/ffsparser.cpp \
+ ../common/parserstats.cpp \
+ ../common/signaturescanner.cpp \
+ ../common/taskpool.cpp \
+ ../common/decompressioncache.cpp \
+ ../common/kaitaiprobe.cpp \
  ../common/ffsreport.cpp \
  ../common/treeitem.cpp \
  ../common/treemodel.cpp \
+ ../common/parsecache.cpp \
+ ../common/filesystem.cpp \
  ../common/LZMA/LzmaCompress.c \
  ../common/LZMA/LzmaDecompress.c \
  ../common/LZMA/SDK/C/CpuArch.c \
@@ -127,6 +143,7 @@ SOURCES += uefitool_main.cpp \
  ../common/digest/sha256.c \
  ../common/digest/sha512.c \
  ../common/digest/sm3.c \
+ ../common/digest/multidigest.cpp \
  ../common/generated/ami_nvar.cpp \
  ../common/generated/apple_sysf.cpp \
  ../common/generated/edk2_vss.cpp \
@@ -1092,3 +1092,90 @@ TianoDecompress (
         2
         );
 }
+
+/*++
+
+Routine Description:
+
+Detects the de/compression algorithm by reading the header of the first block.
+The length of the 'Position Set Code Length Array Size' field differs between the algorithms,
+so the Position Set of the first block is only valid for the algorithm used to compress the data.
+
+Arguments:
+
+Source      - The source buffer containing the compressed data.
+SrcSize     - The size of source buffer
+Scratch     - The buffer used internally by the decompress routine. This  buffer is needed to store intermediate data.
+ScratchSize - The size of scratch buffer.
+Versions    - Bit mask of algorithms the data can be decompressed with, bit 0 for EFI 1.1 and bit 1 for Tiano.
+
+Returns:
+
+EFI_SUCCESS           - Detection is done, Versions is 0 if no algorithm is suitable
+EFI_INVALID_PARAMETER - The source data is corrupted
+
+--*/
+EFI_STATUS
+EFIAPI
+EfiTianoProbe (
+    IN      CONST VOID *Source,
+    IN      UINT32     SrcSize,
+    IN OUT  VOID       *Scratch,
+    IN      UINT32     ScratchSize,
+    OUT     UINT8      *Versions
+    )
+{
+    UINT32           CompSize;
+    UINT32           OrigSize;
+    SCRATCH_DATA     *Sd;
+    CONST UINT8      *Src = Source;
+    UINT8            Version;
+
+    if (ScratchSize < sizeof(SCRATCH_DATA) || SrcSize < 8 || Versions == NULL) {
+        return EFI_INVALID_PARAMETER;
+    }
+
+    Sd = (SCRATCH_DATA *)Scratch;
+
+    CompSize = Src[0] + (Src[1] << 8) + (Src[2] << 16) + (Src[3] << 24);
+    OrigSize = Src[4] + (Src[5] << 8) + (Src[6] << 16) + (Src[7] << 24);
+
+    //
+    // Empty data is the same for both algorithms
+    //
+    if (OrigSize == 0) {
+        *Versions = 3;
+        return EFI_SUCCESS;
+    }
+
+    if (SrcSize < CompSize + 8) {
+        return EFI_INVALID_PARAMETER;
+    }
+
+    *Versions = 0;
+    for (Version = 1; Version <= 2; Version++) {
+        SetMem (Sd, sizeof(SCRATCH_DATA), 0);
+        Sd->mPBit = (Version == 1) ? 4 : 5;
+        Sd->mSrcBase = (UINT8*)(Src + 8);
+        Sd->mCompSize = CompSize;
+        Sd->mOrigSize = OrigSize;
+
+        FillBuf (Sd, BITBUFSIZ);
+
+        //
+        // Read the header of the first block the same way DecodeC does
+        //
+        Sd->mBlockSize = (UINT16)GetBits (Sd, 16);
+        if (ReadPTLen (Sd, NT, TBIT, 3) != 0) {
+            continue;
+        }
+        ReadCLen (Sd);
+        if (ReadPTLen (Sd, MAXNP, Sd->mPBit, (UINT16)(-1)) != 0) {
+            continue;
+        }
+
+        *Versions |= (UINT8)(1U << (Version - 1));
+    }
+
+    return EFI_SUCCESS;
+}
@@ -130,6 +130,36 @@ TianoDecompress(
     IN      UINT32     ScratchSize
     );
 
+/*++
+
+Routine Description:
+
+Detects the de/compression algorithm by reading the header of the first block.
+
+Arguments:
+
+Source      - The source buffer containing the compressed data.
+SrcSize     - The size of source buffer
+Scratch     - The buffer used internally by the decompress routine. This  buffer is needed to store intermediate data.
+ScratchSize - The size of scratch buffer.
+Versions    - Bit mask of algorithms the data can be decompressed with, bit 0 for EFI 1.1 and bit 1 for Tiano.
+
+Returns:
+
+EFI_SUCCESS           - Detection is done, Versions is 0 if no algorithm is suitable
+EFI_INVALID_PARAMETER - The source data is corrupted
+
+--*/
+EFI_STATUS
+EFIAPI
+EfiTianoProbe(
+    IN      CONST VOID *Source,
+    IN      UINT32     SrcSize,
+    IN OUT  VOID       *Scratch,
+    IN      UINT32     ScratchSize,
+    OUT     UINT8      *Versions
+    );
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,99 @@
+/* decompressioncache.cpp
+
+Copyright (c) 2026, Nikolaj Schlej. All rights reserved.
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+*/
+
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+
+#include "decompressioncache.h"
+#include "digest/sha2.h"
+
+DecompressionCache::DecompressionCache(const UINT64 maxSize) : maxSize(maxSize), currentSize(0)
+{
+}
+
+DecompressionCache::KEY DecompressionCache::makeKey(const UINT8 compressionType, const UINT8 inflateAlgorithm, const UByteArray & compressed)
+{
+    UINT8 hash[SHA256_HASH_SIZE];
+    sha256(compressed.constData(), compressed.size(), hash);
+    return KEY(std::make_pair(compressionType, inflateAlgorithm), std::string((const char*)hash, sizeof(hash)));
+}
+
+UINT64 DecompressionCache::resultSize(const DECOMPRESSION_RESULT & result)
+{
+    return (UINT64)result.decompressed.size() + (UINT64)result.efiDecompressed.size();
+}
+
+bool DecompressionCache::find(const KEY & key, DECOMPRESSION_RESULT & result)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::map<KEY, ENTRIES::iterator>::iterator found = index.find(key);
+    if (found == index.end())
+        return false;
+    
+    // Move the entry to the front, so it is dropped last
+    entries.splice(entries.begin(), entries, found->second);
+    result = found->second->second;
+    return true;
+}
+
+void DecompressionCache::insert(const KEY & key, const DECOMPRESSION_RESULT & result)
+{
+    // Results larger than the whole cache are not stored
+    UINT64 size = resultSize(result);
+    if (size > maxSize)
+        return;
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    if (index.count(key))
+        return;
+    
+    // Drop least recently used results until the new one fits
+    while (!entries.empty() && currentSize + size > maxSize) {
+        currentSize -= resultSize(entries.back().second);
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+    
+    entries.push_front(std::make_pair(key, result));
+    index[key] = entries.begin();
+    currentSize += size;
+}
+
+void DecompressionCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    index.clear();
+    currentSize = 0;
+}
+
+UINT64 DecompressionCache::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return currentSize;
+}
+
+bool DecompressionCache::parseMaxSize(const char* text, UINT64 & maxSize)
+{
+    if (!text || !isdigit((unsigned char)text[0]))
+        return false;
+    char* end = NULL;
+    errno = 0;
+    unsigned long long value = strtoull(text, &end, 10);
+    // Size in bytes must fit into 64 bits
+    if (*end != '\0' || errno == ERANGE || value > (~0ULL >> 20))
+        return false;
+    maxSize = (UINT64)value * 1024 * 1024;
+    return true;
+}
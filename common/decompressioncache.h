@@ -0,0 +1,71 @@
+/* decompressioncache.h
+
+Copyright (c) 2026, Nikolaj Schlej. All rights reserved.
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+*/
+
+#ifndef DECOMPRESSIONCACHE_H
+#define DECOMPRESSIONCACHE_H
+
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "basetypes.h"
+#include "ubytearray.h"
+
+// Successful decompression results, as returned by decompress()
+typedef struct DECOMPRESSION_RESULT_ {
+    UINT8 algorithm;
+    UINT32 dictionarySize;
+    UByteArray decompressed;
+    UByteArray efiDecompressed;
+} DECOMPRESSION_RESULT;
+
+// In-memory cache of decompression results, keyed by compression type, inflate algorithm and SHA-256 of compressed data
+// Identical compressed data share the same decompressed buffers, least recently used results are dropped when the cache is full
+// Can be shared by several parsers, including the ones running in parallel
+class DecompressionCache
+{
+public:
+    // Maximum size is the total size of decompressed data kept in the cache
+    explicit DecompressionCache(const UINT64 maxSize);
+    ~DecompressionCache() {}
+
+    // EFI compression type is taken from compressed and GUID defined sections, inflate algorithm is only set for GZip and Zlib GUID defined ones
+    // Key is calculated once, so a missing result can be inserted without hashing compressed data again
+    typedef std::pair<std::pair<UINT8, UINT8>, std::string> KEY; // Compression type, inflate algorithm and SHA-256 of compressed data
+    static KEY makeKey(const UINT8 compressionType, const UINT8 inflateAlgorithm, const UByteArray & compressed);
+    bool find(const KEY & key, DECOMPRESSION_RESULT & result);
+    void insert(const KEY & key, const DECOMPRESSION_RESULT & result);
+
+    void clear();
+    UINT64 size() const;
+
+    // Parses a non-negative decimal size in MiB and returns it in bytes, zero means no cache
+    static bool parseMaxSize(const char* text, UINT64 & maxSize);
+
+private:
+    DecompressionCache(const DecompressionCache &);
+    DecompressionCache & operator=(const DecompressionCache &);
+
+    typedef std::list<std::pair<KEY, DECOMPRESSION_RESULT> > ENTRIES; // Most recently used first
+    static UINT64 resultSize(const DECOMPRESSION_RESULT & result);
+
+    UINT64 maxSize;
+    UINT64 currentSize;
+    ENTRIES entries;
+    std::map<KEY, ENTRIES::iterator> index;
+    mutable std::mutex mutex;
+};
+
+#endif // DECOMPRESSIONCACHE_H
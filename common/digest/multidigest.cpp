@@ -0,0 +1,131 @@
+/* multidigest.cpp
+
+Copyright (c) 2026, Nikolaj Schlej. All rights reserved.
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+*/
+
+#include <algorithm>
+#include <functional>
+#include <string.h>
+
+#include "multidigest.h"
+#include "../taskpool.h"
+
+// Chunks are small enough to stay in cache while all hashers process them
+static const size_t DigestChunkSize = 0x8000;
+
+MultiDigest::MultiDigest(const UINT32 algorithms) : requested(algorithms & DIGEST_ALGORITHM_MASK_ALL), finished(false)
+{
+    memset(digests, 0, sizeof(digests));
+    sha1_init(&sha1State);
+    sha256_init(&sha256State);
+    sha384_init(&sha384State);
+    sha512_init(&sha512State);
+    sm3_init(&sm3State);
+}
+
+UINT32 MultiDigest::digestSize(const DigestAlgorithm algorithm)
+{
+    switch (algorithm) {
+        case DigestSha1:   return SHA1_HASH_SIZE;
+        case DigestSha256: return SHA256_HASH_SIZE;
+        case DigestSha384: return SHA384_HASH_SIZE;
+        case DigestSha512: return SHA512_HASH_SIZE;
+        case DigestSm3:    return SM3_HASH_SIZE;
+        default:           return 0;
+    }
+}
+
+void MultiDigest::updateAlgorithm(const DigestAlgorithm algorithm, const UINT8* data, size_t size)
+{
+    // Digest routines take the size as unsigned long, so the data is fed in chunks
+    while (size > 0) {
+        unsigned long length = (unsigned long)std::min(size, DigestChunkSize);
+        switch (algorithm) {
+            case DigestSha1:   sha1_process(&sha1State, data, length); break;
+            case DigestSha256: sha256_process(&sha256State, data, length); break;
+            case DigestSha384: sha512_process(&sha384State, data, length); break;
+            case DigestSha512: sha512_process(&sha512State, data, length); break;
+            case DigestSm3:    sm3_update(&sm3State, data, length); break;
+            default: break;
+        }
+        data += length;
+        size -= length;
+    }
+}
+
+void MultiDigest::update(const void* data, const size_t size)
+{
+    if (finished)
+        return;
+    
+    const UINT8* current = (const UINT8*)data;
+    for (size_t offset = 0; offset < size; offset += DigestChunkSize) {
+        const size_t length = std::min(DigestChunkSize, size - offset);
+        for (int i = 0; i < DigestAlgorithmCount; i++) {
+            if (requested & DIGEST_ALGORITHM_MASK(i))
+                updateAlgorithm((DigestAlgorithm)i, current + offset, length);
+        }
+    }
+}
+
+void MultiDigest::update(const std::vector<UByteArray> & parts, TaskPool* taskPool)
+{
+    if (finished)
+        return;
+    
+    std::vector<std::function<void()> > tasks;
+    if (taskPool) {
+        for (int i = 0; i < DigestAlgorithmCount; i++) {
+            if (requested & DIGEST_ALGORITHM_MASK(i)) {
+                tasks.push_back([this, &parts, i]() {
+                    for (size_t j = 0; j < parts.size(); j++)
+                        updateAlgorithm((DigestAlgorithm)i, (const UINT8*)parts[j].constData(), (size_t)parts[j].size());
+                });
+            }
+        }
+    }
+    
+    // Every hasher has its own state, so they can run in parallel
+    if (tasks.size() > 1) {
+        taskPool->run(tasks);
+        return;
+    }
+    
+    for (size_t j = 0; j < parts.size(); j++)
+        update(parts[j].constData(), (size_t)parts[j].size());
+}
+
+void MultiDigest::finish()
+{
+    if (finished)
+        return;
+    
+    if (requested & DIGEST_ALGORITHM_MASK(DigestSha1))
+        sha1_done(&sha1State, digests[DigestSha1]);
+    if (requested & DIGEST_ALGORITHM_MASK(DigestSha256))
+        sha256_done(&sha256State, digests[DigestSha256]);
+    if (requested & DIGEST_ALGORITHM_MASK(DigestSha384))
+        sha384_done(&sha384State, digests[DigestSha384]);
+    if (requested & DIGEST_ALGORITHM_MASK(DigestSha512))
+        sha512_done(&sha512State, digests[DigestSha512]);
+    if (requested & DIGEST_ALGORITHM_MASK(DigestSm3))
+        sm3_final(&sm3State, digests[DigestSm3]);
+    finished = true;
+}
+
+UByteArray MultiDigest::digest(const DigestAlgorithm algorithm)
+{
+    if (algorithm >= DigestAlgorithmCount || !(requested & DIGEST_ALGORITHM_MASK(algorithm)))
+        return UByteArray();
+    
+    finish();
+    return UByteArray((const char*)digests[algorithm], (int)digestSize(algorithm));
+}
@@ -0,0 +1,71 @@
+/* multidigest.h
+
+Copyright (c) 2026, Nikolaj Schlej. All rights reserved.
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+*/
+
+#ifndef MULTIDIGEST_H
+#define MULTIDIGEST_H
+
+#include <vector>
+
+#include "../basetypes.h"
+#include "../ubytearray.h"
+#include "sha1.h"
+#include "sha2.h"
+#include "sm3.h"
+
+class TaskPool;
+
+enum DigestAlgorithm {
+    DigestSha1 = 0,
+    DigestSha256,
+    DigestSha384,
+    DigestSha512,
+    DigestSm3,
+    DigestAlgorithmCount
+};
+
+#define DIGEST_ALGORITHM_MASK(algorithm) (1U << (algorithm))
+#define DIGEST_ALGORITHM_MASK_ALL        ((1U << DigestAlgorithmCount) - 1)
+
+// Digests of several algorithms calculated over the same data in a single pass
+class MultiDigest
+{
+public:
+    // Algorithms is a combination of DIGEST_ALGORITHM_MASK values
+    explicit MultiDigest(const UINT32 algorithms);
+
+    // Data is fed to all hashers in chunks small enough to stay in cache
+    void update(const void* data, const size_t size);
+    // Data is the concatenation of parts, i.e. slices of the same image, without copying them together
+    // If a task pool is given, each hasher processes all parts in its own task
+    void update(const std::vector<UByteArray> & parts, TaskPool* taskPool = NULL);
+
+    // Digest of a requested algorithm, finishes all digests on first call, so no data can be added afterwards
+    UByteArray digest(const DigestAlgorithm algorithm);
+
+    static UINT32 digestSize(const DigestAlgorithm algorithm);
+
+private:
+    void updateAlgorithm(const DigestAlgorithm algorithm, const UINT8* data, size_t size);
+    void finish();
+
+    UINT32 requested;
+    bool finished;
+    struct sha1_state sha1State;
+    struct sha256_state sha256State;
+    struct sha512_state sha384State;
+    struct sha512_state sha512State;
+    struct sm3_context sm3State;
+    UINT8 digests[DigestAlgorithmCount][SHA512_HASH_SIZE];
+};
+
+#endif // MULTIDIGEST_H
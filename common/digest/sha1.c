@@ -16,6 +16,7 @@
 // public domain by Tom St Denis.
 //
 #include "sha1.h"
+#include "shaext.h"
 #include <stdint.h>
 #include <string.h>
 
@@ -58,14 +59,66 @@ do { (y)[0] = (unsigned char)(((x)>>56)&255); (y)[1] = (unsigned char)(((x)>>48)
 #define F2(x,y,z)  ((x & y) | (z & (x | y)))
 #define F3(x,y,z)  (x ^ y ^ z)
 
-struct sha1_state {
-    ulong64 length;
-    ulong32 state[5], curlen;
-    unsigned char buf[64];
-};
+#ifdef DIGEST_SHA_EXTENSIONS
+/* four rounds of a block, message words are expanded in a ring of four registers */
+#define SHA1_EXT_ROUNDS(g, f)                                                                               \
+    do {                                                                                                    \
+        if ((g) < 4)                                                                                        \
+            msg[(g) & 3] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(buf + 16 * (g))), mask);       \
+        if ((g) == 0)                                                                                       \
+            e[0] = _mm_add_epi32(e[0], msg[0]);                                                             \
+        else                                                                                                \
+            e[(g) & 1] = _mm_sha1nexte_epu32(e[(g) & 1], msg[(g) & 3]);                                     \
+        e[((g) + 1) & 1] = abcd;                                                                            \
+        abcd = _mm_sha1rnds4_epu32(abcd, e[(g) & 1], f);                                                    \
+        if ((g) >= 3 && (g) <= 18)                                                                          \
+            msg[((g) + 1) & 3] = _mm_sha1msg2_epu32(msg[((g) + 1) & 3], msg[(g) & 3]);                      \
+        if ((g) >= 1 && (g) <= 16)                                                                          \
+            msg[((g) + 3) & 3] = _mm_sha1msg1_epu32(msg[((g) + 3) & 3], msg[(g) & 3]);                      \
+        if ((g) >= 2 && (g) <= 17)                                                                          \
+            msg[((g) + 2) & 3] = _mm_xor_si128(msg[((g) + 2) & 3], msg[(g) & 3]);                           \
+    } while (0)
+
+/* compress blocks of 512-bits using SHA extensions */
+SHA_EXTENSIONS_TARGET
+static void s_sha1_compress_ext(ulong32 *state, const unsigned char *buf, unsigned long blocks)
+{
+    const __m128i mask = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+    __m128i abcd, abcd_save, e_save, e[2], msg[4];
+
+    abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)state), 0x1B);
+    e[0] = _mm_set_epi32((int)state[4], 0, 0, 0);
+    e[1] = msg[0] = msg[1] = msg[2] = msg[3] = _mm_setzero_si128();
+
+    while (blocks--) {
+        abcd_save = abcd;
+        e_save = e[0];
+
+        SHA1_EXT_ROUNDS(0, 0);  SHA1_EXT_ROUNDS(1, 0);  SHA1_EXT_ROUNDS(2, 0);  SHA1_EXT_ROUNDS(3, 0);  SHA1_EXT_ROUNDS(4, 0);
+        SHA1_EXT_ROUNDS(5, 1);  SHA1_EXT_ROUNDS(6, 1);  SHA1_EXT_ROUNDS(7, 1);  SHA1_EXT_ROUNDS(8, 1);  SHA1_EXT_ROUNDS(9, 1);
+        SHA1_EXT_ROUNDS(10, 2); SHA1_EXT_ROUNDS(11, 2); SHA1_EXT_ROUNDS(12, 2); SHA1_EXT_ROUNDS(13, 2); SHA1_EXT_ROUNDS(14, 2);
+        SHA1_EXT_ROUNDS(15, 3); SHA1_EXT_ROUNDS(16, 3); SHA1_EXT_ROUNDS(17, 3); SHA1_EXT_ROUNDS(18, 3); SHA1_EXT_ROUNDS(19, 3);
+
+        e[0] = _mm_sha1nexte_epu32(e[0], e_save);
+        abcd = _mm_add_epi32(abcd, abcd_save);
+        buf += 64;
+    }
+
+    _mm_storeu_si128((__m128i*)state, _mm_shuffle_epi32(abcd, 0x1B));
+    state[4] = (ulong32)_mm_extract_epi32(e[0], 3);
+}
+
+#undef SHA1_EXT_ROUNDS
+#endif
 
 static int s_sha1_compress(struct sha1_state *md, const unsigned char *buf)
 {
+#ifdef DIGEST_SHA_EXTENSIONS
+    if (sha_extensions_supported()) {
+        s_sha1_compress_ext(md->state, buf, 1);
+        return 0;
+    }
+#endif
     ulong32 a,b,c,d,e,W[80],i;
     ulong32 t;
 
@@ -121,7 +174,7 @@ static int s_sha1_compress(struct sha1_state *md, const unsigned char *buf)
     return 0;
 }
 
-static int sha1_init(struct sha1_state * md)
+int sha1_init(struct sha1_state * md)
 {
    if (md == NULL) return -1;
    md->state[0] = 0x67452301UL;
@@ -134,7 +187,7 @@ static int sha1_init(struct sha1_state * md)
    return 0;
 }
 
-static int sha1_process(struct sha1_state * md, const unsigned char *in, unsigned long inlen)
+int sha1_process(struct sha1_state * md, const unsigned char *in, unsigned long inlen)
 {
     unsigned long n;
     int err;
@@ -148,6 +201,17 @@ static int sha1_process(struct sha1_state * md, const unsigned char *in, unsigne
         return -1;
     }
     while (inlen > 0) {
+#ifdef DIGEST_SHA_EXTENSIONS
+        /* all complete blocks are compressed at once, keeping the state in registers */
+        if (md->curlen == 0 && inlen >= 64 && sha_extensions_supported()) {
+            n = inlen / 64;
+            s_sha1_compress_ext(md->state, in, n);
+            md->length += (ulong64)n * 64 * 8;
+            in         += n * 64;
+            inlen      -= n * 64;
+            continue;
+        }
+#endif
         if (md->curlen == 0 && inlen >= 64) {
             if ((err = s_sha1_compress(md, in)) != 0) {
                 return err;
@@ -173,7 +237,7 @@ static int sha1_process(struct sha1_state * md, const unsigned char *in, unsigne
     return 0;
 }
 
-static int sha1_done(struct sha1_state * md, unsigned char *out)
+int sha1_done(struct sha1_state * md, unsigned char *out)
 {
     int i;
 
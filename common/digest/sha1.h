@@ -17,6 +17,19 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 extern "C" {
 #endif
 
+#include <stdint.h>
+
+struct sha1_state {
+    uint64_t length;
+    uint32_t state[5], curlen;
+    unsigned char buf[64];
+};
+
+// Incremental interface, for data that isn't available at once
+int sha1_init(struct sha1_state * md);
+int sha1_process(struct sha1_state * md, const unsigned char *in, unsigned long inlen);
+int sha1_done(struct sha1_state * md, unsigned char *out);
+
 void sha1(const void *in, unsigned long inlen, void* out);
 
 #ifdef __cplusplus
@@ -17,6 +17,7 @@
 //
 
 #include "sha2.h"
+#include "shaext.h"
 #include <stdint.h>
 #include <string.h>
 
@@ -63,15 +64,81 @@ do { (y)[0] = (unsigned char)(((x)>>56)&255); (y)[1] = (unsigned char)(((x)>>48)
 #define Gamma0(x)       (S(x, 7) ^ S(x, 18) ^ R(x, 3))
 #define Gamma1(x)       (S(x, 17) ^ S(x, 19) ^ R(x, 10))
 
-struct sha256_state {
-    ulong64 length;
-    ulong32 state[8], curlen;
-    unsigned char buf[32*2];
+#ifdef DIGEST_SHA_EXTENSIONS
+static const ulong32 K_EXT[64] = {
+    0x428a2f98UL, 0x71374491UL, 0xb5c0fbcfUL, 0xe9b5dba5UL, 0x3956c25bUL, 0x59f111f1UL, 0x923f82a4UL, 0xab1c5ed5UL,
+    0xd807aa98UL, 0x12835b01UL, 0x243185beUL, 0x550c7dc3UL, 0x72be5d74UL, 0x80deb1feUL, 0x9bdc06a7UL, 0xc19bf174UL,
+    0xe49b69c1UL, 0xefbe4786UL, 0x0fc19dc6UL, 0x240ca1ccUL, 0x2de92c6fUL, 0x4a7484aaUL, 0x5cb0a9dcUL, 0x76f988daUL,
+    0x983e5152UL, 0xa831c66dUL, 0xb00327c8UL, 0xbf597fc7UL, 0xc6e00bf3UL, 0xd5a79147UL, 0x06ca6351UL, 0x14292967UL,
+    0x27b70a85UL, 0x2e1b2138UL, 0x4d2c6dfcUL, 0x53380d13UL, 0x650a7354UL, 0x766a0abbUL, 0x81c2c92eUL, 0x92722c85UL,
+    0xa2bfe8a1UL, 0xa81a664bUL, 0xc24b8b70UL, 0xc76c51a3UL, 0xd192e819UL, 0xd6990624UL, 0xf40e3585UL, 0x106aa070UL,
+    0x19a4c116UL, 0x1e376c08UL, 0x2748774cUL, 0x34b0bcb5UL, 0x391c0cb3UL, 0x4ed8aa4aUL, 0x5b9cca4fUL, 0x682e6ff3UL,
+    0x748f82eeUL, 0x78a5636fUL, 0x84c87814UL, 0x8cc70208UL, 0x90befffaUL, 0xa4506cebUL, 0xbef9a3f7UL, 0xc67178f2UL
 };
 
+/* four rounds of a block, message words are expanded in a ring of four registers */
+#define SHA256_EXT_ROUNDS(g)                                                                                \
+    do {                                                                                                    \
+        if ((g) < 4)                                                                                        \
+            msg[(g) & 3] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(buf + 16 * (g))), mask);       \
+        tmp = _mm_add_epi32(msg[(g) & 3], _mm_loadu_si128((const __m128i*)(K_EXT + 4 * (g))));             \
+        state1 = _mm_sha256rnds2_epu32(state1, state0, tmp);                                                \
+        if ((g) >= 3 && (g) <= 14) {                                                                        \
+            msg[((g) + 1) & 3] = _mm_add_epi32(msg[((g) + 1) & 3], _mm_alignr_epi8(msg[(g) & 3], msg[((g) + 3) & 3], 4)); \
+            msg[((g) + 1) & 3] = _mm_sha256msg2_epu32(msg[((g) + 1) & 3], msg[(g) & 3]);                    \
+        }                                                                                                   \
+        tmp = _mm_shuffle_epi32(tmp, 0x0E);                                                                 \
+        state0 = _mm_sha256rnds2_epu32(state0, state1, tmp);                                                \
+        if ((g) >= 1 && (g) <= 12)                                                                          \
+            msg[((g) + 3) & 3] = _mm_sha256msg1_epu32(msg[((g) + 3) & 3], msg[(g) & 3]);                    \
+    } while (0)
+
+/* compress blocks of 512-bits using SHA extensions */
+SHA_EXTENSIONS_TARGET
+static void s_sha256_compress_ext(ulong32 *state, const unsigned char *buf, unsigned long blocks)
+{
+    const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i state0, state1, save0, save1, tmp, msg[4];
+
+    /* state is kept as ABEF and CDGH */
+    tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&state[0]), 0xB1);
+    state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&state[4]), 0x1B);
+    state0 = _mm_alignr_epi8(tmp, state1, 8);
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+    msg[0] = msg[1] = msg[2] = msg[3] = _mm_setzero_si128();
+
+    while (blocks--) {
+        save0 = state0;
+        save1 = state1;
+
+        SHA256_EXT_ROUNDS(0);  SHA256_EXT_ROUNDS(1);  SHA256_EXT_ROUNDS(2);  SHA256_EXT_ROUNDS(3);
+        SHA256_EXT_ROUNDS(4);  SHA256_EXT_ROUNDS(5);  SHA256_EXT_ROUNDS(6);  SHA256_EXT_ROUNDS(7);
+        SHA256_EXT_ROUNDS(8);  SHA256_EXT_ROUNDS(9);  SHA256_EXT_ROUNDS(10); SHA256_EXT_ROUNDS(11);
+        SHA256_EXT_ROUNDS(12); SHA256_EXT_ROUNDS(13); SHA256_EXT_ROUNDS(14); SHA256_EXT_ROUNDS(15);
+
+        state0 = _mm_add_epi32(state0, save0);
+        state1 = _mm_add_epi32(state1, save1);
+        buf += 64;
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);
+    state1 = _mm_shuffle_epi32(state1, 0xB1);
+    _mm_storeu_si128((__m128i*)&state[0], _mm_blend_epi16(tmp, state1, 0xF0));
+    _mm_storeu_si128((__m128i*)&state[4], _mm_alignr_epi8(state1, tmp, 8));
+}
+
+#undef SHA256_EXT_ROUNDS
+#endif
+
 /* compress 512-bits */
 static int s_sha256_compress(struct sha256_state * md, const unsigned char *buf)
 {
+#ifdef DIGEST_SHA_EXTENSIONS
+    if (sha_extensions_supported()) {
+        s_sha256_compress_ext(md->state, buf, 1);
+        return 0;
+    }
+#endif
     ulong32 S[8], W[64], t0, t1;
     int i;
 
@@ -170,7 +237,7 @@ static int s_sha256_compress(struct sha256_state * md, const unsigned char *buf)
     return 0;
 }
 
-static int sha256_init(struct sha256_state * md)
+int sha256_init(struct sha256_state * md)
 {
     if (md == NULL) return -1;
     md->curlen = 0;
@@ -186,7 +253,7 @@ static int sha256_init(struct sha256_state * md)
     return 0;
 }
 
-static int sha256_process(struct sha256_state * md, const unsigned char *in, unsigned long inlen)
+int sha256_process(struct sha256_state * md, const unsigned char *in, unsigned long inlen)
 {
     unsigned long n;
     int err;
@@ -200,6 +267,17 @@ static int sha256_process(struct sha256_state * md, const unsigned char *in, uns
         return -1;
     }
     while (inlen > 0) {
+#ifdef DIGEST_SHA_EXTENSIONS
+        /* all complete blocks are compressed at once, keeping the state in registers */
+        if (md->curlen == 0 && inlen >= 64 && sha_extensions_supported()) {
+            n = inlen / 64;
+            s_sha256_compress_ext(md->state, in, n);
+            md->length += (ulong64)n * 64 * 8;
+            in         += n * 64;
+            inlen      -= n * 64;
+            continue;
+        }
+#endif
         if (md->curlen == 0 && inlen >= 64) {
             if ((err = s_sha256_compress(md, in)) != 0) {
                 return err;
@@ -225,7 +303,7 @@ static int sha256_process(struct sha256_state * md, const unsigned char *in, uns
     return 0;
 }
 
-static int sha256_done(struct sha256_state * md, unsigned char *out)
+int sha256_done(struct sha256_state * md, unsigned char *out)
 {
     int i;
 
@@ -105,12 +105,6 @@ CONST64(0x5fcb6fab3ad6faec), CONST64(0x6c44198c4a475817)
 #define Gamma0(x)       (S(x, 1) ^ S(x, 8) ^ R(x, 7))
 #define Gamma1(x)       (S(x, 19) ^ S(x, 61) ^ R(x, 6))
 
-struct sha512_state {
-    ulong64  length, state[8];
-    unsigned long curlen;
-    unsigned char buf[128];
-};
-
 /* compress 1024-bits */
 static int s_sha512_compress(struct sha512_state * md, const unsigned char *buf)
 {
@@ -158,7 +152,7 @@ static int s_sha512_compress(struct sha512_state * md, const unsigned char *buf)
     return 0;
 }
 
-static int sha512_init(struct sha512_state * md)
+int sha512_init(struct sha512_state * md)
 {
     if (md == NULL) return -1;
     md->curlen = 0;
@@ -174,7 +168,7 @@ static int sha512_init(struct sha512_state * md)
     return 0;
 }
 
-static int sha512_process(struct sha512_state * md, const unsigned char *in, unsigned long inlen)
+int sha512_process(struct sha512_state * md, const unsigned char *in, unsigned long inlen)
 {
     unsigned long n;
     int err;
@@ -213,7 +207,7 @@ static int sha512_process(struct sha512_state * md, const unsigned char *in, uns
     return 0;
 }
 
-static int sha512_done(struct sha512_state * md, unsigned char *out)
+int sha512_done(struct sha512_state * md, unsigned char *out)
 {
     int i;
 
@@ -262,7 +256,7 @@ static int sha512_done(struct sha512_state * md, unsigned char *out)
     return 0;
 }
 
-static int sha384_init(struct sha512_state * md)
+int sha384_init(struct sha512_state * md)
 {
     if (md == NULL) return -1;
 
@@ -279,7 +273,7 @@ static int sha384_init(struct sha512_state * md)
     return 0;
 }
 
-static int sha384_done(struct sha512_state * md, unsigned char *out)
+int sha384_done(struct sha512_state * md, unsigned char *out)
 {
     unsigned char buf[64];
 
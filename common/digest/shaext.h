@@ -0,0 +1,68 @@
+/* shaext.h
+
+Copyright (c) 2026, Nikolaj Schlej. All rights reserved.
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+*/
+
+#ifndef SHAEXT_H
+#define SHAEXT_H
+
+// Intel SHA extensions are available on x86 CPUs since Goldmont and Zen, they are detected at runtime
+// DIGEST_NO_SHA_EXTENSIONS can be defined to use the portable implementation only
+#if (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)) && !defined(DIGEST_NO_SHA_EXTENSIONS)
+#define DIGEST_SHA_EXTENSIONS
+
+#include <immintrin.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define SHA_EXTENSIONS_TARGET
+#define SHA_EXTENSIONS_LOAD(x)     (*(volatile int*)&(x))
+#define SHA_EXTENSIONS_STORE(x, v) (*(volatile int*)&(x) = (v))
+#else
+#include <cpuid.h>
+#define SHA_EXTENSIONS_TARGET __attribute__((target("sha,sse4.1")))
+#define SHA_EXTENSIONS_LOAD(x)     __atomic_load_n(&(x), __ATOMIC_RELAXED)
+#define SHA_EXTENSIONS_STORE(x, v) __atomic_store_n(&(x), (v), __ATOMIC_RELAXED)
+#endif
+
+// Returns non-zero if the CPU supports SHA extensions and SSSE3/SSE4.1 instructions used with them, the result is cached
+static int sha_extensions_supported(void)
+{
+    static int supported = -1;
+    int result = SHA_EXTENSIONS_LOAD(supported);
+    if (result < 0) {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int regs[4];
+        __cpuid(regs, 0);
+        result = 0;
+        if (regs[0] >= 7) {
+            __cpuid(regs, 1);
+            const int ecx1 = regs[2];
+            __cpuidex(regs, 7, 0);
+            result = (ecx1 & (1 << 9)) && (ecx1 & (1 << 19)) && (regs[1] & (1 << 29));
+        }
+#else
+        unsigned int eax, ebx, ecx, edx;
+        result = 0;
+        if (__get_cpuid_max(0, 0) >= 7 && __get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+            const unsigned int ecx1 = ecx;
+            __cpuid_count(7, 0, eax, ebx, ecx, edx);
+            result = (ecx1 & (1u << 9)) && (ecx1 & (1u << 19)) && (ebx & (1u << 29));
+        }
+#endif
+        SHA_EXTENSIONS_STORE(supported, result);
+    }
+    return result;
+}
+
+#endif
+
+#endif // SHAEXT_H
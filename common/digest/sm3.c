@@ -5,18 +5,6 @@
 #include "sm3.h"
 #include <string.h>
 
-struct sm3_context {
-    uint32_t total[2];   /* number of bytes processed */
-    uint32_t state[8];   /* intermediate digest state */
-    uint8_t buffer[64];  /* data block being processed */
-    uint8_t ipad[64];    /* HMAC: inner padding */
-    uint8_t opad[64];    /* HMAC: outer padding */
-};
-
-static void sm3_init(struct sm3_context *ctx);
-static void sm3_update(struct sm3_context *ctx, const uint8_t *input, size_t ilen);
-static void sm3_final(struct sm3_context *ctx, uint8_t* output);
-
 #define GET_UINT32_BE(n, b, i)				\
 	do {						\
 		(n) = ((uint32_t)(b)[(i)] << 24)     |	\
@@ -33,7 +21,7 @@ static void sm3_final(struct sm3_context *ctx, uint8_t* output);
 		(b)[(i) + 3] = (uint8_t)((n));		\
 	} while (0)
 
-static void sm3_init(struct sm3_context *ctx)
+void sm3_init(struct sm3_context *ctx)
 {
 	ctx->total[0] = 0;
 	ctx->total[1] = 0;
@@ -156,7 +144,7 @@ static void sm3_process(struct sm3_context *ctx, const uint8_t data[64])
 	ctx->state[7] ^= H;
 }
 
-static void sm3_update(struct sm3_context *ctx, const uint8_t *input, size_t ilen)
+void sm3_update(struct sm3_context *ctx, const uint8_t *input, size_t ilen)
 {
 	size_t fill;
 	size_t left;
@@ -197,7 +185,7 @@ static const uint8_t sm3_padding[64] = {
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
 };
 
-static void sm3_final(struct sm3_context *ctx, uint8_t* output)
+void sm3_final(struct sm3_context *ctx, uint8_t* output)
 {
 	uint32_t last, padn;
 	uint32_t high, low;
@@ -24,6 +24,19 @@ extern "C" {
 #include <stddef.h>
 #include <stdint.h>
 
+struct sm3_context {
+    uint32_t total[2];   /* number of bytes processed */
+    uint32_t state[8];   /* intermediate digest state */
+    uint8_t buffer[64];  /* data block being processed */
+    uint8_t ipad[64];    /* HMAC: inner padding */
+    uint8_t opad[64];    /* HMAC: outer padding */
+};
+
+/* Incremental interface, for data that isn't available at once */
+void sm3_init(struct sm3_context *ctx);
+void sm3_update(struct sm3_context *ctx, const uint8_t *input, size_t ilen);
+void sm3_final(struct sm3_context *ctx, uint8_t* output);
+
 void sm3(const void *in, unsigned long inlen, void* out);
 
 #ifdef __cplusplus
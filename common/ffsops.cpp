@@ -40,6 +40,8 @@ USTATUS FfsOperations::extract(const UModelIndex & index, UString & name, UByteA
     }
     else if (mode == EXTRACT_MODE_BODY_UNCOMPRESSED) {
         name += UString("_body_uncompressed");
+        if (model->canFetchMore(index))
+            model->fetchMore(index);
         extracted.clear();
         extracted += model->uncompressedData(index);
     }
@@ -30,21 +30,33 @@
 #include "nvramparser.h"
 #include "meparser.h"
 #include "fitparser.h"
+#include "taskpool.h"
+#include "decompressioncache.h"
 
-#include "digest/sha1.h"
-#include "digest/sha2.h"
-#include "digest/sm3.h"
+#include "digest/multidigest.h"
 
 #include "umemstream.h"
 #include "kaitai/kaitaistream.h"
 #include "generated/insyde_fdm.h"
 
+// Signatures of items that can be found in raw areas, a new item type is added by registering its signature and validation routine here
+const FfsParser::RAW_AREA_SIGNATURE FfsParser::rawAreaSignatures[] = {
+    { INTEL_MICROCODE_HEADER_VERSION_1, 0, &FfsParser::checkRawAreaMicrocode },
+    { EFI_FV_SIGNATURE, EFI_FV_SIGNATURE_OFFSET, &FfsParser::checkRawAreaVolume },
+    { BPDT_GREEN_SIGNATURE, 0, &FfsParser::checkRawAreaBpdtStore },
+    { BPDT_YELLOW_SIGNATURE, 0, &FfsParser::checkRawAreaBpdtStore },
+    { INSYDE_FLASH_DEVICE_MAP_SIGNATURE, 0, &FfsParser::checkRawAreaInsydeFlashDeviceMap },
+};
+
 // Constructor
 FfsParser::FfsParser(TreeModel* treeModel) : model(treeModel),
-imageBase(0), addressDiff(0x100000000ULL), protectedRegionsBase(0) {
+imageBase(0), addressDiff(0x100000000ULL), protectedRegionsBase(0), lazyDecompression(false) {
     fitParser = new FitParser(treeModel, this);
     nvramParser = new NvramParser(treeModel, this);
     meParser = new MeParser(treeModel, this);
+    for (size_t i = 0; i < sizeof(rawAreaSignatures) / sizeof(rawAreaSignatures[0]); i++) {
+        rawAreaScanner.add(rawAreaSignatures[i].signature);
+    }
 }
 
 // Destructor
@@ -91,11 +103,17 @@ USTATUS FfsParser::parse(const UByteArray & buffer)
     protectedRanges.clear();
     lastVtf = UModelIndex();
     dxeCore = UModelIndex();
+    stats.clear();
     
     // Parse input buffer
-    USTATUS result = performFirstPass(buffer, root);
+    USTATUS result;
+    {
+        ParserStatsTimer passTimer(stats, stats.firstPass);
+        result = performFirstPass(buffer, root);
+    }
     if (result == U_SUCCESS) {
         if (lastVtf.isValid()) {
+            ParserStatsTimer passTimer(stats, stats.secondPass);
             result = performSecondPass(root);
         }
         else {
@@ -103,10 +121,163 @@ USTATUS FfsParser::parse(const UByteArray & buffer)
         }
     }
     
-    addInfoRecursive(root);
+    if (model->infoEnabled()) {
+        model->setAddressDiff(addressDiff);
+        addInfoRecursive(root);
+    }
+    stats.addItemsRecursive(model, root);
     return result;
 }
 
+// Parallel parsing functions
+void FfsParser::setThreadCount(const UINT32 count)
+{
+    if (count > 1)
+        taskPool = std::make_shared<TaskPool>(count);
+    else
+        taskPool.reset();
+}
+
+// Lazy decompression functions
+void FfsParser::setLazyDecompression(const bool enabled)
+{
+    lazyDecompression = enabled;
+    if (enabled)
+        model->setFetchHandler(std::bind(&FfsParser::fetchDeferred, this, std::placeholders::_1));
+    else
+        model->setFetchHandler(std::function<void(const UModelIndex &)>());
+}
+
+bool FfsParser::deferDecompression(const UModelIndex & index)
+{
+    // Items being fetched are still pending, their contents are parsed right away
+    if (!lazyDecompression || model->fetchPending(index))
+        return false;
+    
+    model->setFetchPending(index, true);
+    return true;
+}
+
+void FfsParser::fetchDeferred(const UModelIndex & index)
+{
+    if (model->subtype(index) == EFI_SECTION_COMPRESSION)
+        parseCompressedSectionBody(index);
+    else
+        parseGuidedSectionBody(index);
+    
+    if (model->infoEnabled())
+        addInfoRecursive(index);
+}
+
+FfsParser::DETACHED_PARSE_TASK FfsParser::detachedBodyParseTask(const UModelIndex & index, USTATUS (FfsParser::*parseBody)(const UModelIndex & index))
+{
+    DETACHED_PARSE_TASK task;
+    task.index = index;
+    task.exclusive = true;
+    task.weight = model->bodySize(index);
+    task.parse = std::mem_fn(parseBody);
+    return task;
+}
+
+void FfsParser::parseDetached(const std::vector<DETACHED_PARSE_TASK> & tasks, std::vector<USTATUS> & results)
+{
+    results.assign(tasks.size(), U_SUCCESS);
+    
+    // Parse items in place if there is nothing to run in parallel
+    if (!taskPool || tasks.size() < 2) {
+        for (size_t i = 0; i < tasks.size(); i++)
+            results[i] = tasks[i].parse(*this, tasks[i].index);
+        return;
+    }
+    
+    // Split tasks into groups of consecutive ones with roughly the same amount of data, several groups per thread
+    const size_t maxGroups = std::min(tasks.size(), (size_t)taskPool->threadCount() * 4);
+    UINT64 totalWeight = 0;
+    for (size_t i = 0; i < tasks.size(); i++)
+        totalWeight += (UINT64)tasks[i].weight + 1;
+    std::vector<size_t> groupStarts;
+    UINT64 weight = 0;
+    for (size_t i = 0; i < tasks.size(); i++) {
+        if (weight >= totalWeight * groupStarts.size() / maxGroups)
+            groupStarts.push_back(i);
+        weight += (UINT64)tasks[i].weight + 1;
+    }
+    groupStarts.push_back(tasks.size());
+    
+    // Every group is parsed by its own parser into its own model, both are created here to be owned by this thread
+    const size_t groupCount = groupStarts.size() - 1;
+    std::vector<std::unique_ptr<TreeModel> > detachedModels(groupCount);
+    std::vector<std::unique_ptr<FfsParser> > detachedParsers(groupCount);
+    std::vector<std::function<void()> > groupTasks(groupCount);
+    for (size_t i = 0; i < groupCount; i++) {
+        TreeModel* detachedModel = new TreeModel();
+        detachedModel->setInfoEnabled(model->infoEnabled());
+        detachedModels[i].reset(detachedModel);
+        
+        FfsParser* detachedParser = new FfsParser(detachedModel);
+        detachedParser->openedImage = openedImage;
+        detachedParser->imageBase = imageBase;
+        detachedParser->addressDiff = addressDiff;
+        detachedParser->protectedRegionsBase = protectedRegionsBase;
+        detachedParser->stats.setEnabled(stats.enabled());
+        detachedParser->taskPool = taskPool;
+        detachedParser->decompressionCache = decompressionCache;
+        detachedParser->lazyDecompression = lazyDecompression;
+        detachedParsers[i].reset(detachedParser);
+        
+        const size_t first = groupStarts[i];
+        const size_t last = groupStarts[i + 1];
+        groupTasks[i] = [this, &tasks, &results, detachedModel, detachedParser, first, last]() {
+            for (size_t j = first; j < last; j++) {
+                UModelIndex copy = detachedModel->copyFrom(*model, tasks[j].index, tasks[j].exclusive);
+                results[j] = tasks[j].parse(*detachedParser, copy);
+            }
+        };
+    }
+    taskPool->run(groupTasks);
+    
+    // Attach results in order, so they are the same as if parsed in place
+    const UINT64 initialProtectedRegionsBase = protectedRegionsBase;
+    for (size_t i = 0; i < groupCount; i++) {
+        model->attachDetached(*detachedModels[i]);
+        attachDetached(*detachedParsers[i], initialProtectedRegionsBase);
+    }
+}
+
+void FfsParser::attachDetached(FfsParser & detached, const UINT64 initialProtectedRegionsBase)
+{
+    const TreeModel & detachedModel = *detached.model;
+    
+    // Messages of every parser are kept in their own order
+    for (size_t i = 0; i < detached.messagesVector.size(); i++)
+        msg(detached.messagesVector[i].first, model->mapFromDetached(detachedModel, detached.messagesVector[i].second));
+    std::vector<std::pair<UString, UModelIndex> > messages = detached.meParser->getMessages();
+    for (size_t i = 0; i < messages.size(); i++)
+        messages[i].second = model->mapFromDetached(detachedModel, messages[i].second);
+    meParser->addMessages(messages);
+    messages = detached.nvramParser->getMessages();
+    for (size_t i = 0; i < messages.size(); i++)
+        messages[i].second = model->mapFromDetached(detachedModel, messages[i].second);
+    nvramParser->addMessages(messages);
+    messages = detached.fitParser->getMessages();
+    for (size_t i = 0; i < messages.size(); i++)
+        messages[i].second = model->mapFromDetached(detachedModel, messages[i].second);
+    fitParser->addMessages(messages);
+    
+    // Last VTF found wins, but only the first DXE core is used
+    if (detached.lastVtf.isValid())
+        lastVtf = model->mapFromDetached(detachedModel, detached.lastVtf);
+    if (!dxeCore.isValid() && detached.dxeCore.isValid())
+        dxeCore = model->mapFromDetached(detachedModel, detached.dxeCore);
+    
+    securityInfo += detached.securityInfo;
+    protectedRanges.insert(protectedRanges.end(), detached.protectedRanges.begin(), detached.protectedRanges.end());
+    if (detached.protectedRegionsBase != initialProtectedRegionsBase)
+        protectedRegionsBase = detached.protectedRegionsBase;
+    
+    stats.merge(detached.stats);
+}
+
 USTATUS FfsParser::performFirstPass(const UByteArray & buffer, UModelIndex & index)
 {
     // Sanity check
@@ -130,9 +301,11 @@ USTATUS FfsParser::performFirstPass(const UByteArray & buffer, UModelIndex & ind
 
 USTATUS FfsParser::parseGenericImage(const UByteArray & buffer, const UINT32 localOffset, const UModelIndex & parent, UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Parse as generic UEFI image
     UString name("UEFI image");
-    UString info = usprintf("Full size: %Xh (%u)", (UINT32)buffer.size(), (UINT32)buffer.size());
+    ItemInfoFormatter info = fullSizeInfo((UINT32)buffer.size());
     
     // Add tree item
     index = model->addItem(localOffset, Types::Image, Subtypes::UefiImage, name, UString(), info, UByteArray(), buffer, UByteArray(), Fixed, parent);
@@ -145,6 +318,8 @@ USTATUS FfsParser::parseGenericImage(const UByteArray & buffer, const UINT32 loc
 
 USTATUS FfsParser::parseCapsule(const UByteArray & capsule, const UINT32 localOffset, const UModelIndex & parent, UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Check buffer size to be more than or equal to size of EFI_CAPSULE_HEADER
     if ((UINT32)capsule.size() < sizeof(EFI_CAPSULE_HEADER)) {
         return U_ITEM_NOT_FOUND;
@@ -287,6 +462,8 @@ USTATUS FfsParser::parseCapsule(const UByteArray & capsule, const UINT32 localOf
 
 USTATUS FfsParser::parseIntelImage(const UByteArray & intelImage, const UINT32 localOffset, const UModelIndex & parent, UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Check for buffer size to be greater or equal to descriptor region size
     if (intelImage.size() < FLASH_DESCRIPTOR_SIZE) {
         msg(usprintf("%s: input file is smaller than minimum descriptor size of %Xh (%u) bytes", __FUNCTION__, FLASH_DESCRIPTOR_SIZE, FLASH_DESCRIPTOR_SIZE));
@@ -594,71 +771,81 @@ USTATUS FfsParser::parseIntelImage(const UByteArray & intelImage, const UINT32 l
     }
     
     // Add descriptor tree item
-    UModelIndex regionIndex = model->addItem(localOffset, Types::Region, Subtypes::DescriptorRegion, name, UString(), info, UByteArray(), body, UByteArray(), Fixed, index);
+    model->addItem(localOffset, Types::Region, Subtypes::DescriptorRegion, name, UString(), info, UByteArray(), body, UByteArray(), Fixed, index);
     
-    // Parse regions
-    USTATUS result = U_SUCCESS;
-    USTATUS parseResult = U_SUCCESS;
+    // Parse regions, they don't depend on each other
+    std::vector<DETACHED_PARSE_TASK> tasks;
     for (size_t i = 0; i < regions.size(); i++) {
-        region = regions[i];
-        switch (region.type) {
-            case Subtypes::BiosRegion:
-                result = parseBiosRegion(region.data, region.offset, index, regionIndex);
-                break;
-            case Subtypes::MeRegion:
-                result = parseMeRegion(region.data, region.offset, index, regionIndex);
-                break;
-            case Subtypes::GbeRegion:
-                result = parseGbeRegion(region.data, region.offset, index, regionIndex);
-                break;
-            case Subtypes::PdrRegion:
-                result = parsePdrRegion(region.data, region.offset, index, regionIndex);
-                break;
-            case Subtypes::DevExp1Region:
-                result = parseDevExp1Region(region.data, region.offset, index, regionIndex);
-                break;
-            case Subtypes::Bios2Region:
-            case Subtypes::MicrocodeRegion:
-            case Subtypes::EcRegion:
-            case Subtypes::DevExp2Region:
-            case Subtypes::IeRegion:
-            case Subtypes::Tgbe1Region:
-            case Subtypes::Tgbe2Region:
-            case Subtypes::Reserved1Region:
-            case Subtypes::Reserved2Region:
-            case Subtypes::PttRegion:
-                result = parseGenericRegion(region.type, region.data, region.offset, index, regionIndex);
-                break;
-            case Subtypes::ZeroPadding:
-            case Subtypes::OnePadding:
-            case Subtypes::DataPadding: {
-                // Add padding between regions
-                UByteArray padding = intelImage.mid(region.offset, region.length);
-                
-                // Get info
-                name = UString("Padding");
-                info = usprintf("Full size: %Xh (%u)",
-                                (UINT32)padding.size(), (UINT32)padding.size());
-                
-                // Add tree item
-                regionIndex = model->addItem(region.offset, Types::Padding, getPaddingType(padding), name, UString(), info, UByteArray(), padding, UByteArray(), Fixed, index);
-                result = U_SUCCESS;
-            } break;
-            default:
-                msg(usprintf("%s: region of unknown type found", __FUNCTION__), index);
-                result = U_INVALID_FLASH_DESCRIPTOR;
-        }
-        // Store the first failed result as a final result
-        if (!parseResult && result) {
-            parseResult = result;
+        DETACHED_PARSE_TASK task;
+        task.index = index;
+        task.exclusive = false;
+        task.weight = regions[i].length;
+        task.parse = std::bind(&FfsParser::parseIntelImageRegion, std::placeholders::_1, intelImage, regions[i], std::placeholders::_2);
+        tasks.push_back(task);
+    }
+    std::vector<USTATUS> results;
+    parseDetached(tasks, results);
+    
+    // Store the first failed result as a final result
+    USTATUS parseResult = U_SUCCESS;
+    for (size_t i = 0; i < results.size(); i++) {
+        if (!parseResult && results[i]) {
+            parseResult = results[i];
         }
     }
     
     return parseResult;
 }
 
+USTATUS FfsParser::parseIntelImageRegion(const UByteArray & intelImage, const REGION_INFO & region, const UModelIndex & parent)
+{
+    UModelIndex regionIndex;
+    switch (region.type) {
+        case Subtypes::BiosRegion:
+            return parseBiosRegion(region.data, region.offset, parent, regionIndex);
+        case Subtypes::MeRegion:
+            return parseMeRegion(region.data, region.offset, parent, regionIndex);
+        case Subtypes::GbeRegion:
+            return parseGbeRegion(region.data, region.offset, parent, regionIndex);
+        case Subtypes::PdrRegion:
+            return parsePdrRegion(region.data, region.offset, parent, regionIndex);
+        case Subtypes::DevExp1Region:
+            return parseDevExp1Region(region.data, region.offset, parent, regionIndex);
+        case Subtypes::Bios2Region:
+        case Subtypes::MicrocodeRegion:
+        case Subtypes::EcRegion:
+        case Subtypes::DevExp2Region:
+        case Subtypes::IeRegion:
+        case Subtypes::Tgbe1Region:
+        case Subtypes::Tgbe2Region:
+        case Subtypes::Reserved1Region:
+        case Subtypes::Reserved2Region:
+        case Subtypes::PttRegion:
+            return parseGenericRegion(region.type, region.data, region.offset, parent, regionIndex);
+        case Subtypes::ZeroPadding:
+        case Subtypes::OnePadding:
+        case Subtypes::DataPadding: {
+            // Add padding between regions
+            UByteArray padding = intelImage.mid(region.offset, region.length);
+            
+            // Get info
+            UString name = UString("Padding");
+            ItemInfoFormatter info = fullSizeInfo((UINT32)padding.size());
+            
+            // Add tree item
+            model->addItem(region.offset, Types::Padding, getPaddingType(padding), name, UString(), info, UByteArray(), padding, UByteArray(), Fixed, parent);
+            return U_SUCCESS;
+        }
+        default:
+            msg(usprintf("%s: region of unknown type found", __FUNCTION__), parent);
+            return U_INVALID_FLASH_DESCRIPTOR;
+    }
+}
+
 USTATUS FfsParser::parseGbeRegion(const UByteArray & gbe, const UINT32 localOffset, const UModelIndex & parent, UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Check sanity
     if (gbe.isEmpty())
         return U_EMPTY_REGION;
@@ -684,6 +871,8 @@ USTATUS FfsParser::parseGbeRegion(const UByteArray & gbe, const UINT32 localOffs
 
 USTATUS FfsParser::parseMeRegion(const UByteArray & me, const UINT32 localOffset, const UModelIndex & parent, UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Check sanity
     if (me.isEmpty())
         return U_EMPTY_REGION;
@@ -696,7 +885,7 @@ USTATUS FfsParser::parseMeRegion(const UByteArray & me, const UINT32 localOffset
     bool versionFound = true;
     bool emptyRegion = false;
     // Check for empty region
-    if (me.size() == me.count('\xFF') || me.size() == me.count('\x00')) {
+    if (getPaddingType(me) != Subtypes::DataPadding) {
         // Further parsing not needed
         emptyRegion = true;
         info += ("\nState: empty");
@@ -751,13 +940,15 @@ USTATUS FfsParser::parseMeRegion(const UByteArray & me, const UINT32 localOffset
 
 USTATUS FfsParser::parsePdrRegion(const UByteArray & pdr, const UINT32 localOffset, const UModelIndex & parent, UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Check sanity
     if (pdr.isEmpty())
         return U_EMPTY_REGION;
     
     // Get info
     UString name("PDR region");
-    UString info = usprintf("Full size: %Xh (%u)", (UINT32)pdr.size(), (UINT32)pdr.size());
+    ItemInfoFormatter info = fullSizeInfo((UINT32)pdr.size());
     
     // Add tree item
     index = model->addItem(localOffset, Types::Region, Subtypes::PdrRegion, name, UString(), info, UByteArray(), pdr, UByteArray(), Fixed, parent);
@@ -772,6 +963,8 @@ USTATUS FfsParser::parsePdrRegion(const UByteArray & pdr, const UINT32 localOffs
 
 USTATUS FfsParser::parseDevExp1Region(const UByteArray & devExp1, const UINT32 localOffset, const UModelIndex & parent, UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Check sanity
     if (devExp1.isEmpty())
         return U_EMPTY_REGION;
@@ -782,7 +975,7 @@ USTATUS FfsParser::parseDevExp1Region(const UByteArray & devExp1, const UINT32 l
     
     bool emptyRegion = false;
     // Check for empty region
-    if (devExp1.size() == devExp1.count('\xFF') || devExp1.size() == devExp1.count('\x00')) {
+    if (getPaddingType(devExp1) != Subtypes::DataPadding) {
         // Further parsing not needed
         emptyRegion = true;
         info += ("\nState: empty");
@@ -799,13 +992,15 @@ USTATUS FfsParser::parseDevExp1Region(const UByteArray & devExp1, const UINT32 l
 
 USTATUS FfsParser::parseGenericRegion(const UINT8 subtype, const UByteArray & region, const UINT32 localOffset, const UModelIndex & parent, UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Check sanity
     if (region.isEmpty())
         return U_EMPTY_REGION;
     
     // Get info
     UString name = itemSubtypeToUString(Types::Region, subtype) + UString(" region");
-    UString info = usprintf("Full size: %Xh (%u)", (UINT32)region.size(), (UINT32)region.size());
+    ItemInfoFormatter info = fullSizeInfo((UINT32)region.size());
     
     // Add tree item
     index = model->addItem(localOffset, Types::Region, subtype, name, UString(), info, UByteArray(), region, UByteArray(), Fixed, parent);
@@ -815,13 +1010,15 @@ USTATUS FfsParser::parseGenericRegion(const UINT8 subtype, const UByteArray & re
 
 USTATUS FfsParser::parseBiosRegion(const UByteArray & bios, const UINT32 localOffset, const UModelIndex & parent, UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Sanity check
     if (bios.isEmpty())
         return U_EMPTY_REGION;
     
     // Get info
     UString name("BIOS region");
-    UString info = usprintf("Full size: %Xh (%u)", (UINT32)bios.size(), (UINT32)bios.size());
+    ItemInfoFormatter info = fullSizeInfo((UINT32)bios.size());
     
     // Add tree item
     index = model->addItem(localOffset, Types::Region, Subtypes::BiosRegion, name, UString(), info, UByteArray(), bios, UByteArray(), Fixed, parent);
@@ -831,6 +1028,8 @@ USTATUS FfsParser::parseBiosRegion(const UByteArray & bios, const UINT32 localOf
 
 USTATUS FfsParser::parseRawArea(const UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Sanity check
     if (!index.isValid())
         return U_INVALID_PARAMETER;
@@ -841,7 +1040,7 @@ USTATUS FfsParser::parseRawArea(const UModelIndex & index)
     
     USTATUS result;
     UString name;
-    UString info;
+    ItemInfoFormatter info;
     
     // Search for the first item
     UINT8  prevItemType = 0;
@@ -866,7 +1065,7 @@ USTATUS FfsParser::parseRawArea(const UModelIndex & index)
         // Get info
         UByteArray padding = data.left(prevItemOffset);
         name = UString("Padding");
-        info = usprintf("Full size: %Xh (%u)", (UINT32)padding.size(), (UINT32)padding.size());
+        info = fullSizeInfo((UINT32)padding.size());
         
         // Add tree item
         model->addItem(headerSize, Types::Padding, getPaddingType(padding), name, UString(), info, UByteArray(), padding, UByteArray(), Fixed, index);
@@ -887,7 +1086,7 @@ USTATUS FfsParser::parseRawArea(const UModelIndex & index)
             
             // Get info
             name = UString("Padding");
-            info = usprintf("Full size: %Xh (%u)", (UINT32)padding.size(), (UINT32)padding.size());
+            info = fullSizeInfo((UINT32)padding.size());
             
             // Add tree item
             model->addItem(headerSize + paddingOffset, Types::Padding, getPaddingType(padding), name, UString(), info, UByteArray(), padding, UByteArray(), Fixed, index);
@@ -900,7 +1099,7 @@ USTATUS FfsParser::parseRawArea(const UModelIndex & index)
             
             // Get info
             name = UString("Padding");
-            info = usprintf("Full size: %Xh (%u)", (UINT32)padding.size(), (UINT32)padding.size());
+            info = fullSizeInfo((UINT32)padding.size());
             
             // Add tree item
             UModelIndex paddingIndex = model->addItem(headerSize + itemOffset, Types::Padding, getPaddingType(padding), name, UString(), info, UByteArray(), padding, UByteArray(), Fixed, index);
@@ -940,7 +1139,7 @@ USTATUS FfsParser::parseRawArea(const UModelIndex & index)
             
             // Get info
             name = UString("BPDT region");
-            info = usprintf("Full size: %Xh (%u)", (UINT32)bpdtStore.size(), (UINT32)bpdtStore.size());
+            info = fullSizeInfo((UINT32)bpdtStore.size());
             
             // Add tree item
             UModelIndex bpdtIndex = model->addItem(headerSize + itemOffset, Types::BpdtStore, 0, name, UString(), info, UByteArray(), bpdtStore, UByteArray(), Fixed, index);
@@ -1086,19 +1285,21 @@ USTATUS FfsParser::parseRawArea(const UModelIndex & index)
         
         // Get info
         name = UString("Padding");
-        info = usprintf("Full size: %Xh (%u)", (UINT32)padding.size(), (UINT32)padding.size());
+        info = fullSizeInfo((UINT32)padding.size());
         
         // Add tree item
         model->addItem(headerSize + itemOffset, Types::Padding, getPaddingType(padding), name, UString(), info, UByteArray(), padding, UByteArray(), Fixed, index);
     }
     
-    // Parse bodies
-    for (int i = 0; i < model->rowCount(index); i++) {
+    // Parse bodies up to the first item of unknown type
+    std::vector<DETACHED_PARSE_TASK> tasks;
+    result = U_SUCCESS;
+    for (int i = 0; i < model->rowCount(index) && result == U_SUCCESS; i++) {
         UModelIndex current = index.model()->index(i, 0, index);
         
         switch (model->type(current)) {
             case Types::Volume:
-                parseVolumeBody(current);
+                tasks.push_back(detachedBodyParseTask(current, &FfsParser::parseVolumeBody));
                 break;
             case Types::Microcode:
                 // Parsing already done
@@ -1116,15 +1317,19 @@ USTATUS FfsParser::parseRawArea(const UModelIndex & index)
                 // No parsing required
                 break;
             default:
-                return U_UNKNOWN_ITEM_TYPE;
+                result = U_UNKNOWN_ITEM_TYPE;
         }
     }
+    std::vector<USTATUS> results;
+    parseDetached(tasks, results);
     
-    return U_SUCCESS;
+    return result;
 }
 
 USTATUS FfsParser::parseVolumeHeader(const UByteArray & volume, const UINT32 localOffset, const UModelIndex & parent, UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Sanity check
     if (volume.isEmpty())
         return U_INVALID_PARAMETER;
@@ -1231,8 +1436,8 @@ USTATUS FfsParser::parseVolumeHeader(const UByteArray & volume, const UINT32 loc
     // Check for AppleCRC32 and UsedSpace in ZeroVector
     bool hasAppleCrc32 = false;
     UINT32 volumeSize = (UINT32)volume.size();
-    UINT32 appleCrc32 = *(UINT32*)(volume.constData() + 8);
-    UINT32 usedSpace = *(UINT32*)(volume.constData() + 12);
+    UINT32 appleCrc32 = readUnaligned((const UINT32*)(volumeHeader->ZeroVector + 8));
+    UINT32 usedSpace = readUnaligned((const UINT32*)(volumeHeader->ZeroVector + 12));
     if (appleCrc32 != 0) {
         // Calculate CRC32 of the volume body
         UINT32 crc = (UINT32)crc32(0, (const UINT8*)(volume.constData() + volumeHeader->HeaderLength), volumeSize - volumeHeader->HeaderLength);
@@ -1261,22 +1466,25 @@ USTATUS FfsParser::parseVolumeHeader(const UByteArray & volume, const UINT32 loc
     UByteArray header = volume.left(headerSize);
     UByteArray body = volume.mid(headerSize);
     UString name = guidToUString(volumeHeader->FileSystemGuid);
-    UString info = usprintf("ZeroVector:\n%02X %02X %02X %02X %02X %02X %02X %02X\n"
-                            "%02X %02X %02X %02X %02X %02X %02X %02X\nSignature: _FVH\nFileSystem GUID: ",
-                            volumeHeader->ZeroVector[0], volumeHeader->ZeroVector[1], volumeHeader->ZeroVector[2], volumeHeader->ZeroVector[3],
-                            volumeHeader->ZeroVector[4], volumeHeader->ZeroVector[5], volumeHeader->ZeroVector[6], volumeHeader->ZeroVector[7],
-                            volumeHeader->ZeroVector[8], volumeHeader->ZeroVector[9], volumeHeader->ZeroVector[10], volumeHeader->ZeroVector[11],
-                            volumeHeader->ZeroVector[12], volumeHeader->ZeroVector[13], volumeHeader->ZeroVector[14], volumeHeader->ZeroVector[15])
-    + guidToUString(volumeHeader->FileSystemGuid, false) \
-    + usprintf("\nFull size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\nRevision: %u\nAttributes: %08Xh\nErase polarity: %u\nChecksum: %04Xh",
-               volumeSize, volumeSize,
-               headerSize, headerSize,
-               volumeSize - headerSize, volumeSize - headerSize,
-               volumeHeader->Revision,
-               volumeHeader->Attributes,
-               (emptyByte ? 1 : 0),
-               volumeHeader->Checksum) +
-    (msgInvalidChecksum ? usprintf(", invalid, should be %04Xh", calculated) : UString(", valid"));
+    const EFI_FIRMWARE_VOLUME_HEADER infoHeader = *volumeHeader;
+    ItemInfoFormatter info = [infoHeader, volumeSize, headerSize, emptyByte, msgInvalidChecksum, calculated]() {
+        return usprintf("ZeroVector:\n%02X %02X %02X %02X %02X %02X %02X %02X\n"
+                        "%02X %02X %02X %02X %02X %02X %02X %02X\nSignature: _FVH\nFileSystem GUID: ",
+                        infoHeader.ZeroVector[0], infoHeader.ZeroVector[1], infoHeader.ZeroVector[2], infoHeader.ZeroVector[3],
+                        infoHeader.ZeroVector[4], infoHeader.ZeroVector[5], infoHeader.ZeroVector[6], infoHeader.ZeroVector[7],
+                        infoHeader.ZeroVector[8], infoHeader.ZeroVector[9], infoHeader.ZeroVector[10], infoHeader.ZeroVector[11],
+                        infoHeader.ZeroVector[12], infoHeader.ZeroVector[13], infoHeader.ZeroVector[14], infoHeader.ZeroVector[15])
+        + guidToUString(infoHeader.FileSystemGuid, false)
+        + usprintf("\nFull size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\nRevision: %u\nAttributes: %08Xh\nErase polarity: %u\nChecksum: %04Xh",
+                   volumeSize, volumeSize,
+                   headerSize, headerSize,
+                   volumeSize - headerSize, volumeSize - headerSize,
+                   infoHeader.Revision,
+                   infoHeader.Attributes,
+                   (emptyByte ? 1 : 0),
+                   infoHeader.Checksum) +
+        (msgInvalidChecksum ? usprintf(", invalid, should be %04Xh", calculated) : UString(", valid"));
+    };
     
     // Extended header present
     if (volumeHeader->Revision > 1 && volumeHeader->ExtHeaderOffset) {
@@ -1284,8 +1492,12 @@ USTATUS FfsParser::parseVolumeHeader(const UByteArray & volume, const UINT32 loc
             return U_INVALID_VOLUME;
         }
         const EFI_FIRMWARE_VOLUME_EXT_HEADER* extendedHeader = (const EFI_FIRMWARE_VOLUME_EXT_HEADER*)(volume.constData() + volumeHeader->ExtHeaderOffset);
-        info += usprintf("\nExtended header size: %Xh (%u)\nVolume GUID: ",
-                         extendedHeader->ExtHeaderSize, extendedHeader->ExtHeaderSize) + guidToUString(extendedHeader->FvName, false);
+        const EFI_FIRMWARE_VOLUME_EXT_HEADER infoExtendedHeader = *extendedHeader;
+        const ItemInfoFormatter headerInfo = info;
+        info = [headerInfo, infoExtendedHeader]() {
+            return headerInfo() + usprintf("\nExtended header size: %Xh (%u)\nVolume GUID: ",
+                                           infoExtendedHeader.ExtHeaderSize, infoExtendedHeader.ExtHeaderSize) + guidToUString(infoExtendedHeader.FvName, false);
+        };
         name = guidToUString(extendedHeader->FvName); // Replace FFS GUID with volume GUID
     }
     
@@ -1320,7 +1532,7 @@ USTATUS FfsParser::parseVolumeHeader(const UByteArray & volume, const UINT32 loc
     pdata.hasValidUsedSpace = FALSE; // Will be updated later, if needed
     pdata.usedSpace = usedSpace;
     pdata.isWeakAligned = (volumeHeader->Revision > 1 && (volumeHeader->Attributes & EFI_FVB2_WEAK_ALIGNMENT));
-    model->setParsingData(index, UByteArray((const char*)&pdata, sizeof(pdata)));
+    model->setParsingData(index, pdata);
     
     // Show messages
     if (isUnknown)
@@ -1398,172 +1610,208 @@ USTATUS FfsParser::findNextRawAreaItem(const UModelIndex & index, const UINT32 l
     if (dataSize < sizeof(UINT32))
         return U_STORES_NOT_FOUND;
     
+    // Find all registered signatures in one sweep, validate only the found candidates
     UINT32 offset = localOffset;
-    for (; offset < dataSize - sizeof(UINT32); offset++) {
-        const UINT32* currentPos = (const UINT32*)(data.constData() + offset);
-        UINT32 restSize = dataSize - offset;
-        if (readUnaligned(currentPos) == INTEL_MICROCODE_HEADER_VERSION_1) { // Intel microcode
-            // Check data size
-            if (restSize < sizeof(INTEL_MICROCODE_HEADER)) {
-                continue;
-            }
-            
-            // Check microcode header candidate
-            const INTEL_MICROCODE_HEADER* ucodeHeader = (const INTEL_MICROCODE_HEADER*)currentPos;
-            if (FALSE == microcodeHeaderValid(ucodeHeader)) {
-                continue;
-            }
-            
-            // Check size candidate
-            if (ucodeHeader->TotalSize == 0)
-                continue;
-            
-            // All checks passed, microcode found
-            nextItemType = Types::Microcode;
-            nextItemSize = ucodeHeader->TotalSize;
-            nextItemAlternativeSize = ucodeHeader->TotalSize;
-            nextItemOffset = offset;
+    UINT32 candidates = 0;
+    while (offset < dataSize - sizeof(UINT32)) {
+        INT32 signature;
+        offset = rawAreaScanner.findNext((const UINT8*)data.constData(), dataSize, offset, dataSize - sizeof(UINT32), signature);
+        if (signature < 0)
             break;
-        }
-        else if (readUnaligned(currentPos) == EFI_FV_SIGNATURE) {
-            if (offset < EFI_FV_SIGNATURE_OFFSET)
-                continue;
-
-            // Prevent OOB access
-            if (restSize + EFI_FV_SIGNATURE_OFFSET < sizeof(EFI_FIRMWARE_VOLUME_HEADER)) {
-                continue;
-            }
-            const EFI_FIRMWARE_VOLUME_HEADER* volumeHeader = (const EFI_FIRMWARE_VOLUME_HEADER*)(data.constData() + offset - EFI_FV_SIGNATURE_OFFSET);
-            restSize -= sizeof(EFI_FIRMWARE_VOLUME_HEADER);
-            if (volumeHeader->FvLength < sizeof(EFI_FIRMWARE_VOLUME_HEADER) + 2 * sizeof(EFI_FV_BLOCK_MAP_ENTRY) || volumeHeader->FvLength >= 0xFFFFFFFFUL) {
-                continue;
-            }
-            if (volumeHeader->Revision != 1 && volumeHeader->Revision != 2) {
-                continue;
-            }
-            
-            // Calculate alternative volume size using its BlockMap
-            nextItemAlternativeSize = 0;
-
-            // Prevent OOB access
-            if (restSize + EFI_FV_SIGNATURE_OFFSET < sizeof(EFI_FIRMWARE_VOLUME_HEADER)) {
-                continue;
-            }
-            const EFI_FV_BLOCK_MAP_ENTRY* entry = (const EFI_FV_BLOCK_MAP_ENTRY*)(data.constData() + offset - EFI_FV_SIGNATURE_OFFSET + sizeof(EFI_FIRMWARE_VOLUME_HEADER));
-            restSize -= sizeof(EFI_FV_BLOCK_MAP_ENTRY);
-            while (entry->NumBlocks != 0 && entry->Length != 0) {
-                // Check if we are past the end of the volume
-                if (restSize + EFI_FV_SIGNATURE_OFFSET < sizeof(EFI_FV_BLOCK_MAP_ENTRY)) {
-                    // This volume is broken, but we can't use continue here because we need to continue the outer loop
-                    goto continue_searching;
-                }
-                
-                nextItemAlternativeSize += entry->NumBlocks * entry->Length;
-                restSize -= sizeof(EFI_FV_BLOCK_MAP_ENTRY);
-                entry += 1;
-            }
-            
-            // All checks passed, volume found
-            nextItemType = Types::Volume;
-            nextItemSize = (UINT32)volumeHeader->FvLength;
-            nextItemOffset = offset - EFI_FV_SIGNATURE_OFFSET;
-            break;
-continue_searching: {}
-        }
-        else if (readUnaligned(currentPos) == BPDT_GREEN_SIGNATURE
-                 || readUnaligned(currentPos) == BPDT_YELLOW_SIGNATURE) {
-            // Check data size
-            if (restSize < sizeof(BPDT_HEADER))
-                continue;
-            
-            const BPDT_HEADER *bpdtHeader = (const BPDT_HEADER *)currentPos;
-                        
-            // Check NumEntries to be sane
-            if (bpdtHeader->NumEntries > 0x100)
-                continue;
-            
-            // Check HeaderVersion to be 1
-            if (bpdtHeader->HeaderVersion != BPDT_HEADER_VERSION_1) // Check only for IFWI 2.0 headers in raw areas
-                continue;
-            
-            // Check RedundancyFlag to be 0 or 1
-            if (bpdtHeader->RedundancyFlag != 0 && bpdtHeader->RedundancyFlag != 1) // Check only for IFWI 2.0 headers in raw areas
-                continue;
-            
-            UINT32 ptBodySize = bpdtHeader->NumEntries * sizeof(BPDT_ENTRY);
-            UINT32 ptSize = sizeof(BPDT_HEADER) + ptBodySize;
-            // Check data size again
-            if (restSize < ptSize)
-                continue;
-            
-            UINT32 sizeCandidate = 0;
-            // Parse partition table
-            const BPDT_ENTRY* firstPtEntry = (const BPDT_ENTRY*)((const UINT8*)bpdtHeader + sizeof(BPDT_HEADER));
-            for (UINT16 i = 0; i < bpdtHeader->NumEntries; i++) {
-                // Populate entry header
-                const BPDT_ENTRY* ptEntry = firstPtEntry + i;
-                // Check that entry is present in the image
-                if (ptEntry->Offset != 0
-                    && ptEntry->Offset != 0xFFFFFFFF
-                    && ptEntry->Size != 0
-                    && sizeCandidate < ptEntry->Offset + ptEntry->Size) {
-                    sizeCandidate = ptEntry->Offset + ptEntry->Size;
-                }
-            }
-            
-            // Check size candidate
-            if (sizeCandidate == 0 || sizeCandidate > restSize) {
-                msg(usprintf("%s: invalid BpdtStore size (sizeCandidate = 0x%x, restSize = 0x%x)", __FUNCTION__, sizeCandidate, restSize), index);
-                continue;
-            }
-            
-            // All checks passed, BPDT found
-            nextItemType = Types::BpdtStore;
-            nextItemSize = sizeCandidate;
-            nextItemAlternativeSize = sizeCandidate;
-            nextItemOffset = offset;
-            break;
-        }
-        else if (readUnaligned(currentPos) == INSYDE_FLASH_DEVICE_MAP_SIGNATURE) {
-            // Check data size
-            if (restSize < sizeof(INSYDE_FLASH_DEVICE_MAP_HEADER))
-                continue;
-            
-            const INSYDE_FLASH_DEVICE_MAP_HEADER *fdmHeader = (const INSYDE_FLASH_DEVICE_MAP_HEADER *)currentPos;
-            
-            if (restSize < fdmHeader->Size)
-                continue;
-            
-            if (fdmHeader->Revision > 4) {
-                msg(usprintf("%s: Insyde Flash Device Map candidate with unknown revision %u", __FUNCTION__, fdmHeader->Revision), index);
-                continue;
-            }
-            
-            // All checks passed, FDM found
-            nextItemType = Types::InsydeFlashDeviceMapStore;
-            nextItemSize = fdmHeader->Size;
-            nextItemAlternativeSize = fdmHeader->Size;
-            nextItemOffset = offset;
+        
+        candidates++;
+        if ((this->*rawAreaSignatures[signature].check)(index, data, offset, nextItemType, nextItemSize, nextItemAlternativeSize)) {
+            nextItemOffset = offset - rawAreaSignatures[signature].offset;
             break;
         }
+        offset++;
     }
     
     // No more stores found
     if (offset >= dataSize - sizeof(UINT32)) {
+        if (stats.enabled()) {
+            stats.rawAreaBytesScanned += offset > localOffset ? offset - localOffset : 0;
+            stats.rawAreaCandidatesRejected += candidates;
+        }
         return U_STORES_NOT_FOUND;
     }
     
+    if (stats.enabled()) {
+        stats.rawAreaBytesScanned += offset - localOffset;
+        stats.rawAreaCandidatesRejected += candidates - 1;
+    }
+    
     return U_SUCCESS;
 }
 
+bool FfsParser::checkRawAreaMicrocode(const UModelIndex & index, const UByteArray & data, const UINT32 offset, UINT8 & nextItemType, UINT32 & nextItemSize, UINT32 & nextItemAlternativeSize)
+{
+    U_UNUSED_PARAMETER(index);
+    UINT32 restSize = (UINT32)data.size() - offset;
+    
+    // Check data size
+    if (restSize < sizeof(INTEL_MICROCODE_HEADER)) {
+        return false;
+    }
+    
+    // Check microcode header candidate
+    const INTEL_MICROCODE_HEADER* ucodeHeader = (const INTEL_MICROCODE_HEADER*)(data.constData() + offset);
+    if (FALSE == microcodeHeaderValid(ucodeHeader)) {
+        return false;
+    }
+    
+    // Check size candidate
+    if (ucodeHeader->TotalSize == 0)
+        return false;
+    
+    // All checks passed, microcode found
+    nextItemType = Types::Microcode;
+    nextItemSize = ucodeHeader->TotalSize;
+    nextItemAlternativeSize = ucodeHeader->TotalSize;
+    return true;
+}
+
+bool FfsParser::checkRawAreaVolume(const UModelIndex & index, const UByteArray & data, const UINT32 offset, UINT8 & nextItemType, UINT32 & nextItemSize, UINT32 & nextItemAlternativeSize)
+{
+    U_UNUSED_PARAMETER(index);
+    UINT32 restSize = (UINT32)data.size() - offset;
+    
+    if (offset < EFI_FV_SIGNATURE_OFFSET)
+        return false;
+    
+    // Prevent OOB access
+    if (restSize + EFI_FV_SIGNATURE_OFFSET < sizeof(EFI_FIRMWARE_VOLUME_HEADER)) {
+        return false;
+    }
+    const EFI_FIRMWARE_VOLUME_HEADER* volumeHeader = (const EFI_FIRMWARE_VOLUME_HEADER*)(data.constData() + offset - EFI_FV_SIGNATURE_OFFSET);
+    restSize -= sizeof(EFI_FIRMWARE_VOLUME_HEADER);
+    if (volumeHeader->FvLength < sizeof(EFI_FIRMWARE_VOLUME_HEADER) + 2 * sizeof(EFI_FV_BLOCK_MAP_ENTRY) || volumeHeader->FvLength >= 0xFFFFFFFFUL) {
+        return false;
+    }
+    if (volumeHeader->Revision != 1 && volumeHeader->Revision != 2) {
+        return false;
+    }
+    
+    // Calculate alternative volume size using its BlockMap
+    nextItemAlternativeSize = 0;
+    
+    // Prevent OOB access
+    if (restSize + EFI_FV_SIGNATURE_OFFSET < sizeof(EFI_FIRMWARE_VOLUME_HEADER)) {
+        return false;
+    }
+    const EFI_FV_BLOCK_MAP_ENTRY* entry = (const EFI_FV_BLOCK_MAP_ENTRY*)(data.constData() + offset - EFI_FV_SIGNATURE_OFFSET + sizeof(EFI_FIRMWARE_VOLUME_HEADER));
+    restSize -= sizeof(EFI_FV_BLOCK_MAP_ENTRY);
+    while (entry->NumBlocks != 0 && entry->Length != 0) {
+        // Check if we are past the end of the volume
+        if (restSize + EFI_FV_SIGNATURE_OFFSET < sizeof(EFI_FV_BLOCK_MAP_ENTRY)) {
+            // This volume is broken
+            return false;
+        }
+        
+        nextItemAlternativeSize += entry->NumBlocks * entry->Length;
+        restSize -= sizeof(EFI_FV_BLOCK_MAP_ENTRY);
+        entry += 1;
+    }
+    
+    // All checks passed, volume found
+    nextItemType = Types::Volume;
+    nextItemSize = (UINT32)volumeHeader->FvLength;
+    return true;
+}
+
+bool FfsParser::checkRawAreaBpdtStore(const UModelIndex & index, const UByteArray & data, const UINT32 offset, UINT8 & nextItemType, UINT32 & nextItemSize, UINT32 & nextItemAlternativeSize)
+{
+    UINT32 restSize = (UINT32)data.size() - offset;
+    
+    // Check data size
+    if (restSize < sizeof(BPDT_HEADER))
+        return false;
+    
+    const BPDT_HEADER *bpdtHeader = (const BPDT_HEADER *)(data.constData() + offset);
+    
+    // Check NumEntries to be sane
+    if (bpdtHeader->NumEntries > 0x100)
+        return false;
+    
+    // Check HeaderVersion to be 1
+    if (bpdtHeader->HeaderVersion != BPDT_HEADER_VERSION_1) // Check only for IFWI 2.0 headers in raw areas
+        return false;
+    
+    // Check RedundancyFlag to be 0 or 1
+    if (bpdtHeader->RedundancyFlag != 0 && bpdtHeader->RedundancyFlag != 1) // Check only for IFWI 2.0 headers in raw areas
+        return false;
+    
+    UINT32 ptBodySize = bpdtHeader->NumEntries * sizeof(BPDT_ENTRY);
+    UINT32 ptSize = sizeof(BPDT_HEADER) + ptBodySize;
+    // Check data size again
+    if (restSize < ptSize)
+        return false;
+    
+    UINT32 sizeCandidate = 0;
+    // Parse partition table
+    const BPDT_ENTRY* firstPtEntry = (const BPDT_ENTRY*)((const UINT8*)bpdtHeader + sizeof(BPDT_HEADER));
+    for (UINT16 i = 0; i < bpdtHeader->NumEntries; i++) {
+        // Populate entry header
+        const BPDT_ENTRY* ptEntry = firstPtEntry + i;
+        // Check that entry is present in the image
+        if (ptEntry->Offset != 0
+            && ptEntry->Offset != 0xFFFFFFFF
+            && ptEntry->Size != 0
+            && sizeCandidate < ptEntry->Offset + ptEntry->Size) {
+            sizeCandidate = ptEntry->Offset + ptEntry->Size;
+        }
+    }
+    
+    // Check size candidate
+    if (sizeCandidate == 0 || sizeCandidate > restSize) {
+        // Message keeps the name of the raw area scan this check is a part of
+        msg(usprintf("findNextRawAreaItem: invalid BpdtStore size (sizeCandidate = 0x%x, restSize = 0x%x)", sizeCandidate, restSize), index);
+        return false;
+    }
+    
+    // All checks passed, BPDT found
+    nextItemType = Types::BpdtStore;
+    nextItemSize = sizeCandidate;
+    nextItemAlternativeSize = sizeCandidate;
+    return true;
+}
+
+bool FfsParser::checkRawAreaInsydeFlashDeviceMap(const UModelIndex & index, const UByteArray & data, const UINT32 offset, UINT8 & nextItemType, UINT32 & nextItemSize, UINT32 & nextItemAlternativeSize)
+{
+    UINT32 restSize = (UINT32)data.size() - offset;
+    
+    // Check data size
+    if (restSize < sizeof(INSYDE_FLASH_DEVICE_MAP_HEADER))
+        return false;
+    
+    const INSYDE_FLASH_DEVICE_MAP_HEADER *fdmHeader = (const INSYDE_FLASH_DEVICE_MAP_HEADER *)(data.constData() + offset);
+    
+    if (restSize < fdmHeader->Size)
+        return false;
+    
+    if (fdmHeader->Revision > 4) {
+        // Message keeps the name of the raw area scan this check is a part of
+        msg(usprintf("findNextRawAreaItem: Insyde Flash Device Map candidate with unknown revision %u", fdmHeader->Revision), index);
+        return false;
+    }
+    
+    // All checks passed, FDM found
+    nextItemType = Types::InsydeFlashDeviceMapStore;
+    nextItemSize = fdmHeader->Size;
+    nextItemAlternativeSize = fdmHeader->Size;
+    return true;
+}
+
 USTATUS FfsParser::parseVolumeNonUefiData(const UByteArray & data, const UINT32 localOffset, const UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Sanity check
     if (!index.isValid())
         return U_INVALID_PARAMETER;
     
     // Get info
-    UString info = usprintf("Full size: %Xh (%u)", (UINT32)data.size(), (UINT32)data.size());
+    ItemInfoFormatter info = fullSizeInfo((UINT32)data.size());
     
     // Add padding tree item
     UModelIndex paddingIndex = model->addItem(localOffset, Types::Padding, Subtypes::DataPadding, UString("Non-UEFI data"), UString(), info, UByteArray(), data, UByteArray(), Fixed, index);
@@ -1575,6 +1823,8 @@ USTATUS FfsParser::parseVolumeNonUefiData(const UByteArray & data, const UINT32
 
 USTATUS FfsParser::parseVolumeBody(const UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Sanity check
     if (!index.isValid()) {
         return U_INVALID_PARAMETER;
@@ -1599,13 +1849,12 @@ USTATUS FfsParser::parseVolumeBody(const UModelIndex & index)
     UINT8 ffsVersion = 2;
     UINT32 usedSpace = 0;
     UINT8 revision = 2;
-    if (model->hasEmptyParsingData(index) == false) {
-        UByteArray data = model->parsingData(index);
-        const VOLUME_PARSING_DATA* pdata = (const VOLUME_PARSING_DATA*)data.constData();
-        emptyByte = pdata->emptyByte;
-        ffsVersion = pdata->ffsVersion;
-        usedSpace = pdata->usedSpace;
-        revision = pdata->revision;
+    const VOLUME_PARSING_DATA* vdata = model->volumeParsingData(index);
+    if (vdata) {
+        emptyByte = vdata->emptyByte;
+        ffsVersion = vdata->ffsVersion;
+        usedSpace = vdata->usedSpace;
+        revision = vdata->revision;
     }
     
     // Check for unknown FFS version
@@ -1628,13 +1877,12 @@ USTATUS FfsParser::parseVolumeBody(const UModelIndex & index)
         
         // Check that we are at the empty space
         UByteArray header = volumeBody.mid(fileOffset, (int)std::min(sizeof(EFI_FFS_FILE_HEADER), (size_t)volumeBodySize - fileOffset));
-        if (header.count(emptyByte) == header.size()) { //Empty space
+        if (isFilledWith(header, emptyByte)) { //Empty space
             // Check volume usedSpace entry to be valid
             if (usedSpace > 0 && usedSpace == fileOffset + volumeHeaderSize) {
-                if (model->hasEmptyParsingData(index) == false) {
-                    UByteArray data = model->parsingData(index);
-                    VOLUME_PARSING_DATA* pdata = (VOLUME_PARSING_DATA*)data.data();
-                    pdata->hasValidUsedSpace = TRUE;
+                if (vdata) {
+                    VOLUME_PARSING_DATA data = *vdata;
+                    data.hasValidUsedSpace = TRUE;
                     model->setParsingData(index, data);
                     model->setText(index, model->text(index) + "UsedSpace ");
                 }
@@ -1642,17 +1890,9 @@ USTATUS FfsParser::parseVolumeBody(const UModelIndex & index)
             
             // Check free space to be actually free
             UByteArray freeSpace = volumeBody.mid(fileOffset);
-            if (freeSpace.count(emptyByte) != freeSpace.size()) {
-                // Search for the first non-empty byte
-                UINT32 i;
-                UINT32 size = (UINT32)freeSpace.size();
-                const UINT8* current = (UINT8*)freeSpace.constData();
-                for (i = 0; i < size; i++) {
-                    if (*current++ != emptyByte) {
-                        break; // Exit from parsing loop
-                    }
-                }
-                
+            // Search for the first non-empty byte
+            UINT32 i = findNonFillByte((const UINT8*)freeSpace.constData(), (UINT32)freeSpace.size(), emptyByte);
+            if (i != (UINT32)freeSpace.size()) {
                 // Align found index to file alignment
                 // It must be possible because minimum 16 bytes of empty were found before
                 if (i != ALIGN8(i)) {
@@ -1664,7 +1904,7 @@ USTATUS FfsParser::parseVolumeBody(const UModelIndex & index)
                     UByteArray free = freeSpace.left(i);
                     
                     // Get info
-                    UString info = usprintf("Full size: %Xh (%u)", (UINT32)free.size(), (UINT32)free.size());
+                    ItemInfoFormatter info = fullSizeInfo((UINT32)free.size());
                     
                     // Add free space item
                     model->addItem(volumeHeaderSize + fileOffset, Types::FreeSpace, 0, UString("Volume free space"), UString(), info, UByteArray(), free, UByteArray(), Movable, index);
@@ -1675,7 +1915,7 @@ USTATUS FfsParser::parseVolumeBody(const UModelIndex & index)
             }
             else {
                 // Get info
-                UString info = usprintf("Full size: %Xh (%u)", (UINT32)freeSpace.size(), (UINT32)freeSpace.size());
+                ItemInfoFormatter info = fullSizeInfo((UINT32)freeSpace.size());
                 
                 // Add free space item
                 model->addItem(volumeHeaderSize + fileOffset, Types::FreeSpace, 0, UString("Volume free space"), UString(), info, UByteArray(), freeSpace, UByteArray(), Movable, index);
@@ -1739,24 +1979,28 @@ USTATUS FfsParser::parseVolumeBody(const UModelIndex & index)
         }
     }
     
-    // Parse bodies
-    for (int i = 0; i < model->rowCount(index); i++) {
+    // Parse bodies up to the first item of unknown type
+    std::vector<DETACHED_PARSE_TASK> tasks;
+    USTATUS result = U_SUCCESS;
+    for (int i = 0; i < model->rowCount(index) && result == U_SUCCESS; i++) {
         UModelIndex current = index.model()->index(i, 0, index);
         
         switch (model->type(current)) {
             case Types::File:
-                parseFileBody(current);
+                tasks.push_back(detachedBodyParseTask(current, &FfsParser::parseFileBody));
                 break;
             case Types::Padding:
             case Types::FreeSpace:
                 // No parsing required
                 break;
             default:
-                return U_UNKNOWN_ITEM_TYPE;
+                result = U_UNKNOWN_ITEM_TYPE;
         }
     }
+    std::vector<USTATUS> results;
+    parseDetached(tasks, results);
     
-    return U_SUCCESS;
+    return result;
 }
 
 UINT32 FfsParser::getFileSize(const UByteArray & volume, const UINT32 fileOffset, const UINT8 ffsVersion, const UINT8 revision)
@@ -1799,6 +2043,8 @@ UINT32 FfsParser::getFileSize(const UByteArray & volume, const UINT32 fileOffset
 
 USTATUS FfsParser::parseFileHeader(const UByteArray & file, const UINT32 localOffset, const UModelIndex & parent, UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Sanity check
     if (file.isEmpty()) {
         return U_INVALID_PARAMETER;
@@ -1813,13 +2059,12 @@ USTATUS FfsParser::parseFileHeader(const UByteArray & file, const UINT32 localOf
     UINT32 volumeAlignment = 0xFFFFFFFF;
     UINT8 volumeRevision = 2;
     UModelIndex parentVolumeIndex = model->type(parent) == Types::Volume ? parent : model->findParentOfType(parent, Types::Volume);
-    if (parentVolumeIndex.isValid() && model->hasEmptyParsingData(parentVolumeIndex) == false) {
-        UByteArray data = model->parsingData(parentVolumeIndex);
-        const VOLUME_PARSING_DATA* pdata = (const VOLUME_PARSING_DATA*)data.constData();
-        ffsVersion = pdata->ffsVersion;
-        volumeAlignment = pdata->alignment;
-        volumeRevision = pdata->revision;
-        isWeakAligned = pdata->isWeakAligned;
+    const VOLUME_PARSING_DATA* vdata = model->volumeParsingData(parentVolumeIndex);
+    if (vdata) {
+        ffsVersion = vdata->ffsVersion;
+        volumeAlignment = vdata->alignment;
+        volumeRevision = vdata->revision;
+        isWeakAligned = vdata->isWeakAligned;
     }
     
     // Get file header
@@ -1908,24 +2153,29 @@ USTATUS FfsParser::parseFileHeader(const UByteArray & file, const UINT32 localOf
     
     // Get info
     UString name;
-    UString info;
     if (fileHeader->Type != EFI_FV_FILETYPE_PAD) {
         name = guidToUString(fileHeader->Name);
     } else {
         name = UString("Padding file");
     }
     
-    info = UString("File GUID: ") + guidToUString(fileHeader->Name, false) +
-    usprintf("\nType: %02Xh\nAttributes: %02Xh\nFull size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\nTail size: %Xh (%u)\nState: %02Xh",
-             fileHeader->Type,
-             fileHeader->Attributes,
-             (UINT32)(header.size() + body.size() + tail.size()), (UINT32)(header.size() + body.size() + tail.size()),
-             (UINT32)header.size(), (UINT32)header.size(),
-             (UINT32)body.size(), (UINT32)body.size(),
-             (UINT32)tail.size(), (UINT32)tail.size(),
-             fileHeader->State) +
-    usprintf("\nHeader checksum: %02Xh", fileHeader->IntegrityCheck.Checksum.Header) + (msgInvalidHeaderChecksum ? usprintf(", invalid, should be %02Xh", calculatedHeader) : UString(", valid")) +
-    usprintf("\nData checksum: %02Xh", fileHeader->IntegrityCheck.Checksum.File) + (msgInvalidDataChecksum ? usprintf(", invalid, should be %02Xh", calculatedData) : UString(", valid"));
+    const EFI_FFS_FILE_HEADER infoHeader = *fileHeader;
+    const UINT32 headerSize = (UINT32)header.size();
+    const UINT32 bodySize = (UINT32)body.size();
+    const UINT32 tailSize = (UINT32)tail.size();
+    ItemInfoFormatter info = [infoHeader, headerSize, bodySize, tailSize, msgInvalidHeaderChecksum, calculatedHeader, msgInvalidDataChecksum, calculatedData]() {
+        return UString("File GUID: ") + guidToUString(infoHeader.Name, false) +
+        usprintf("\nType: %02Xh\nAttributes: %02Xh\nFull size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\nTail size: %Xh (%u)\nState: %02Xh",
+                 infoHeader.Type,
+                 infoHeader.Attributes,
+                 headerSize + bodySize + tailSize, headerSize + bodySize + tailSize,
+                 headerSize, headerSize,
+                 bodySize, bodySize,
+                 tailSize, tailSize,
+                 infoHeader.State) +
+        usprintf("\nHeader checksum: %02Xh", infoHeader.IntegrityCheck.Checksum.Header) + (msgInvalidHeaderChecksum ? usprintf(", invalid, should be %02Xh", calculatedHeader) : UString(", valid")) +
+        usprintf("\nData checksum: %02Xh", infoHeader.IntegrityCheck.Checksum.File) + (msgInvalidDataChecksum ? usprintf(", invalid, should be %02Xh", calculatedData) : UString(", valid"));
+    };
     
     UString text;
     bool isVtf = false;
@@ -1956,7 +2206,7 @@ USTATUS FfsParser::parseFileHeader(const UByteArray & file, const UINT32 localOf
     FILE_PARSING_DATA pdata = {};
     pdata.emptyByte = (fileHeader->State & EFI_FILE_ERASE_POLARITY) ? 0xFF : 0x00;
     pdata.guid = fileHeader->Name;
-    model->setParsingData(index, UByteArray((const char*)&pdata, sizeof(pdata)));
+    model->setParsingData(index, pdata);
     
     // Override lastVtf index, if needed
     if (isVtf) {
@@ -2013,6 +2263,8 @@ UINT32 FfsParser::getSectionSize(const UByteArray & file, const UINT32 sectionOf
 
 USTATUS FfsParser::parseFileBody(const UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Sanity check
     if (!index.isValid())
         return U_INVALID_PARAMETER;
@@ -2079,6 +2331,8 @@ USTATUS FfsParser::parseFileBody(const UModelIndex & index)
 
 USTATUS FfsParser::parsePadFileBody(const UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Sanity check
     if (!index.isValid())
         return U_INVALID_PARAMETER;
@@ -2089,25 +2343,18 @@ USTATUS FfsParser::parsePadFileBody(const UModelIndex & index)
     // Obtain required information from parent file
     UINT8 emptyByte = 0xFF;
     UModelIndex parentFileIndex = model->findParentOfType(index, Types::File);
-    if (parentFileIndex.isValid() && model->hasEmptyParsingData(parentFileIndex) == false) {
-        UByteArray data = model->parsingData(index);
-        const FILE_PARSING_DATA* pdata = (const FILE_PARSING_DATA*)data.constData();
+    const FILE_PARSING_DATA* pdata = model->fileParsingData(index);
+    if (parentFileIndex.isValid() && model->hasEmptyParsingData(parentFileIndex) == false && pdata) {
         emptyByte = pdata->emptyByte;
     }
     
+    // Search for the first non-empty byte
+    UINT32 nonEmptyByteOffset = findNonFillByte((const UINT8*)body.constData(), (UINT32)body.size(), emptyByte);
+    
     // Check if the while padding file is empty
-    if (body.size() == body.count(emptyByte))
+    if (nonEmptyByteOffset == (UINT32)body.size())
         return U_SUCCESS;
     
-    // Search for the first non-empty byte
-    UINT32 nonEmptyByteOffset;
-    UINT32 size = (UINT32)body.size();
-    const UINT8* current = (const UINT8*)body.constData();
-    for (nonEmptyByteOffset = 0; nonEmptyByteOffset < size; nonEmptyByteOffset++) {
-        if (*current++ != emptyByte)
-            break;
-    }
-    
     // Add all bytes before as free space...
     UINT32 headerSize = (UINT32)model->header(index).size();
     if (nonEmptyByteOffset >= 8) {
@@ -2118,7 +2365,7 @@ USTATUS FfsParser::parsePadFileBody(const UModelIndex & index)
         UByteArray free = body.left(nonEmptyByteOffset);
         
         // Get info
-        UString info = usprintf("Full size: %Xh (%u)", (UINT32)free.size(), (UINT32)free.size());
+        ItemInfoFormatter info = fullSizeInfo((UINT32)free.size());
         
         // Add tree item
         model->addItem(headerSize, Types::FreeSpace, 0, UString("Free space"), UString(), info, UByteArray(), free, UByteArray(), Movable, index);
@@ -2134,7 +2381,7 @@ USTATUS FfsParser::parsePadFileBody(const UModelIndex & index)
     // https://github.com/tianocore/edk2/blob/stable/202011/BaseTools/Source/C/GenFv/GenFvInternalLib.c#L106
     if (padding.left(RECOVERY_STARTUP_AP_DATA_X86_SIZE) == RECOVERY_STARTUP_AP_DATA_X86_128K) {
         // Get info
-        UString info = usprintf("Full size: %Xh (%u)", (UINT32)padding.size(), (UINT32)padding.size());
+        ItemInfoFormatter info = fullSizeInfo((UINT32)padding.size());
         
         // Add tree item
         (void)model->addItem(headerSize + nonEmptyByteOffset, Types::StartupApDataEntry, Subtypes::x86128kStartupApDataEntry, UString("Startup AP data"), UString(), info, UByteArray(), padding, UByteArray(), Fixed, index);
@@ -2147,7 +2394,7 @@ USTATUS FfsParser::parsePadFileBody(const UModelIndex & index)
     }
     else { // Not a data array
         // Get info
-        UString info = usprintf("Full size: %Xh (%u)", (UINT32)padding.size(), (UINT32)padding.size());
+        ItemInfoFormatter info = fullSizeInfo((UINT32)padding.size());
         
         // Add tree item
         UModelIndex dataIndex = model->addItem(headerSize + nonEmptyByteOffset, Types::Padding, Subtypes::DataPadding, UString("Non-UEFI data"), UString(), info, UByteArray(), padding, UByteArray(), Fixed, index);
@@ -2167,6 +2414,8 @@ USTATUS FfsParser::parsePadFileBody(const UModelIndex & index)
 
 USTATUS FfsParser::parseSections(const UByteArray & sections, const UModelIndex & index, const bool insertIntoTree)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Sanity check
     if (!index.isValid())
         return U_INVALID_PARAMETER;
@@ -2180,10 +2429,9 @@ USTATUS FfsParser::parseSections(const UByteArray & sections, const UModelIndex
     // Obtain required information from parent volume
     UINT8 ffsVersion = 2;
     UModelIndex parentVolumeIndex = model->findParentOfType(index, Types::Volume);
-    if (parentVolumeIndex.isValid() && model->hasEmptyParsingData(parentVolumeIndex) == false) {
-        UByteArray data = model->parsingData(parentVolumeIndex);
-        const VOLUME_PARSING_DATA* pdata = (const VOLUME_PARSING_DATA*)data.constData();
-        ffsVersion = pdata->ffsVersion;
+    const VOLUME_PARSING_DATA* vdata = model->volumeParsingData(parentVolumeIndex);
+    if (vdata) {
+        ffsVersion = vdata->ffsVersion;
     }
     
     // Iterate over sections
@@ -2201,7 +2449,7 @@ USTATUS FfsParser::parseSections(const UByteArray & sections, const UModelIndex
                 UByteArray padding = sections.mid(sectionOffset);
                 
                 // Get info
-                UString info = usprintf("Full size: %Xh (%u)", (UINT32)padding.size(), (UINT32)padding.size());
+                ItemInfoFormatter info = fullSizeInfo((UINT32)padding.size());
                 
                 // Add tree item
                 UModelIndex dataIndex = model->addItem(headerSize + sectionOffset, Types::Padding, Subtypes::DataPadding, UString("Non-UEFI data"), UString(), info, UByteArray(), padding, UByteArray(), Fixed, index);
@@ -2275,6 +2523,8 @@ USTATUS FfsParser::parseSections(const UByteArray & sections, const UModelIndex
 
 USTATUS FfsParser::parseSectionHeader(const UByteArray & section, const UINT32 localOffset, const UModelIndex & parent, UModelIndex & index, const bool insertIntoTree)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Check sanity
     if ((UINT32)section.size() < sizeof(EFI_COMMON_SECTION_HEADER)) {
         return U_INVALID_SECTION;
@@ -2311,6 +2561,8 @@ USTATUS FfsParser::parseSectionHeader(const UByteArray & section, const UINT32 l
 
 USTATUS FfsParser::parseCommonSectionHeader(const UByteArray & section, const UINT32 localOffset, const UModelIndex & parent, UModelIndex & index, const bool insertIntoTree)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Check sanity
     if ((UINT32)section.size() < sizeof(EFI_COMMON_SECTION_HEADER)) {
         return U_INVALID_SECTION;
@@ -2319,10 +2571,9 @@ USTATUS FfsParser::parseCommonSectionHeader(const UByteArray & section, const UI
     // Obtain required information from parent volume
     UINT8 ffsVersion = 2;
     UModelIndex parentVolumeIndex = model->findParentOfType(parent, Types::Volume);
-    if (parentVolumeIndex.isValid() && model->hasEmptyParsingData(parentVolumeIndex) == false) {
-        UByteArray data = model->parsingData(parentVolumeIndex);
-        const VOLUME_PARSING_DATA* pdata = (const VOLUME_PARSING_DATA*)data.constData();
-        ffsVersion = pdata->ffsVersion;
+    const VOLUME_PARSING_DATA* vdata = model->volumeParsingData(parentVolumeIndex);
+    if (vdata) {
+        ffsVersion = vdata->ffsVersion;
     }
     
     // Obtain header fields
@@ -2342,11 +2593,15 @@ USTATUS FfsParser::parseCommonSectionHeader(const UByteArray & section, const UI
     
     // Get info
     UString name = sectionTypeToUString(type) + UString(" section");
-    UString info = usprintf("Type: %02Xh\nFull size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)",
-                            type,
-                            (UINT32)section.size(), (UINT32)section.size(),
-                            headerSize, headerSize,
-                            (UINT32)body.size(), (UINT32)body.size());
+    const UINT32 sectionSize = (UINT32)section.size();
+    const UINT32 bodySize = (UINT32)body.size();
+    ItemInfoFormatter info = [sectionSize, type, headerSize, bodySize]() {
+        return usprintf("Type: %02Xh\nFull size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)",
+                        type,
+                        sectionSize, sectionSize,
+                        headerSize, headerSize,
+                        bodySize, bodySize);
+    };
     
     // Add tree item
     if (insertIntoTree) {
@@ -2358,6 +2613,8 @@ USTATUS FfsParser::parseCommonSectionHeader(const UByteArray & section, const UI
 
 USTATUS FfsParser::parseCompressedSectionHeader(const UByteArray & section, const UINT32 localOffset, const UModelIndex & parent, UModelIndex & index, const bool insertIntoTree)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Check sanity
     if ((UINT32)section.size() < sizeof(EFI_COMMON_SECTION_HEADER))
         return U_INVALID_SECTION;
@@ -2365,10 +2622,9 @@ USTATUS FfsParser::parseCompressedSectionHeader(const UByteArray & section, cons
     // Obtain required information from parent volume
     UINT8 ffsVersion = 2;
     UModelIndex parentVolumeIndex = model->findParentOfType(parent, Types::Volume);
-    if (parentVolumeIndex.isValid() && model->hasEmptyParsingData(parentVolumeIndex) == false) {
-        UByteArray data = model->parsingData(parentVolumeIndex);
-        const VOLUME_PARSING_DATA* pdata = (const VOLUME_PARSING_DATA*)data.constData();
-        ffsVersion = pdata->ffsVersion;
+    const VOLUME_PARSING_DATA* vdata = model->volumeParsingData(parentVolumeIndex);
+    if (vdata) {
+        ffsVersion = vdata->ffsVersion;
     }
     
     // Obtain header fields
@@ -2403,13 +2659,18 @@ USTATUS FfsParser::parseCompressedSectionHeader(const UByteArray & section, cons
     
     // Get info
     UString name = sectionTypeToUString(sectionHeader->Type) + UString(" section");
-    UString info = usprintf("Type: %02Xh\nFull size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\nCompression type: %02Xh\nDecompressed size: %Xh (%u)",
-                            sectionHeader->Type,
-                            (UINT32)section.size(), (UINT32)section.size(),
-                            headerSize, headerSize,
-                            (UINT32)body.size(), (UINT32)body.size(),
-                            compressionType,
-                            uncompressedLength, uncompressedLength);
+    const UINT32 sectionSize = (UINT32)section.size();
+    const UINT8 type = sectionHeader->Type;
+    const UINT32 bodySize = (UINT32)body.size();
+    ItemInfoFormatter info = [sectionSize, type, headerSize, bodySize, compressionType, uncompressedLength]() {
+        return usprintf("Type: %02Xh\nFull size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\nCompression type: %02Xh\nDecompressed size: %Xh (%u)",
+                        type,
+                        sectionSize, sectionSize,
+                        headerSize, headerSize,
+                        bodySize, bodySize,
+                        compressionType,
+                        uncompressedLength, uncompressedLength);
+    };
     
     // Add tree item
     if (insertIntoTree) {
@@ -2419,7 +2680,7 @@ USTATUS FfsParser::parseCompressedSectionHeader(const UByteArray & section, cons
         COMPRESSED_SECTION_PARSING_DATA pdata = {};
         pdata.compressionType = compressionType;
         pdata.uncompressedSize = uncompressedLength;
-        model->setParsingData(index, UByteArray((const char*)&pdata, sizeof(pdata)));
+        model->setParsingData(index, pdata);
     }
     
     return U_SUCCESS;
@@ -2427,6 +2688,8 @@ USTATUS FfsParser::parseCompressedSectionHeader(const UByteArray & section, cons
 
 USTATUS FfsParser::parseGuidedSectionHeader(const UByteArray & section, const UINT32 localOffset, const UModelIndex & parent, UModelIndex & index, const bool insertIntoTree)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Check sanity
     if ((UINT32)section.size() < sizeof(EFI_COMMON_SECTION_HEADER))
         return U_INVALID_SECTION;
@@ -2434,10 +2697,9 @@ USTATUS FfsParser::parseGuidedSectionHeader(const UByteArray & section, const UI
     // Obtain required information from parent volume
     UINT8 ffsVersion = 2;
     UModelIndex parentVolumeIndex = model->findParentOfType(parent, Types::Volume);
-    if (parentVolumeIndex.isValid() && model->hasEmptyParsingData(parentVolumeIndex) == false) {
-        UByteArray data = model->parsingData(parentVolumeIndex);
-        const VOLUME_PARSING_DATA* pdata = (const VOLUME_PARSING_DATA*)data.constData();
-        ffsVersion = pdata->ffsVersion;
+    const VOLUME_PARSING_DATA* vdata = model->volumeParsingData(parentVolumeIndex);
+    if (vdata) {
+        ffsVersion = vdata->ffsVersion;
     }
     
     // Obtain header fields
@@ -2596,16 +2858,19 @@ USTATUS FfsParser::parseGuidedSectionHeader(const UByteArray & section, const UI
     
     // Get info
     UString name = guidToUString(guid);
-    UString info = UString("Section GUID: ") + guidToUString(guid, false) +
-    usprintf("\nType: %02Xh\nFull size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\nAttributes: %04Xh",
-             sectionHeader->Type,
-             (UINT32)section.size(), (UINT32)section.size(),
-             (UINT32)header.size(), (UINT32)header.size(),
-             (UINT32)body.size(), (UINT32)body.size(),
-             attributes);
-    
-    // Append additional info
-    info += additionalInfo;
+    const UINT32 sectionSize = (UINT32)section.size();
+    const UINT8 type = sectionHeader->Type;
+    const UINT32 headerLength = (UINT32)header.size();
+    const UINT32 bodySize = (UINT32)body.size();
+    ItemInfoFormatter info = [sectionSize, type, headerLength, bodySize, guid, attributes, additionalInfo]() {
+        return UString("Section GUID: ") + guidToUString(guid, false) +
+        usprintf("\nType: %02Xh\nFull size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\nAttributes: %04Xh",
+                 type,
+                 sectionSize, sectionSize,
+                 headerLength, headerLength,
+                 bodySize, bodySize,
+                 attributes) + additionalInfo;
+    };
     
     // Add tree item
     if (insertIntoTree) {
@@ -2614,7 +2879,7 @@ USTATUS FfsParser::parseGuidedSectionHeader(const UByteArray & section, const UI
         // Set parsing data
         GUIDED_SECTION_PARSING_DATA pdata = {};
         pdata.guid = guid;
-        model->setParsingData(index, UByteArray((const char*)&pdata, sizeof(pdata)));
+        model->setParsingData(index, pdata);
         
         // Show messages
         if (msgSignedSectionFound)
@@ -2642,6 +2907,8 @@ USTATUS FfsParser::parseGuidedSectionHeader(const UByteArray & section, const UI
 
 USTATUS FfsParser::parseFreeformGuidedSectionHeader(const UByteArray & section, const UINT32 localOffset, const UModelIndex & parent, UModelIndex & index, const bool insertIntoTree)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Check sanity
     if ((UINT32)section.size() < sizeof(EFI_COMMON_SECTION_HEADER))
         return U_INVALID_SECTION;
@@ -2649,10 +2916,9 @@ USTATUS FfsParser::parseFreeformGuidedSectionHeader(const UByteArray & section,
     // Obtain required information from parent volume
     UINT8 ffsVersion = 2;
     UModelIndex parentVolumeIndex = model->findParentOfType(parent, Types::Volume);
-    if (parentVolumeIndex.isValid() && model->hasEmptyParsingData(parentVolumeIndex) == false) {
-        UByteArray data = model->parsingData(parentVolumeIndex);
-        const VOLUME_PARSING_DATA* pdata = (const VOLUME_PARSING_DATA*)data.constData();
-        ffsVersion = pdata->ffsVersion;
+    const VOLUME_PARSING_DATA* vdata = model->volumeParsingData(parentVolumeIndex);
+    if (vdata) {
+        ffsVersion = vdata->ffsVersion;
     }
     
     // Obtain header fields
@@ -2686,12 +2952,16 @@ USTATUS FfsParser::parseFreeformGuidedSectionHeader(const UByteArray & section,
     
     // Get info
     UString name = sectionTypeToUString(type) + (" section");
-    UString info = usprintf("Type: %02Xh\nFull size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\nSubtype GUID: ",
-                            type,
-                            (UINT32)section.size(), (UINT32)section.size(),
-                            (UINT32)header.size(), (UINT32)header.size(),
-                            (UINT32)body.size(), (UINT32)body.size())
-    + guidToUString(guid, false);
+    const UINT32 sectionSize = (UINT32)section.size();
+    const UINT32 bodySize = (UINT32)body.size();
+    ItemInfoFormatter info = [sectionSize, type, headerSize, bodySize, guid]() {
+        return usprintf("Type: %02Xh\nFull size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\nSubtype GUID: ",
+                        type,
+                        sectionSize, sectionSize,
+                        headerSize, headerSize,
+                        bodySize, bodySize)
+        + guidToUString(guid, false);
+    };
     
     // Add tree item
     if (insertIntoTree) {
@@ -2700,7 +2970,7 @@ USTATUS FfsParser::parseFreeformGuidedSectionHeader(const UByteArray & section,
         // Set parsing data
         FREEFORM_GUIDED_SECTION_PARSING_DATA pdata = {};
         pdata.guid = guid;
-        model->setParsingData(index, UByteArray((const char*)&pdata, sizeof(pdata)));
+        model->setParsingData(index, pdata);
         
         // Rename section
         model->setName(index, guidToUString(guid));
@@ -2711,6 +2981,8 @@ USTATUS FfsParser::parseFreeformGuidedSectionHeader(const UByteArray & section,
 
 USTATUS FfsParser::parseVersionSectionHeader(const UByteArray & section, const UINT32 localOffset, const UModelIndex & parent, UModelIndex & index, const bool insertIntoTree)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Check sanity
     if ((UINT32)section.size() < sizeof(EFI_COMMON_SECTION_HEADER))
         return U_INVALID_SECTION;
@@ -2718,10 +2990,9 @@ USTATUS FfsParser::parseVersionSectionHeader(const UByteArray & section, const U
     // Obtain required information from parent volume
     UINT8 ffsVersion = 2;
     UModelIndex parentVolumeIndex = model->findParentOfType(parent, Types::Volume);
-    if (parentVolumeIndex.isValid() && model->hasEmptyParsingData(parentVolumeIndex) == false) {
-        UByteArray data = model->parsingData(parentVolumeIndex);
-        const VOLUME_PARSING_DATA* pdata = (const VOLUME_PARSING_DATA*)data.constData();
-        ffsVersion = pdata->ffsVersion;
+    const VOLUME_PARSING_DATA* vdata = model->volumeParsingData(parentVolumeIndex);
+    if (vdata) {
+        ffsVersion = vdata->ffsVersion;
     }
     
     // Obtain header fields
@@ -2753,12 +3024,16 @@ USTATUS FfsParser::parseVersionSectionHeader(const UByteArray & section, const U
     
     // Get info
     UString name = sectionTypeToUString(type) + (" section");
-    UString info = usprintf("Type: %02Xh\nFull size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\nBuild number: %u",
-                            type,
-                            (UINT32)section.size(), (UINT32)section.size(),
-                            (UINT32)header.size(), (UINT32)header.size(),
-                            (UINT32)body.size(), (UINT32)body.size(),
-                            buildNumber);
+    const UINT32 sectionSize = (UINT32)section.size();
+    const UINT32 bodySize = (UINT32)body.size();
+    ItemInfoFormatter info = [sectionSize, type, headerSize, bodySize, buildNumber]() {
+        return usprintf("Type: %02Xh\nFull size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\nBuild number: %u",
+                        type,
+                        sectionSize, sectionSize,
+                        headerSize, headerSize,
+                        bodySize, bodySize,
+                        buildNumber);
+    };
     
     // Add tree item
     if (insertIntoTree) {
@@ -2770,6 +3045,8 @@ USTATUS FfsParser::parseVersionSectionHeader(const UByteArray & section, const U
 
 USTATUS FfsParser::parsePostcodeSectionHeader(const UByteArray & section, const UINT32 localOffset, const UModelIndex & parent, UModelIndex & index, const bool insertIntoTree)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Check sanity
     if ((UINT32)section.size() < sizeof(EFI_COMMON_SECTION_HEADER))
         return U_INVALID_SECTION;
@@ -2777,10 +3054,9 @@ USTATUS FfsParser::parsePostcodeSectionHeader(const UByteArray & section, const
     // Obtain required information from parent volume
     UINT8 ffsVersion = 2;
     UModelIndex parentVolumeIndex = model->findParentOfType(parent, Types::Volume);
-    if (parentVolumeIndex.isValid() && model->hasEmptyParsingData(parentVolumeIndex) == false) {
-        UByteArray data = model->parsingData(parentVolumeIndex);
-        const VOLUME_PARSING_DATA* pdata = (const VOLUME_PARSING_DATA*)data.constData();
-        ffsVersion = pdata->ffsVersion;
+    const VOLUME_PARSING_DATA* vdata = model->volumeParsingData(parentVolumeIndex);
+    if (vdata) {
+        ffsVersion = vdata->ffsVersion;
     }
     
     // Obtain header fields
@@ -2812,12 +3088,16 @@ USTATUS FfsParser::parsePostcodeSectionHeader(const UByteArray & section, const
     
     // Get info
     UString name = sectionTypeToUString(type) + (" section");
-    UString info = usprintf("Type: %02Xh\nFull size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\nPostcode: %Xh",
-                            type,
-                            (UINT32)section.size(), (UINT32)section.size(),
-                            (UINT32)header.size(), (UINT32)header.size(),
-                            (UINT32)body.size(), (UINT32)body.size(),
-                            postCode);
+    const UINT32 sectionSize = (UINT32)section.size();
+    const UINT32 bodySize = (UINT32)body.size();
+    ItemInfoFormatter info = [sectionSize, type, headerSize, bodySize, postCode]() {
+        return usprintf("Type: %02Xh\nFull size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\nPostcode: %Xh",
+                        type,
+                        sectionSize, sectionSize,
+                        headerSize, headerSize,
+                        bodySize, bodySize,
+                        postCode);
+    };
     
     // Add tree item
     if (insertIntoTree) {
@@ -2829,6 +3109,8 @@ USTATUS FfsParser::parsePostcodeSectionHeader(const UByteArray & section, const
 
 USTATUS FfsParser::parseSectionBody(const UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Sanity check
     if (!index.isValid())
         return U_INVALID_PARAMETER;
@@ -2864,28 +3146,78 @@ USTATUS FfsParser::parseSectionBody(const UModelIndex & index)
     }
 }
 
+USTATUS FfsParser::decompressBody(const UModelIndex & index, const UINT8 compressionType, const UINT8 inflateAlgorithm, UINT8 & algorithm, UINT32 & dictionarySize, UByteArray & decompressed, UByteArray & efiDecompressed)
+{
+    const UByteArray body = model->body(index);
+    
+    // Identical data might already be decompressed, uncompressed data is used as is and doesn't need caching
+    const bool useCache = decompressionCache && (compressionType != EFI_NOT_COMPRESSED || inflateAlgorithm != COMPRESSION_ALGORITHM_NONE);
+    DecompressionCache::KEY cacheKey;
+    DECOMPRESSION_RESULT cached;
+    if (useCache) {
+        cacheKey = DecompressionCache::makeKey(compressionType, inflateAlgorithm, body);
+    }
+    if (useCache && decompressionCache->find(cacheKey, cached)) {
+        algorithm = cached.algorithm;
+        dictionarySize = cached.dictionarySize;
+        decompressed = cached.decompressed;
+        efiDecompressed = cached.efiDecompressed;
+        stats.addDecompressionCacheHit((UINT32)decompressed.size());
+        return U_SUCCESS;
+    }
+    
+    UINT64 decompressionStarted = stats.now();
+    USTATUS result;
+    // GZip and Zlib are only selected by GUIDs of GUID defined sections, never by compression type stored in the image
+    if (inflateAlgorithm == COMPRESSION_ALGORITHM_GZIP || inflateAlgorithm == COMPRESSION_ALGORITHM_ZLIB) {
+        algorithm = inflateAlgorithm;
+        dictionarySize = 0;
+        result = (inflateAlgorithm == COMPRESSION_ALGORITHM_GZIP) ? gzipDecompress(body, decompressed) : zlibDecompress(body, decompressed);
+    }
+    else {
+        result = decompress(body, compressionType, algorithm, dictionarySize, decompressed, efiDecompressed);
+    }
+    stats.addDecompression(algorithm, (UINT32)body.size(), (UINT32)decompressed.size(), result == U_SUCCESS, decompressionStarted);
+    
+    if (result == U_SUCCESS && useCache) {
+        DECOMPRESSION_RESULT entry;
+        entry.algorithm = algorithm;
+        entry.dictionarySize = dictionarySize;
+        entry.decompressed = decompressed;
+        entry.efiDecompressed = efiDecompressed;
+        decompressionCache->insert(cacheKey, entry);
+    }
+    
+    return result;
+}
+
 USTATUS FfsParser::parseCompressedSectionBody(const UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Sanity check
     if (!index.isValid())
         return U_INVALID_PARAMETER;
     
     // Obtain required information from parsing data
     UINT8 compressionType = EFI_NOT_COMPRESSED;
-    UINT32 uncompressedSize = (UINT32)model->body(index).size();
-    if (model->hasEmptyParsingData(index) == false) {
-        UByteArray data = model->parsingData(index);
-        const COMPRESSED_SECTION_PARSING_DATA* pdata = (const COMPRESSED_SECTION_PARSING_DATA*)data.constData();
-        compressionType = readUnaligned(pdata).compressionType;
-        uncompressedSize = readUnaligned(pdata).uncompressedSize;
+    UINT32 uncompressedSize = model->bodySize(index);
+    const COMPRESSED_SECTION_PARSING_DATA* cdata = model->compressedSectionParsingData(index);
+    if (cdata) {
+        compressionType = cdata->compressionType;
+        uncompressedSize = cdata->uncompressedSize;
     }
     
+    // Decompression can be deferred until contents of the section are requested
+    if (compressionType != EFI_NOT_COMPRESSED && deferDecompression(index))
+        return U_SUCCESS;
+    
     // Decompress section
     UINT8 algorithm = COMPRESSION_ALGORITHM_NONE;
     UINT32 dictionarySize = 0;
     UByteArray decompressed;
     UByteArray efiDecompressed;
-    USTATUS result = decompress(model->body(index), compressionType, algorithm, dictionarySize, decompressed, efiDecompressed);
+    USTATUS result = decompressBody(index, compressionType, COMPRESSION_ALGORITHM_NONE, algorithm, dictionarySize, decompressed, efiDecompressed);
     if (result) {
         msg(usprintf("%s: decompression failed with error ", __FUNCTION__) + errorCodeToUString(result), index);
         return U_SUCCESS;
@@ -2935,7 +3267,7 @@ USTATUS FfsParser::parseCompressedSectionBody(const UModelIndex & index)
     pdata.dictionarySize = dictionarySize;
     pdata.compressionType = compressionType;
     pdata.uncompressedSize = uncompressedSize;
-    model->setParsingData(index, UByteArray((const char*)&pdata, sizeof(pdata)));
+    model->setParsingData(index, pdata);
     
     // Parse decompressed data
     return parseSections(decompressed, index, true);
@@ -2943,16 +3275,17 @@ USTATUS FfsParser::parseCompressedSectionBody(const UModelIndex & index)
 
 USTATUS FfsParser::parseGuidedSectionBody(const UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Sanity check
     if (!index.isValid())
         return U_INVALID_PARAMETER;
     
     // Obtain required information from parsing data
     EFI_GUID guid = { 0, 0, 0, {0, 0, 0, 0, 0, 0, 0, 0 }};
-    if (model->hasEmptyParsingData(index) == false) {
-        UByteArray data = model->parsingData(index);
-        const GUIDED_SECTION_PARSING_DATA* pdata = (const GUIDED_SECTION_PARSING_DATA*)data.constData();
-        guid = readUnaligned(pdata).guid;
+    const GUIDED_SECTION_PARSING_DATA* gdata = model->guidedSectionParsingData(index);
+    if (gdata) {
+        guid = gdata->guid;
     }
     
     // Check if section requires processing
@@ -2963,9 +3296,21 @@ USTATUS FfsParser::parseGuidedSectionBody(const UModelIndex & index)
     UINT8 algorithm = COMPRESSION_ALGORITHM_NONE;
     UINT32 dictionarySize = 0;
     UByteArray baGuid = UByteArray((const char*)&guid, sizeof(EFI_GUID));
+    
+    // Decompression can be deferred until contents of the section are requested
+    if ((baGuid == EFI_GUIDED_SECTION_TIANO
+         || baGuid == EFI_GUIDED_SECTION_LZMA
+         || baGuid == EFI_GUIDED_SECTION_LZMA_HP
+         || baGuid == EFI_GUIDED_SECTION_LZMA_MS
+         || baGuid == EFI_GUIDED_SECTION_LZMAF86
+         || baGuid == EFI_GUIDED_SECTION_GZIP
+         || baGuid == EFI_GUIDED_SECTION_ZLIB_AMD)
+        && deferDecompression(index))
+        return U_SUCCESS;
+    
     // Tiano compressed section
     if (baGuid == EFI_GUIDED_SECTION_TIANO) {
-        USTATUS result = decompress(model->body(index), EFI_STANDARD_COMPRESSION, algorithm, dictionarySize, processed, efiDecompressed);
+        USTATUS result = decompressBody(index, EFI_STANDARD_COMPRESSION, COMPRESSION_ALGORITHM_NONE, algorithm, dictionarySize, processed, efiDecompressed);
         if (result) {
             msg(usprintf("%s: decompression failed with error ", __FUNCTION__) + errorCodeToUString(result), index);
             return U_SUCCESS;
@@ -2995,7 +3340,7 @@ USTATUS FfsParser::parseGuidedSectionBody(const UModelIndex & index)
     else if (baGuid == EFI_GUIDED_SECTION_LZMA
              || baGuid == EFI_GUIDED_SECTION_LZMA_HP
              || baGuid == EFI_GUIDED_SECTION_LZMA_MS) {
-        USTATUS result = decompress(model->body(index), EFI_CUSTOMIZED_COMPRESSION, algorithm, dictionarySize, processed, efiDecompressed);
+        USTATUS result = decompressBody(index, EFI_CUSTOMIZED_COMPRESSION, COMPRESSION_ALGORITHM_NONE, algorithm, dictionarySize, processed, efiDecompressed);
         if (result) {
             msg(usprintf("%s: decompression failed with error ", __FUNCTION__) + errorCodeToUString(result), index);
             return U_SUCCESS;
@@ -3013,7 +3358,7 @@ USTATUS FfsParser::parseGuidedSectionBody(const UModelIndex & index)
     }
     // LZMAF86 compressed section
     else if (baGuid == EFI_GUIDED_SECTION_LZMAF86) {
-        USTATUS result = decompress(model->body(index), EFI_CUSTOMIZED_COMPRESSION_LZMAF86, algorithm, dictionarySize, processed, efiDecompressed);
+        USTATUS result = decompressBody(index, EFI_CUSTOMIZED_COMPRESSION_LZMAF86, COMPRESSION_ALGORITHM_NONE, algorithm, dictionarySize, processed, efiDecompressed);
         if (result) {
             msg(usprintf("%s: decompression failed with error ", __FUNCTION__) + errorCodeToUString(result), index);
             return U_SUCCESS;
@@ -3031,25 +3376,23 @@ USTATUS FfsParser::parseGuidedSectionBody(const UModelIndex & index)
     }
     // GZip compressed section
     else if (baGuid == EFI_GUIDED_SECTION_GZIP) {
-        USTATUS result = gzipDecompress(model->body(index), processed);
+        USTATUS result = decompressBody(index, EFI_NOT_COMPRESSED, COMPRESSION_ALGORITHM_GZIP, algorithm, dictionarySize, processed, efiDecompressed);
         if (result) {
             msg(usprintf("%s: decompression failed with error ", __FUNCTION__) + errorCodeToUString(result), index);
             return U_SUCCESS;
         }
 
-        algorithm = COMPRESSION_ALGORITHM_GZIP;
         info += UString("\nCompression algorithm: GZip");
         info += usprintf("\nDecompressed size: %Xh (%u)", (UINT32)processed.size(), (UINT32)processed.size());
     }
     // Zlib compressed section
     else if (baGuid == EFI_GUIDED_SECTION_ZLIB_AMD) {
-        USTATUS result = zlibDecompress(model->body(index), processed);
+        USTATUS result = decompressBody(index, EFI_NOT_COMPRESSED, COMPRESSION_ALGORITHM_ZLIB, algorithm, dictionarySize, processed, efiDecompressed);
         if (result) {
             msg(usprintf("%s: decompression failed with error ", __FUNCTION__) + errorCodeToUString(result), index);
             return U_SUCCESS;
         }
 
-        algorithm = COMPRESSION_ALGORITHM_ZLIB;
         info += UString("\nCompression algorithm: Zlib");
         info += usprintf("\nDecompressed size: %Xh (%u)", (UINT32)processed.size(), (UINT32)processed.size());
     }
@@ -3060,7 +3403,7 @@ USTATUS FfsParser::parseGuidedSectionBody(const UModelIndex & index)
     // Set parsing data
     GUIDED_SECTION_PARSING_DATA pdata = {};
     pdata.dictionarySize = dictionarySize;
-    model->setParsingData(index, UByteArray((const char*)&pdata, sizeof(pdata)));
+    model->setParsingData(index, pdata);
     
     // Set compression data
     if (algorithm != COMPRESSION_ALGORITHM_NONE) {
@@ -3078,18 +3421,22 @@ USTATUS FfsParser::parseGuidedSectionBody(const UModelIndex & index)
 
 USTATUS FfsParser::parseVersionSectionBody(const UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Sanity check
     if (!index.isValid())
         return U_INVALID_PARAMETER;
     
     // Add info
-    model->addInfo(index, UString("\nVersion string: ") + uFromUcs2(model->body(index).constData()));
+    model->addInfo(index, UString("\nVersion string: ") + uFromUcs2(model->body(index).constData(), model->body(index).size() / 2));
     
     return U_SUCCESS;
 }
 
 USTATUS FfsParser::parseDepexSectionBody(const UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Sanity check
     if (!index.isValid())
         return U_INVALID_PARAMETER;
@@ -3216,11 +3563,13 @@ USTATUS FfsParser::parseDepexSectionBody(const UModelIndex & index)
 
 USTATUS FfsParser::parseUiSectionBody(const UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Sanity check
     if (!index.isValid())
         return U_INVALID_PARAMETER;
     
-    UString text = uFromUcs2(model->body(index).constData());
+    UString text = uFromUcs2(model->body(index).constData(), model->body(index).size() / 2);
     
     // Add info
     model->addInfo(index, UString("\nText: ") + text);
@@ -3233,6 +3582,8 @@ USTATUS FfsParser::parseUiSectionBody(const UModelIndex & index)
 
 USTATUS FfsParser::parseAprioriRawSection(const UByteArray & body, UString & parsed)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Sanity check
     if (body.size() % sizeof(EFI_GUID)) {
         msg(usprintf("%s: apriori file has size is not a multiple of 16", __FUNCTION__));
@@ -3251,6 +3602,8 @@ USTATUS FfsParser::parseAprioriRawSection(const UByteArray & body, UString & par
 
 USTATUS FfsParser::parseRawSectionBody(const UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Sanity check
     if (!index.isValid())
         return U_INVALID_PARAMETER;
@@ -3300,6 +3653,8 @@ USTATUS FfsParser::parseRawSectionBody(const UModelIndex & index)
 
 USTATUS FfsParser::parsePeImageSectionBody(const UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Sanity check
     if (!index.isValid())
         return U_INVALID_PARAMETER;
@@ -3343,51 +3698,70 @@ USTATUS FfsParser::parsePeImageSectionBody(const UModelIndex & index)
         return U_SUCCESS;
     }
     
-    info += usprintf("\nDOS signature: %04Xh\nPE signature: %08Xh",
-                     dosHeader->e_magic,
-                     peHeader->Signature) +
-    UString("\nMachine type: ") + machineTypeToUString(imageFileHeader->Machine) +
-    usprintf("\nNumber of sections: %u\nCharacteristics: %04Xh",
-             imageFileHeader->NumberOfSections,
-             imageFileHeader->Characteristics);
+    // Header fields are formatted only when info of the section is requested
+    const UINT16 dosSignature = dosHeader->e_magic;
+    const UINT32 peSignature = peHeader->Signature;
+    const EFI_IMAGE_FILE_HEADER infoFileHeader = *imageFileHeader;
+    const ItemInfoFormatter headerInfo = [dosSignature, peSignature, infoFileHeader]() {
+        return usprintf("\nDOS signature: %04Xh\nPE signature: %08Xh",
+                        dosSignature,
+                        peSignature) +
+        UString("\nMachine type: ") + machineTypeToUString(infoFileHeader.Machine) +
+        usprintf("\nNumber of sections: %u\nCharacteristics: %04Xh",
+                 infoFileHeader.NumberOfSections,
+                 infoFileHeader.Characteristics);
+    };
     
     EFI_IMAGE_OPTIONAL_HEADER_POINTERS_UNION optionalHeader = {};
     optionalHeader.H32 = (const EFI_IMAGE_OPTIONAL_HEADER32*)(imageFileHeader + 1);
     if (body.size() < (UINT8*)optionalHeader.H32 - (UINT8*)dosHeader) {
-        info += UString("\nPE optional header: invalid");
         msg(usprintf("%s: PE32 image with invalid PE optional header", __FUNCTION__), index);
-        model->addInfo(index, info);
+        model->addInfo(index, [headerInfo]() { return headerInfo() + UString("\nPE optional header: invalid"); });
         return U_SUCCESS;
     }
     
-    if (optionalHeader.H32->Magic == EFI_IMAGE_PE_OPTIONAL_HDR32_MAGIC) {
-        info += usprintf("\nOptional header signature: %04Xh\nSubsystem: %04Xh\nAddress of entry point: %Xh\nBase of code: %Xh\nImage base: %Xh",
-                         optionalHeader.H32->Magic,
-                         optionalHeader.H32->Subsystem,
-                         optionalHeader.H32->AddressOfEntryPoint,
-                         optionalHeader.H32->BaseOfCode,
-                         optionalHeader.H32->ImageBase);
-    }
-    else if (optionalHeader.H32->Magic == EFI_IMAGE_PE_OPTIONAL_HDR64_MAGIC) {
-        info += usprintf("\nOptional header signature: %04Xh\nSubsystem: %04Xh\nAddress of entry point: %Xh\nBase of code: %Xh\nImage base: %" PRIX64 "h",
-                         optionalHeader.H64->Magic,
-                         optionalHeader.H64->Subsystem,
-                         optionalHeader.H64->AddressOfEntryPoint,
-                         optionalHeader.H64->BaseOfCode,
-                         optionalHeader.H64->ImageBase);
+    const UINT16 magic = optionalHeader.H32->Magic;
+    if (magic == EFI_IMAGE_PE_OPTIONAL_HDR32_MAGIC) {
+        const UINT16 subsystem = optionalHeader.H32->Subsystem;
+        const UINT32 entryPoint = optionalHeader.H32->AddressOfEntryPoint;
+        const UINT32 baseOfCode = optionalHeader.H32->BaseOfCode;
+        const UINT32 imageBase = optionalHeader.H32->ImageBase;
+        model->addInfo(index, [headerInfo, magic, subsystem, entryPoint, baseOfCode, imageBase]() {
+            return headerInfo() + usprintf("\nOptional header signature: %04Xh\nSubsystem: %04Xh\nAddress of entry point: %Xh\nBase of code: %Xh\nImage base: %Xh",
+                                           magic,
+                                           subsystem,
+                                           entryPoint,
+                                           baseOfCode,
+                                           imageBase);
+        });
+    }
+    else if (magic == EFI_IMAGE_PE_OPTIONAL_HDR64_MAGIC) {
+        const UINT16 subsystem = optionalHeader.H64->Subsystem;
+        const UINT32 entryPoint = optionalHeader.H64->AddressOfEntryPoint;
+        const UINT32 baseOfCode = optionalHeader.H64->BaseOfCode;
+        const UINT64 imageBase = optionalHeader.H64->ImageBase;
+        model->addInfo(index, [headerInfo, magic, subsystem, entryPoint, baseOfCode, imageBase]() {
+            return headerInfo() + usprintf("\nOptional header signature: %04Xh\nSubsystem: %04Xh\nAddress of entry point: %Xh\nBase of code: %Xh\nImage base: %" PRIX64 "h",
+                                           magic,
+                                           subsystem,
+                                           entryPoint,
+                                           baseOfCode,
+                                           imageBase);
+        });
     }
     else {
-        info += usprintf("\nOptional header signature: %04Xh, unknown", optionalHeader.H32->Magic);
         msg(usprintf("%s: PE32 image with invalid optional PE header signature", __FUNCTION__), index);
+        model->addInfo(index, [headerInfo, magic]() { return headerInfo() + usprintf("\nOptional header signature: %04Xh, unknown", magic); });
     }
     
-    model->addInfo(index, info);
     return U_SUCCESS;
 }
 
 
 USTATUS FfsParser::parseTeImageSectionBody(const UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Check sanity
     if (!index.isValid())
         return U_INVALID_PARAMETER;
@@ -3399,24 +3773,27 @@ USTATUS FfsParser::parseTeImageSectionBody(const UModelIndex & index)
         return U_SUCCESS;
     }
     
-    UString info;
+    // Add TE info
     const EFI_IMAGE_TE_HEADER* teHeader = (const EFI_IMAGE_TE_HEADER*)body.constData();
     if (teHeader->Signature != EFI_IMAGE_TE_SIGNATURE) {
-        info += usprintf("\nSignature: %04Xh, invalid", teHeader->Signature);
+        model->addInfo(index, usprintf("\nSignature: %04Xh, invalid", teHeader->Signature));
         msg(usprintf("%s: TE image with invalid TE signature", __FUNCTION__), index);
     }
     else {
-        info += usprintf("\nSignature: %04Xh", teHeader->Signature) +
-        UString("\nMachine type: ") + machineTypeToUString(teHeader->Machine) +
-        usprintf("\nNumber of sections: %u\nSubsystem: %02Xh\nStripped size: %Xh (%u)\n"
-                 "Base of code: %Xh\nAddress of entry point: %Xh\nImage base: %" PRIX64 "h\nAdjusted image base: %" PRIX64 "h",
-                 teHeader->NumberOfSections,
-                 teHeader->Subsystem,
-                 teHeader->StrippedSize, teHeader->StrippedSize,
-                 teHeader->BaseOfCode,
-                 teHeader->AddressOfEntryPoint,
-                 teHeader->ImageBase,
-                 teHeader->ImageBase + teHeader->StrippedSize - sizeof(EFI_IMAGE_TE_HEADER));
+        const EFI_IMAGE_TE_HEADER infoHeader = *teHeader;
+        model->addInfo(index, [infoHeader]() {
+            return usprintf("\nSignature: %04Xh", infoHeader.Signature) +
+            UString("\nMachine type: ") + machineTypeToUString(infoHeader.Machine) +
+            usprintf("\nNumber of sections: %u\nSubsystem: %02Xh\nStripped size: %Xh (%u)\n"
+                     "Base of code: %Xh\nAddress of entry point: %Xh\nImage base: %" PRIX64 "h\nAdjusted image base: %" PRIX64 "h",
+                     infoHeader.NumberOfSections,
+                     infoHeader.Subsystem,
+                     infoHeader.StrippedSize, infoHeader.StrippedSize,
+                     infoHeader.BaseOfCode,
+                     infoHeader.AddressOfEntryPoint,
+                     infoHeader.ImageBase,
+                     infoHeader.ImageBase + infoHeader.StrippedSize - sizeof(EFI_IMAGE_TE_HEADER));
+        });
     }
     
     // Update parsing data
@@ -3424,10 +3801,7 @@ USTATUS FfsParser::parseTeImageSectionBody(const UModelIndex & index)
     pdata.imageBaseType = EFI_IMAGE_TE_BASE_OTHER; // Will be determined later
     pdata.originalImageBase = (UINT32)teHeader->ImageBase;
     pdata.adjustedImageBase = (UINT32)(teHeader->ImageBase + teHeader->StrippedSize - sizeof(EFI_IMAGE_TE_HEADER));
-    model->setParsingData(index, UByteArray((const char*)&pdata, sizeof(pdata)));
-    
-    // Add TE info
-    model->addInfo(index, info);
+    model->setParsingData(index, pdata);
     
     return U_SUCCESS;
 }
@@ -3446,7 +3820,7 @@ USTATUS FfsParser::performSecondPass(const UModelIndex & index)
     }
     
     // Calculate address difference
-    const UINT32 vtfSize = (UINT32)(model->header(lastVtf).size() + model->body(lastVtf).size() + model->tail(lastVtf).size());
+    const UINT32 vtfSize = (UINT32)model->dataSize(lastVtf);
     addressDiff = 0xFFFFFFFFULL - model->base(lastVtf) - vtfSize + 1;
     
     // Parse reset vector data
@@ -3455,6 +3829,11 @@ USTATUS FfsParser::performSecondPass(const UModelIndex & index)
     // Find and parse FIT
     fitParser->parseFit(index);
     
+    // Protected ranges can cover contents of lazily decompressed sections, and the DXE core used for them can be there as well,
+    // so parsing falls back to eager mode once there are ranges to check
+    if (lazyDecompression && !protectedRanges.empty())
+        model->fetchAll(index);
+    
     // Check protected ranges
     checkProtectedRanges(index);
     
@@ -3466,6 +3845,8 @@ USTATUS FfsParser::performSecondPass(const UModelIndex & index)
 
 USTATUS FfsParser::parseResetVectorData()
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Sanity check
     if (!lastVtf.isValid())
         return U_SUCCESS;
@@ -3510,11 +3891,10 @@ USTATUS FfsParser::checkTeImageBase(const UModelIndex & index)
         UINT32 originalImageBase = 0;
         UINT32 adjustedImageBase = 0;
         UINT8  imageBaseType = EFI_IMAGE_TE_BASE_OTHER;
-        if (model->hasEmptyParsingData(index) == false) {
-            UByteArray data = model->parsingData(index);
-            const TE_IMAGE_SECTION_PARSING_DATA* pdata = (const TE_IMAGE_SECTION_PARSING_DATA*)data.constData();
-            originalImageBase = readUnaligned(pdata).originalImageBase;
-            adjustedImageBase = readUnaligned(pdata).adjustedImageBase;
+        const TE_IMAGE_SECTION_PARSING_DATA* tdata = model->teImageSectionParsingData(index);
+        if (tdata) {
+            originalImageBase = tdata->originalImageBase;
+            adjustedImageBase = tdata->adjustedImageBase;
         }
         
         if (originalImageBase != 0 || adjustedImageBase != 0) {
@@ -3552,7 +3932,7 @@ USTATUS FfsParser::checkTeImageBase(const UModelIndex & index)
             pdata.imageBaseType = imageBaseType;
             pdata.originalImageBase = originalImageBase;
             pdata.adjustedImageBase = adjustedImageBase;
-            model->setParsingData(index, UByteArray((const char*)&pdata, sizeof(pdata)));
+            model->setParsingData(index, pdata);
         }
     }
     
@@ -3570,28 +3950,8 @@ USTATUS FfsParser::addInfoRecursive(const UModelIndex & index)
     if (!index.isValid())
         return U_INVALID_PARAMETER;
     
-    // Add offset
-    model->addInfo(index, usprintf("Offset: %Xh\n", model->offset(index)), false);
-    
-    // Add current base if the element is not compressed
-    // or it's compressed, but its parent isn't
-    if ((!model->compressed(index)) || (index.parent().isValid() && !model->compressed(index.parent()))) {
-        // Add physical address of the whole item or its header and data portions separately
-        UINT64 address = addressDiff + model->base(index);
-        if (address <= 0xFFFFFFFFUL) {
-            UINT32 headerSize = (UINT32)model->header(index).size();
-            if (headerSize) {
-                model->addInfo(index, usprintf("Data address: %08Xh\n", (UINT32)address + headerSize),false);
-                model->addInfo(index, usprintf("Header address: %08Xh\n", (UINT32)address), false);
-            }
-            else {
-                model->addInfo(index, usprintf("Address: %08Xh\n", (UINT32)address), false);
-            }
-        }
-        // Add base
-        model->addInfo(index, usprintf("Base: %Xh\n", model->base(index)), false);
-    }
-    model->addInfo(index, usprintf("Fixed: %s\n", model->fixed(index) ? "Yes" : "No"), false);
+    // Offset, address, base and fixed state are generated from item fields on request
+    model->setLocationInfo(index, true);
     
     // Process child items
     for (int i = 0; i < model->rowCount(index); i++) {
@@ -3611,8 +3971,11 @@ USTATUS FfsParser::checkProtectedRanges(const UModelIndex & index)
     // so mid() here doesn't throw anything for UEFITool, just returns ranges with all zeroes
     // UByteArray (non-Qt builds) throws an exception that needs to be caught every time or the tools will crash.
     
+    // Ranges are marked together once all of them are processed
+    std::vector<PROTECTED_RANGE> markedRanges;
+    
     // Calculate digest for BG-protected ranges
-    UByteArray protectedParts;
+    std::vector<UByteArray> protectedParts;
     bool bgProtectedRangeFound = false;
     try {
         for (UINT32 i = 0; i < (UINT32)protectedRanges.size(); i++) {
@@ -3623,8 +3986,8 @@ USTATUS FfsParser::checkProtectedRanges(const UModelIndex & index)
                 } else {
                     msg(usprintf("%s: suspicious protected range offset", __FUNCTION__), index);
                 }
-                protectedParts += openedImage.mid(protectedRanges[i].Offset, protectedRanges[i].Size);
-                markProtectedRangeRecursive(index, protectedRanges[i]);
+                protectedParts.push_back(openedImage.mid(protectedRanges[i].Offset, protectedRanges[i].Size));
+                markedRanges.push_back(protectedRanges[i]);
             }
         }
     } catch (...) {
@@ -3632,44 +3995,29 @@ USTATUS FfsParser::checkProtectedRanges(const UModelIndex & index)
     }
     
     if (bgProtectedRangeFound) {
-        UINT8 digest[SHA512_HASH_SIZE] = {};
-        UString digestString;
+        // All digests are calculated in a single pass over protected parts
+        MultiDigest digests(DIGEST_ALGORITHM_MASK_ALL);
+        calculateProtectedRangeDigests(protectedParts, digests);
+        
+        const struct {
+            DigestAlgorithm algorithm;
+            const char* name;
+        } ibbDigestNames[] = {
+            { DigestSha1, "SHA1" },
+            { DigestSha256, "SHA256" },
+            { DigestSha384, "SHA384" },
+            { DigestSha512, "SHA512" },
+            { DigestSm3, "SM3" },
+        };
         UString ibbDigests;
-        // SHA1
-        digestString = "";
-        sha1(protectedParts.constData(), protectedParts.size(), digest);
-        for (UINT8 i = 0; i < SHA1_HASH_SIZE; i++) {
-            digestString += usprintf("%02X", digest[i]);
-        }
-        ibbDigests += UString("Computed IBB Hash (SHA1): ") + digestString + "\n";
-        // SHA256
-        digestString = "";
-        sha256(protectedParts.constData(), protectedParts.size(), digest);
-        for (UINT8 i = 0; i < SHA256_HASH_SIZE; i++) {
-            digestString += usprintf("%02X", digest[i]);
-        }
-        ibbDigests += UString("Computed IBB Hash (SHA256): ") + digestString + "\n";
-        // SHA384
-        digestString = "";
-        sha384(protectedParts.constData(), protectedParts.size(), digest);
-        for (UINT8 i = 0; i < SHA384_HASH_SIZE; i++) {
-            digestString += usprintf("%02X", digest[i]);
-        }
-        ibbDigests += UString("Computed IBB Hash (SHA384): ") + digestString + "\n";
-        // SHA512
-        digestString = "";
-        sha512(protectedParts.constData(), protectedParts.size(), digest);
-        for (UINT8 i = 0; i < SHA512_HASH_SIZE; i++) {
-            digestString += usprintf("%02X", digest[i]);
-        }
-        ibbDigests += UString("Computed IBB Hash (SHA512): ") + digestString + "\n";
-        // SM3
-        digestString = "";
-        sm3(protectedParts.constData(), protectedParts.size(), digest);
-        for (UINT8 i = 0; i < SM3_HASH_SIZE; i++) {
-            digestString += usprintf("%02X", digest[i]);
-        }
-        ibbDigests += UString("Computed IBB Hash (SM3): ") + digestString + "\n";
+        for (size_t i = 0; i < sizeof(ibbDigestNames) / sizeof(ibbDigestNames[0]); i++) {
+            UByteArray digest = digests.digest(ibbDigestNames[i].algorithm);
+            UString digestString;
+            for (int j = 0; j < digest.size(); j++) {
+                digestString += usprintf("%02X", (UINT8)digest.at(j));
+            }
+            ibbDigests += usprintf("Computed IBB Hash (%s): ", ibbDigestNames[i].name) + digestString + "\n";
+        }
         
         securityInfo += ibbDigests + "\n";
     }
@@ -3689,32 +4037,12 @@ USTATUS FfsParser::checkProtectedRanges(const UModelIndex & index)
                 else {
                     try {
                         protectedRanges[i].Offset = model->base(dxeRootVolumeIndex);
-                        protectedRanges[i].Size = (UINT32)(model->header(dxeRootVolumeIndex).size() + model->body(dxeRootVolumeIndex).size() + model->tail(dxeRootVolumeIndex).size());
-                        protectedParts = openedImage.mid(protectedRanges[i].Offset, protectedRanges[i].Size);
+                        protectedRanges[i].Size = (UINT32)model->dataSize(dxeRootVolumeIndex);
+                        protectedParts.assign(1, openedImage.mid(protectedRanges[i].Offset, protectedRanges[i].Size));
                         
                         // Calculate the hash
                         UByteArray digest(SHA512_HASH_SIZE, '\x00');
-                        if (protectedRanges[i].AlgorithmId == TCG_HASH_ALGORITHM_ID_SHA1) {
-                            sha1(protectedParts.constData(), protectedParts.size(), digest.data());
-                            digest = digest.left(SHA1_HASH_SIZE);
-                        }
-                        else if (protectedRanges[i].AlgorithmId == TCG_HASH_ALGORITHM_ID_SHA256) {
-                            sha256(protectedParts.constData(), protectedParts.size(), digest.data());
-                            digest = digest.left(SHA256_HASH_SIZE);
-                        }
-                        else if (protectedRanges[i].AlgorithmId == TCG_HASH_ALGORITHM_ID_SHA384) {
-                            sha384(protectedParts.constData(), protectedParts.size(), digest.data());
-                            digest = digest.left(SHA384_HASH_SIZE);
-                        }
-                        else if (protectedRanges[i].AlgorithmId == TCG_HASH_ALGORITHM_ID_SHA512) {
-                            sha512(protectedParts.constData(), protectedParts.size(), digest.data());
-                            digest = digest.left(SHA512_HASH_SIZE);
-                        }
-                        else if (protectedRanges[i].AlgorithmId == TCG_HASH_ALGORITHM_ID_SM3) {
-                            sm3(protectedParts.constData(), protectedParts.size(), digest.data());
-                            digest = digest.left(SM3_HASH_SIZE);
-                        }
-                        else {
+                        if (!calculateProtectedRangeDigest(protectedRanges[i].AlgorithmId, protectedParts, digest)) {
                             msg(usprintf("%s: post-IBB protected range [%Xh:%Xh] uses unknown hash algorithm %04Xh", __FUNCTION__,
                                          protectedRanges[i].Offset, protectedRanges[i].Offset + protectedRanges[i].Size, protectedRanges[i].AlgorithmId),
                                 model->findByBase(protectedRanges[i].Offset));
@@ -3727,7 +4055,7 @@ USTATUS FfsParser::checkProtectedRanges(const UModelIndex & index)
                                 model->findByBase(protectedRanges[i].Offset));
                         }
                         
-                        markProtectedRangeRecursive(index, protectedRanges[i]);
+                        markedRanges.push_back(protectedRanges[i]);
                     }
                     catch(...) {
                         // Do nothing, this range is likely not found in the image
@@ -3748,10 +4076,10 @@ USTATUS FfsParser::checkProtectedRanges(const UModelIndex & index)
                 else {
                     try {
                         protectedRanges[i].Offset = model->base(dxeRootVolumeIndex);
-                        protectedParts = openedImage.mid(protectedRanges[i].Offset, protectedRanges[i].Size);
+                        protectedParts.assign(1, openedImage.mid(protectedRanges[i].Offset, protectedRanges[i].Size));
 
-                        UByteArray digest(SHA256_HASH_SIZE, '\x00');
-                        sha256(protectedParts.constData(), protectedParts.size(), digest.data());
+                        UByteArray digest;
+                        calculateProtectedRangeDigest(TCG_HASH_ALGORITHM_ID_SHA256, protectedParts, digest);
 
                         if (digest != protectedRanges[i].Hash) {
                             msg(usprintf("%s: AMI v1 protected range [%Xh:%Xh] hash mismatch, opened image may refuse to boot", __FUNCTION__,
@@ -3759,7 +4087,7 @@ USTATUS FfsParser::checkProtectedRanges(const UModelIndex & index)
                                 model->findByBase(protectedRanges[i].Offset));
                         }
 
-                        markProtectedRangeRecursive(index, protectedRanges[i]);
+                        markedRanges.push_back(protectedRanges[i]);
                     }
                     catch (...) {
                         // Do nothing, this range is likely not found in the image
@@ -3770,10 +4098,10 @@ USTATUS FfsParser::checkProtectedRanges(const UModelIndex & index)
         else if (protectedRanges[i].Type == PROTECTED_RANGE_VENDOR_HASH_AMI_V2) {
             try {
                 protectedRanges[i].Offset -= (UINT32)addressDiff;
-                protectedParts = openedImage.mid(protectedRanges[i].Offset, protectedRanges[i].Size);
+                protectedParts.assign(1, openedImage.mid(protectedRanges[i].Offset, protectedRanges[i].Size));
                 
-                UByteArray digest(SHA256_HASH_SIZE, '\x00');
-                sha256(protectedParts.constData(), protectedParts.size(), digest.data());
+                UByteArray digest;
+                calculateProtectedRangeDigest(TCG_HASH_ALGORITHM_ID_SHA256, protectedParts, digest);
                 
                 if (digest != protectedRanges[i].Hash) {
                     msg(usprintf("%s: AMI v2 protected range [%Xh:%Xh] hash mismatch, opened image may refuse to boot", __FUNCTION__,
@@ -3781,7 +4109,7 @@ USTATUS FfsParser::checkProtectedRanges(const UModelIndex & index)
                         model->findByBase(protectedRanges[i].Offset));
                 }
                 
-                markProtectedRangeRecursive(index, protectedRanges[i]);
+                markedRanges.push_back(protectedRanges[i]);
             }
             catch(...) {
                 // Do nothing, this range is likely not found in the image
@@ -3790,26 +4118,26 @@ USTATUS FfsParser::checkProtectedRanges(const UModelIndex & index)
         else if (protectedRanges[i].Type == PROTECTED_RANGE_VENDOR_HASH_AMI_V3) {
             try {
                 protectedRanges[i].Offset -= (UINT32)addressDiff;
-                protectedParts = openedImage.mid(protectedRanges[i].Offset, protectedRanges[i].Size);
-                markProtectedRangeRecursive(index, protectedRanges[i]);
+                protectedParts.assign(1, openedImage.mid(protectedRanges[i].Offset, protectedRanges[i].Size));
+                markedRanges.push_back(protectedRanges[i]);
 
                 // Process second range
                 if (i + 1 < (UINT32)protectedRanges.size() && protectedRanges[i + 1].Type == PROTECTED_RANGE_VENDOR_HASH_AMI_V3) {
                     protectedRanges[i + 1].Offset -= (UINT32)addressDiff;
-                    protectedParts += openedImage.mid(protectedRanges[i + 1].Offset, protectedRanges[i + 1].Size);
-                    markProtectedRangeRecursive(index, protectedRanges[i + 1]);
+                    protectedParts.push_back(openedImage.mid(protectedRanges[i + 1].Offset, protectedRanges[i + 1].Size));
+                    markedRanges.push_back(protectedRanges[i + 1]);
 
                     // Process third range
                     if (i + 2 < (UINT32)protectedRanges.size() && protectedRanges[i + 2].Type == PROTECTED_RANGE_VENDOR_HASH_AMI_V3) {
                         protectedRanges[i + 2].Offset -= (UINT32)addressDiff;
-                        protectedParts += openedImage.mid(protectedRanges[i + 2].Offset, protectedRanges[i + 2].Size);
-                        markProtectedRangeRecursive(index, protectedRanges[i + 2]);
+                        protectedParts.push_back(openedImage.mid(protectedRanges[i + 2].Offset, protectedRanges[i + 2].Size));
+                        markedRanges.push_back(protectedRanges[i + 2]);
 
                         // Process fourth range
                         if (i + 3 < (UINT32)protectedRanges.size() && protectedRanges[i + 3].Type == PROTECTED_RANGE_VENDOR_HASH_AMI_V3) {
                             protectedRanges[i + 3].Offset -= (UINT32)addressDiff;
-                            protectedParts += openedImage.mid(protectedRanges[i + 3].Offset, protectedRanges[i + 3].Size);
-                            markProtectedRangeRecursive(index, protectedRanges[i + 3]);
+                            protectedParts.push_back(openedImage.mid(protectedRanges[i + 3].Offset, protectedRanges[i + 3].Size));
+                            markedRanges.push_back(protectedRanges[i + 3]);
                             i += 3; // Skip 3 already processed ranges
                         }
                         else {
@@ -3821,8 +4149,8 @@ USTATUS FfsParser::checkProtectedRanges(const UModelIndex & index)
                     }
                 }
 
-                UByteArray digest(SHA256_HASH_SIZE, '\x00');
-                sha256(protectedParts.constData(), protectedParts.size(), digest.data());
+                UByteArray digest;
+                calculateProtectedRangeDigest(TCG_HASH_ALGORITHM_ID_SHA256, protectedParts, digest);
                 if (digest != protectedRanges[i].Hash) {
                     msg(usprintf("%s: AMI v3 protected ranges hash mismatch, opened image may refuse to boot", __FUNCTION__));
                 }
@@ -3834,10 +4162,10 @@ USTATUS FfsParser::checkProtectedRanges(const UModelIndex & index)
         else if (protectedRanges[i].Type == PROTECTED_RANGE_VENDOR_HASH_PHOENIX) {
             try {
                 protectedRanges[i].Offset += (UINT32)protectedRegionsBase;
-                protectedParts = openedImage.mid(protectedRanges[i].Offset, protectedRanges[i].Size);
+                protectedParts.assign(1, openedImage.mid(protectedRanges[i].Offset, protectedRanges[i].Size));
                 
-                UByteArray digest(SHA256_HASH_SIZE, '\x00');
-                sha256(protectedParts.constData(), protectedParts.size(), digest.data());
+                UByteArray digest;
+                calculateProtectedRangeDigest(TCG_HASH_ALGORITHM_ID_SHA256, protectedParts, digest);
                 
                 if (digest != protectedRanges[i].Hash) {
                     msg(usprintf("%s: Phoenix protected range [%Xh:%Xh] hash mismatch, opened image may refuse to boot", __FUNCTION__,
@@ -3845,7 +4173,7 @@ USTATUS FfsParser::checkProtectedRanges(const UModelIndex & index)
                         model->findByBase(protectedRanges[i].Offset));
                 }
                 
-                markProtectedRangeRecursive(index, protectedRanges[i]);
+                markedRanges.push_back(protectedRanges[i]);
             }
             catch(...) {
                 // Do nothing, this range is likely not found in the image
@@ -3854,31 +4182,11 @@ USTATUS FfsParser::checkProtectedRanges(const UModelIndex & index)
         else if (protectedRanges[i].Type == PROTECTED_RANGE_VENDOR_HASH_MICROSOFT_PMDA) {
             try {
                 protectedRanges[i].Offset -= (UINT32)addressDiff;
-                protectedParts = openedImage.mid(protectedRanges[i].Offset, protectedRanges[i].Size);
+                protectedParts.assign(1, openedImage.mid(protectedRanges[i].Offset, protectedRanges[i].Size));
                 
                 // Calculate the hash
                 UByteArray digest(SHA512_HASH_SIZE, '\x00');
-                if (protectedRanges[i].AlgorithmId == TCG_HASH_ALGORITHM_ID_SHA1) {
-                    sha1(protectedParts.constData(), protectedParts.size(), digest.data());
-                    digest = digest.left(SHA1_HASH_SIZE);
-                }
-                else if (protectedRanges[i].AlgorithmId == TCG_HASH_ALGORITHM_ID_SHA256) {
-                    sha256(protectedParts.constData(), protectedParts.size(), digest.data());
-                    digest = digest.left(SHA256_HASH_SIZE);
-                }
-                else if (protectedRanges[i].AlgorithmId == TCG_HASH_ALGORITHM_ID_SHA384) {
-                    sha384(protectedParts.constData(), protectedParts.size(), digest.data());
-                    digest = digest.left(SHA384_HASH_SIZE);
-                }
-                else if (protectedRanges[i].AlgorithmId == TCG_HASH_ALGORITHM_ID_SHA512) {
-                    sha512(protectedParts.constData(), protectedParts.size(), digest.data());
-                    digest = digest.left(SHA512_HASH_SIZE);
-                }
-                else if (protectedRanges[i].AlgorithmId == TCG_HASH_ALGORITHM_ID_SM3) {
-                    sm3(protectedParts.constData(), protectedParts.size(), digest.data());
-                    digest = digest.left(SM3_HASH_SIZE);
-                }
-                else {
+                if (!calculateProtectedRangeDigest(protectedRanges[i].AlgorithmId, protectedParts, digest)) {
                     msg(usprintf("%s: Microsoft PMDA protected range [%Xh:%Xh] uses unknown hash algorithm %04Xh", __FUNCTION__,
                                  protectedRanges[i].Offset, protectedRanges[i].Offset + protectedRanges[i].Size, protectedRanges[i].AlgorithmId),
                         model->findByBase(protectedRanges[i].Offset));
@@ -3891,7 +4199,7 @@ USTATUS FfsParser::checkProtectedRanges(const UModelIndex & index)
                         model->findByBase(protectedRanges[i].Offset));
                 }
                 
-                markProtectedRangeRecursive(index, protectedRanges[i]);
+                markedRanges.push_back(protectedRanges[i]);
             }
             catch(...) {
                 // Do nothing, this range is likely not found in the image
@@ -3900,10 +4208,10 @@ USTATUS FfsParser::checkProtectedRanges(const UModelIndex & index)
         else if (protectedRanges[i].Type == PROTECTED_RANGE_VENDOR_HASH_INSYDE) {
             try {
                 protectedRanges[i].Offset -= (UINT32)addressDiff;
-                protectedParts = openedImage.mid(protectedRanges[i].Offset, protectedRanges[i].Size);
+                protectedParts.assign(1, openedImage.mid(protectedRanges[i].Offset, protectedRanges[i].Size));
                 
-                UByteArray digest(SHA256_HASH_SIZE, '\x00');
-                sha256(protectedParts.constData(), protectedParts.size(), digest.data());
+                UByteArray digest;
+                calculateProtectedRangeDigest(TCG_HASH_ALGORITHM_ID_SHA256, protectedParts, digest);
                 
                 if (digest != protectedRanges[i].Hash) {
                     msg(usprintf("%s: Insyde protected range [%Xh:%Xh] hash mismatch, opened image may refuse to boot", __FUNCTION__,
@@ -3911,7 +4219,7 @@ USTATUS FfsParser::checkProtectedRanges(const UModelIndex & index)
                         model->findByBase(protectedRanges[i].Offset));
                 }
                 
-                markProtectedRangeRecursive(index, protectedRanges[i]);
+                markedRanges.push_back(protectedRanges[i]);
             }
             catch(...) {
                 // Do nothing, this range is likely not found in the image
@@ -3919,48 +4227,143 @@ USTATUS FfsParser::checkProtectedRanges(const UModelIndex & index)
         }
     }
     
+    markProtectedRanges(index, markedRanges);
+    
     return U_SUCCESS;
 }
 
-USTATUS FfsParser::markProtectedRangeRecursive(const UModelIndex & index, const PROTECTED_RANGE & range)
+USTATUS FfsParser::markProtectedRanges(const UModelIndex & index, const std::vector<PROTECTED_RANGE> & ranges)
 {
-    if (!index.isValid())
+    if (!index.isValid() || ranges.empty())
         return U_SUCCESS;
     
-    // Mark compressed items
-    UModelIndex parentIndex = model->parent(index);
-    if (parentIndex.isValid() && model->compressed(index) && model->compressed(parentIndex)) {
-        model->setMarking(index, model->marking(parentIndex));
+    // Boundaries of all ranges split the address space into segments
+    // Empty ranges and ranges ending above 4 GiB never overlap any item
+    std::vector<UINT64> points;
+    for (size_t i = 0; i < ranges.size(); i++) {
+        UINT64 end = (UINT64)ranges[i].Offset + ranges[i].Size;
+        if (ranges[i].Size != 0 && end <= 0xFFFFFFFFULL) {
+            points.push_back(ranges[i].Offset);
+            points.push_back(end);
+        }
+    }
+    std::sort(points.begin(), points.end());
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+    const size_t segments = points.empty() ? 0 : points.size() - 1;
+    
+    // Each segment is owned by the last range covering it, ranges are assigned from the last one
+    // Already owned segments are skipped by following links to the next unowned one
+    std::vector<INT32> owner(segments, -1);
+    std::vector<size_t> nextFree(segments + 1);
+    for (size_t j = 0; j <= segments; j++)
+        nextFree[j] = j;
+    for (size_t i = ranges.size(); i-- > 0;) {
+        UINT64 end = (UINT64)ranges[i].Offset + ranges[i].Size;
+        if (ranges[i].Size == 0 || end > 0xFFFFFFFFULL)
+            continue;
+        size_t first = std::lower_bound(points.begin(), points.end(), (UINT64)ranges[i].Offset) - points.begin();
+        size_t last = std::lower_bound(points.begin(), points.end(), end) - points.begin();
+        for (size_t j = first;;) {
+            while (nextFree[j] != j) {
+                nextFree[j] = nextFree[nextFree[j]];
+                j = nextFree[j];
+            }
+            if (j >= last)
+                break;
+            owner[j] = (INT32)i;
+            nextFree[j] = j + 1;
+        }
     }
-    // Mark normal items
-    else {
-        UINT32 currentOffset = model->base(index);
-        UINT32 currentSize = (UINT32)(model->header(index).size() + model->body(index).size() + model->tail(index).size());
+    
+    // Sparse table of owners, giving the last range overlapping any span of segments
+    std::vector<std::vector<INT32> > lastOwner(1, owner);
+    for (size_t width = 2; width <= segments; width *= 2) {
+        const std::vector<INT32> & previous = lastOwner.back();
+        std::vector<INT32> current(segments - width + 1);
+        for (size_t j = 0; j < current.size(); j++)
+            current[j] = std::max(previous[j], previous[j + width / 2]);
+        lastOwner.push_back(current);
+    }
+    
+    // Single pass over all items, parents are marked before their children
+    std::vector<UModelIndex> stack(1, index);
+    while (!stack.empty()) {
+        UModelIndex current = stack.back();
+        stack.pop_back();
+        for (int i = 0; i < model->rowCount(current); i++) {
+            stack.push_back(current.model()->index(i, 0, current));
+        }
         
-        if (std::min(currentOffset + currentSize, range.Offset + range.Size) > std::max(currentOffset, range.Offset)) {
-            if (range.Offset <= currentOffset && currentOffset + currentSize <= range.Offset + range.Size) { // Mark as fully in range
-                if (range.Type == PROTECTED_RANGE_INTEL_BOOT_GUARD_IBB) {
-                    model->setMarking(index, BootGuardMarking::BootGuardFullyInRange);
-                }
-                else {
-                    model->setMarking(index, BootGuardMarking::VendorFullyInRange);
-                }
+        // Mark compressed items
+        UModelIndex parentIndex = model->parent(current);
+        if (parentIndex.isValid() && !model->hasMeaningfulBase(current)) {
+            model->setMarking(current, model->marking(parentIndex));
+            continue;
+        }
+        
+        // Mark normal items
+        UINT64 currentOffset = model->base(current);
+        UINT64 currentEnd = currentOffset + model->dataSize(current);
+        if (segments == 0 || currentEnd == currentOffset || currentEnd > 0xFFFFFFFFULL)
+            continue;
+        size_t first = std::upper_bound(points.begin(), points.end(), currentOffset) - points.begin();
+        size_t last = std::lower_bound(points.begin(), points.end(), currentEnd) - points.begin();
+        first = first > 0 ? first - 1 : 0;
+        last = std::min(last, segments);
+        if (first >= last)
+            continue;
+        size_t level = 0;
+        while (((size_t)2 << level) <= last - first)
+            level++;
+        INT32 rangeIndex = std::max(lastOwner[level][first], lastOwner[level][last - ((size_t)1 << level)]);
+        if (rangeIndex < 0)
+            continue;
+        
+        const PROTECTED_RANGE & range = ranges[rangeIndex];
+        if (range.Offset <= currentOffset && currentEnd <= (UINT64)range.Offset + range.Size) { // Mark as fully in range
+            if (range.Type == PROTECTED_RANGE_INTEL_BOOT_GUARD_IBB) {
+                model->setMarking(current, BootGuardMarking::BootGuardFullyInRange);
             }
-            else { // Mark as partially in range
-                model->setMarking(index, BootGuardMarking::PartiallyInRange);
+            else {
+                model->setMarking(current, BootGuardMarking::VendorFullyInRange);
             }
         }
-    }
-    
-    for (int i = 0; i < model->rowCount(index); i++) {
-        markProtectedRangeRecursive(index.model()->index(i, 0, index), range);
+        else { // Mark as partially in range
+            model->setMarking(current, BootGuardMarking::PartiallyInRange);
+        }
     }
     
     return U_SUCCESS;
 }
 
+void FfsParser::calculateProtectedRangeDigests(const std::vector<UByteArray> & protectedParts, MultiDigest & digests)
+{
+    ParserStatsTimer hashingTimer(stats, stats.protectedRangesHashing);
+    digests.update(protectedParts, taskPool.get());
+}
+
+bool FfsParser::calculateProtectedRangeDigest(const UINT16 algorithmId, const std::vector<UByteArray> & protectedParts, UByteArray & digest)
+{
+    DigestAlgorithm algorithm;
+    switch (algorithmId) {
+        case TCG_HASH_ALGORITHM_ID_SHA1:   algorithm = DigestSha1; break;
+        case TCG_HASH_ALGORITHM_ID_SHA256: algorithm = DigestSha256; break;
+        case TCG_HASH_ALGORITHM_ID_SHA384: algorithm = DigestSha384; break;
+        case TCG_HASH_ALGORITHM_ID_SHA512: algorithm = DigestSha512; break;
+        case TCG_HASH_ALGORITHM_ID_SM3:    algorithm = DigestSm3; break;
+        default: return false;
+    }
+    
+    MultiDigest digests(DIGEST_ALGORITHM_MASK(algorithm));
+    calculateProtectedRangeDigests(protectedParts, digests);
+    digest = digests.digest(algorithm);
+    return true;
+}
+
 USTATUS FfsParser::parseVendorHashFile(const UByteArray & fileGuid, const UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Check sanity
     if (!index.isValid()) {
         return U_INVALID_PARAMETER;
@@ -4137,8 +4540,10 @@ USTATUS FfsParser::parseVendorHashFile(const UByteArray & fileGuid, const UModel
 
 USTATUS FfsParser::parseMicrocodeVolumeBody(const UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     const UINT32 headerSize = (UINT32)model->header(index).size();
-    const UINT32 bodySize = (UINT32)model->body(index).size();
+    const UINT32 bodySize = model->bodySize(index);
     UINT32 offset = 0;
     USTATUS result = U_SUCCESS;
     
@@ -4148,7 +4553,7 @@ USTATUS FfsParser::parseMicrocodeVolumeBody(const UModelIndex & index)
         UByteArray ucode = model->body(index).mid(offset);
         
         // Check for empty area
-        if (ucode.size() == ucode.count('\xFF') || ucode.size() == ucode.count('\x00')) {
+        if (getPaddingType(ucode) != Subtypes::DataPadding) {
             result = U_INVALID_MICROCODE;
         }
         else {
@@ -4160,7 +4565,7 @@ USTATUS FfsParser::parseMicrocodeVolumeBody(const UModelIndex & index)
             if (offset < bodySize) {
                 // Get info
                 UString name = UString("Padding");
-                UString info = usprintf("Full size: %Xh (%u)", (UINT32)ucode.size(), (UINT32)ucode.size());
+                ItemInfoFormatter info = fullSizeInfo((UINT32)ucode.size());
                 
                 // Add tree item
                 model->addItem(headerSize + offset, Types::Padding, getPaddingType(ucode), name, UString(), info, UByteArray(), ucode, UByteArray(), Fixed, index);
@@ -4169,7 +4574,7 @@ USTATUS FfsParser::parseMicrocodeVolumeBody(const UModelIndex & index)
         }
         
         // Get to next candidate
-        offset += model->header(currentMicrocode).size() + model->body(currentMicrocode).size() + model->tail(currentMicrocode).size();
+        offset += model->dataSize(currentMicrocode);
         if (offset >= bodySize)
             break;
     }
@@ -4178,6 +4583,8 @@ USTATUS FfsParser::parseMicrocodeVolumeBody(const UModelIndex & index)
 
 USTATUS FfsParser::parseIntelMicrocodeHeader(const UByteArray & microcode, const UINT32 localOffset, const UModelIndex & parent, UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // We have enough data to fit the header
     if ((UINT32)microcode.size() <  sizeof(INTEL_MICROCODE_HEADER)) {
         return U_INVALID_MICROCODE;
@@ -4281,20 +4688,24 @@ USTATUS FfsParser::parseIntelMicrocodeHeader(const UByteArray & microcode, const
     
     // Add info
     UString name("Intel microcode");
-    UString info = usprintf("Full size: %Xh (%u)\nHeader size: 0h (0u)\nBody size: %Xh (%u)\nTail size: 0h (0u)\n"
-                            "Date: %02X.%02X.%04x\nCPU signature: %08Xh\nRevision: %08Xh\nMinimal update revision: %08Xh\nCPU platform Id: %08Xh\nChecksum: %08Xh, ",
-                            (UINT32)microcodeBinary.size(), (UINT32)microcodeBinary.size(),
-                            (UINT32)microcodeBinary.size(), (UINT32)microcodeBinary.size(),
-                            ucodeHeader->DateDay,
-                            ucodeHeader->DateMonth,
-                            ucodeHeader->DateYear,
-                            ucodeHeader->ProcessorSignature,
-                            ucodeHeader->UpdateRevision,
-                            ucodeHeader->UpdateRevisionMin,
-                            ucodeHeader->PlatformIds,
-                            ucodeHeader->Checksum)
-    + (ucodeHeader->Checksum == calculated ? UString("valid") : usprintf("invalid, should be %08Xh", calculated))
-    + extendedHeaderInfo;
+    const INTEL_MICROCODE_HEADER infoHeader = *ucodeHeader;
+    const UINT32 binarySize = (UINT32)microcodeBinary.size();
+    ItemInfoFormatter info = [infoHeader, binarySize, calculated, extendedHeaderInfo]() {
+        return usprintf("Full size: %Xh (%u)\nHeader size: 0h (0u)\nBody size: %Xh (%u)\nTail size: 0h (0u)\n"
+                        "Date: %02X.%02X.%04x\nCPU signature: %08Xh\nRevision: %08Xh\nMinimal update revision: %08Xh\nCPU platform Id: %08Xh\nChecksum: %08Xh, ",
+                        binarySize, binarySize,
+                        binarySize, binarySize,
+                        infoHeader.DateDay,
+                        infoHeader.DateMonth,
+                        infoHeader.DateYear,
+                        infoHeader.ProcessorSignature,
+                        infoHeader.UpdateRevision,
+                        infoHeader.UpdateRevisionMin,
+                        infoHeader.PlatformIds,
+                        infoHeader.Checksum)
+        + (infoHeader.Checksum == calculated ? UString("valid") : usprintf("invalid, should be %08Xh", calculated))
+        + extendedHeaderInfo;
+    };
     
     // Add tree item
     index = model->addItem(localOffset, Types::Microcode, Subtypes::IntelMicrocode, name, UString(), info, UByteArray(), microcodeBinary, UByteArray(), Fixed, parent);
@@ -4309,6 +4720,8 @@ USTATUS FfsParser::parseIntelMicrocodeHeader(const UByteArray & microcode, const
 
 USTATUS FfsParser::parseBpdtRegion(const UByteArray & region, const UINT32 localOffset, const UINT32 sbpdtOffsetFixup, const UModelIndex & parent, UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     UINT32 regionSize = (UINT32)region.size();
     
     // Check region size
@@ -4333,17 +4746,21 @@ USTATUS FfsParser::parseBpdtRegion(const UByteArray & region, const UINT32 local
     UByteArray body = region.mid(sizeof(BPDT_HEADER), ptBodySize);
     
     UString name = UString("BPDT partition table");
-    UString info = usprintf("Full size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\n"
-                            "Number of entries: %u\nVersion: %02Xh\nRedundancyFlag: %Xh\n"
-                            "IFWI version: %Xh\nFITC version: %u.%u.%u.%u",
-                            ptSize, ptSize,
-                            (UINT32)header.size(), (UINT32)header.size(),
-                            ptBodySize, ptBodySize,
-                            ptHeader->NumEntries,
-                            ptHeader->HeaderVersion,
-                            ptHeader->RedundancyFlag,
-                            ptHeader->IfwiVersion,
-                            ptHeader->FitcMajor, ptHeader->FitcMinor, ptHeader->FitcHotfix, ptHeader->FitcBuild);
+    const BPDT_HEADER infoHeader = *ptHeader;
+    const UINT32 headerSize = (UINT32)header.size();
+    ItemInfoFormatter info = [infoHeader, ptSize, headerSize, ptBodySize]() {
+        return usprintf("Full size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\n"
+                        "Number of entries: %u\nVersion: %02Xh\nRedundancyFlag: %Xh\n"
+                        "IFWI version: %Xh\nFITC version: %u.%u.%u.%u",
+                        ptSize, ptSize,
+                        headerSize, headerSize,
+                        ptBodySize, ptBodySize,
+                        infoHeader.NumEntries,
+                        infoHeader.HeaderVersion,
+                        infoHeader.RedundancyFlag,
+                        infoHeader.IfwiVersion,
+                        infoHeader.FitcMajor, infoHeader.FitcMinor, infoHeader.FitcHotfix, infoHeader.FitcBuild);
+    };
     
     // Add tree item
     index = model->addItem(localOffset, Types::BpdtStore, 0, name, UString(), info, header, body, UByteArray(), Fixed, parent);
@@ -4361,15 +4778,18 @@ USTATUS FfsParser::parseBpdtRegion(const UByteArray & region, const UINT32 local
         
         // Get info
         name = bpdtEntryTypeToUString(ptEntry->Type);
-        info = usprintf("Full size: %Xh (%u)\nType: %Xh\nPartition offset: %Xh\nPartition length: %Xh",
-                        (UINT32)sizeof(BPDT_ENTRY), (UINT32)sizeof(BPDT_ENTRY),
-                        ptEntry->Type,
-                        ptEntry->Offset,
-                        ptEntry->Size) +
-        UString("\nSplit sub-partition first part: ") + (ptEntry->SplitSubPartitionFirstPart ? "Yes" : "No") +
-        UString("\nSplit sub-partition second part: ") + (ptEntry->SplitSubPartitionSecondPart ? "Yes" : "No") +
-        UString("\nCode sub-partition: ") + (ptEntry->CodeSubPartition ? "Yes" : "No") +
-        UString("\nUMA cacheable: ") + (ptEntry->UmaCacheable ? "Yes" : "No");
+        const BPDT_ENTRY infoEntry = *ptEntry;
+        info = [infoEntry]() {
+            return usprintf("Full size: %Xh (%u)\nType: %Xh\nPartition offset: %Xh\nPartition length: %Xh",
+                            (UINT32)sizeof(BPDT_ENTRY), (UINT32)sizeof(BPDT_ENTRY),
+                            infoEntry.Type,
+                            infoEntry.Offset,
+                            infoEntry.Size) +
+            UString("\nSplit sub-partition first part: ") + (infoEntry.SplitSubPartitionFirstPart ? "Yes" : "No") +
+            UString("\nSplit sub-partition second part: ") + (infoEntry.SplitSubPartitionSecondPart ? "Yes" : "No") +
+            UString("\nCode sub-partition: ") + (infoEntry.CodeSubPartition ? "Yes" : "No") +
+            UString("\nUMA cacheable: ") + (infoEntry.UmaCacheable ? "Yes" : "No");
+        };
         
         // Add tree item
         UModelIndex entryIndex = model->addItem(localOffset + offset, Types::BpdtEntry, 0, name, UString(), info, UByteArray(), UByteArray((const char*)ptEntry, sizeof(BPDT_ENTRY)), UByteArray(), Fixed, index);
@@ -4475,13 +4895,17 @@ make_partition_table_consistent:
             UByteArray partition = region.mid(partitions[i].ptEntry.Offset, partitions[i].ptEntry.Size);
             UByteArray signature = partition.left(sizeof(UINT32));
             
-            UString info = usprintf("Full size: %Xh (%u)\nType: %Xh",
-                                    (UINT32)partition.size(), (UINT32)partition.size(),
-                                    partitions[i].ptEntry.Type) +
-            UString("\nSplit sub-partition first part: ") + (partitions[i].ptEntry.SplitSubPartitionFirstPart ? "Yes" : "No") +
-            UString("\nSplit sub-partition second part: ") + (partitions[i].ptEntry.SplitSubPartitionSecondPart ? "Yes" : "No") +
-            UString("\nCode sub-partition: ") + (partitions[i].ptEntry.CodeSubPartition ? "Yes" : "No") +
-            UString("\nUMA cacheable: ") + (partitions[i].ptEntry.UmaCacheable ? "Yes" : "No");
+            const BPDT_ENTRY infoEntry = partitions[i].ptEntry;
+            const UINT32 partitionSize = (UINT32)partition.size();
+            ItemInfoFormatter info = [infoEntry, partitionSize]() {
+                return usprintf("Full size: %Xh (%u)\nType: %Xh",
+                                partitionSize, partitionSize,
+                                infoEntry.Type) +
+                UString("\nSplit sub-partition first part: ") + (infoEntry.SplitSubPartitionFirstPart ? "Yes" : "No") +
+                UString("\nSplit sub-partition second part: ") + (infoEntry.SplitSubPartitionSecondPart ? "Yes" : "No") +
+                UString("\nCode sub-partition: ") + (infoEntry.CodeSubPartition ? "Yes" : "No") +
+                UString("\nUMA cacheable: ") + (infoEntry.UmaCacheable ? "Yes" : "No");
+            };
             
             UString text = bpdtEntryTypeToUString(partitions[i].ptEntry.Type);
             
@@ -4511,8 +4935,7 @@ make_partition_table_consistent:
             
             // Get info
             name = UString("Padding");
-            info = usprintf("Full size: %Xh (%u)",
-                            (UINT32)padding.size(), (UINT32)padding.size());
+            info = fullSizeInfo((UINT32)padding.size());
             
             // Add tree item
             model->addItem(localOffset + partitions[i].ptEntry.Offset, Types::Padding, getPaddingType(padding), name, UString(), info, UByteArray(), padding, UByteArray(), Fixed, parent);
@@ -4526,8 +4949,7 @@ make_partition_table_consistent:
         
         // Get info
         name = UString("Padding");
-        info = usprintf("Full size: %Xh (%u)",
-                        (UINT32)padding.size(), (UINT32)padding.size());
+        info = fullSizeInfo((UINT32)padding.size());
         
         // Add tree item
         model->addItem(localOffset + partitions.back().ptEntry.Offset + partitions.back().ptEntry.Size, Types::Padding, getPaddingType(padding), name, UString(), info, UByteArray(), padding, UByteArray(), Fixed, parent);
@@ -4538,6 +4960,8 @@ make_partition_table_consistent:
 
 USTATUS FfsParser::parseCpdRegion(const UByteArray & region, const UINT32 localOffset, const UModelIndex & parent, UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     // Check directory size
     if ((UINT32)region.size() < sizeof(CPD_REV1_HEADER)) {
         msg(usprintf("%s: CPD too small to fit rev1 partition table header", __FUNCTION__), parent);
@@ -4573,14 +4997,17 @@ USTATUS FfsParser::parseCpdRegion(const UByteArray & region, const UINT32 localO
     UByteArray header = region.left(ptHeaderSize);
     UByteArray body = region.mid(ptHeaderSize, ptBodySize);
     UString name = usprintf("CPD partition table");
-    UString info = usprintf("Full size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\nNumber of entries: %u\n"
-                            "Header version: %u\nEntry version: %u",
-                            ptSize, ptSize,
-                            (UINT32)header.size(), (UINT32)header.size(),
-                            (UINT32)body.size(), (UINT32)body.size(),
-                            cpdHeader->NumEntries,
-                            cpdHeader->HeaderVersion,
-                            cpdHeader->EntryVersion);
+    const CPD_REV1_HEADER infoHeader = *cpdHeader;
+    ItemInfoFormatter info = [infoHeader, ptSize, ptHeaderSize, ptBodySize]() {
+        return usprintf("Full size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\nNumber of entries: %u\n"
+                        "Header version: %u\nEntry version: %u",
+                        ptSize, ptSize,
+                        ptHeaderSize, ptHeaderSize,
+                        ptBodySize, ptBodySize,
+                        infoHeader.NumEntries,
+                        infoHeader.HeaderVersion,
+                        infoHeader.EntryVersion);
+    };
     
     // Add tree item
     index = model->addItem(localOffset, Types::CpdStore, 0, name, UString(), info, header, body, UByteArray(), Fixed, parent);
@@ -4596,11 +5023,14 @@ USTATUS FfsParser::parseCpdRegion(const UByteArray & region, const UINT32 localO
         
         // Get info
         name = usprintf("%.12s", cpdEntry->EntryName);
-        info = usprintf("Full size: %Xh (%u)\nEntry offset: %Xh\nEntry length: %Xh\nHuffman compressed: ",
-                        (UINT32)entry.size(), (UINT32)entry.size(),
-                        cpdEntry->Offset.Offset,
-                        cpdEntry->Length)
-        + (cpdEntry->Offset.HuffmanCompressed ? "Yes" : "No");
+        const CPD_ENTRY infoEntry = *cpdEntry;
+        info = [infoEntry]() {
+            return usprintf("Full size: %Xh (%u)\nEntry offset: %Xh\nEntry length: %Xh\nHuffman compressed: ",
+                            (UINT32)sizeof(CPD_ENTRY), (UINT32)sizeof(CPD_ENTRY),
+                            infoEntry.Offset.Offset,
+                            infoEntry.Length)
+            + (infoEntry.Offset.HuffmanCompressed ? "Yes" : "No");
+        };
         
         // Add tree item
         UModelIndex entryIndex = model->addItem(offset, Types::CpdEntry, 0, name, UString(), info, UByteArray(), entry, UByteArray(), Fixed, index);
@@ -4625,8 +5055,7 @@ USTATUS FfsParser::parseCpdRegion(const UByteArray & region, const UINT32 localO
         
         // Get info
         name = UString("Padding");
-        info = usprintf("Full size: %Xh (%u)",
-                        (UINT32)partition.size(), (UINT32)partition.size());
+        info = fullSizeInfo((UINT32)partition.size());
         
         // Add tree item
         model->addItem(localOffset + ptSize, Types::Padding, getPaddingType(partition), name, UString(), info, UByteArray(), partition, UByteArray(), Fixed, parent);
@@ -4808,23 +5237,29 @@ make_partition_table_consistent:
                         UByteArray header = partition.left(manifestHeader->HeaderLength * sizeof(UINT32));
                         UByteArray body = partition.mid(manifestHeader->HeaderLength * sizeof(UINT32));
                         
-                        info = usprintf("Full size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)"
-                                        "\nHeader type: %u\nHeader length: %Xh (%u)\nHeader version: %Xh\nFlags: %08Xh\nVendor: %Xh\n"
-                                        "Date: %Xh\nSize: %Xh (%u)\nVersion: %u.%u.%u.%u\nSecurity version number: %u\nModulus size: %Xh (%u)\nExponent size: %Xh (%u)",
-                                        (UINT32)partition.size(), (UINT32)partition.size(),
-                                        (UINT32)header.size(), (UINT32)header.size(),
-                                        (UINT32)body.size(), (UINT32)body.size(),
-                                        manifestHeader->HeaderType,
-                                        manifestHeader->HeaderLength * (UINT32)sizeof(UINT32), manifestHeader->HeaderLength * (UINT32)sizeof(UINT32),
-                                        manifestHeader->HeaderVersion,
-                                        manifestHeader->Flags,
-                                        manifestHeader->Vendor,
-                                        manifestHeader->Date,
-                                        manifestHeader->Size * (UINT32)sizeof(UINT32), manifestHeader->Size * (UINT32)sizeof(UINT32),
-                                        manifestHeader->VersionMajor, manifestHeader->VersionMinor, manifestHeader->VersionBugfix, manifestHeader->VersionBuild,
-                                        manifestHeader->SecurityVersion,
-                                        manifestHeader->ModulusSize * (UINT32)sizeof(UINT32), manifestHeader->ModulusSize * (UINT32)sizeof(UINT32),
-                                        manifestHeader->ExponentSize * (UINT32)sizeof(UINT32), manifestHeader->ExponentSize * (UINT32)sizeof(UINT32));
+                        const CPD_MANIFEST_HEADER infoHeader = *manifestHeader;
+                        const UINT32 partitionSize = (UINT32)partition.size();
+                        const UINT32 headerSize = (UINT32)header.size();
+                        const UINT32 bodySize = (UINT32)body.size();
+                        info = [infoHeader, partitionSize, headerSize, bodySize]() {
+                            return usprintf("Full size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)"
+                                            "\nHeader type: %u\nHeader length: %Xh (%u)\nHeader version: %Xh\nFlags: %08Xh\nVendor: %Xh\n"
+                                            "Date: %Xh\nSize: %Xh (%u)\nVersion: %u.%u.%u.%u\nSecurity version number: %u\nModulus size: %Xh (%u)\nExponent size: %Xh (%u)",
+                                            partitionSize, partitionSize,
+                                            headerSize, headerSize,
+                                            bodySize, bodySize,
+                                            infoHeader.HeaderType,
+                                            infoHeader.HeaderLength * (UINT32)sizeof(UINT32), infoHeader.HeaderLength * (UINT32)sizeof(UINT32),
+                                            infoHeader.HeaderVersion,
+                                            infoHeader.Flags,
+                                            infoHeader.Vendor,
+                                            infoHeader.Date,
+                                            infoHeader.Size * (UINT32)sizeof(UINT32), infoHeader.Size * (UINT32)sizeof(UINT32),
+                                            infoHeader.VersionMajor, infoHeader.VersionMinor, infoHeader.VersionBugfix, infoHeader.VersionBuild,
+                                            infoHeader.SecurityVersion,
+                                            infoHeader.ModulusSize * (UINT32)sizeof(UINT32), infoHeader.ModulusSize * (UINT32)sizeof(UINT32),
+                                            infoHeader.ExponentSize * (UINT32)sizeof(UINT32), infoHeader.ExponentSize * (UINT32)sizeof(UINT32));
+                        };
                         
                         // Add tree item
                         UModelIndex partitionIndex = model->addItem(localOffset + partitions[i].ptEntry.Offset.Offset, Types::CpdPartition, Subtypes::ManifestCpdPartition, name, UString(), info, header, body, UByteArray(), Fixed, parent);
@@ -4838,14 +5273,16 @@ make_partition_table_consistent:
             }
             // It's a metadata
             else if (name.endsWith(".met")) {
-                info = usprintf("Full size: %Xh (%u)\nHuffman compressed: ",
-                                (UINT32)partition.size(), (UINT32)partition.size())
-                + (partitions[i].ptEntry.Offset.HuffmanCompressed ? "Yes" : "No");
-                
-                // Calculate SHA256 hash over the metadata and add it to its info
-                UByteArray hash(SHA256_HASH_SIZE, '\x00');
-                sha256(partition.constData(), partition.size(), hash.data());
-                info += UString("\nMetadata hash: ") + UString(hash.toHex().constData());
+                // SHA256 hash over the metadata is only calculated when its info is requested
+                const bool huffmanCompressed = partitions[i].ptEntry.Offset.HuffmanCompressed;
+                info = [partition, huffmanCompressed]() {
+                    UByteArray hash(SHA256_HASH_SIZE, '\x00');
+                    sha256(partition.constData(), partition.size(), hash.data());
+                    return usprintf("Full size: %Xh (%u)\nHuffman compressed: ",
+                                    (UINT32)partition.size(), (UINT32)partition.size())
+                    + (huffmanCompressed ? "Yes" : "No")
+                    + UString("\nMetadata hash: ") + UString(hash.toHex().constData());
+                };
                 
                 // Add three item
                 UModelIndex partitionIndex = model->addItem(localOffset + partitions[i].ptEntry.Offset.Offset, Types::CpdPartition,  Subtypes::MetadataCpdPartition, name, UString(), info, UByteArray(), partition, UByteArray(), Fixed, parent);
@@ -4855,14 +5292,16 @@ make_partition_table_consistent:
             }
             // It's a code
             else {
-                info = usprintf("Full size: %Xh (%u)\nHuffman compressed: ",
-                                (UINT32)partition.size(), (UINT32)partition.size())
-                + (partitions[i].ptEntry.Offset.HuffmanCompressed ? "Yes" : "No");
-                
-                // Calculate SHA256 hash over the code and add it to its info
-                UByteArray hash(SHA256_HASH_SIZE, '\x00');
-                sha256(partition.constData(), partition.size(), hash.data());
-                info += UString("\nHash: ") + UString(hash.toHex().constData());
+                // SHA256 hash over the code is only calculated when its info is requested
+                const bool huffmanCompressed = partitions[i].ptEntry.Offset.HuffmanCompressed;
+                info = [partition, huffmanCompressed]() {
+                    UByteArray hash(SHA256_HASH_SIZE, '\x00');
+                    sha256(partition.constData(), partition.size(), hash.data());
+                    return usprintf("Full size: %Xh (%u)\nHuffman compressed: ",
+                                    (UINT32)partition.size(), (UINT32)partition.size())
+                    + (huffmanCompressed ? "Yes" : "No")
+                    + UString("\nHash: ") + UString(hash.toHex().constData());
+                };
                 
                 UModelIndex codeIndex = model->addItem(localOffset + partitions[i].ptEntry.Offset.Offset, Types::CpdPartition, Subtypes::CodeCpdPartition, name, UString(), info, UByteArray(), partition, UByteArray(), Fixed, parent);
                 (void)parseRawArea(codeIndex);
@@ -4873,7 +5312,7 @@ make_partition_table_consistent:
             
             // Get info
             name = UString("Padding");
-            info = usprintf("Full size: %Xh (%u)", (UINT32)partition.size(), (UINT32)partition.size());
+            info = fullSizeInfo((UINT32)partition.size());
             
             // Add tree item
             model->addItem(localOffset + partitions[i].ptEntry.Offset.Offset, Types::Padding, getPaddingType(partition), name, UString(), info, UByteArray(), partition, UByteArray(), Fixed, parent);
@@ -4889,6 +5328,8 @@ make_partition_table_consistent:
 
 USTATUS FfsParser::parseCpdExtensionsArea(const UModelIndex & index, const UINT32 localOffset)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     if (!index.isValid()) {
         return U_INVALID_PARAMETER;
     }
@@ -5025,6 +5466,8 @@ USTATUS FfsParser::parseCpdExtensionsArea(const UModelIndex & index, const UINT3
 
 USTATUS FfsParser::parseSignedPackageInfoData(const UModelIndex & index)
 {
+    ParserStatsTimer routineTimer(stats, __FUNCTION__);
+    
     if (!index.isValid()) {
         return U_INVALID_PARAMETER;
     }
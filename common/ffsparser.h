@@ -13,6 +13,8 @@ WITHWARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #ifndef FFSPARSER_H
 #define FFSPARSER_H
 
+#include <functional>
+#include <memory>
 #include <vector>
 
 #include "basetypes.h"
@@ -22,6 +24,8 @@ WITHWARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include "intel_microcode.h"
 #include "ffs.h"
 #include "fitparser.h"
+#include "parserstats.h"
+#include "signaturescanner.h"
 
 // Region info
 typedef struct REGION_INFO_ {
@@ -72,6 +76,9 @@ typedef struct PROTECTED_RANGE_ {
 class FitParser;
 class NvramParser;
 class MeParser;
+class TaskPool;
+class DecompressionCache;
+class MultiDigest;
 
 class FfsParser
 {
@@ -97,6 +104,22 @@ public:
     // Obtain offset/address difference
     UINT64 getAddressDiff() { return addressDiff; }
 
+    // Collect timings and counters during parsing, disabled by default
+    void setStatsEnabled(const bool enabled) { stats.setEnabled(enabled); }
+    // Obtain statistics of the last parsing
+    const ParserStats & getStats() const { return stats; }
+
+    // Parse independent regions, volumes and files using the given number of threads, 1 (the default) disables parallel parsing
+    // Parsing results do not depend on the number of threads
+    void setThreadCount(const UINT32 count);
+
+    // Reuse decompression results of identical compressed data, the cache can be shared between parsers
+    void setDecompressionCache(const std::shared_ptr<DecompressionCache> & cache) { decompressionCache = cache; }
+
+    // Decompress and parse contents of compressed sections only when the model is asked to fetch them, disabled by default
+    // The parser must outlive the use of the model, all contents are still parsed right away if the image has protected ranges to check
+    void setLazyDecompression(const bool enabled);
+
     // Output some info to stdout
     void outputInfo(void);
 
@@ -117,17 +140,45 @@ private:
     UINT64 addressDiff;
     
     UString securityInfo;
+    ParserStats stats;
+
+    // Raw area items are found by their signatures, each candidate is then validated by its own routine
+    typedef bool (FfsParser::*RawAreaCheck)(const UModelIndex & index, const UByteArray & data, const UINT32 offset, UINT8 & nextItemType, UINT32 & nextItemSize, UINT32 & nextItemAlternativeSize);
+    typedef struct RAW_AREA_SIGNATURE_ {
+        UINT32 signature;
+        UINT32 offset; // Offset of the signature from the start of the item
+        RawAreaCheck check;
+    } RAW_AREA_SIGNATURE;
+    static const RAW_AREA_SIGNATURE rawAreaSignatures[];
+    SignatureScanner rawAreaScanner;
 
     std::vector<PROTECTED_RANGE> protectedRanges;
     UINT64 protectedRegionsBase;
     UModelIndex dxeCore;
 
+    // Parallel parsing, each task parses a copy of its item in a detached model and results are attached in order of tasks
+    typedef struct DETACHED_PARSE_TASK_ {
+        UModelIndex index;  // Copied into the detached model with all its parents
+        bool exclusive;     // Item is changed by the task, otherwise the task can only add new children to it
+        UINT32 weight;      // Amount of data to parse, used to balance groups of tasks
+        std::function<USTATUS(FfsParser & parser, const UModelIndex & index)> parse;
+    } DETACHED_PARSE_TASK;
+    std::shared_ptr<TaskPool> taskPool;
+    std::shared_ptr<DecompressionCache> decompressionCache;
+    bool lazyDecompression;
+    bool deferDecompression(const UModelIndex & index);
+    void fetchDeferred(const UModelIndex & index);
+    DETACHED_PARSE_TASK detachedBodyParseTask(const UModelIndex & index, USTATUS (FfsParser::*parseBody)(const UModelIndex & index));
+    void parseDetached(const std::vector<DETACHED_PARSE_TASK> & tasks, std::vector<USTATUS> & results);
+    void attachDetached(FfsParser & detached, const UINT64 initialProtectedRegionsBase);
+
     // First pass
     USTATUS performFirstPass(const UByteArray & imageFile, UModelIndex & index);
 
     USTATUS parseCapsule(const UByteArray & capsule, const UINT32 localOffset, const UModelIndex & parent, UModelIndex & index);
     USTATUS parseIntelImage(const UByteArray & intelImage, const UINT32 localOffset, const UModelIndex & parent, UModelIndex & index);
     USTATUS parseGenericImage(const UByteArray & intelImage, const UINT32 localOffset, const UModelIndex & parent, UModelIndex & index);
+    USTATUS parseIntelImageRegion(const UByteArray & intelImage, const REGION_INFO & region, const UModelIndex & parent);
 
     USTATUS parseBpdtRegion(const UByteArray & region, const UINT32 localOffset, const UINT32 sbpdtOffsetFixup, const UModelIndex & parent, UModelIndex & index);
     USTATUS parseCpdRegion(const UByteArray & region, const UINT32 localOffset, const UModelIndex & parent, UModelIndex & index);
@@ -161,6 +212,7 @@ private:
     USTATUS parseVersionSectionHeader(const UByteArray & section, const UINT32 localOffset, const UModelIndex & parent, UModelIndex & index, const bool insertIntoTree);
     USTATUS parsePostcodeSectionHeader(const UByteArray & section, const UINT32 localOffset, const UModelIndex & parent, UModelIndex & index, const bool insertIntoTree);
 
+    USTATUS decompressBody(const UModelIndex & index, const UINT8 compressionType, const UINT8 inflateAlgorithm, UINT8 & algorithm, UINT32 & dictionarySize, UByteArray & decompressed, UByteArray & efiDecompressed);
     USTATUS parseCompressedSectionBody(const UModelIndex & index);
     USTATUS parseGuidedSectionBody(const UModelIndex & index);
     USTATUS parseVersionSectionBody(const UModelIndex & index);
@@ -172,6 +224,10 @@ private:
 
     USTATUS parseAprioriRawSection(const UByteArray & body, UString & parsed);
     USTATUS findNextRawAreaItem(const UModelIndex & index, const UINT32 localOffset, UINT8 & nextItemType, UINT32 & nextItemOffset, UINT32 & nextItemSize, UINT32 & nextItemAlternativeSize);
+    bool checkRawAreaMicrocode(const UModelIndex & index, const UByteArray & data, const UINT32 offset, UINT8 & nextItemType, UINT32 & nextItemSize, UINT32 & nextItemAlternativeSize);
+    bool checkRawAreaVolume(const UModelIndex & index, const UByteArray & data, const UINT32 offset, UINT8 & nextItemType, UINT32 & nextItemSize, UINT32 & nextItemAlternativeSize);
+    bool checkRawAreaBpdtStore(const UModelIndex & index, const UByteArray & data, const UINT32 offset, UINT8 & nextItemType, UINT32 & nextItemSize, UINT32 & nextItemAlternativeSize);
+    bool checkRawAreaInsydeFlashDeviceMap(const UModelIndex & index, const UByteArray & data, const UINT32 offset, UINT8 & nextItemType, UINT32 & nextItemSize, UINT32 & nextItemAlternativeSize);
     UINT32  getFileSize(const UByteArray & volume, const UINT32 fileOffset, const UINT8 ffsVersion, const UINT8 revision);
     UINT32  getSectionSize(const UByteArray & file, const UINT32 sectionOffset, const UINT8 ffsVersion);
     
@@ -186,7 +242,11 @@ private:
     USTATUS checkTeImageBase(const UModelIndex & index);
     
     USTATUS checkProtectedRanges(const UModelIndex & index);
-    USTATUS markProtectedRangeRecursive(const UModelIndex & index, const PROTECTED_RANGE & range);
+    // Ranges are applied in order, so later ranges take precedence over earlier ones for items they both cover
+    USTATUS markProtectedRanges(const UModelIndex & index, const std::vector<PROTECTED_RANGE> & ranges);
+    // Protected parts are slices of the opened image, hashed without being concatenated
+    void calculateProtectedRangeDigests(const std::vector<UByteArray> & protectedParts, MultiDigest & digests);
+    bool calculateProtectedRangeDigest(const UINT16 algorithmId, const std::vector<UByteArray> & protectedParts, UByteArray & digest);
 
     USTATUS parseResetVectorData();
     
@@ -201,6 +261,8 @@ private:
 #ifdef U_ENABLE_ME_PARSING_SUPPORT
     friend class MeParser; // Make FFS parsing routines accessible to MeParser
 #endif
+
+    friend class ParseCache; // Make parser state accessible to ParseCache
 };
 
 #endif // FFSPARSER_H
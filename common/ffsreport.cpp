@@ -32,6 +32,9 @@ std::vector<UString> FfsReport::generate()
         return report;
     }
     
+    // Contents of lazily decompressed sections are reported too
+    model->fetchAll(root);
+    
     // Generate report recursive
     report.push_back(UString("        Type         |        Subtype        |   Base   |   Size   |  CRC32   |   Name "));
     USTATUS result = generateRecursive(report, root);
@@ -47,14 +50,14 @@ USTATUS FfsReport::generateRecursive(std::vector<UString> & report, const UModel
     if (!index.isValid())
         return U_SUCCESS; // Nothing to report for invalid index
     
-    // Calculate item CRC32
-    UByteArray data = model->header(index) + model->body(index) + model->tail(index);
-    UINT32 crc = (UINT32)crc32(0, (const UINT8*)data.constData(), (uInt)data.size());
+    // Item CRC32 is calculated from CRC32 values of its children where possible
+    UINT32 size = model->dataSize(index);
+    UINT32 crc = model->dataCrc32(index);
     
     // Information on current item
     UString text = model->text(index);
     UString offset = "|   N/A    ";
-    if ((!model->compressed(index)) || (index.parent().isValid() && !model->compressed(index.parent()))) {
+    if (model->hasMeaningfulBase(index)) {
         offset = usprintf("| %08X ", model->base(index));
     }
     
@@ -62,7 +65,7 @@ USTATUS FfsReport::generateRecursive(std::vector<UString> & report, const UModel
                      UString(" ") + itemTypeToUString(model->type(index)).leftJustified(20)
                      + UString("| ") + itemSubtypeToUString(model->type(index), model->subtype(index)).leftJustified(22)
                      + offset
-                     + usprintf("| %08X | %08X | ", (UINT32)data.size(), crc)
+                     + usprintf("| %08X | %08X | ", size, crc)
                      + urepeated('-', level) + UString(" ") + model->name(index) + (text.isEmpty() ? UString() : UString(" | ") + text)
                      );
     
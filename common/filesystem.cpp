@@ -14,6 +14,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include "filesystem.h"
 #include <sys/stat.h>
 #include <fstream>
+#include <memory>
 
 bool readFileIntoBuffer(const UString& inPath, UByteArray& buf) 
 {
@@ -27,11 +28,52 @@ bool readFileIntoBuffer(const UString& inPath, UByteArray& buf)
         (std::istreambuf_iterator<char>()));
     inputFile.close();
 
-    buf = buffer;
+    buf = UByteArray(buffer.data(), (int)buffer.size());
 
     return true;
 }
 
+#if defined(QT_CORE_LIB) || defined(_WIN32) || defined(__MINGW32__)
+bool mapFileIntoBuffer(const UString& inPath, UByteArray& buf)
+{
+    return readFileIntoBuffer(inPath, buf);
+}
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Maps the file read-only, the mapping is released when the last array referring to it is destroyed
+// The file must not be truncated while mapped
+bool mapFileIntoBuffer(const UString& inPath, UByteArray& buf)
+{
+    int fd = open(inPath.toLocal8Bit(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || (uint64_t)st.st_size > INT32_MAX) {
+        close(fd);
+        return readFileIntoBuffer(inPath, buf);
+    }
+
+    size_t size = (size_t)st.st_size;
+    if (size == 0) {
+        close(fd);
+        buf.clear();
+        return true;
+    }
+
+    void* mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED)
+        return readFileIntoBuffer(inPath, buf);
+
+    buf = UByteArray(std::shared_ptr<const char>((const char*)mapped, [size](const char* p) { munmap((void*)p, size); }), size);
+    return true;
+}
+#endif
+
 #if defined(_WIN32) || defined(__MINGW32__)
 #include <direct.h>
 #include <stdlib.h>
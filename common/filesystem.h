@@ -22,6 +22,7 @@ bool makeDirectory(const UString& dir);
 bool changeDirectory(const UString& dir);
 bool removeDirectory(const UString& dir);
 bool readFileIntoBuffer(const UString& inPath, UByteArray& buf);
+bool mapFileIntoBuffer(const UString& inPath, UByteArray& buf);
 UString getAbsPath(const UString& path);
 
 #endif
@@ -20,6 +20,7 @@
 #include "types.h"
 #include "utility.h"
 #include "digest/sha2.h"
+#include "kaitaiprobe.h"
 
 #include "umemstream.h"
 #include "kaitai/kaitaistream.h"
@@ -231,7 +232,7 @@ void FitParser::findFitRecursive(const UModelIndex & index, UModelIndex & found,
         // Check FIT address to be stored in the last VTF
         if (fitAddress == storedFitAddress) {
             // Valid FIT table must have at least two entries
-            if ((UINT32)model->body(index).size() < offset + 2*sizeof(INTEL_FIT_ENTRY)) {
+            if (model->bodySize(index) < offset + 2*sizeof(INTEL_FIT_ENTRY)) {
                 msg(usprintf("%s: FIT table candidate found, too small to contain real FIT", __FUNCTION__), index);
             }
             else {
@@ -278,6 +279,13 @@ USTATUS FitParser::parseFitEntryMicrocode(const UByteArray & microcode, const UI
 
 USTATUS FitParser::parseFitEntryAcm(const UByteArray & acm, const UINT32 localOffset, const UModelIndex & parent, UString & info, UINT32 &realSize)
 {
+    // No need to parse further if the parser will certainly fail
+    if (localOffset > (UINT32)acm.size()
+        || probeIntelAcm((const UINT8*)acm.constData() + localOffset, (UINT32)acm.size() - localOffset) != U_SUCCESS) {
+        msg(usprintf("%s: unable to parse ACM", __FUNCTION__), parent);
+        return U_INVALID_ACM;
+    }
+    
     try {
         umemstream is(acm.constData(), acm.size());
         is.seekg(localOffset, is.beg);
@@ -395,7 +403,16 @@ USTATUS FitParser::parseFitEntryBootGuardKeyManifest(const UByteArray & keyManif
 {
     U_UNUSED_PARAMETER(realSize);
     
+    if (localOffset > (UINT32)keyManifest.size()) {
+        msg(usprintf("%s: unable to parse Key Manifest", __FUNCTION__), parent);
+        return U_INVALID_BOOT_GUARD_KEY_MANIFEST;
+    }
+    
     // v1
+    if (probeIntelKeymV1((const UINT8*)keyManifest.constData() + localOffset, (UINT32)keyManifest.size() - localOffset) != U_SUCCESS) {
+        // No need to parse further, will try parsing as v2 next
+        goto not_keym_v1;
+    }
     try {
         umemstream is(keyManifest.constData(), keyManifest.size());
         is.seekg(localOffset, is.beg);
@@ -498,7 +515,12 @@ USTATUS FitParser::parseFitEntryBootGuardKeyManifest(const UByteArray & keyManif
         // Do nothing here, will try parsing as v2 next
     }
     
+not_keym_v1:
     // v2
+    if (probeIntelKeymV2((const UINT8*)keyManifest.constData() + localOffset, (UINT32)keyManifest.size() - localOffset) != U_SUCCESS) {
+        msg(usprintf("%s: unable to parse Key Manifest", __FUNCTION__), parent);
+        return U_INVALID_BOOT_GUARD_KEY_MANIFEST;
+    }
     try {
         umemstream is(keyManifest.constData(), keyManifest.size());
         is.seekg(localOffset, is.beg);
@@ -630,7 +652,16 @@ USTATUS FitParser::parseFitEntryBootGuardBootPolicy(const UByteArray & bootPolic
 {
     U_UNUSED_PARAMETER(realSize);
     
+    if (localOffset > (UINT32)bootPolicy.size()) {
+        msg(usprintf("%s: unable to parse Boot Policy", __FUNCTION__), parent);
+        return U_INVALID_BOOT_GUARD_BOOT_POLICY;
+    }
+    
     // v1
+    if (probeIntelAcbpV1((const UINT8*)bootPolicy.constData() + localOffset, (UINT32)bootPolicy.size() - localOffset) != U_SUCCESS) {
+        // No need to parse further, will try parsing as v2 next
+        goto not_acbp_v1;
+    }
     try {
         umemstream is(bootPolicy.constData(), bootPolicy.size());
         is.seekg(localOffset, is.beg);
@@ -709,8 +740,7 @@ USTATUS FitParser::parseFitEntryBootGuardBootPolicy(const UByteArray & bootPolic
                 else {
                     // Add postIbbHash protected range
                     UByteArray postIbbHash(ibbs_body->post_ibb_hash()->hash().data(), ibbs_body->post_ibb_hash()->len_hash());
-                    if (postIbbHash.count('\x00') != postIbbHash.size()
-                        && postIbbHash.count('\xFF') != postIbbHash.size()) {
+                    if (getPaddingType(postIbbHash) == Subtypes::DataPadding) {
                         PROTECTED_RANGE range = {};
                         range.Type = PROTECTED_RANGE_INTEL_BOOT_GUARD_POST_IBB;
                         range.AlgorithmId = ibbs_body->post_ibb_hash()->hash_algorithm_id();
@@ -893,7 +923,12 @@ USTATUS FitParser::parseFitEntryBootGuardBootPolicy(const UByteArray & bootPolic
         // Do nothing here, will try parsing as v2 next
     }
     
+not_acbp_v1:
     // v2
+    if (probeIntelAcbpV2((const UINT8*)bootPolicy.constData() + localOffset, (UINT32)bootPolicy.size() - localOffset) != U_SUCCESS) {
+        msg(usprintf("%s: unable to parse Boot Policy", __FUNCTION__), parent);
+        return U_INVALID_BOOT_GUARD_BOOT_POLICY;
+    }
     try {
         umemstream is(bootPolicy.constData(), bootPolicy.size());
         is.seekg(localOffset, is.beg);
@@ -990,8 +1025,7 @@ USTATUS FitParser::parseFitEntryBootGuardBootPolicy(const UByteArray & bootPolic
                 else {
                     // Add postIbbHash protected range
                     UByteArray postIbbHash(ibbs_body->post_ibb_digest()->hash().data(), ibbs_body->post_ibb_digest()->len_hash());
-                    if (postIbbHash.count('\x00') != postIbbHash.size()
-                        && postIbbHash.count('\xFF') != postIbbHash.size()) {
+                    if (getPaddingType(postIbbHash) == Subtypes::DataPadding) {
                         PROTECTED_RANGE range = {};
                         range.Type = PROTECTED_RANGE_INTEL_BOOT_GUARD_POST_IBB;
                         range.AlgorithmId = ibbs_body->post_ibb_digest()->hash_algorithm_id();
@@ -1021,8 +1055,7 @@ USTATUS FitParser::parseFitEntryBootGuardBootPolicy(const UByteArray & bootPolic
                     
                     // Add ObbHash protected range
                     UByteArray obbHash(ibbs_body->obb_digest()->hash().data(), ibbs_body->obb_digest()->len_hash());
-                    if (obbHash.count('\x00') != obbHash.size()
-                        && obbHash.count('\xFF') != obbHash.size()) {
+                    if (getPaddingType(obbHash) == Subtypes::DataPadding) {
                         PROTECTED_RANGE range = {};
                         range.Type = PROTECTED_RANGE_INTEL_BOOT_GUARD_OBB;
                         range.AlgorithmId = ibbs_body->obb_digest()->hash_algorithm_id();
@@ -40,6 +40,8 @@ public:
     std::vector<std::pair<UString, UModelIndex> > getMessages() const { return messagesVector; }
     // Clears messages
     void clearMessages() { messagesVector.clear(); }
+    // Append messages of another parser
+    void addMessages(const std::vector<std::pair<UString, UModelIndex> > & messages) { messagesVector.insert(messagesVector.end(), messages.begin(), messages.end()); }
 
     // Obtain parsed FIT table
     std::vector<std::pair<std::vector<UString>, UModelIndex> > getFitTable() const { return fitTable; }
@@ -73,6 +75,8 @@ private:
     USTATUS parseFitEntryAcm(const UByteArray & acm, const UINT32 localOffset, const UModelIndex & parent, UString & info, UINT32 &realSize);
     USTATUS parseFitEntryBootGuardKeyManifest(const UByteArray & keyManifest, const UINT32 localOffset, const UModelIndex & parent, UString & info, UINT32 &realSize);
     USTATUS parseFitEntryBootGuardBootPolicy(const UByteArray & bootPolicy, const UINT32 localOffset, const UModelIndex & parent, UString & info, UINT32 &realSize);
+
+    friend class ParseCache; // Make FIT table accessible to ParseCache
 };
 #else // U_ENABLE_FIT_PARSING_SUPPORT
 class FitParser
@@ -86,6 +90,7 @@ public:
     std::vector<std::pair<UString, UModelIndex> > getMessages() const { return std::vector<std::pair<UString, UModelIndex> >(); }
     // Clears messages
     void clearMessages() {}
+    void addMessages(const std::vector<std::pair<UString, UModelIndex> > &) {}
 
     // Obtain parsed FIT table
     std::vector<std::pair<std::vector<UString>, UModelIndex> > getFitTable() const { return std::vector<std::pair<std::vector<UString>, UModelIndex> >(); }
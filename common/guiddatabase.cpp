@@ -90,7 +90,11 @@ void initGuidDatabase(const UString & path, UINT32* numEntries)
 
 UString guidDatabaseLookup(const EFI_GUID & guid)
 {
-    return gLocalGuidDatabase[guid];
+    // Lookups must not change the database, they are done from parallel parsing threads
+    GuidDatabase::const_iterator found = gLocalGuidDatabase.find(guid);
+    if (found == gLocalGuidDatabase.end())
+        return UString();
+    return found->second;
 }
 
 #else
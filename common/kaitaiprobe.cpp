@@ -0,0 +1,276 @@
+/* kaitaiprobe.cpp
+
+Copyright (c) 2026, Nikolaj Schlej. All rights reserved.
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+*/
+
+#include "kaitaiprobe.h"
+#include "utility.h"
+
+// Field offsets and sizes below follow seq definitions in the corresponding .ksy files
+// Sizes are calculated the same way generated parsers do, including 32-bit wraparounds, but without reading anything
+
+#define KAITAI_PROBE_STRUCTURE_ID_KEYM 0x5f5f4d59454b5f5fULL // __KEYM__
+#define KAITAI_PROBE_STRUCTURE_ID_ACBP 0x5f5f504243415f5fULL // __ACBP__
+
+static inline UINT16 probeU16(const UINT8* buffer, const UINT32 offset)
+{
+    return readUnaligned((const UINT16*)(buffer + offset));
+}
+
+static inline UINT32 probeU32(const UINT8* buffer, const UINT32 offset)
+{
+    return readUnaligned((const UINT32*)(buffer + offset));
+}
+
+static inline UINT64 probeU64(const UINT8* buffer, const UINT32 offset)
+{
+    return readUnaligned((const UINT64*)(buffer + offset));
+}
+
+USTATUS probeAmiNvar(const UINT8* buffer, const UINT32 bufferSize)
+{
+    // Entries are read until the first one without NVAR signature or until the end of data,
+    // but at least one entry is always read
+    UINT32 offset = 0;
+    do {
+        if (bufferSize - offset < 1)
+            return U_INVALID_STORE_SIZE;
+        if (buffer[offset] != 'N')
+            return U_SUCCESS;
+
+        // Signature, size, next and attributes
+        const UINT32 headerSize = 4 + 2 + 3 + 1;
+        if (bufferSize - offset < headerSize)
+            return U_INVALID_STORE_SIZE;
+        if (buffer[offset + 1] != 'V' || buffer[offset + 2] != 'A' || buffer[offset + 3] != 'R')
+            return U_INVALID_STORE;
+        const UINT16 entrySize = probeU16(buffer, offset + 4);
+        if (entrySize <= headerSize)
+            return U_INVALID_STORE_SIZE;
+        if (bufferSize - offset < entrySize)
+            return U_INVALID_STORE_SIZE;
+        offset += entrySize;
+    } while (offset < bufferSize);
+
+    return U_SUCCESS;
+}
+
+USTATUS probeAppleSysf(const UINT8* buffer, const UINT32 bufferSize)
+{
+    // Signature, unknown, unknown1 and size, body, CRC32
+    const UINT32 headerSize = 4 + 1 + 4 + 2;
+    if (bufferSize < headerSize)
+        return U_INVALID_STORE_SIZE;
+    const UINT16 storeSize = probeU16(buffer, 9);
+    if (storeSize < headerSize + sizeof(UINT32) || storeSize > bufferSize)
+        return U_INVALID_STORE_SIZE;
+
+    return U_SUCCESS;
+}
+
+USTATUS probeEdk2Ftw(const UINT8* buffer, const UINT32 bufferSize)
+{
+    // Signature, CRC32, state, reserved and 32-bit write queue size
+    const UINT32 headerSize = 16 + 4 + 1 + 3 + 4;
+    if (bufferSize < headerSize)
+        return U_INVALID_STORE_SIZE;
+    const UINT32 writeQueueSize = probeU32(buffer, 24);
+    if (writeQueueSize % 0x10 == 0x04) {
+        if (writeQueueSize > bufferSize - headerSize)
+            return U_INVALID_STORE_SIZE;
+    }
+    else if (writeQueueSize % 0x10 == 0) {
+        // 64-bit write queue size
+        const UINT32 headerSize64 = headerSize + 4;
+        if (bufferSize < headerSize64)
+            return U_INVALID_STORE_SIZE;
+        if (((UINT64)probeU32(buffer, 28) << 32) + writeQueueSize > bufferSize - headerSize64)
+            return U_INVALID_STORE_SIZE;
+    }
+
+    return U_SUCCESS;
+}
+
+USTATUS probeEdk2Vss(const UINT8* buffer, const UINT32 bufferSize)
+{
+    // Signature, size, format, state and reserved fields
+    const UINT32 headerSize = 4 + 4 + 1 + 1 + 2 + 4;
+    if (bufferSize < headerSize)
+        return U_INVALID_STORE_SIZE;
+    const UINT32 storeSize = probeU32(buffer, 4);
+    if (storeSize <= headerSize || storeSize == 0xFFFFFFFF || storeSize > bufferSize)
+        return U_INVALID_STORE_SIZE;
+
+    return U_SUCCESS;
+}
+
+USTATUS probeEdk2Vss2(const UINT8* buffer, const UINT32 bufferSize)
+{
+    // Signature GUID, size, format, state and reserved fields
+    const UINT32 headerSize = 16 + 4 + 1 + 1 + 2 + 4;
+    if (bufferSize < headerSize)
+        return U_INVALID_STORE_SIZE;
+    const UINT32 storeSize = probeU32(buffer, 16);
+    if (storeSize <= headerSize || storeSize == 0xFFFFFFFF || storeSize > bufferSize)
+        return U_INVALID_STORE_SIZE;
+
+    return U_SUCCESS;
+}
+
+USTATUS probeInsydeFdc(const UINT8* buffer, const UINT32 bufferSize)
+{
+    // Signature and size, the rest of the header is a part of the body
+    const UINT32 headerSize = 4 + 4;
+    const UINT32 fullHeaderSize = 0x50;
+    if (bufferSize < headerSize)
+        return U_INVALID_STORE_SIZE;
+    const UINT32 storeSize = probeU32(buffer, 4);
+    if (storeSize <= fullHeaderSize || storeSize == 0xFFFFFFFF || storeSize - fullHeaderSize > bufferSize - headerSize)
+        return U_INVALID_STORE_SIZE;
+
+    return U_SUCCESS;
+}
+
+USTATUS probeMsSlicMarker(const UINT8* buffer, const UINT32 bufferSize)
+{
+    U_UNUSED_PARAMETER(buffer);
+
+    // Type, size, version, OEM ID, OEM table ID, Windows flag, SLIC version, reserved and signature
+    if (bufferSize < 4 + 4 + 4 + 6 + 8 + 8 + 4 + 16 + 128)
+        return U_INVALID_STORE_SIZE;
+
+    return U_SUCCESS;
+}
+
+USTATUS probeMsSlicPubkey(const UINT8* buffer, const UINT32 bufferSize)
+{
+    U_UNUSED_PARAMETER(buffer);
+
+    // Type, size, key type, version, reserved, algorithm, magic, bit length, exponent and modulus
+    if (bufferSize < 4 + 4 + 1 + 1 + 2 + 4 + 4 + 4 + 4 + 128)
+        return U_INVALID_STORE_SIZE;
+
+    return U_SUCCESS;
+}
+
+USTATUS probePhoenixEvsa(const UINT8* buffer, const UINT32 bufferSize)
+{
+    // Type, checksum, header size, signature, attributes, store size and reserved
+    const UINT32 headerSize = 1 + 1 + 2 + 4 + 4 + 4 + 4;
+    if (bufferSize < headerSize)
+        return U_INVALID_STORE_SIZE;
+    const UINT16 storeHeaderSize = probeU16(buffer, 2);
+    const UINT32 storeSize = probeU32(buffer, 12);
+    if (storeSize < storeHeaderSize || storeSize - storeHeaderSize > bufferSize - headerSize)
+        return U_INVALID_STORE_SIZE;
+
+    return U_SUCCESS;
+}
+
+USTATUS probePhoenixFlm(const UINT8* buffer, const UINT32 bufferSize)
+{
+    // Signature, number of entries and reserved, followed by entries of fixed size
+    const UINT32 headerSize = 10 + 2 + 4;
+    const UINT32 entrySize = 16 + 2 + 2 + 8 + 4 + 4;
+    if (bufferSize < headerSize)
+        return U_INVALID_STORE_SIZE;
+    const UINT16 numEntries = probeU16(buffer, 10);
+    if ((UINT64)numEntries * entrySize > bufferSize - headerSize)
+        return U_INVALID_STORE_SIZE;
+
+    return U_SUCCESS;
+}
+
+USTATUS probeIntelAcm(const UINT8* buffer, const UINT32 bufferSize)
+{
+    // Fixed part of the header, up to and including scratch space size
+    const UINT32 headerSize = 128;
+    if (bufferSize < headerSize)
+        return U_INVALID_ACM;
+    if (probeU16(buffer, 0) != 2 // Module type
+        || probeU32(buffer, 16) != 0x8086) // Module vendor
+        return U_INVALID_ACM;
+
+    const UINT32 headerSizeField = probeU32(buffer, 4);
+    const UINT32 headerVersion = probeU32(buffer, 8);
+    const UINT32 moduleSize = probeU32(buffer, 24);
+    const UINT32 keySize = probeU32(buffer, 120);
+    const UINT32 scratchSpaceSize = probeU32(buffer, 124);
+
+    // RSA public key, optional RSA exponent, RSA signature, scratch space and body
+    UINT64 fullSize = headerSize;
+    fullSize += (UINT32)(4 * keySize);
+    if (headerVersion == 0)
+        fullSize += sizeof(UINT32);
+    fullSize += (UINT32)(4 * keySize);
+    fullSize += (UINT32)(4 * scratchSpaceSize);
+    fullSize += (UINT32)(4 * (moduleSize - headerSizeField - scratchSpaceSize));
+    if (fullSize > bufferSize)
+        return U_INVALID_ACM;
+
+    return U_SUCCESS;
+}
+
+USTATUS probeIntelKeymV1(const UINT8* buffer, const UINT32 bufferSize)
+{
+    // Structure ID, version, KM version, KM SVN, KM ID, followed by hash algorithm and hash size
+    const UINT32 headerSize = 8 + 1 + 1 + 1 + 1;
+    if (bufferSize < headerSize + 2 + 2)
+        return U_INVALID_BOOT_GUARD_KEY_MANIFEST;
+    if (probeU64(buffer, 0) != KAITAI_PROBE_STRUCTURE_ID_KEYM
+        || buffer[8] >= 0x20)
+        return U_INVALID_BOOT_GUARD_KEY_MANIFEST;
+    if (probeU16(buffer, headerSize + 2) > bufferSize - headerSize - 2 - 2)
+        return U_INVALID_BOOT_GUARD_KEY_MANIFEST;
+
+    return U_SUCCESS;
+}
+
+USTATUS probeIntelKeymV2(const UINT8* buffer, const UINT32 bufferSize)
+{
+    // Structure ID, version, header specific, total size, key signature offset, reserved,
+    // KM version, KM SVN, KM ID, FPF hash algorithm and number of KM hashes
+    if (bufferSize < 8 + 1 + 1 + 2 + 2 + 3 + 1 + 1 + 1 + 2 + 2)
+        return U_INVALID_BOOT_GUARD_KEY_MANIFEST;
+    if (probeU64(buffer, 0) != KAITAI_PROBE_STRUCTURE_ID_KEYM
+        || buffer[8] < 0x20
+        || probeU16(buffer, 10) != 0) // Total size
+        return U_INVALID_BOOT_GUARD_KEY_MANIFEST;
+
+    return U_SUCCESS;
+}
+
+USTATUS probeIntelAcbpV1(const UINT8* buffer, const UINT32 bufferSize)
+{
+    // Structure ID, version, reserved, BPM revision, BP SVN, ACM SVN, reserved, NEM data size,
+    // followed by at least one element with structure ID and version
+    if (bufferSize < 8 + 1 + 1 + 1 + 1 + 1 + 1 + 2 + 8 + 1)
+        return U_INVALID_BOOT_GUARD_BOOT_POLICY;
+    if (probeU64(buffer, 0) != KAITAI_PROBE_STRUCTURE_ID_ACBP
+        || buffer[8] >= 0x20)
+        return U_INVALID_BOOT_GUARD_BOOT_POLICY;
+
+    return U_SUCCESS;
+}
+
+USTATUS probeIntelAcbpV2(const UINT8* buffer, const UINT32 bufferSize)
+{
+    // Structure ID, version, header specific, total size, key signature offset, BPM revision, BP SVN, ACM SVN,
+    // reserved, NEM data size, followed by at least one element with structure ID, version, header specific and total size
+    if (bufferSize < 8 + 1 + 1 + 2 + 2 + 1 + 1 + 1 + 1 + 2 + 8 + 1 + 1 + 2)
+        return U_INVALID_BOOT_GUARD_BOOT_POLICY;
+    if (probeU64(buffer, 0) != KAITAI_PROBE_STRUCTURE_ID_ACBP
+        || buffer[8] < 0x20
+        || probeU16(buffer, 10) != 20) // Total size
+        return U_INVALID_BOOT_GUARD_BOOT_POLICY;
+
+    return U_SUCCESS;
+}
@@ -0,0 +1,44 @@
+/* kaitaiprobe.h
+
+Copyright (c) 2026, Nikolaj Schlej. All rights reserved.
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+*/
+
+#ifndef KAITAIPROBE_H
+#define KAITAIPROBE_H
+
+#include "basetypes.h"
+
+// Exception-free probes for formats parsed by generated kaitai parsers in common/generated
+// Every probe checks magic values, sizes and bounds of the top-level structure as described in common/ksy,
+// and fails only for inputs the corresponding generated parser would certainly throw on,
+// so it is safe to skip constructing the parser when a probe fails
+// Buffer is the exact data the parser stream would be constructed on
+
+// NVRAM formats
+USTATUS probeAmiNvar(const UINT8* buffer, const UINT32 bufferSize);
+USTATUS probeAppleSysf(const UINT8* buffer, const UINT32 bufferSize);
+USTATUS probeEdk2Ftw(const UINT8* buffer, const UINT32 bufferSize);
+USTATUS probeEdk2Vss(const UINT8* buffer, const UINT32 bufferSize);
+USTATUS probeEdk2Vss2(const UINT8* buffer, const UINT32 bufferSize);
+USTATUS probeInsydeFdc(const UINT8* buffer, const UINT32 bufferSize);
+USTATUS probeMsSlicMarker(const UINT8* buffer, const UINT32 bufferSize);
+USTATUS probeMsSlicPubkey(const UINT8* buffer, const UINT32 bufferSize);
+USTATUS probePhoenixEvsa(const UINT8* buffer, const UINT32 bufferSize);
+USTATUS probePhoenixFlm(const UINT8* buffer, const UINT32 bufferSize);
+
+// Intel Boot Guard formats
+USTATUS probeIntelAcm(const UINT8* buffer, const UINT32 bufferSize);
+USTATUS probeIntelKeymV1(const UINT8* buffer, const UINT32 bufferSize);
+USTATUS probeIntelKeymV2(const UINT8* buffer, const UINT32 bufferSize);
+USTATUS probeIntelAcbpV1(const UINT8* buffer, const UINT32 bufferSize);
+USTATUS probeIntelAcbpV2(const UINT8* buffer, const UINT32 bufferSize);
+
+#endif // KAITAIPROBE_H
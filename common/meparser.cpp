@@ -130,48 +130,54 @@ USTATUS MeParser::parseFptRegion(const UByteArray & region, const UModelIndex &
     UByteArray body = region.mid(header.size(), ptBodySize);
     
     UString name = UString("FPT partition table");
-    UString info;
+    ItemInfoFormatter info;
+    const UINT32 headerSize = (UINT32)header.size();
+    const bool romBypassVectorPresent = romBypassVectorSize != 0;
     
     // Special case of FPT header version 2.1
     if (ptHeader->HeaderVersion == FPT_HEADER_VERSION_21) {
-        const FPT_HEADER_21* ptHeader21 = (const FPT_HEADER_21*)ptHeader;
-        
-        info = usprintf("Full size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\nROM bypass vector: %s\nNumber of entries: %u\nHeader version: %02Xh\nEntry version: %02Xh\n"
-                        "Header length: %02Xh\nFlags: %Xh\nTicks to add: %04Xh\nTokens to add: %04Xh\nSPS Flags: %Xh\nFITC version: %u.%u.%u.%u\nCRC32 Checksum: %08Xh",
-                        ptSize, ptSize,
-                        (UINT32)header.size(), (UINT32)header.size(),
-                        ptBodySize, ptBodySize,
-                        (romBypassVectorSize ? "present" : "absent"),
-                        ptHeader21->NumEntries,
-                        ptHeader21->HeaderVersion,
-                        ptHeader21->EntryVersion,
-                        ptHeader21->HeaderLength,
-                        ptHeader21->Flags,
-                        ptHeader21->TicksToAdd,
-                        ptHeader21->TokensToAdd,
-                        ptHeader21->SPSFlags,
-                        ptHeader21->FitcMajor, ptHeader21->FitcMinor, ptHeader21->FitcHotfix, ptHeader21->FitcBuild,
-                        ptHeader21->HeaderCrc32);
+        const FPT_HEADER_21 ptHeader21 = *(const FPT_HEADER_21*)ptHeader;
+        info = [ptHeader21, ptSize, headerSize, ptBodySize, romBypassVectorPresent]() {
+            return usprintf("Full size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\nROM bypass vector: %s\nNumber of entries: %u\nHeader version: %02Xh\nEntry version: %02Xh\n"
+                            "Header length: %02Xh\nFlags: %Xh\nTicks to add: %04Xh\nTokens to add: %04Xh\nSPS Flags: %Xh\nFITC version: %u.%u.%u.%u\nCRC32 Checksum: %08Xh",
+                            ptSize, ptSize,
+                            headerSize, headerSize,
+                            ptBodySize, ptBodySize,
+                            (romBypassVectorPresent ? "present" : "absent"),
+                            ptHeader21.NumEntries,
+                            ptHeader21.HeaderVersion,
+                            ptHeader21.EntryVersion,
+                            ptHeader21.HeaderLength,
+                            ptHeader21.Flags,
+                            ptHeader21.TicksToAdd,
+                            ptHeader21.TokensToAdd,
+                            ptHeader21.SPSFlags,
+                            ptHeader21.FitcMajor, ptHeader21.FitcMinor, ptHeader21.FitcHotfix, ptHeader21.FitcBuild,
+                            ptHeader21.HeaderCrc32);
+        };
         // TODO: verify header crc32
     }
     // Default handling for all other versions, may be too generic in some corner cases
     else {
-        info = usprintf("Full size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\nROM bypass vector: %s\nNumber of entries: %u\nHeader version: %02Xh\nEntry version: %02Xh\n"
-                        "Header length: %02Xh\nFlash cycle life: %04Xh\nFlash cycle limit: %04Xh\nUMA size: %Xh\nFlags: %Xh\nFITC version: %u.%u.%u.%u\nChecksum: %02Xh",
-                        ptSize, ptSize,
-                        (UINT32)header.size(), (UINT32)header.size(),
-                        ptBodySize, ptBodySize,
-                        (romBypassVectorSize ? "present" : "absent"),
-                        ptHeader->NumEntries,
-                        ptHeader->HeaderVersion,
-                        ptHeader->EntryVersion,
-                        ptHeader->HeaderLength,
-                        ptHeader->FlashCycleLife,
-                        ptHeader->FlashCycleLimit,
-                        ptHeader->UmaSize,
-                        ptHeader->Flags,
-                        ptHeader->FitcMajor, ptHeader->FitcMinor, ptHeader->FitcHotfix, ptHeader->FitcBuild,
-                        ptHeader->HeaderChecksum);
+        const FPT_HEADER infoHeader = *ptHeader;
+        info = [infoHeader, ptSize, headerSize, ptBodySize, romBypassVectorPresent]() {
+            return usprintf("Full size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\nROM bypass vector: %s\nNumber of entries: %u\nHeader version: %02Xh\nEntry version: %02Xh\n"
+                            "Header length: %02Xh\nFlash cycle life: %04Xh\nFlash cycle limit: %04Xh\nUMA size: %Xh\nFlags: %Xh\nFITC version: %u.%u.%u.%u\nChecksum: %02Xh",
+                            ptSize, ptSize,
+                            headerSize, headerSize,
+                            ptBodySize, ptBodySize,
+                            (romBypassVectorPresent ? "present" : "absent"),
+                            infoHeader.NumEntries,
+                            infoHeader.HeaderVersion,
+                            infoHeader.EntryVersion,
+                            infoHeader.HeaderLength,
+                            infoHeader.FlashCycleLife,
+                            infoHeader.FlashCycleLimit,
+                            infoHeader.UmaSize,
+                            infoHeader.Flags,
+                            infoHeader.FitcMajor, infoHeader.FitcMinor, infoHeader.FitcHotfix, infoHeader.FitcBuild,
+                            infoHeader.HeaderChecksum);
+        };
         // TODO: verify header checksum8
     }
     
@@ -189,11 +195,14 @@ USTATUS MeParser::parseFptRegion(const UByteArray & region, const UModelIndex &
         
         // Get info
         name = visibleAsciiOrHex((UINT8*)ptEntry->Name, 4);
-        info = usprintf("Full size: %Xh (%u)\nPartition offset: %Xh\nPartition length: %Xh\nPartition type: %02Xh",
-                        (UINT32)sizeof(FPT_HEADER_ENTRY), (UINT32)sizeof(FPT_HEADER_ENTRY),
-                        ptEntry->Offset,
-                        ptEntry->Size,
-                        ptEntry->Type);
+        const FPT_HEADER_ENTRY infoEntry = *ptEntry;
+        info = [infoEntry]() {
+            return usprintf("Full size: %Xh (%u)\nPartition offset: %Xh\nPartition length: %Xh\nPartition type: %02Xh",
+                            (UINT32)sizeof(FPT_HEADER_ENTRY), (UINT32)sizeof(FPT_HEADER_ENTRY),
+                            infoEntry.Offset,
+                            infoEntry.Size,
+                            infoEntry.Type);
+        };
         
         // Add tree item
         const UINT8 type = (ptEntry->Offset != 0 && ptEntry->Offset != 0xFFFFFFFF && ptEntry->Size != 0 && ptEntry->EntryValid != 0xFF) ? Subtypes::ValidFptEntry : Subtypes::InvalidFptEntry;
@@ -305,9 +314,13 @@ make_partition_table_consistent:
             UModelIndex partitionIndex;
             // Get info
             name = visibleAsciiOrHex((UINT8*) partitions[i].ptEntry.Name, 4);
-            info = usprintf("Full size: %Xh (%u)\nPartition type: %02Xh\n",
-                            (UINT32)partition.size(), (UINT32)partition.size(),
-                            partitions[i].ptEntry.Type);
+            const UINT32 partitionSize = (UINT32)partition.size();
+            const UINT8 partitionType = partitions[i].ptEntry.Type;
+            info = [partitionSize, partitionType]() {
+                return usprintf("Full size: %Xh (%u)\nPartition type: %02Xh\n",
+                                partitionSize, partitionSize,
+                                partitionType);
+            };
             
             // Add tree item
             UINT8 type = Subtypes::CodeFptPartition + partitions[i].ptEntry.Type;
@@ -321,7 +334,7 @@ make_partition_table_consistent:
         else if (partitions[i].type == Types::Padding) {
             // Get info
             name = UString("Padding");
-            info = usprintf("Full size: %Xh (%u)", (UINT32)partition.size(), (UINT32)partition.size());
+            info = fullSizeInfo((UINT32)partition.size());
             
             // Add tree item
             model->addItem(partitions[i].ptEntry.Offset, Types::Padding, getPaddingType(partition), name, UString(), info, UByteArray(), partition, UByteArray(), Fixed, parent);
@@ -346,22 +359,26 @@ USTATUS MeParser::parseIfwi16Region(const UByteArray & region, const UModelIndex
     UByteArray header = region.left(ptSize);
     
     UString name = UString("IFWI 1.6 header");
-    UString info = usprintf("Full size: %Xh (%u)\n"
-                            "Data  partition offset: %Xh\nData  partition size:   %Xh\n"
-                            "Boot1 partition offset: %Xh\nBoot1 partition size:   %Xh\n"
-                            "Boot2 partition offset: %Xh\nBoot2 partition size:   %Xh\n"
-                            "Boot3 partition offset: %Xh\nBoot3 partition size:   %Xh\n"
-                            "Boot4 partition offset: %Xh\nBoot4 partition size:   %Xh\n"
-                            "Boot5 partition offset: %Xh\nBoot5 partition size:   %Xh\n"
-                            "Checksum: %" PRIX64 "h",
-                            (UINT32)header.size(), (UINT32)header.size(),
-                            ifwiHeader->DataPartition.Offset, ifwiHeader->DataPartition.Size,
-                            ifwiHeader->BootPartition[0].Offset, ifwiHeader->BootPartition[0].Size,
-                            ifwiHeader->BootPartition[1].Offset, ifwiHeader->BootPartition[1].Size,
-                            ifwiHeader->BootPartition[2].Offset, ifwiHeader->BootPartition[2].Size,
-                            ifwiHeader->BootPartition[3].Offset, ifwiHeader->BootPartition[3].Size,
-                            ifwiHeader->BootPartition[4].Offset, ifwiHeader->BootPartition[4].Size,
-                            ifwiHeader->Checksum);
+    const IFWI_16_LAYOUT_HEADER infoHeader = *ifwiHeader;
+    const UINT32 headerSize = (UINT32)header.size();
+    ItemInfoFormatter info = [infoHeader, headerSize]() {
+        return usprintf("Full size: %Xh (%u)\n"
+                        "Data  partition offset: %Xh\nData  partition size:   %Xh\n"
+                        "Boot1 partition offset: %Xh\nBoot1 partition size:   %Xh\n"
+                        "Boot2 partition offset: %Xh\nBoot2 partition size:   %Xh\n"
+                        "Boot3 partition offset: %Xh\nBoot3 partition size:   %Xh\n"
+                        "Boot4 partition offset: %Xh\nBoot4 partition size:   %Xh\n"
+                        "Boot5 partition offset: %Xh\nBoot5 partition size:   %Xh\n"
+                        "Checksum: %" PRIX64 "h",
+                        headerSize, headerSize,
+                        infoHeader.DataPartition.Offset, infoHeader.DataPartition.Size,
+                        infoHeader.BootPartition[0].Offset, infoHeader.BootPartition[0].Size,
+                        infoHeader.BootPartition[1].Offset, infoHeader.BootPartition[1].Size,
+                        infoHeader.BootPartition[2].Offset, infoHeader.BootPartition[2].Size,
+                        infoHeader.BootPartition[3].Offset, infoHeader.BootPartition[3].Size,
+                        infoHeader.BootPartition[4].Offset, infoHeader.BootPartition[4].Size,
+                        infoHeader.Checksum);
+    };
     // Add tree item
     index = model->addItem(0, Types::IfwiHeader, 0, name, UString(), info, UByteArray(), header, UByteArray(), Fixed, parent);
     
@@ -471,7 +488,8 @@ make_partition_table_consistent:
             }
             
             // Get info
-            info = usprintf("Full size: %Xh (%u)\n", (UINT32)partition.size(), (UINT32)partition.size());
+            const UINT32 partitionSize = (UINT32)partition.size();
+            info = [partitionSize]() { return usprintf("Full size: %Xh (%u)\n", partitionSize, partitionSize); };
             
             // Add tree item
             partitionIndex = model->addItem(partitions[i].ptEntry.Offset, partitions[i].type, partitions[i].subtype, name, UString(), info, UByteArray(), partition, UByteArray(), Fixed, parent);
@@ -490,7 +508,7 @@ make_partition_table_consistent:
         else if (partitions[i].type == Types::Padding) {
             // Get info
             name = UString("Padding");
-            info = usprintf("Full size: %Xh (%u)", (UINT32)partition.size(), (UINT32)partition.size());
+            info = fullSizeInfo((UINT32)partition.size());
             
             // Add tree item
             model->addItem(partitions[i].ptEntry.Offset, Types::Padding, getPaddingType(partition), name, UString(), info, UByteArray(), partition, UByteArray(), Fixed, parent);
@@ -516,28 +534,32 @@ USTATUS MeParser::parseIfwi17Region(const UByteArray & region, const UModelIndex
     UByteArray header = region.left(ptSize);
     
     UString name = UString("IFWI 1.7 header");
-    UString info = usprintf("Full size: %Xh (%u)\n"
-                            "Flags: %02Xh\n"
-                            "Reserved: %02Xh\n"
-                            "Checksum: %Xh\n"
-                            "Data  partition offset: %Xh\nData  partition size:   %Xh\n"
-                            "Boot1 partition offset: %Xh\nBoot1 partition size:   %Xh\n"
-                            "Boot2 partition offset: %Xh\nBoot2 partition size:   %Xh\n"
-                            "Boot3 partition offset: %Xh\nBoot3 partition size:   %Xh\n"
-                            "Boot4 partition offset: %Xh\nBoot4 partition size:   %Xh\n"
-                            "Boot5 partition offset: %Xh\nBoot5 partition size:   %Xh\n"
-                            "Temp page offset:       %Xh\nTemp page size:         %Xh\n",
-                            (UINT32)header.size(), (UINT32)header.size(),
-                            ifwiHeader->Flags,
-                            ifwiHeader->Reserved,
-                            ifwiHeader->Checksum,
-                            ifwiHeader->DataPartition.Offset, ifwiHeader->DataPartition.Size,
-                            ifwiHeader->BootPartition[0].Offset, ifwiHeader->BootPartition[0].Size,
-                            ifwiHeader->BootPartition[1].Offset, ifwiHeader->BootPartition[1].Size,
-                            ifwiHeader->BootPartition[2].Offset, ifwiHeader->BootPartition[2].Size,
-                            ifwiHeader->BootPartition[3].Offset, ifwiHeader->BootPartition[3].Size,
-                            ifwiHeader->BootPartition[4].Offset, ifwiHeader->BootPartition[4].Size,
-                            ifwiHeader->TempPage.Offset, ifwiHeader->TempPage.Size);
+    const IFWI_17_LAYOUT_HEADER infoHeader = *ifwiHeader;
+    const UINT32 headerSize = (UINT32)header.size();
+    ItemInfoFormatter info = [infoHeader, headerSize]() {
+        return usprintf("Full size: %Xh (%u)\n"
+                        "Flags: %02Xh\n"
+                        "Reserved: %02Xh\n"
+                        "Checksum: %Xh\n"
+                        "Data  partition offset: %Xh\nData  partition size:   %Xh\n"
+                        "Boot1 partition offset: %Xh\nBoot1 partition size:   %Xh\n"
+                        "Boot2 partition offset: %Xh\nBoot2 partition size:   %Xh\n"
+                        "Boot3 partition offset: %Xh\nBoot3 partition size:   %Xh\n"
+                        "Boot4 partition offset: %Xh\nBoot4 partition size:   %Xh\n"
+                        "Boot5 partition offset: %Xh\nBoot5 partition size:   %Xh\n"
+                        "Temp page offset:       %Xh\nTemp page size:         %Xh\n",
+                        headerSize, headerSize,
+                        infoHeader.Flags,
+                        infoHeader.Reserved,
+                        infoHeader.Checksum,
+                        infoHeader.DataPartition.Offset, infoHeader.DataPartition.Size,
+                        infoHeader.BootPartition[0].Offset, infoHeader.BootPartition[0].Size,
+                        infoHeader.BootPartition[1].Offset, infoHeader.BootPartition[1].Size,
+                        infoHeader.BootPartition[2].Offset, infoHeader.BootPartition[2].Size,
+                        infoHeader.BootPartition[3].Offset, infoHeader.BootPartition[3].Size,
+                        infoHeader.BootPartition[4].Offset, infoHeader.BootPartition[4].Size,
+                        infoHeader.TempPage.Offset, infoHeader.TempPage.Size);
+    };
     // Add tree item
     index = model->addItem(0, Types::IfwiHeader, 0, name, UString(), info, UByteArray(), header, UByteArray(), Fixed, parent);
     
@@ -659,7 +681,8 @@ make_partition_table_consistent:
             }
             
             // Get info
-            info = usprintf("Full size: %Xh (%u)\n", (UINT32)partition.size(), (UINT32)partition.size());
+            const UINT32 partitionSize = (UINT32)partition.size();
+            info = [partitionSize]() { return usprintf("Full size: %Xh (%u)\n", partitionSize, partitionSize); };
             
             // Add tree item
             partitionIndex = model->addItem(partitions[i].ptEntry.Offset, partitions[i].type, partitions[i].subtype, name, UString(), info, UByteArray(), partition, UByteArray(), Fixed, parent);
@@ -685,7 +708,7 @@ make_partition_table_consistent:
         else if (partitions[i].type == Types::Padding) {
             // Get info
             name = UString("Padding");
-            info = usprintf("Full size: %Xh (%u)", (UINT32)partition.size(), (UINT32)partition.size());
+            info = fullSizeInfo((UINT32)partition.size());
             
             // Add tree item
             model->addItem(partitions[i].ptEntry.Offset, Types::Padding, getPaddingType(partition), name, UString(), info, UByteArray(), partition, UByteArray(), Fixed, parent);
@@ -37,6 +37,8 @@ public:
     std::vector<std::pair<UString, UModelIndex> > getMessages() const { return messagesVector; }
     // Clears messages
     void clearMessages() { messagesVector.clear(); }
+    // Append messages of another parser
+    void addMessages(const std::vector<std::pair<UString, UModelIndex> > & messages) { messagesVector.insert(messagesVector.end(), messages.begin(), messages.end()); }
 
     // ME parsing
     USTATUS parseMeRegionBody(const UModelIndex & index);
@@ -65,6 +67,7 @@ public:
     std::vector<std::pair<UString, UModelIndex> > getMessages() const { return std::vector<std::pair<UString, UModelIndex> >(); }
     // Clears messages
     void clearMessages() {}
+    void addMessages(const std::vector<std::pair<UString, UModelIndex> > &) {}
 
     // ME parsing
     USTATUS parseMeRegionBody(const UModelIndex & index) { U_UNUSED_PARAMETER(index); return U_SUCCESS; }
@@ -13,6 +13,7 @@
  */
 
 #ifdef U_ENABLE_NVRAM_PARSING_SUPPORT
+#include <cstddef>
 #include <map>
 
 #include "nvramparser.h"
@@ -22,6 +23,7 @@
 #include "nvram.h"
 #include "ffs.h"
 #include "intel_microcode.h"
+#include "kaitaiprobe.h"
 
 #include "umemstream.h"
 #include "kaitai/kaitaistream.h"
@@ -40,6 +42,44 @@
 #define MIN(x, y) (((x) < (y)) ? (x) : (y))
 #endif
 
+// Info of VSS and VSS2 variables, followed by info specific to the variable format
+static ItemInfoFormatter vssVariableInfo(const EFI_GUID & guid, const UINT32 variableSize, const UINT32 headerSize, const UINT32 bodySize,
+                                         const UINT8 state, const UINT8 reserved, const UINT32 attributes, const ItemInfoFormatter & specificInfo)
+{
+    return [guid, variableSize, headerSize, bodySize, state, reserved, attributes, specificInfo]() {
+        return UString("Variable GUID: ") + guidToUString(guid, false) + "\n"
+        + usprintf("Full size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\nState: %02Xh\nReserved: %02Xh\nAttributes: %08Xh (",
+                   variableSize, variableSize,
+                   headerSize, headerSize,
+                   bodySize, bodySize,
+                   state,
+                   reserved,
+                   attributes) + vssAttributesToUString(attributes) + UString(")")
+        + (specificInfo ? specificInfo() : UString());
+    };
+}
+
+// Info common to all EVSA entries
+static UString evsaEntryInfo(const UINT32 entrySize, const UINT32 headerSize, const UINT32 bodySize, const UINT8 type, const UINT8 checksum, const UINT8 calculated)
+{
+    return usprintf("Full size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\nType: %02Xh\nChecksum: %02Xh",
+                    entrySize, entrySize,
+                    headerSize, headerSize,
+                    bodySize, bodySize,
+                    type,
+                    checksum)
+    + (checksum != calculated ? usprintf(", invalid, should be %02Xh", calculated) : UString(", valid"));
+}
+
+// Info specific to authenticated VSS and VSS2 variables
+static ItemInfoFormatter vssAuthVariableInfo(const UINT64 monotonicCounter, const EFI_TIME & timestamp, const UINT32 pubKeyIndex)
+{
+    return [monotonicCounter, timestamp, pubKeyIndex]() {
+        return usprintf("\nMonotonic counter: %" PRIX64 "h\nTimestamp: ", monotonicCounter) + efiTimeToUString(timestamp)
+        + usprintf("\nPubKey index: %u", pubKeyIndex);
+    };
+}
+
 USTATUS NvramParser::parseNvarStore(const UModelIndex & index)
 {
     // Sanity check
@@ -52,12 +92,20 @@ USTATUS NvramParser::parseNvarStore(const UModelIndex & index)
     if (nvar.isEmpty())
         return U_SUCCESS;
 
-    // Obtain required fields from parsing data
+    // Obtain required fields from parsing data, NVAR store can be found inside a file or inside an NVAR entry
     UINT8 emptyByte = 0xFF;
-    if (model->hasEmptyParsingData(index) == false) {
-        UByteArray data = model->parsingData(index);
-        const VOLUME_PARSING_DATA* pdata = (const VOLUME_PARSING_DATA*)data.constData();
-        emptyByte = pdata->emptyByte;
+    const FILE_PARSING_DATA* fdata = model->fileParsingData(index);
+    const NVAR_ENTRY_PARSING_DATA* ndata = model->nvarEntryParsingData(index);
+    if (fdata) {
+        emptyByte = fdata->emptyByte;
+    }
+    else if (ndata) {
+        emptyByte = ndata->emptyByte;
+    }
+    
+    // No need to parse further if the parser will certainly fail
+    if (probeAmiNvar((const UINT8*)nvar.constData(), (UINT32)nvar.size()) != U_SUCCESS) {
+        return U_INVALID_STORE;
     }
     
     try {
@@ -72,8 +120,9 @@ USTATUS NvramParser::parseNvarStore(const UModelIndex & index)
             UINT8 subtype = Subtypes::FullNvarEntry;
             UString name;
             UString text;
-            UString info;
-            UString guid;
+            ItemInfoFormatter info;
+            bool hasGuid = false;
+            EFI_GUID guid = {};
             UByteArray header;
             UByteArray body;
             UByteArray tail;
@@ -87,9 +136,9 @@ USTATUS NvramParser::parseNvarStore(const UModelIndex & index)
                 UByteArray padding = nvar.mid(entry->offset(), unparsedSize);
 
                 // Get info
-                UString info = usprintf("Full size: %Xh (%u)", (UINT32)padding.size(), (UINT32)padding.size());
+                info = fullSizeInfo((UINT32)padding.size());
 
-                if ((UINT32)padding.count(emptyByte) == unparsedSize) { // Free space
+                if ((UINT32)padding.size() == unparsedSize && isFilledWith(padding, emptyByte)) { // Free space
                     // Add tree item
                     model->addItem(localOffset + entry->offset(), Types::FreeSpace, 0, UString("Free space"), UString(), info, UByteArray(), padding, UByteArray(), Fixed, index);
                 }
@@ -108,9 +157,13 @@ USTATUS NvramParser::parseNvarStore(const UModelIndex & index)
                 UByteArray guidArea = nvar.right(guidAreaSize);
                 // Get info
                 name = UString("GUID store");
-                info = usprintf("Full size: %Xh (%u)\nGUIDs in store: %u",
-                                (UINT32)guidArea.size(), (UINT32)guidArea.size(),
-                                guidsInStore);
+                const UINT32 guidAreaFullSize = (UINT32)guidArea.size();
+                const UINT16 guids = guidsInStore;
+                info = [guidAreaFullSize, guids]() {
+                    return usprintf("Full size: %Xh (%u)\nGUIDs in store: %u",
+                                    guidAreaFullSize, guidAreaFullSize,
+                                    guids);
+                };
                 // Add tree item
                 model->addItem((UINT32)(localOffset + entry->offset() + padding.size()), Types::NvarGuidStore, 0, name, UString(), info, UByteArray(), guidArea, UByteArray(), Fixed, index);
 
@@ -154,8 +207,8 @@ USTATUS NvramParser::parseNvarStore(const UModelIndex & index)
                         if ((UINT32)previousEntry->next() + (UINT32)previousEntry->offset() == (UINT32)entry->offset()) { // Previous link is present and valid
                             prevEntryIndex = index.model()->index(i, 0, index);
                             // Make sure that we are linking to a valid entry
-                            NVAR_ENTRY_PARSING_DATA pd = readUnaligned((NVAR_ENTRY_PARSING_DATA*)model->parsingData(prevEntryIndex).constData());
-                            if (!pd.isValid) {
+                            const NVAR_ENTRY_PARSING_DATA* pd = model->nvarEntryParsingData(prevEntryIndex);
+                            if (!pd || !pd->isValid) {
                                 prevEntryIndex = UModelIndex();
                             }
                             break;
@@ -188,14 +241,15 @@ USTATUS NvramParser::parseNvarStore(const UModelIndex & index)
                 for (const auto & ch : *entry_body->ucs2_name()->ucs2_chars()) {
                     temp += UByteArray((const char*)&ch, sizeof(ch));
                 }
-                text = uFromUcs2(temp.constData());
+                text = uFromUcs2(temp.constData(), temp.size() / 2);
             }
 
             // Obtain GUID
             if (!entry_body->_is_null_guid()) { // GUID is stored in the entry itself
                 const EFI_GUID g = readUnaligned((EFI_GUID*)entry_body->guid().c_str());
                 name = guidToUString(g);
-                guid = guidToUString(g, false);
+                hasGuid = true;
+                guid = g;
             }
             else { // GUID is stored in GUID store at the end of the NVAR store
                 // Grow the GUID store if needed
@@ -205,7 +259,8 @@ USTATUS NvramParser::parseNvarStore(const UModelIndex & index)
                 // The list begins at the end of the store and goes backwards
                 const EFI_GUID g = readUnaligned((EFI_GUID*)(nvar.constData() + nvar.size()) - (entry_body->guid_index() + 1));
                 name = guidToUString(g);
-                guid = guidToUString(g, false);
+                hasGuid = true;
+                guid = g;
             }
 
 processing_done:
@@ -214,71 +269,94 @@ processing_done:
             body = nvar.mid(entry->offset() + sizeof(NVAR_ENTRY_HEADER) + entry_body->data_start_offset(), entry_body->data_size());
             tail = nvar.mid(entry->end_offset() - entry_body->extended_header_size(), entry_body->extended_header_size());
 
-            // Add GUID info for valid entries
-            if (!guid.isEmpty())
-                info += UString("Variable GUID: ") + guid + "\n";
+            if (model->infoEnabled()) {
+                // Values shown in info are taken from the entry here, but only formatted when the info is requested
+                const bool hasGuidIndex = !entry_body->_is_null_guid_index();
+                const UINT8 guidIndex = hasGuidIndex ? entry_body->guid_index() : 0;
+                const UINT32 entrySize = entry->size();
+                const UINT32 headerSize = (UINT32)header.size();
+                const UINT32 bodySize = (UINT32)body.size();
+                const UINT32 tailSize = (UINT32)tail.size();
+                const NVAR_ENTRY_HEADER entryHeader = readUnaligned((NVAR_ENTRY_HEADER*)header.constData());
+                const bool hasNext = entry->next() != 0xFFFFFF;
+                const UINT32 nextOffset = localOffset + entry->offset() + (UINT32)entry->next();
+                const UINT16 extendedHeaderSize = entry_body->extended_header_size();
+                const bool hasChecksum = extendedHeaderSize > 0 && !entry_body->_is_null_extended_header_checksum();
+                const UINT8 checksum = hasChecksum ? entry_body->extended_header_checksum() : 0;
+                const bool hasTimestamp = extendedHeaderSize > 0 && !entry_body->_is_null_extended_header_timestamp();
+                const UINT64 timestamp = hasTimestamp ? entry_body->extended_header_timestamp() : 0;
+                const bool hasHash = extendedHeaderSize > 0 && !entry_body->_is_null_extended_header_hash();
+                const UByteArray hash = hasHash ? UByteArray(entry_body->extended_header_hash().c_str(), entry_body->extended_header_hash().size()) : UByteArray();
 
-            // Add GUID index information
-            if (!entry_body->_is_null_guid_index())
-                info += usprintf("GUID index: %u\n", entry_body->guid_index());
+                info = [hasGuid, guid, hasGuidIndex, guidIndex, entrySize, headerSize, bodySize, tailSize, entryHeader, hasNext, nextOffset,
+                        extendedHeaderSize, hasChecksum, checksum, hasTimestamp, timestamp, hasHash, hash, body, tail]() {
+                    UString info;
 
-            // Add header, body and extended data info
-            info += usprintf("Full size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\nTail size: %Xh (%u)",
-                             entry->size(), entry->size(),
-                             (UINT32)header.size(), (UINT32)header.size(),
-                             (UINT32)body.size(), (UINT32)body.size(),
-                             (UINT32)tail.size(), (UINT32)tail.size());
+                    // Add GUID info for valid entries
+                    if (hasGuid)
+                        info += UString("Variable GUID: ") + guidToUString(guid, false) + "\n";
 
-            // Add attributes info
-            const NVAR_ENTRY_HEADER entryHeader = readUnaligned((NVAR_ENTRY_HEADER*)header.constData());
-            info += usprintf("\nAttributes: %02Xh", entryHeader.Attributes);
+                    // Add GUID index information
+                    if (hasGuidIndex)
+                        info += usprintf("GUID index: %u\n", guidIndex);
 
-            // Translate attributes to text
-            if (entryHeader.Attributes != 0x00 && entryHeader.Attributes != 0xFF)
-                info += UString(" (") + nvarAttributesToUString(entryHeader.Attributes) + UString(")");
+                    // Add header, body and extended data info
+                    info += usprintf("Full size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\nTail size: %Xh (%u)",
+                                     entrySize, entrySize,
+                                     headerSize, headerSize,
+                                     bodySize, bodySize,
+                                     tailSize, tailSize);
 
-            // Add next node info
-            if (entry->next() != 0xFFFFFF)
-                info += usprintf("\nNext node at offset: %Xh", localOffset + entry->offset() + (UINT32)entry->next());
+                    // Add attributes info
+                    info += usprintf("\nAttributes: %02Xh", entryHeader.Attributes);
 
-            // Add extended header info
-            if (entry_body->extended_header_size() > 0) {
-                info += usprintf("\nExtended header size: %Xh (%u)",
-                                 entry_body->extended_header_size(), entry_body->extended_header_size());
+                    // Translate attributes to text
+                    if (entryHeader.Attributes != 0x00 && entryHeader.Attributes != 0xFF)
+                        info += UString(" (") + nvarAttributesToUString(entryHeader.Attributes) + UString(")");
 
-                const UINT8 extendedAttributes = *tail.constData();
-                info += usprintf("\nExtended attributes: %02Xh (", extendedAttributes) + nvarExtendedAttributesToUString(extendedAttributes) + UString(")");
+                    // Add next node info
+                    if (hasNext)
+                        info += usprintf("\nNext node at offset: %Xh", nextOffset);
 
-                // Add checksum
-                if (!entry_body->_is_null_extended_header_checksum()) {
-                    UINT8 calculatedChecksum = 0;
-                    UByteArray wholeBody = body + tail;
+                    // Add extended header info
+                    if (extendedHeaderSize > 0) {
+                        info += usprintf("\nExtended header size: %Xh (%u)",
+                                         extendedHeaderSize, extendedHeaderSize);
 
-                    // Include entry body
-                    UINT8* start = (UINT8*)wholeBody.constData();
-                    for (UINT8* p = start; p < start + wholeBody.size(); p++) {
-                        calculatedChecksum += *p;
-                    }
-                    // Include entry size and flags
-                    start = (UINT8*)&entryHeader.Size;
-                    for (UINT8*p = start; p < start + sizeof(UINT16); p++) {
-                        calculatedChecksum += *p;
-                    }
-                    // Include entry attributes
-                    calculatedChecksum += entryHeader.Attributes;
-                    info += usprintf("\nChecksum: %02Xh, ", entry_body->extended_header_checksum())
-                     + (calculatedChecksum ? usprintf(", invalid, should be %02Xh", 0x100 - calculatedChecksum) : UString(", valid"));
-                }
+                        const UINT8 extendedAttributes = *tail.constData();
+                        info += usprintf("\nExtended attributes: %02Xh (", extendedAttributes) + nvarExtendedAttributesToUString(extendedAttributes) + UString(")");
 
-                // Add timestamp
-                if (!entry_body->_is_null_extended_header_timestamp())
-                    info += usprintf("\nTimestamp: %" PRIX64 "h", entry_body->extended_header_timestamp());
+                        // Add checksum
+                        if (hasChecksum) {
+                            UINT8 calculatedChecksum = 0;
+                            UByteArray wholeBody = body + tail;
 
-                // Add hash
-                if (!entry_body->_is_null_extended_header_hash()) {
-                    UByteArray hash = UByteArray(entry_body->extended_header_hash().c_str(), entry_body->extended_header_hash().size());
-                    info += UString("\nHash: ") + UString(hash.toHex().constData());
-                }
+                            // Include entry body
+                            UINT8* start = (UINT8*)wholeBody.constData();
+                            for (UINT8* p = start; p < start + wholeBody.size(); p++) {
+                                calculatedChecksum += *p;
+                            }
+                            // Include entry size and flags
+                            start = (UINT8*)&entryHeader.Size;
+                            for (UINT8*p = start; p < start + sizeof(UINT16); p++) {
+                                calculatedChecksum += *p;
+                            }
+                            // Include entry attributes
+                            calculatedChecksum += entryHeader.Attributes;
+                            info += usprintf("\nChecksum: %02Xh, ", checksum)
+                             + (calculatedChecksum ? usprintf(", invalid, should be %02Xh", 0x100 - calculatedChecksum) : UString(", valid"));
+                        }
+
+                        // Add timestamp
+                        if (hasTimestamp)
+                            info += usprintf("\nTimestamp: %" PRIX64 "h", timestamp);
+
+                        // Add hash
+                        if (hasHash)
+                            info += UString("\nHash: ") + UString(hash.toHex().constData());
+                    }
+                    return info;
+                };
             }
 
             // Add tree item
@@ -286,7 +364,7 @@ processing_done:
             currentEntryIndex++;
 
             // Set parsing data
-            model->setParsingData(varIndex, UByteArray((const char*)&pdata, sizeof(pdata)));
+            model->setParsingData(varIndex, pdata);
 
             // Try parsing the entry data as NVAR storage if it begins with NVAR signature
             if ((subtype == Subtypes::DataNvarEntry || subtype == Subtypes::FullNvarEntry)
@@ -301,6 +379,59 @@ processing_done:
     return U_SUCCESS;
 }
 
+void NvramParser::initStoreScanners()
+{
+    // Every store parser below starts with checking one of these signatures
+    const std::pair<UINT32, UINT32> signatures[] = {
+        std::make_pair((UINT32)0, (UINT32)NVRAM_VSS_STORE_SIGNATURE),
+        std::make_pair((UINT32)0, (UINT32)NVRAM_APPLE_SVS_STORE_SIGNATURE),
+        std::make_pair((UINT32)0, (UINT32)NVRAM_APPLE_NSS_STORE_SIGNATURE),
+        std::make_pair((UINT32)0, readUnaligned((const UINT32*)NVRAM_VSS2_AUTH_VAR_KEY_DATABASE_GUID.constData())),
+        std::make_pair((UINT32)0, readUnaligned((const UINT32*)NVRAM_VSS2_STORE_GUID.constData())),
+        std::make_pair((UINT32)0, readUnaligned((const UINT32*)NVRAM_FDC_STORE_GUID.constData())),
+        std::make_pair((UINT32)0, readUnaligned((const UINT32*)NVRAM_MAIN_STORE_VOLUME_GUID.constData())),
+        std::make_pair((UINT32)0, readUnaligned((const UINT32*)EDKII_WORKING_BLOCK_SIGNATURE_GUID.constData())), // Also covers VSS2 working block
+        std::make_pair((UINT32)0, (UINT32)INSYDE_FDC_STORE_SIGNATURE),
+        std::make_pair((UINT32)0, (UINT32)NVRAM_APPLE_SYSF_STORE_SIGNATURE),
+        std::make_pair((UINT32)0, (UINT32)NVRAM_APPLE_DIAG_STORE_SIGNATURE),
+        std::make_pair((UINT32)0, readUnaligned((const UINT32*)NVRAM_PHOENIX_FLASH_MAP_SIGNATURE.constData())),
+        std::make_pair((UINT32)offsetof(EVSA_STORE_ENTRY, Signature), (UINT32)NVRAM_EVSA_STORE_SIGNATURE),
+        std::make_pair((UINT32)0, (UINT32)NVRAM_PHOENIX_CMDB_HEADER_SIGNATURE),
+        std::make_pair((UINT32)offsetof(OEM_ACTIVATION_PUBKEY, Magic), (UINT32)OEM_ACTIVATION_PUBKEY_MAGIC),
+        std::make_pair((UINT32)offsetof(OEM_ACTIVATION_MARKER, WindowsFlag), (UINT32)OEM_ACTIVATION_MARKER_WINDOWS_FLAG),
+        std::make_pair((UINT32)0, (UINT32)INTEL_MICROCODE_HEADER_VERSION_1),
+        std::make_pair((UINT32)EFI_FV_SIGNATURE_OFFSET, (UINT32)EFI_FV_SIGNATURE),
+    };
+
+    storeScanners.clear();
+    for (size_t i = 0; i < sizeof(signatures) / sizeof(signatures[0]); i++) {
+        size_t group = 0;
+        while (group < storeScanners.size() && storeScanners[group].first != signatures[i].first)
+            group++;
+        if (group == storeScanners.size())
+            storeScanners.push_back(std::make_pair(signatures[i].first, SignatureScanner()));
+        storeScanners[group].second.add(signatures[i].second);
+    }
+}
+
+UINT32 NvramParser::findNextStoreCandidate(const UByteArray & volumeBody, const UINT32 from, std::vector<INT64> & nextCandidates)
+{
+    // Returns the first offset not less than from where one of the known stores can start, or the body size if there is none
+    // Next candidate of every group is remembered until the offset moves past it
+    const UINT32 volumeBodySize = (UINT32)volumeBody.size();
+    UINT32 candidate = volumeBodySize;
+    for (size_t i = 0; i < storeScanners.size(); i++) {
+        if (nextCandidates[i] < (INT64)from) {
+            const UINT32 signatureOffset = storeScanners[i].first;
+            INT32 id;
+            UINT32 found = storeScanners[i].second.findNext((const UINT8*)volumeBody.constData(), volumeBodySize, from + signatureOffset, volumeBodySize, id);
+            nextCandidates[i] = (id < 0) ? (INT64)volumeBodySize : (INT64)(found - signatureOffset);
+        }
+        candidate = (UINT32)MIN((INT64)candidate, nextCandidates[i]);
+    }
+    return candidate;
+}
+
 USTATUS NvramParser::parseNvramVolumeBody(const UModelIndex & index,const UINT32 fdcStoreSizeOverride)
 {
     // Sanity check
@@ -309,9 +440,8 @@ USTATUS NvramParser::parseNvramVolumeBody(const UModelIndex & index,const UINT32
     
     // Obtain required fields from parsing data
     UINT8 emptyByte = 0xFF;
-    if (model->hasEmptyParsingData(index) == false) {
-        UByteArray data = model->parsingData(index);
-        const VOLUME_PARSING_DATA* pdata = (const VOLUME_PARSING_DATA*)data.constData();
+    const VOLUME_PARSING_DATA* pdata = model->volumeParsingData(index);
+    if (pdata) {
         emptyByte = pdata->emptyByte;
     }
     
@@ -322,7 +452,10 @@ USTATUS NvramParser::parseNvramVolumeBody(const UModelIndex & index,const UINT32
     UByteArray volumeBody = model->body(index);
     const UINT32 volumeBodySize = (UINT32)volumeBody.size();
 
-    // Iterate over all bytes inside the volume body, trying to parse every next byte offset by one of the known parsers
+    // Iterate over all offsets inside the volume body where one of the known store signatures is found, trying to parse them by the known parsers
+    if (storeScanners.empty())
+        initStoreScanners();
+    std::vector<INT64> nextCandidates(storeScanners.size(), -1);
     UByteArray outerPadding;
     UINT32 previousStoreEndOffset = 0;
     for (UINT32 storeOffset = 0;
@@ -331,6 +464,18 @@ USTATUS NvramParser::parseNvramVolumeBody(const UModelIndex & index,const UINT32
         UString name, text, info;
         UByteArray header, body;
         
+        // Everything before the next candidate is padding
+        UINT32 candidateOffset = findNextStoreCandidate(volumeBody, storeOffset, nextCandidates);
+        if (candidateOffset > storeOffset) {
+            if (fdcStoreSizeOverride == 0) {
+                outerPadding += volumeBody.mid(storeOffset, candidateOffset - storeOffset);
+            }
+            storeOffset = candidateOffset;
+            if (storeOffset >= volumeBodySize) {
+                break;
+            }
+        }
+        
         // VSS
         try {
             if (volumeBodySize - storeOffset < sizeof(VSS_VARIABLE_STORE_HEADER)) {
@@ -362,6 +507,10 @@ USTATUS NvramParser::parseNvramVolumeBody(const UModelIndex & index,const UINT32
             }
             
             // Try parsing VSS store candidate
+            if (probeEdk2Vss((const UINT8*)vss.constData(), (UINT32)vss.size()) != U_SUCCESS) {
+                // No need to parse further, the parser will certainly fail
+                goto not_vss;
+            }
             umemstream is(vss.constData(), vss.size());
             kaitai::kstream ks(&is);
             edk2_vss_t parsed(&ks);
@@ -375,7 +524,7 @@ USTATUS NvramParser::parseNvramVolumeBody(const UModelIndex & index,const UINT32
             // VSS store at current offset parsed correctly
             // Check if we need to add a padding before it
             if (!outerPadding.isEmpty()) {
-                UString info = usprintf("Full size: %Xh (%u)", (UINT32)outerPadding.size(), (UINT32)outerPadding.size());
+                ItemInfoFormatter info = fullSizeInfo((UINT32)outerPadding.size());
                 model->addItem(localOffset + previousStoreEndOffset, Types::Padding, getPaddingType(outerPadding), UString("Padding"), UString(), info, UByteArray(), outerPadding, UByteArray(), Fixed, index);
                 outerPadding.clear();
             }
@@ -419,16 +568,16 @@ USTATUS NvramParser::parseNvramVolumeBody(const UModelIndex & index,const UINT32
                     if (entryOffset < storeSize) {
                         UByteArray freeSpace = vss.mid(entryOffset, storeSize - entryOffset);
                         // Add info
-                        info = usprintf("Full size: %Xh (%u)", (UINT32)freeSpace.size(), (UINT32)freeSpace.size());
+                        const ItemInfoFormatter sizeInfo = fullSizeInfo((UINT32)freeSpace.size());
                         
                         // Check that remaining unparsed bytes are actually empty
-                        if (freeSpace.count(emptyByte) == freeSpace.size()) { // Free space
+                        if (isFilledWith(freeSpace, emptyByte)) { // Free space
                             // Add tree item
-                            model->addItem(entryOffset, Types::FreeSpace, 0, UString("Free space"), UString(), info, UByteArray(), freeSpace, UByteArray(), Fixed, headerIndex);
+                            model->addItem(entryOffset, Types::FreeSpace, 0, UString("Free space"), UString(), sizeInfo, UByteArray(), freeSpace, UByteArray(), Fixed, headerIndex);
                         }
                         else {
                             // Add tree item
-                            model->addItem(entryOffset, Types::Padding, getPaddingType(freeSpace), UString("Padding"), UString(), info, UByteArray(), freeSpace, UByteArray(), Fixed, headerIndex);
+                            model->addItem(entryOffset, Types::Padding, getPaddingType(freeSpace), UString("Padding"), UString(), sizeInfo, UByteArray(), freeSpace, UByteArray(), Fixed, headerIndex);
                         }
                     }
                     break;
@@ -436,6 +585,7 @@ USTATUS NvramParser::parseNvramVolumeBody(const UModelIndex & index,const UINT32
                 
                 // This is a normal entry
                 UINT32 variableSize;
+                EFI_GUID variableGuid;
                 if (variable->is_intel_legacy()) { // Intel legacy
                     subtype = Subtypes::IntelVssEntry;
                     // Needs some additional parsing of variable->intel_legacy_data to separate the name from the value
@@ -444,39 +594,35 @@ USTATUS NvramParser::parseNvramVolumeBody(const UModelIndex & index,const UINT32
                     header = vss.mid(entryOffset, variable->len_intel_legacy_header() + textLengthInBytes);
                     body = vss.mid(entryOffset + header.size(), variable->len_total() - variable->len_intel_legacy_header() - textLengthInBytes);
                     variableSize = (UINT32)(header.size() + body.size());
-                    const EFI_GUID variableGuid = readUnaligned((const EFI_GUID*)(variable->vendor_guid().c_str()));
+                    variableGuid = readUnaligned((const EFI_GUID*)(variable->vendor_guid().c_str()));
                     name = guidToUString(variableGuid);
-                    info = UString("Variable GUID: ") + guidToUString(variableGuid, false) + "\n";
                 }
                 else if (variable->is_auth()) { // Authenticated
                     subtype = Subtypes::AuthVssEntry;
                     header = vss.mid(entryOffset, variable->len_auth_header() + variable->len_name_auth());
                     body = vss.mid(entryOffset + header.size(), variable->len_data_auth());
                     variableSize = (UINT32)(header.size() + body.size());
-                    const EFI_GUID variableGuid = readUnaligned((const EFI_GUID*)(variable->vendor_guid().c_str()));
+                    variableGuid = readUnaligned((const EFI_GUID*)(variable->vendor_guid().c_str()));
                     name = guidToUString(variableGuid);
                     text = uFromUcs2(variable->name_auth().c_str());
-                    info = UString("Variable GUID: ") + guidToUString(variableGuid, false) + "\n";
                 }
                 else if (!variable->_is_null_apple_data_crc32()) { // Apple CRC32
                     subtype = Subtypes::AppleVssEntry;
                     header = vss.mid(entryOffset, variable->len_apple_header() + variable->len_name());
                     body = vss.mid(entryOffset + header.size(), variable->len_data());
                     variableSize = (UINT32)(header.size() + body.size());
-                    const EFI_GUID variableGuid = readUnaligned((const EFI_GUID*)(variable->vendor_guid().c_str()));
+                    variableGuid = readUnaligned((const EFI_GUID*)(variable->vendor_guid().c_str()));
                     name = guidToUString(variableGuid);
                     text = uFromUcs2(variable->name().c_str());
-                    info = UString("Variable GUID: ") + guidToUString(variableGuid, false) + "\n";
                 }
                 else { // Standard
                     subtype = Subtypes::StandardVssEntry;
                     header = vss.mid(entryOffset, variable->len_standard_header() + variable->len_name());
                     body = vss.mid(entryOffset + header.size(), variable->len_data());
                     variableSize = (UINT32)(header.size() + body.size());
-                    const EFI_GUID variableGuid = readUnaligned((const EFI_GUID*)(variable->vendor_guid().c_str()));
+                    variableGuid = readUnaligned((const EFI_GUID*)(variable->vendor_guid().c_str()));
                     name = guidToUString(variableGuid);
                     text = uFromUcs2(variable->name().c_str());
-                    info = UString("Variable GUID: ") + guidToUString(variableGuid, false) + "\n";
                 }
                 
                 // Override variable type to Invalid, if needed
@@ -496,31 +642,27 @@ USTATUS NvramParser::parseNvramVolumeBody(const UModelIndex & index,const UINT32
                 + (UINT32)(variable->attributes()->reserved() << 7)
                 + (UINT32)(variable->attributes()->apple_data_checksum() << 31);
                 
-                // Add generic info
-                info += usprintf("Full size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\nState: %02Xh\nReserved: %02Xh\nAttributes: %08Xh (",
-                                 variableSize, variableSize,
-                                 (UINT32)header.size(), (UINT32)header.size(),
-                                 (UINT32)body.size(), (UINT32)body.size(),
-                                 variable->state(),
-                                 variable->reserved(),
-                                 variableAttributes) + vssAttributesToUString(variableAttributes) + UString(")");
-                
                 // Add specific info
+                ItemInfoFormatter specificInfo;
                 if (variable->is_auth()) {
                     UINT64 monotonicCounter = (UINT64)variable->len_name() + ((UINT64)variable->len_data() << 32);
-                    info += usprintf("\nMonotonic counter: %" PRIX64 "h\nTimestamp: ", monotonicCounter) + efiTimeToUString(*(const EFI_TIME*)variable->timestamp().c_str())
-                    + usprintf("\nPubKey index: %u", variable->pubkey_index());
+                    specificInfo = vssAuthVariableInfo(monotonicCounter, readUnaligned((const EFI_TIME*)variable->timestamp().c_str()), variable->pubkey_index());
                 }
                 else if (!variable->_is_null_apple_data_crc32()) {
-                    // Calculate CRC32 of the variable data
-                    UINT32 calculatedCrc32 = (UINT32)crc32(0, (const UINT8*)body.constData(), (uInt)body.size());
-                    
-                    info += usprintf("\nData checksum: %08Xh", variable->apple_data_crc32()) +
-                    (variable->apple_data_crc32() != calculatedCrc32 ? usprintf(", invalid, should be %08Xh", calculatedCrc32) : UString(", valid"));
+                    // CRC32 of the variable data is only calculated when info is requested
+                    const UINT32 dataCrc32 = variable->apple_data_crc32();
+                    const UByteArray data = body;
+                    specificInfo = [dataCrc32, data]() {
+                        UINT32 calculatedCrc32 = (UINT32)crc32(0, (const UINT8*)data.constData(), (uInt)data.size());
+                        return usprintf("\nData checksum: %08Xh", dataCrc32) +
+                        (dataCrc32 != calculatedCrc32 ? usprintf(", invalid, should be %08Xh", calculatedCrc32) : UString(", valid"));
+                    };
                 }
                 
                 // Add tree item
-                model->addItem(entryOffset, Types::VssEntry, subtype, name, text, info, header, body, UByteArray(), Fixed, headerIndex);
+                model->addItem(entryOffset, Types::VssEntry, subtype, name, text,
+                               vssVariableInfo(variableGuid, variableSize, (UINT32)header.size(), (UINT32)body.size(), variable->state(), variable->reserved(), variableAttributes, specificInfo),
+                               header, body, UByteArray(), Fixed, headerIndex);
                 
                 entryOffset += variableSize;
             }
@@ -565,6 +707,10 @@ not_vss:
             }
             
             // Try parsing VSS store candidate
+            if (probeEdk2Vss2((const UINT8*)vss2.constData(), (UINT32)vss2.size()) != U_SUCCESS) {
+                // No need to parse further, the parser will certainly fail
+                goto not_vss2;
+            }
             umemstream is(vss2.constData(), vss2.size());
             kaitai::kstream ks(&is);
             edk2_vss2_t parsed(&ks);
@@ -578,8 +724,8 @@ not_vss:
             // VSS2 store at current offset parsed correctly
             // Check if we need to add a padding before it
             if (!outerPadding.isEmpty()) {
-                info = usprintf("Full size: %Xh (%u)", (UINT32)outerPadding.size(), (UINT32)outerPadding.size());
-                model->addItem(localOffset + previousStoreEndOffset, Types::Padding, getPaddingType(outerPadding), UString("Padding"), UString(), info, UByteArray(), outerPadding, UByteArray(), Fixed, index);
+                const ItemInfoFormatter sizeInfo = fullSizeInfo((UINT32)outerPadding.size());
+                model->addItem(localOffset + previousStoreEndOffset, Types::Padding, getPaddingType(outerPadding), UString("Padding"), UString(), sizeInfo, UByteArray(), outerPadding, UByteArray(), Fixed, index);
                 outerPadding.clear();
             }
 
@@ -622,16 +768,16 @@ not_vss:
                     if (entryOffset < storeSize) {
                         UByteArray freeSpace = vss2.mid(entryOffset, storeSize - entryOffset);
                         // Add info
-                        info = usprintf("Full size: %Xh (%u)", (UINT32)freeSpace.size(), (UINT32)freeSpace.size());
+                        const ItemInfoFormatter sizeInfo = fullSizeInfo((UINT32)freeSpace.size());
                         
                         // Check that remaining unparsed bytes are actually empty
-                        if (freeSpace.count(emptyByte) == freeSpace.size()) { // Free space
+                        if (isFilledWith(freeSpace, emptyByte)) { // Free space
                             // Add tree item
-                            model->addItem(entryOffset, Types::FreeSpace, 0, UString("Free space"), UString(), info, UByteArray(), freeSpace, UByteArray(), Fixed, headerIndex);
+                            model->addItem(entryOffset, Types::FreeSpace, 0, UString("Free space"), UString(), sizeInfo, UByteArray(), freeSpace, UByteArray(), Fixed, headerIndex);
                         }
                         else {
                             // Add tree item
-                            model->addItem(entryOffset, Types::Padding, getPaddingType(freeSpace), UString("Padding"), UString(), info, UByteArray(), freeSpace, UByteArray(), Fixed, headerIndex);
+                            model->addItem(entryOffset, Types::Padding, getPaddingType(freeSpace), UString("Padding"), UString(), sizeInfo, UByteArray(), freeSpace, UByteArray(), Fixed, headerIndex);
                         }
                     }
                     break;
@@ -640,16 +786,16 @@ not_vss:
                 // This is a normal entry
                 UINT32 variableSize;
                 UINT32 alignmentSize;
+                EFI_GUID variableGuid;
                 if (variable->is_auth()) { // Authenticated
                     subtype = Subtypes::AuthVssEntry;
                     header = vss2.mid(entryOffset, variable->len_auth_header() + variable->len_name_auth());
                     body = vss2.mid(entryOffset + header.size(), variable->len_data_auth());
                     variableSize = (UINT32)(header.size() + body.size());
                     alignmentSize = variable->len_alignment_padding_auth();
-                    const EFI_GUID variableGuid = readUnaligned((const EFI_GUID*)(variable->vendor_guid().c_str()));
+                    variableGuid = readUnaligned((const EFI_GUID*)(variable->vendor_guid().c_str()));
                     name = guidToUString(variableGuid);
                     text = uFromUcs2(variable->name_auth().c_str());
-                    info = UString("Variable GUID: ") + guidToUString(variableGuid, false) + "\n";
                 }
                 else { // Standard
                     subtype = Subtypes::StandardVssEntry;
@@ -657,10 +803,9 @@ not_vss:
                     body = vss2.mid(entryOffset + header.size(), variable->len_data());
                     variableSize = (UINT32)(header.size() + body.size());
                     alignmentSize = variable->len_alignment_padding();
-                    const EFI_GUID variableGuid = readUnaligned((const EFI_GUID*)(variable->vendor_guid().c_str()));
+                    variableGuid = readUnaligned((const EFI_GUID*)(variable->vendor_guid().c_str()));
                     name = guidToUString(variableGuid);
                     text = uFromUcs2(variable->name().c_str());
-                    info = UString("Variable GUID: ") + guidToUString(variableGuid, false) + "\n";
                 }
                 
                 // Override variable type to Invalid if needed
@@ -679,24 +824,17 @@ not_vss:
                 + (variable->attributes()->append_write() << 6)
                 + (UINT32)(variable->attributes()->reserved() << 7);
                 
-                // Add generic info
-                info += usprintf("Full size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\nState: %02Xh\nReserved: %02Xh\nAttributes: %08Xh (",
-                                 variableSize, variableSize,
-                                 (UINT32)header.size(), (UINT32)header.size(),
-                                 (UINT32)body.size(), (UINT32)body.size(),
-                                 variable->state(),
-                                 variable->reserved(),
-                                 variableAttributes) + vssAttributesToUString(variableAttributes) + UString(")");
-                
                 // Add specific info
+                ItemInfoFormatter specificInfo;
                 if (variable->is_auth()) {
                     UINT64 monotonicCounter = (UINT64)variable->len_name() + ((UINT64)variable->len_data() << 32);
-                    info += usprintf("\nMonotonic counter: %" PRIX64 "h\nTimestamp: ", monotonicCounter) + efiTimeToUString(*(const EFI_TIME*)variable->timestamp().c_str())
-                    + usprintf("\nPubKey index: %u", variable->pubkey_index());
+                    specificInfo = vssAuthVariableInfo(monotonicCounter, readUnaligned((const EFI_TIME*)variable->timestamp().c_str()), variable->pubkey_index());
                 }
                 
                 // Add tree item
-                model->addItem(entryOffset, Types::VssEntry, subtype, name, text, info, header, body, UByteArray(), Fixed, headerIndex);
+                model->addItem(entryOffset, Types::VssEntry, subtype, name, text,
+                               vssVariableInfo(variableGuid, variableSize, (UINT32)header.size(), (UINT32)body.size(), variable->state(), variable->reserved(), variableAttributes, specificInfo),
+                               header, body, UByteArray(), Fixed, headerIndex);
                 
                 entryOffset += (variableSize + alignmentSize);
             }
@@ -744,6 +882,10 @@ not_vss2:
             }
             storeSize = MIN(volumeBodySize - storeOffset, storeSize);
         
+            if (probeEdk2Ftw((const UINT8*)volumeBody.constData() + storeOffset, storeSize) != U_SUCCESS) {
+                // No need to parse further, the parser will certainly fail
+                goto not_ftw;
+            }
             umemstream is(volumeBody.constData() + storeOffset, storeSize);
             kaitai::kstream ks(&is);
             edk2_ftw_t parsed(&ks);
@@ -777,7 +919,7 @@ not_vss2:
             // FTW store at current offset parsed correctly
             // Check if we need to add a padding before it
             if (!outerPadding.isEmpty()) {
-                UString info = usprintf("Full size: %Xh (%u)", (UINT32)outerPadding.size(), (UINT32)outerPadding.size());
+                ItemInfoFormatter info = fullSizeInfo((UINT32)outerPadding.size());
                 model->addItem(localOffset + previousStoreEndOffset, Types::Padding, getPaddingType(outerPadding), UString("Padding"), UString(), info, UByteArray(), outerPadding, UByteArray(), Fixed, index);
                 outerPadding.clear();
             }
@@ -819,6 +961,10 @@ not_ftw:
             }
             UINT32 storeSize = MIN(volumeBodySize - storeOffset, storeHeader->Size);
             
+            if (probeInsydeFdc((const UINT8*)volumeBody.constData() + storeOffset, storeSize) != U_SUCCESS) {
+                // No need to parse further, the parser will certainly fail
+                goto not_fdc;
+            }
             umemstream is(volumeBody.constData() + storeOffset, storeSize);
             kaitai::kstream ks(&is);
             insyde_fdc_t parsed(&ks);
@@ -826,7 +972,7 @@ not_ftw:
             // Insyde FDC store at current offset parsed correctly
             // Check if we need to add a padding before it
             if (!outerPadding.isEmpty()) {
-                UString info = usprintf("Full size: %Xh (%u)", (UINT32)outerPadding.size(), (UINT32)outerPadding.size());
+                ItemInfoFormatter info = fullSizeInfo((UINT32)outerPadding.size());
                 model->addItem(localOffset + previousStoreEndOffset, Types::Padding, getPaddingType(outerPadding), UString("Padding"), UString(), info, UByteArray(), outerPadding, UByteArray(), Fixed, index);
                 outerPadding.clear();
             }
@@ -870,6 +1016,10 @@ not_fdc:
             }
             UINT32 storeSize = MIN(volumeBodySize - storeOffset, storeHeader->Size);
             
+            if (probeAppleSysf((const UINT8*)volumeBody.constData() + storeOffset, storeSize) != U_SUCCESS) {
+                // No need to parse further, the parser will certainly fail
+                goto not_sysf;
+            }
             umemstream is(volumeBody.constData() + storeOffset, storeSize);
             kaitai::kstream ks(&is);
             apple_sysf_t parsed(&ks);
@@ -877,8 +1027,8 @@ not_fdc:
             // Apple SysF/Diag store at current offset parsed correctly
             // Check if we need to add a padding before it
             if (!outerPadding.isEmpty()) {
-                info = usprintf("Full size: %Xh (%u)", (UINT32)outerPadding.size(), (UINT32)outerPadding.size());
-                model->addItem(localOffset + previousStoreEndOffset, Types::Padding, getPaddingType(outerPadding), UString("Padding"), UString(), info, UByteArray(), outerPadding, UByteArray(), Fixed, index);
+                const ItemInfoFormatter sizeInfo = fullSizeInfo((UINT32)outerPadding.size());
+                model->addItem(localOffset + previousStoreEndOffset, Types::Padding, getPaddingType(outerPadding), UString("Padding"), UString(), sizeInfo, UByteArray(), outerPadding, UByteArray(), Fixed, index);
                 outerPadding.clear();
             }
             
@@ -947,16 +1097,16 @@ not_fdc:
             if (entryOffset < storeSize) {
                 UByteArray freeSpace = volumeBody.mid(storeOffset + entryOffset, storeSize - entryOffset);
                 // Add info
-                info = usprintf("Full size: %Xh (%u)", (UINT32)freeSpace.size(), (UINT32)freeSpace.size());
+                const ItemInfoFormatter sizeInfo = fullSizeInfo((UINT32)freeSpace.size());
                 
                 // Check that remaining unparsed bytes are actually zeroes
                 if (freeSpace.count('\x00') == freeSpace.size() - 4) { // Free space, 4 last bytes are always CRC32
                     // Add tree item
-                    model->addItem(entryOffset, Types::FreeSpace, 0, UString("Free space"), UString(), info, UByteArray(), freeSpace, UByteArray(), Fixed, headerIndex);
+                    model->addItem(entryOffset, Types::FreeSpace, 0, UString("Free space"), UString(), sizeInfo, UByteArray(), freeSpace, UByteArray(), Fixed, headerIndex);
                 }
                 else {
                     // Add tree item
-                    model->addItem(entryOffset, Types::Padding, getPaddingType(freeSpace), UString("Padding"), UString(), info, UByteArray(), freeSpace, UByteArray(), Fixed, headerIndex);
+                    model->addItem(entryOffset, Types::Padding, getPaddingType(freeSpace), UString("Padding"), UString(), sizeInfo, UByteArray(), freeSpace, UByteArray(), Fixed, headerIndex);
                 }
             }
             
@@ -982,6 +1132,10 @@ not_sysf:
             }
             UINT32 storeSize = sizeof(PHOENIX_FLASH_MAP_HEADER) + storeHeader->NumEntries * sizeof(PHOENIX_FLASH_MAP_ENTRY);
             
+            if (probePhoenixFlm((const UINT8*)volumeBody.constData() + storeOffset, storeSize) != U_SUCCESS) {
+                // No need to parse further, the parser will certainly fail
+                goto not_flm;
+            }
             umemstream is(volumeBody.constData() + storeOffset, storeSize);
             kaitai::kstream ks(&is);
             phoenix_flm_t parsed(&ks);
@@ -989,8 +1143,8 @@ not_sysf:
             // Phoenix FlashMap store at current offset parsed correctly
             // Check if we need to add a padding before it
             if (!outerPadding.isEmpty()) {
-                info = usprintf("Full size: %Xh (%u)", (UINT32)outerPadding.size(), (UINT32)outerPadding.size());
-                model->addItem(localOffset + previousStoreEndOffset, Types::Padding, getPaddingType(outerPadding), UString("Padding"), UString(), info, UByteArray(), outerPadding, UByteArray(), Fixed, index);
+                const ItemInfoFormatter sizeInfo = fullSizeInfo((UINT32)outerPadding.size());
+                model->addItem(localOffset + previousStoreEndOffset, Types::Padding, getPaddingType(outerPadding), UString("Padding"), UString(), sizeInfo, UByteArray(), outerPadding, UByteArray(), Fixed, index);
                 outerPadding.clear();
             }
             
@@ -1070,6 +1224,10 @@ not_flm:
             }
             UINT32 storeSize = MIN(volumeBodySize - storeOffset, storeHeader->StoreSize);
             
+            if (probePhoenixEvsa((const UINT8*)volumeBody.constData() + storeOffset, storeSize) != U_SUCCESS) {
+                // No need to parse further, the parser will certainly fail
+                goto not_evsa;
+            }
             umemstream is(volumeBody.constData() + storeOffset, storeSize);
             kaitai::kstream ks(&is);
             phoenix_evsa_t parsed(&ks);
@@ -1077,8 +1235,8 @@ not_flm:
             // Phoenix EVSA store at current offset parsed correctly
             // Check if we need to add a padding before it
             if (!outerPadding.isEmpty()) {
-                info = usprintf("Full size: %Xh (%u)", (UINT32)outerPadding.size(), (UINT32)outerPadding.size());
-                model->addItem(localOffset + previousStoreEndOffset, Types::Padding, getPaddingType(outerPadding), UString("Padding"), UString(), info, UByteArray(), outerPadding, UByteArray(), Fixed, index);
+                const ItemInfoFormatter sizeInfo = fullSizeInfo((UINT32)outerPadding.size());
+                model->addItem(localOffset + previousStoreEndOffset, Types::Padding, getPaddingType(outerPadding), UString("Padding"), UString(), sizeInfo, UByteArray(), outerPadding, UByteArray(), Fixed, index);
                 outerPadding.clear();
             }
             
@@ -1110,6 +1268,7 @@ not_flm:
             for (const auto & entry : *parsed.body()->entries()) {
                 UINT8 subtype;
                 UINT32 entrySize;
+                ItemInfoFormatter entryInfo;
                 
                 // This is the terminating entry, needs special processing
                 if (entry->_is_null_checksum()) {
@@ -1117,16 +1276,16 @@ not_flm:
                     if (entryOffset < storeSize) {
                         UByteArray freeSpace = volumeBody.mid(storeOffset + entryOffset, storeSize - entryOffset);
                         // Add info
-                        info = usprintf("Full size: %Xh (%u)", (UINT32)freeSpace.size(), (UINT32)freeSpace.size());
+                        const ItemInfoFormatter sizeInfo = fullSizeInfo((UINT32)freeSpace.size());
                         
                         // Check that remaining unparsed bytes are actually empty
-                        if (freeSpace.count(emptyByte) == freeSpace.size()) { // Free space
+                        if (isFilledWith(freeSpace, emptyByte)) { // Free space
                             // Add tree item
-                            model->addItem(entryOffset, Types::FreeSpace, 0, UString("Free space"), UString(), info, UByteArray(), freeSpace, UByteArray(), Fixed, headerIndex);
+                            model->addItem(entryOffset, Types::FreeSpace, 0, UString("Free space"), UString(), sizeInfo, UByteArray(), freeSpace, UByteArray(), Fixed, headerIndex);
                         }
                         else {
                             // Add tree item
-                            model->addItem(entryOffset, Types::Padding, getPaddingType(freeSpace), UString("Padding"), UString(), info, UByteArray(), freeSpace, UByteArray(), Fixed, headerIndex);
+                            model->addItem(entryOffset, Types::Padding, getPaddingType(freeSpace), UString("Padding"), UString(), sizeInfo, UByteArray(), freeSpace, UByteArray(), Fixed, headerIndex);
                         }
                     }
                     break;
@@ -1143,15 +1302,16 @@ not_flm:
                     entrySize = (UINT32)(header.size() + body.size());
                     EFI_GUID guid = *(const EFI_GUID*)(guidEntry->guid().c_str());
                     name = guidToUString(guid);
-                    info = UString("GUID: ") + guidToUString(guid, false)
-                    + usprintf("\nFull size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\nType: %02Xh\nChecksum: %02Xh",
-                               entrySize, entrySize,
-                               (UINT32)header.size(), (UINT32)header.size(),
-                               (UINT32)body.size(), (UINT32)body.size(),
-                               entry->entry_type(),
-                               entry->checksum())
-                    + (entry->checksum() != calculated ? usprintf(", invalid, should be %02Xh", calculated) : UString(", valid"))
-                    + usprintf("\nGuidId: %04Xh", guidEntry->guid_id());
+                    const UINT32 headerSize = (UINT32)header.size();
+                    const UINT32 bodySize = (UINT32)body.size();
+                    const UINT8 type = entry->entry_type();
+                    const UINT8 checksum = entry->checksum();
+                    const UINT16 guidId = guidEntry->guid_id();
+                    entryInfo = [guid, entrySize, headerSize, bodySize, type, checksum, calculated, guidId]() {
+                        return UString("GUID: ") + guidToUString(guid, false) + "\n"
+                        + evsaEntryInfo(entrySize, headerSize, bodySize, type, checksum, calculated)
+                        + usprintf("\nGuidId: %04Xh", guidId);
+                    };
                     subtype = Subtypes::GuidEvsaEntry;
                     guidMap.insert(std::pair<UINT16, EFI_GUID>(guidEntry->guid_id(), guid));
                 }
@@ -1161,16 +1321,18 @@ not_flm:
                     header = volumeBody.mid(storeOffset + entryOffset, sizeof(EVSA_NAME_ENTRY));
                     body = volumeBody.mid(storeOffset + entryOffset + sizeof(EVSA_NAME_ENTRY), entry->len_evsa_entry() - header.size());
                     entrySize = (UINT32)(header.size() + body.size());
-                    name = uFromUcs2(body.constData());
-                    info = UString("Name: ") + name
-                    + usprintf("\nFull size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\nType: %02Xh\nChecksum: %02Xh",
-                               entrySize, entrySize,
-                               (UINT32)header.size(), (UINT32)header.size(),
-                               (UINT32)body.size(), (UINT32)body.size(),
-                               entry->entry_type(),
-                               entry->checksum())
-                    + (entry->checksum() != calculated ? usprintf(", invalid, should be %02Xh", calculated) : UString(", valid"))
-                    + usprintf("\nVarId: %04Xh", nameEntry->var_id());
+                    name = uFromUcs2(body.constData(), body.size() / 2);
+                    const UString entryName = name;
+                    const UINT32 headerSize = (UINT32)header.size();
+                    const UINT32 bodySize = (UINT32)body.size();
+                    const UINT8 type = entry->entry_type();
+                    const UINT8 checksum = entry->checksum();
+                    const UINT16 varId = nameEntry->var_id();
+                    entryInfo = [entryName, entrySize, headerSize, bodySize, type, checksum, calculated, varId]() {
+                        return UString("Name: ") + entryName + "\n"
+                        + evsaEntryInfo(entrySize, headerSize, bodySize, type, checksum, calculated)
+                        + usprintf("\nVarId: %04Xh", varId);
+                    };
                     subtype = Subtypes::NameEvsaEntry;
                     nameMap.insert(std::pair<UINT16, UString>(nameEntry->var_id(), name));
                 }
@@ -1202,22 +1364,24 @@ not_flm:
                     + (dataEntry->attributes()->extended_header() << 28)
                     + (UINT32)(dataEntry->attributes()->reserved1() << 29);
                     
-                    info = usprintf("Full size: %Xh (%u)\nHeader size: %Xh (%u)\nBody size: %Xh (%u)\nType: %02Xh\nChecksum: %02Xh",
-                                    entrySize, entrySize,
-                                    (UINT32)header.size(), (UINT32)header.size(),
-                                    (UINT32)body.size(), (UINT32)body.size(),
-                                    entry->entry_type(),
-                                    entry->checksum())
-                    + (entry->checksum() != calculated ? usprintf(", invalid, should be %02Xh", calculated) : UString(", valid"))
-                    + usprintf("\nVarId: %04Xh\nGuidId: %04Xh\nAttributes: %08Xh (",
-                               dataEntry->var_id(),
-                               dataEntry->guid_id(),
-                               attributes)
-                    + evsaAttributesToUString(attributes) + UString(")");
+                    const UINT32 headerSize = (UINT32)header.size();
+                    const UINT32 bodySize = (UINT32)body.size();
+                    const UINT8 type = entry->entry_type();
+                    const UINT8 checksum = entry->checksum();
+                    const UINT16 varId = dataEntry->var_id();
+                    const UINT16 guidId = dataEntry->guid_id();
+                    entryInfo = [entrySize, headerSize, bodySize, type, checksum, calculated, varId, guidId, attributes]() {
+                        return evsaEntryInfo(entrySize, headerSize, bodySize, type, checksum, calculated)
+                        + usprintf("\nVarId: %04Xh\nGuidId: %04Xh\nAttributes: %08Xh (",
+                                   varId,
+                                   guidId,
+                                   attributes)
+                        + evsaAttributesToUString(attributes) + UString(")");
+                    };
                 }
                 
                 // Add tree item
-                model->addItem(entryOffset, Types::EvsaEntry, subtype, name, text, info, header, body, UByteArray(), Fixed, headerIndex);
+                model->addItem(entryOffset, Types::EvsaEntry, subtype, name, text, entryInfo, header, body, UByteArray(), Fixed, headerIndex);
                 
                 entryOffset += entrySize;
             }
@@ -1294,8 +1458,8 @@ not_flm:
             // CMDB store at current offset parsed correctly
             // Check if we need to add a padding before it
             if (!outerPadding.isEmpty()) {
-                info = usprintf("Full size: %Xh (%u)", (UINT32)outerPadding.size(), (UINT32)outerPadding.size());
-                model->addItem(localOffset + previousStoreEndOffset, Types::Padding, getPaddingType(outerPadding), UString("Padding"), UString(), info, UByteArray(), outerPadding, UByteArray(), Fixed, index);
+                const ItemInfoFormatter sizeInfo = fullSizeInfo((UINT32)outerPadding.size());
+                model->addItem(localOffset + previousStoreEndOffset, Types::Padding, getPaddingType(outerPadding), UString("Padding"), UString(), sizeInfo, UByteArray(), outerPadding, UByteArray(), Fixed, index);
                 outerPadding.clear();
             }
             
@@ -1336,6 +1500,10 @@ not_cmdb:
             }
             UINT32 storeSize = sizeof(OEM_ACTIVATION_PUBKEY);
             
+            if (probeMsSlicPubkey((const UINT8*)volumeBody.constData() + storeOffset, storeSize) != U_SUCCESS) {
+                // No need to parse further, the parser will certainly fail
+                goto not_pubkey;
+            }
             umemstream is(volumeBody.constData() + storeOffset, storeSize);
             kaitai::kstream ks(&is);
             ms_slic_pubkey_t parsed(&ks);
@@ -1343,8 +1511,8 @@ not_cmdb:
             // SLIC PubKey at current offset parsed correctly
             // Check if we need to add a padding before it
             if (!outerPadding.isEmpty()) {
-                info = usprintf("Full size: %Xh (%u)", (UINT32)outerPadding.size(), (UINT32)outerPadding.size());
-                model->addItem(localOffset + previousStoreEndOffset, Types::Padding, getPaddingType(outerPadding), UString("Padding"), UString(), info, UByteArray(), outerPadding, UByteArray(), Fixed, index);
+                const ItemInfoFormatter sizeInfo = fullSizeInfo((UINT32)outerPadding.size());
+                model->addItem(localOffset + previousStoreEndOffset, Types::Padding, getPaddingType(outerPadding), UString("Padding"), UString(), sizeInfo, UByteArray(), outerPadding, UByteArray(), Fixed, index);
                 outerPadding.clear();
             }
             
@@ -1396,6 +1564,10 @@ not_pubkey:
             }
             UINT32 storeSize = sizeof(OEM_ACTIVATION_MARKER);
             
+            if (probeMsSlicMarker((const UINT8*)volumeBody.constData() + storeOffset, storeSize) != U_SUCCESS) {
+                // No need to parse further, the parser will certainly fail
+                goto not_marker;
+            }
             umemstream is(volumeBody.constData() + storeOffset, storeSize);
             kaitai::kstream ks(&is);
             ms_slic_marker_t parsed(&ks);
@@ -1403,8 +1575,8 @@ not_pubkey:
             // SLIC marker at current offset parsed correctly
             // Check if we need to add a padding before it
             if (!outerPadding.isEmpty()) {
-                info = usprintf("Full size: %Xh (%u)", (UINT32)outerPadding.size(), (UINT32)outerPadding.size());
-                model->addItem(localOffset + previousStoreEndOffset, Types::Padding, getPaddingType(outerPadding), UString("Padding"), UString(), info, UByteArray(), outerPadding, UByteArray(), Fixed, index);
+                const ItemInfoFormatter sizeInfo = fullSizeInfo((UINT32)outerPadding.size());
+                model->addItem(localOffset + previousStoreEndOffset, Types::Padding, getPaddingType(outerPadding), UString("Padding"), UString(), sizeInfo, UByteArray(), outerPadding, UByteArray(), Fixed, index);
                 outerPadding.clear();
             }
             
@@ -1464,8 +1636,8 @@ not_marker:
             // All checks passed, microcode found
             // Check if we need to add a padding before it
             if (!outerPadding.isEmpty()) {
-                info = usprintf("Full size: %Xh (%u)", (UINT32)outerPadding.size(), (UINT32)outerPadding.size());
-                model->addItem(localOffset + previousStoreEndOffset, Types::Padding, getPaddingType(outerPadding), UString("Padding"), UString(), info, UByteArray(), outerPadding, UByteArray(), Fixed, index);
+                const ItemInfoFormatter sizeInfo = fullSizeInfo((UINT32)outerPadding.size());
+                model->addItem(localOffset + previousStoreEndOffset, Types::Padding, getPaddingType(outerPadding), UString("Padding"), UString(), sizeInfo, UByteArray(), outerPadding, UByteArray(), Fixed, index);
                 outerPadding.clear();
             }
             
@@ -1522,10 +1694,10 @@ not_ffs_volume:
     // Add padding at the very end
     if (!outerPadding.isEmpty()) {
         // Add info
-        UString info = usprintf("Full size: %Xh (%u)", (UINT32)outerPadding.size(), (UINT32)outerPadding.size());
+        ItemInfoFormatter info = fullSizeInfo((UINT32)outerPadding.size());
         
         // Check that remaining unparsed bytes are actually empty
-        if (outerPadding.count(emptyByte) == outerPadding.size()) {
+        if (isFilledWith(outerPadding, emptyByte)) {
             // Add tree item
             model->addItem(localOffset + previousStoreEndOffset, Types::FreeSpace, 0, UString("Free space"), UString(), info, UByteArray(), outerPadding, UByteArray(), Fixed, index);
         }
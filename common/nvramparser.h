@@ -22,6 +22,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include "ubytearray.h"
 #include "treemodel.h"
 #include "ffsparser.h"
+#include "signaturescanner.h"
 
 #ifdef U_ENABLE_NVRAM_PARSING_SUPPORT
 class NvramParser
@@ -35,6 +36,8 @@ public:
     std::vector<std::pair<UString, UModelIndex> > getMessages() const { return messagesVector; }
     // Clears messages
     void clearMessages() { messagesVector.clear(); }
+    // Append messages of another parser
+    void addMessages(const std::vector<std::pair<UString, UModelIndex> > & messages) { messagesVector.insert(messagesVector.end(), messages.begin(), messages.end()); }
 
     // NVRAM parsing
     USTATUS parseNvramVolumeBody(const UModelIndex & index, const UINT32 fdcStoreSizeOverride = 0);
@@ -47,6 +50,11 @@ private:
     void msg(const UString & message, const UModelIndex & index = UModelIndex()) {
         messagesVector.push_back(std::pair<UString, UModelIndex>(message, index));
     };
+
+    // Signatures of all known stores, grouped by their offset from the start of a store
+    std::vector<std::pair<UINT32, SignatureScanner> > storeScanners;
+    void initStoreScanners();
+    UINT32 findNextStoreCandidate(const UByteArray & volumeBody, const UINT32 from, std::vector<INT64> & nextCandidates);
 };
 #else
 class NvramParser
@@ -60,6 +68,7 @@ public:
     std::vector<std::pair<UString, UModelIndex> > getMessages() const { return std::vector<std::pair<UString, UModelIndex> >(); }
     // Clears messages
     void clearMessages() {}
+    void addMessages(const std::vector<std::pair<UString, UModelIndex> > &) {}
 
     // NVRAM parsing
     USTATUS parseNvramVolumeBody(const UModelIndex &) { return U_SUCCESS; }
@@ -0,0 +1,529 @@
+/* parsecache.cpp
+
+Copyright (c) 2026, Nikolaj Schlej. All rights reserved.
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+*/
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "parsecache.h"
+#include "filesystem.h"
+#include "fitparser.h"
+#include "nvramparser.h"
+#include "meparser.h"
+#include "utility.h"
+#include "digest/sha2.h"
+
+// Cache file layout, all values are little-endian:
+//   header:   signature, format version, flags, image size, image SHA-256, tool version string, CRC32 of the rest
+//   parser:   address difference, security info, messages, FIT table
+//   blobs:    data not found in the image or in decompressed data of a parent item
+//   items:    all tree items in pre-order, each referring to its parent by number
+// Strings are stored as UINT32 size followed by the string bytes,
+// item data as a span (blob number, offset, size), where blob 0 is the image itself
+#define PARSE_CACHE_SIGNATURE      0x4548434143505455ULL // UTPCACHE
+#define PARSE_CACHE_FORMAT_VERSION 2
+#define PARSE_CACHE_FLAG_HAS_INFO  0x01
+
+#define PARSE_CACHE_ITEM_FIXED      0x01
+#define PARSE_CACHE_ITEM_COMPRESSED 0x02
+
+#define PARSE_CACHE_NO_BLOB  0xFFFFFFFFU
+#define PARSE_CACHE_NO_ITEM  0xFFFFFFFFU
+
+typedef struct PARSE_CACHE_ITEM_ {
+    UINT32 parent;
+    UINT32 offset;
+    UINT8  type;
+    UINT8  subtype;
+    UINT8  action;
+    UINT8  marking;
+    UINT8  flags;
+    UString name;
+    UString text;
+    UString info;
+    UByteArray header;
+    UByteArray body;
+    UByteArray tail;
+    UByteArray uncompressedData;
+    PARSING_DATA parsingData;
+} PARSE_CACHE_ITEM;
+
+// Serialization helpers
+template <typename T>
+static void cacheWrite(std::string & out, const T value)
+{
+    out.append((const char*)&value, sizeof(T));
+}
+
+// Strings are stored as UTF-8 with their size, so they don't depend on the locale and can have embedded NUL characters
+static void cacheWriteString(std::string & out, const UString & str)
+{
+#if defined(QT_CORE_LIB)
+    const QByteArray bytes = str.toUtf8();
+    cacheWrite<UINT32>(out, (UINT32)bytes.size());
+    out.append(bytes.constData(), (size_t)bytes.size());
+#else
+    cacheWrite<UINT32>(out, (UINT32)str.length());
+    out.append((const char*)str, (size_t)str.length());
+#endif
+}
+
+static void cacheWriteSpan(std::string & out, const UINT32 blob, const UINT32 offset, const UINT32 size)
+{
+    cacheWrite<UINT32>(out, size ? blob : PARSE_CACHE_NO_BLOB);
+    cacheWrite<UINT32>(out, size ? offset : 0);
+    cacheWrite<UINT32>(out, size);
+}
+
+// Bounds-checked deserialization of a cache buffer, any out-of-bounds access marks the whole buffer invalid
+class ParseCacheReader
+{
+public:
+    ParseCacheReader(const UByteArray & buffer) : data(buffer), position(0), valid(true) {}
+
+    bool isValid() const { return valid; }
+    bool atEnd() const { return position == (UINT32)data.size(); }
+    UINT32 offset() const { return position; }
+
+    // Element count, that can't be larger than the number of remaining bytes
+    UINT32 readCount() {
+        UINT32 count = read<UINT32>();
+        if (!check(count))
+            return 0;
+        return count;
+    }
+
+    template <typename T>
+    T read() {
+        T value = T();
+        if (!check(sizeof(T)))
+            return value;
+        memcpy(&value, data.constData() + position, sizeof(T));
+        position += sizeof(T);
+        return value;
+    }
+
+    UString readString() {
+        UINT32 size = read<UINT32>();
+        if (!check(size))
+            return UString();
+        const char* bytes = data.constData() + position;
+        position += size;
+#if defined(QT_CORE_LIB)
+        return QString::fromUtf8(bytes, (int)size);
+#else
+        return UString((const void*)bytes, (int)size);
+#endif
+    }
+
+    UByteArray readBlob() {
+        UINT32 size = read<UINT32>();
+        if (!check(size))
+            return UByteArray();
+        UByteArray blob = data.mid(position, size);
+        position += size;
+        return blob;
+    }
+
+    UByteArray readSpan(const std::vector<UByteArray> & blobs) {
+        UINT32 blob = read<UINT32>();
+        UINT32 offset = read<UINT32>();
+        UINT32 size = read<UINT32>();
+        if (!valid || size == 0)
+            return UByteArray();
+        if (blob >= blobs.size() || (UINT64)offset + size > (UINT64)blobs[blob].size()) {
+            valid = false;
+            return UByteArray();
+        }
+        return blobs[blob].mid(offset, size);
+    }
+
+private:
+    bool check(const UINT64 size) {
+        if (!valid || (UINT64)position + size > (UINT64)data.size())
+            valid = false;
+        return valid;
+    }
+
+    const UByteArray & data;
+    UINT32 position;
+    bool valid;
+};
+
+// Check that item data with given parts is present in the blob at the given offset
+static bool blobContains(const UByteArray & blob, const INT64 offset, const UByteArray & header, const UByteArray & body, const UByteArray & tail)
+{
+    if (offset < 0 || offset + header.size() + body.size() + tail.size() > (INT64)blob.size())
+        return false;
+
+    const char* data = blob.constData() + offset;
+    return 0 == memcmp(data, header.constData(), header.size())
+        && 0 == memcmp(data + header.size(), body.constData(), body.size())
+        && 0 == memcmp(data + header.size() + body.size(), tail.constData(), tail.size());
+}
+
+ParseCache::ParseCache(const UString & directory, const UString & toolVersion, const UByteArray & image)
+: cacheDirectory(directory), version(toolVersion), openedImage(image), imageHash(SHA256_HASH_SIZE, '\x00')
+{
+    sha256(openedImage.constData(), openedImage.size(), imageHash.data());
+
+    UString name;
+    for (int i = 0; i < imageHash.size(); i++)
+        name += usprintf("%02x", (UINT8)imageHash.at(i));
+
+    cachePath = directory + UString("/") + name + UString(".cache");
+}
+
+USTATUS ParseCache::parse(TreeModel* model, FfsParser* parser) const
+{
+    if (U_SUCCESS == load(model, parser))
+        return U_SUCCESS;
+
+    USTATUS result = parser->parse(openedImage);
+    if (result)
+        return result;
+
+    // Cached tree has no pending items, so contents of lazily decompressed sections are saved too
+    model->fetchAll();
+    
+    // Failure to save the cache doesn't affect parsing results
+    (void)save(model, parser);
+    return U_SUCCESS;
+}
+
+USTATUS ParseCache::load(TreeModel* model, FfsParser* parser) const
+{
+    // Sanity check
+    if (!model || !parser || model->rowCount() != 0)
+        return U_INVALID_PARAMETER;
+
+    if (!isExistOnFs(cachePath))
+        return U_ITEM_NOT_FOUND;
+
+    UByteArray cache;
+    if (!mapFileIntoBuffer(cachePath, cache))
+        return U_FILE_READ;
+
+    ParseCacheReader reader(cache);
+
+    // Check that the cache belongs to this image and this tool version
+    UINT64 signature = reader.read<UINT64>();
+    UINT32 formatVersion = reader.read<UINT32>();
+    UINT32 flags = reader.read<UINT32>();
+    UINT32 imageSize = reader.read<UINT32>();
+    UByteArray hash = reader.readBlob();
+    UString cachedVersion = reader.readString();
+    if (!reader.isValid()
+        || signature != PARSE_CACHE_SIGNATURE
+        || formatVersion != PARSE_CACHE_FORMAT_VERSION
+        || imageSize != (UINT32)openedImage.size()
+        || hash != imageHash
+        || cachedVersion != version)
+        return U_ITEM_NOT_FOUND;
+
+    // Cache saved without item info can't be used if info is requested
+    if (model->infoEnabled() && !(flags & PARSE_CACHE_FLAG_HAS_INFO))
+        return U_ITEM_NOT_FOUND;
+
+    // Check integrity of the rest
+    UINT32 crc = reader.read<UINT32>();
+    if (!reader.isValid()
+        || crc != (UINT32)crc32(0, (const UINT8*)cache.constData() + reader.offset(), (uInt)(cache.size() - reader.offset())))
+        return U_FILE_READ;
+
+    // Parser state
+    UINT64 addressDiff = reader.read<UINT64>();
+    UString securityInfo = reader.readString();
+
+    std::vector<std::pair<UString, UINT32> > messages(reader.readCount());
+    for (size_t i = 0; i < messages.size() && reader.isValid(); i++) {
+        messages[i].first = reader.readString();
+        messages[i].second = reader.read<UINT32>();
+    }
+
+    std::vector<std::pair<std::vector<UString>, UINT32> > fitTable(reader.readCount());
+    for (size_t i = 0; i < fitTable.size() && reader.isValid(); i++) {
+        fitTable[i].first.resize(reader.readCount());
+        for (size_t j = 0; j < fitTable[i].first.size() && reader.isValid(); j++)
+            fitTable[i].first[j] = reader.readString();
+        fitTable[i].second = reader.read<UINT32>();
+    }
+
+    // Blobs
+    std::vector<UByteArray> blobs(1, openedImage);
+    UINT32 blobCount = reader.readCount();
+    for (UINT32 i = 0; i < blobCount && reader.isValid(); i++)
+        blobs.push_back(reader.readBlob());
+
+    // Items
+    UINT32 itemCount = reader.readCount();
+    if (!reader.isValid())
+        return U_FILE_READ;
+    std::vector<PARSE_CACHE_ITEM> items(itemCount);
+    for (UINT32 i = 0; i < itemCount && reader.isValid(); i++) {
+        PARSE_CACHE_ITEM & item = items[i];
+        item.parent = reader.read<UINT32>();
+        item.offset = reader.read<UINT32>();
+        item.type = reader.read<UINT8>();
+        item.subtype = reader.read<UINT8>();
+        item.action = reader.read<UINT8>();
+        item.marking = reader.read<UINT8>();
+        item.flags = reader.read<UINT8>();
+        item.name = reader.readString();
+        item.text = reader.readString();
+        if (flags & PARSE_CACHE_FLAG_HAS_INFO)
+            item.info = reader.readString();
+        item.header = reader.readSpan(blobs);
+        item.body = reader.readSpan(blobs);
+        item.tail = reader.readSpan(blobs);
+        item.uncompressedData = reader.readSpan(blobs);
+        item.parsingData = reader.read<PARSING_DATA>();
+
+        // Parents always precede their children
+        if (item.parent != PARSE_CACHE_NO_ITEM && item.parent >= i)
+            return U_FILE_READ;
+    }
+
+    // Model is only touched after the whole cache is read successfully
+    if (!reader.isValid() || !reader.atEnd())
+        return U_FILE_READ;
+
+    std::vector<UModelIndex> indexes(itemCount);
+    for (UINT32 i = 0; i < itemCount; i++) {
+        const PARSE_CACHE_ITEM & item = items[i];
+        UModelIndex parent = (item.parent == PARSE_CACHE_NO_ITEM) ? UModelIndex() : indexes[item.parent];
+        indexes[i] = model->addItem(item.offset, item.type, item.subtype, item.name, item.text, item.info,
+                                    item.header, item.body, item.tail, Movable, parent);
+        model->setAction(indexes[i], item.action);
+        model->setMarking(indexes[i], item.marking);
+        if (!item.uncompressedData.isEmpty())
+            model->setUncompressedData(indexes[i], item.uncompressedData);
+
+        switch (item.parsingData.type) {
+        case ParsingDataTypes::Volume:                model->setParsingData(indexes[i], item.parsingData.volume); break;
+        case ParsingDataTypes::File:                  model->setParsingData(indexes[i], item.parsingData.file); break;
+        case ParsingDataTypes::GuidedSection:         model->setParsingData(indexes[i], item.parsingData.guidedSection); break;
+        case ParsingDataTypes::FreeformGuidedSection: model->setParsingData(indexes[i], item.parsingData.freeformGuidedSection); break;
+        case ParsingDataTypes::CompressedSection:     model->setParsingData(indexes[i], item.parsingData.compressedSection); break;
+        case ParsingDataTypes::TeImageSection:        model->setParsingData(indexes[i], item.parsingData.teImageSection); break;
+        case ParsingDataTypes::NvarEntry:             model->setParsingData(indexes[i], item.parsingData.nvarEntry); break;
+        }
+    }
+
+    // Fixed state propagates to parents, so it's restored from leaves to root, before any item is marked compressed
+    for (UINT32 i = itemCount; i > 0; i--) {
+        model->setFixed(indexes[i - 1], (items[i - 1].flags & PARSE_CACHE_ITEM_FIXED) != 0);
+    }
+
+    // Compressed state affects base meaningfulness of the item and its children, so it's restored from root to leaves
+    for (UINT32 i = 0; i < itemCount; i++) {
+        if (items[i].flags & PARSE_CACHE_ITEM_COMPRESSED)
+            model->setCompressed(indexes[i], true);
+    }
+
+    // Restore parser state, all messages are attributed to the FFS parser
+    parser->addressDiff = addressDiff;
+    parser->securityInfo = securityInfo;
+    parser->messagesVector.clear();
+    parser->fitParser->clearMessages();
+    parser->nvramParser->clearMessages();
+    parser->meParser->clearMessages();
+    for (size_t i = 0; i < messages.size(); i++) {
+        parser->messagesVector.push_back(std::pair<UString, UModelIndex>(messages[i].first,
+            messages[i].second < itemCount ? indexes[messages[i].second] : UModelIndex()));
+    }
+#ifdef U_ENABLE_FIT_PARSING_SUPPORT
+    parser->fitParser->securityInfo = UString();
+    parser->fitParser->fitTable.clear();
+    for (size_t i = 0; i < fitTable.size(); i++) {
+        parser->fitParser->fitTable.push_back(std::pair<std::vector<UString>, UModelIndex>(fitTable[i].first,
+            fitTable[i].second < itemCount ? indexes[fitTable[i].second] : UModelIndex()));
+    }
+#endif
+    model->setAddressDiff(addressDiff);
+
+    return U_SUCCESS;
+}
+
+USTATUS ParseCache::save(const TreeModel* model, const FfsParser* parser) const
+{
+    // Sanity check
+    if (!model || !parser)
+        return U_INVALID_PARAMETER;
+
+    // Enumerate items in pre-order
+    std::vector<UModelIndex> indexes;
+    std::vector<UINT32> parents;
+    std::map<void*, UINT32> numbers;
+    std::vector<std::pair<UModelIndex, UINT32> > stack;
+    for (int i = model->rowCount() - 1; i >= 0; i--)
+        stack.push_back(std::pair<UModelIndex, UINT32>(model->index(i, 0), PARSE_CACHE_NO_ITEM));
+    while (!stack.empty()) {
+        UModelIndex index = stack.back().first;
+        UINT32 parent = stack.back().second;
+        stack.pop_back();
+
+        UINT32 number = (UINT32)indexes.size();
+        numbers[index.internalPointer()] = number;
+        indexes.push_back(index);
+        parents.push_back(parent);
+        for (int i = model->rowCount(index) - 1; i >= 0; i--)
+            stack.push_back(std::pair<UModelIndex, UINT32>(model->index(i, 0, index), number));
+    }
+
+    // Locate item data in the image or in decompressed data of parents, store everything else as new blobs
+    // Item data location is the blob and the offset of its header, body and tail placed one after another
+    std::vector<UByteArray> blobs(1, openedImage);
+    std::vector<std::pair<UINT32, INT64> > locations(indexes.size());
+    std::vector<UINT32> uncompressedBlobs(indexes.size(), PARSE_CACHE_NO_BLOB);
+    std::string items;
+    for (size_t n = 0; n < indexes.size(); n++) {
+        const UModelIndex & index = indexes[n];
+        UByteArray header = model->header(index);
+        UByteArray body = model->body(index);
+        UByteArray tail = model->tail(index);
+        UINT32 offset = model->offset(index);
+
+        std::pair<UINT32, INT64> location(PARSE_CACHE_NO_BLOB, 0);
+        if (parents[n] == PARSE_CACHE_NO_ITEM) {
+            if (blobContains(blobs[0], offset, header, body, tail))
+                location = std::pair<UINT32, INT64>(0, offset);
+        }
+        else {
+            const std::pair<UINT32, INT64> & parentLocation = locations[parents[n]];
+            UINT32 parentUncompressedBlob = uncompressedBlobs[parents[n]];
+            INT64 parentHeaderSize = model->header(indexes[parents[n]]).size();
+            if (parentLocation.first != PARSE_CACHE_NO_BLOB
+                && blobContains(blobs[parentLocation.first], parentLocation.second + offset, header, body, tail))
+                location = std::pair<UINT32, INT64>(parentLocation.first, parentLocation.second + offset);
+            else if (parentUncompressedBlob != PARSE_CACHE_NO_BLOB
+                && blobContains(blobs[parentUncompressedBlob], (INT64)offset - parentHeaderSize, header, body, tail))
+                location = std::pair<UINT32, INT64>(parentUncompressedBlob, (INT64)offset - parentHeaderSize);
+        }
+        if (location.first == PARSE_CACHE_NO_BLOB && header.size() + body.size() + tail.size() > 0) {
+            location = std::pair<UINT32, INT64>((UINT32)blobs.size(), 0);
+            blobs.push_back(header + body + tail);
+        }
+        locations[n] = location;
+
+        // Decompressed data is stored once, children refer to it
+        UByteArray uncompressedData = model->uncompressedData(index);
+        if (!uncompressedData.isEmpty()) {
+            uncompressedBlobs[n] = (UINT32)blobs.size();
+            blobs.push_back(uncompressedData);
+        }
+
+        UINT8 flags = 0;
+        if (model->fixed(index))
+            flags |= PARSE_CACHE_ITEM_FIXED;
+        if (model->compressed(index))
+            flags |= PARSE_CACHE_ITEM_COMPRESSED;
+
+        PARSING_DATA pdata;
+        memset(&pdata, 0, sizeof(pdata));
+        if (const VOLUME_PARSING_DATA* vdata = model->volumeParsingData(index)) { pdata.type = ParsingDataTypes::Volume; pdata.volume = *vdata; }
+        else if (const FILE_PARSING_DATA* fdata = model->fileParsingData(index)) { pdata.type = ParsingDataTypes::File; pdata.file = *fdata; }
+        else if (const GUIDED_SECTION_PARSING_DATA* gdata = model->guidedSectionParsingData(index)) { pdata.type = ParsingDataTypes::GuidedSection; pdata.guidedSection = *gdata; }
+        else if (const FREEFORM_GUIDED_SECTION_PARSING_DATA* fgdata = model->freeformGuidedSectionParsingData(index)) { pdata.type = ParsingDataTypes::FreeformGuidedSection; pdata.freeformGuidedSection = *fgdata; }
+        else if (const COMPRESSED_SECTION_PARSING_DATA* cdata = model->compressedSectionParsingData(index)) { pdata.type = ParsingDataTypes::CompressedSection; pdata.compressedSection = *cdata; }
+        else if (const TE_IMAGE_SECTION_PARSING_DATA* tdata = model->teImageSectionParsingData(index)) { pdata.type = ParsingDataTypes::TeImageSection; pdata.teImageSection = *tdata; }
+        else if (const NVAR_ENTRY_PARSING_DATA* ndata = model->nvarEntryParsingData(index)) { pdata.type = ParsingDataTypes::NvarEntry; pdata.nvarEntry = *ndata; }
+
+        // Item info is stored fully generated
+        cacheWrite<UINT32>(items, parents[n]);
+        cacheWrite<UINT32>(items, offset);
+        cacheWrite<UINT8>(items, model->type(index));
+        cacheWrite<UINT8>(items, model->subtype(index));
+        cacheWrite<UINT8>(items, model->action(index));
+        cacheWrite<UINT8>(items, model->marking(index));
+        cacheWrite<UINT8>(items, flags);
+        cacheWriteString(items, model->name(index));
+        cacheWriteString(items, model->text(index));
+        if (model->infoEnabled())
+            cacheWriteString(items, model->info(index));
+        cacheWriteSpan(items, location.first, (UINT32)location.second, (UINT32)header.size());
+        cacheWriteSpan(items, location.first, (UINT32)location.second + (UINT32)header.size(), (UINT32)body.size());
+        cacheWriteSpan(items, location.first, (UINT32)location.second + (UINT32)header.size() + (UINT32)body.size(), (UINT32)tail.size());
+        cacheWriteSpan(items, uncompressedBlobs[n], 0, (UINT32)uncompressedData.size());
+        cacheWrite<PARSING_DATA>(items, pdata);
+    }
+
+    std::string out;
+    // Parser state
+    cacheWrite<UINT64>(out, parser->addressDiff);
+    cacheWriteString(out, parser->getSecurityInfo());
+
+    std::vector<std::pair<UString, UModelIndex> > messages = parser->getMessages();
+    cacheWrite<UINT32>(out, (UINT32)messages.size());
+    for (size_t i = 0; i < messages.size(); i++) {
+        cacheWriteString(out, messages[i].first);
+        std::map<void*, UINT32>::const_iterator found = numbers.find(messages[i].second.internalPointer());
+        cacheWrite<UINT32>(out, (messages[i].second.isValid() && found != numbers.end()) ? found->second : PARSE_CACHE_NO_ITEM);
+    }
+
+    std::vector<std::pair<std::vector<UString>, UModelIndex> > fitTable = parser->getFitTable();
+    cacheWrite<UINT32>(out, (UINT32)fitTable.size());
+    for (size_t i = 0; i < fitTable.size(); i++) {
+        cacheWrite<UINT32>(out, (UINT32)fitTable[i].first.size());
+        for (size_t j = 0; j < fitTable[i].first.size(); j++)
+            cacheWriteString(out, fitTable[i].first[j]);
+        std::map<void*, UINT32>::const_iterator found = numbers.find(fitTable[i].second.internalPointer());
+        cacheWrite<UINT32>(out, (fitTable[i].second.isValid() && found != numbers.end()) ? found->second : PARSE_CACHE_NO_ITEM);
+    }
+
+    // Blobs, the image itself is not stored
+    cacheWrite<UINT32>(out, (UINT32)blobs.size() - 1);
+    for (size_t i = 1; i < blobs.size(); i++) {
+        cacheWrite<UINT32>(out, (UINT32)blobs[i].size());
+        out.append(blobs[i].constData(), blobs[i].size());
+    }
+
+    // Items
+    cacheWrite<UINT32>(out, (UINT32)indexes.size());
+    out.append(items);
+
+    // Header
+    std::string cacheHeader;
+    cacheWrite<UINT64>(cacheHeader, PARSE_CACHE_SIGNATURE);
+    cacheWrite<UINT32>(cacheHeader, PARSE_CACHE_FORMAT_VERSION);
+    cacheWrite<UINT32>(cacheHeader, model->infoEnabled() ? PARSE_CACHE_FLAG_HAS_INFO : 0);
+    cacheWrite<UINT32>(cacheHeader, (UINT32)openedImage.size());
+    cacheWrite<UINT32>(cacheHeader, (UINT32)imageHash.size());
+    cacheHeader.append(imageHash.constData(), imageHash.size());
+    cacheWriteString(cacheHeader, version);
+    cacheWrite<UINT32>(cacheHeader, (UINT32)crc32(0, (const UINT8*)out.data(), (uInt)out.size()));
+
+    if (!isExistOnFs(cacheDirectory) && !makeDirectory(cacheDirectory))
+        return U_DIR_CREATE;
+
+    // Write to a temporary file first, so concurrent readers never see a partial cache
+    UString tempPath = cachePath + UString(".tmp");
+    std::ofstream file((const char*)tempPath.toLocal8Bit(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file)
+        return U_FILE_OPEN;
+    file.write(cacheHeader.data(), cacheHeader.size());
+    file.write(out.data(), out.size());
+    file.close();
+    if (!file) {
+        remove((const char*)tempPath.toLocal8Bit());
+        return U_FILE_WRITE;
+    }
+    if (0 != rename((const char*)tempPath.toLocal8Bit(), (const char*)cachePath.toLocal8Bit())) {
+        remove((const char*)tempPath.toLocal8Bit());
+        return U_FILE_WRITE;
+    }
+
+    return U_SUCCESS;
+}
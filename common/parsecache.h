@@ -0,0 +1,52 @@
+/* parsecache.h
+
+Copyright (c) 2026, Nikolaj Schlej. All rights reserved.
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+*/
+
+#ifndef PARSECACHE_H
+#define PARSECACHE_H
+
+#include "basetypes.h"
+#include "ustring.h"
+#include "ubytearray.h"
+#include "treemodel.h"
+#include "ffsparser.h"
+
+// On-disk cache of parsing results, keyed by SHA-256 of the image and tool version
+// Item data is stored as spans into the image or into decompressed data, each of the latter is stored once
+class ParseCache
+{
+public:
+    // Cache file for the image is named after its SHA-256 and placed into the given directory
+    ParseCache(const UString & directory, const UString & toolVersion, const UByteArray & image);
+    ~ParseCache() {}
+
+    // Path to the cache file
+    UString path() const { return cachePath; }
+
+    // Fill an empty model and a fresh parser with cached results, U_ITEM_NOT_FOUND if there is no usable cache
+    USTATUS load(TreeModel* model, FfsParser* parser) const;
+
+    // Store parsing results of the image, cache directory is created if needed
+    USTATUS save(const TreeModel* model, const FfsParser* parser) const;
+
+    // Load cached results if possible, otherwise parse the image and try to save them
+    USTATUS parse(TreeModel* model, FfsParser* parser) const;
+
+private:
+    UString cacheDirectory;
+    UString cachePath;
+    UString version;
+    UByteArray openedImage;
+    UByteArray imageHash;
+};
+
+#endif // PARSECACHE_H
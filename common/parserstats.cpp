@@ -0,0 +1,184 @@
+/* parserstats.cpp
+
+Copyright (c) 2026, Nikolaj Schlej. All rights reserved.
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+*/
+
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+#include "parserstats.h"
+#include "types.h"
+
+static bool routineNameLess(const std::pair<const char*, PARSER_STATS_COUNTER> & lhs, const std::pair<const char*, PARSER_STATS_COUNTER> & rhs)
+{
+    return strcmp(lhs.first, rhs.first) < 0;
+}
+
+static UString timeToUString(const UINT64 time)
+{
+    return usprintf("%.3f ms", (double)time / 1000000.0);
+}
+
+void ParserStats::clear()
+{
+    firstPass = PARSER_STATS_COUNTER();
+    secondPass = PARSER_STATS_COUNTER();
+    routines.clear();
+    rawAreaBytesScanned = 0;
+    rawAreaCandidatesRejected = 0;
+    for (size_t i = 0; i < sizeof(decompression) / sizeof(decompression[0]); i++)
+        decompression[i] = PARSER_STATS_DECOMPRESSION();
+    decompressionCacheHits = 0;
+    decompressionCacheBytes = 0;
+    itemsAdded.clear();
+    protectedRangesHashing = PARSER_STATS_COUNTER();
+}
+
+UINT64 ParserStats::now() const
+{
+    if (!enabledFlag)
+        return 0;
+
+    return (UINT64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void ParserStats::addDecompression(const UINT8 algorithm, const UINT32 compressedSize, const UINT32 decompressedSize, const bool success, const UINT64 started)
+{
+    if (!enabledFlag)
+        return;
+
+    PARSER_STATS_DECOMPRESSION & entry = decompression[algorithm <= COMPRESSION_ALGORITHM_ZLIB ? algorithm : COMPRESSION_ALGORITHM_UNKNOWN];
+    entry.calls++;
+    entry.compressedBytes += compressedSize;
+    if (success)
+        entry.decompressedBytes += decompressedSize;
+    else
+        entry.failures++;
+    entry.time += now() - started;
+}
+
+void ParserStats::addDecompressionCacheHit(const UINT32 decompressedSize)
+{
+    if (!enabledFlag)
+        return;
+
+    decompressionCacheHits++;
+    decompressionCacheBytes += decompressedSize;
+}
+
+static void addCounter(PARSER_STATS_COUNTER & counter, const PARSER_STATS_COUNTER & other)
+{
+    counter.calls += other.calls;
+    counter.time += other.time;
+}
+
+void ParserStats::merge(const ParserStats & other)
+{
+    if (!enabledFlag)
+        return;
+
+    addCounter(firstPass, other.firstPass);
+    addCounter(secondPass, other.secondPass);
+    for (std::map<const char*, PARSER_STATS_COUNTER>::const_iterator it = other.routines.begin(); it != other.routines.end(); ++it)
+        addCounter(routines[it->first], it->second);
+    rawAreaBytesScanned += other.rawAreaBytesScanned;
+    rawAreaCandidatesRejected += other.rawAreaCandidatesRejected;
+    for (size_t i = 0; i < sizeof(decompression) / sizeof(decompression[0]); i++) {
+        decompression[i].calls += other.decompression[i].calls;
+        decompression[i].failures += other.decompression[i].failures;
+        decompression[i].compressedBytes += other.decompression[i].compressedBytes;
+        decompression[i].decompressedBytes += other.decompression[i].decompressedBytes;
+        decompression[i].time += other.decompression[i].time;
+    }
+    decompressionCacheHits += other.decompressionCacheHits;
+    decompressionCacheBytes += other.decompressionCacheBytes;
+    for (std::map<UINT8, UINT64>::const_iterator it = other.itemsAdded.begin(); it != other.itemsAdded.end(); ++it)
+        itemsAdded[it->first] += it->second;
+    addCounter(protectedRangesHashing, other.protectedRangesHashing);
+}
+
+void ParserStats::addItemsRecursive(const TreeModel* model, const UModelIndex & index)
+{
+    if (!enabledFlag || !index.isValid())
+        return;
+
+    itemsAdded[model->type(index)]++;
+    for (int i = 0; i < model->rowCount(index); i++) {
+        addItemsRecursive(model, model->index(i, 0, index));
+    }
+}
+
+UString ParserStats::toString() const
+{
+    UString result("Parser statistics:\n");
+    result += UString("First pass: ") + timeToUString(firstPass.time) + "\n";
+    result += UString("Second pass: ") + timeToUString(secondPass.time) + "\n";
+    result += usprintf("Raw area scan: %" PRIu64 " bytes scanned, %" PRIu64 " candidates rejected\n", rawAreaBytesScanned, rawAreaCandidatesRejected);
+    result += usprintf("Protected ranges hashing: %" PRIu64 " calls, ", protectedRangesHashing.calls) + timeToUString(protectedRangesHashing.time) + "\n";
+
+    result += UString("Decompression:\n");
+    for (UINT8 algorithm = 0; algorithm <= COMPRESSION_ALGORITHM_ZLIB; algorithm++) {
+        const PARSER_STATS_DECOMPRESSION & entry = decompression[algorithm];
+        if (entry.calls == 0)
+            continue;
+        result += UString("  ") + compressionTypeToUString(algorithm)
+        + usprintf(": %" PRIu64 " calls (%" PRIu64 " failed), %" PRIu64 " bytes in, %" PRIu64 " bytes out, ",
+                   entry.calls, entry.failures, entry.compressedBytes, entry.decompressedBytes)
+        + timeToUString(entry.time) + "\n";
+    }
+    if (decompressionCacheHits > 0)
+        result += usprintf("  Cached: %" PRIu64 " calls, %" PRIu64 " bytes out\n", decompressionCacheHits, decompressionCacheBytes);
+
+    result += UString("Items added:\n");
+    for (std::map<UINT8, UINT64>::const_iterator it = itemsAdded.begin(); it != itemsAdded.end(); ++it) {
+        result += UString("  ") + itemTypeToUString(it->first) + usprintf(": %" PRIu64 "\n", it->second);
+    }
+
+    // Routines are sorted by name to make the output stable
+    std::vector<std::pair<const char*, PARSER_STATS_COUNTER> > sorted(routines.begin(), routines.end());
+    std::sort(sorted.begin(), sorted.end(), routineNameLess);
+    result += UString("Routines:\n");
+    for (size_t i = 0; i < sorted.size(); i++) {
+        result += UString("  ") + UString(sorted[i].first) + usprintf(": %" PRIu64 " calls, ", sorted[i].second.calls) + timeToUString(sorted[i].second.time) + "\n";
+    }
+
+    return result;
+}
+
+ParserStatsTimer::ParserStatsTimer(ParserStats & stats, PARSER_STATS_COUNTER & counter)
+: stats(stats), counter(stats.enabled() ? &counter : NULL), started(0)
+{
+    start();
+}
+
+ParserStatsTimer::ParserStatsTimer(ParserStats & stats, const char* routine)
+: stats(stats), counter(stats.enabled() ? &stats.routines[routine] : NULL), started(0)
+{
+    start();
+}
+
+void ParserStatsTimer::start()
+{
+    if (!counter)
+        return;
+
+    counter->calls++;
+    if (counter->depth++ == 0)
+        started = stats.now();
+}
+
+ParserStatsTimer::~ParserStatsTimer()
+{
+    if (counter && --counter->depth == 0)
+        counter->time += stats.now() - started;
+}
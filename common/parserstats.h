@@ -0,0 +1,101 @@
+/* parserstats.h
+
+Copyright (c) 2026, Nikolaj Schlej. All rights reserved.
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+*/
+
+#ifndef PARSERSTATS_H
+#define PARSERSTATS_H
+
+#include <map>
+
+#include "basetypes.h"
+#include "ustring.h"
+#include "treemodel.h"
+
+// Number of calls and time spent, in nanoseconds
+typedef struct PARSER_STATS_COUNTER_ {
+    UINT64 calls = 0;
+    UINT64 time = 0;
+    UINT32 depth = 0; // Recursive calls are only accounted once
+} PARSER_STATS_COUNTER;
+
+// Decompression calls per algorithm
+typedef struct PARSER_STATS_DECOMPRESSION_ {
+    UINT64 calls = 0;
+    UINT64 failures = 0;
+    UINT64 compressedBytes = 0;
+    UINT64 decompressedBytes = 0;
+    UINT64 time = 0;
+} PARSER_STATS_DECOMPRESSION;
+
+// Parser instrumentation, nothing is collected unless enabled
+class ParserStats
+{
+public:
+    ParserStats() : enabledFlag(false) {}
+    ~ParserStats() {}
+
+    void setEnabled(const bool enabled) { enabledFlag = enabled; }
+    bool enabled() const { return enabledFlag; }
+
+    // Reset all counters, enabled state is kept
+    void clear();
+
+    // Monotonic time in nanoseconds, 0 if disabled
+    UINT64 now() const;
+
+    // Account a decompression attempt started at the given time
+    void addDecompression(const UINT8 algorithm, const UINT32 compressedSize, const UINT32 decompressedSize, const bool success, const UINT64 started);
+
+    // Account decompressed data reused from the decompression cache
+    void addDecompressionCacheHit(const UINT32 decompressedSize);
+
+    // Add counters of another instance, used for parts of the image parsed in parallel, so routine times are summed over threads
+    void merge(const ParserStats & other);
+
+    // Count items of the subtree per item type
+    void addItemsRecursive(const TreeModel* model, const UModelIndex & index);
+
+    // Human-readable summary
+    UString toString() const;
+
+    PARSER_STATS_COUNTER firstPass;
+    PARSER_STATS_COUNTER secondPass;
+    std::map<const char*, PARSER_STATS_COUNTER> routines; // Keyed by __FUNCTION__
+    UINT64 rawAreaBytesScanned = 0;
+    UINT64 rawAreaCandidatesRejected = 0;
+    PARSER_STATS_DECOMPRESSION decompression[COMPRESSION_ALGORITHM_ZLIB + 1];
+    UINT64 decompressionCacheHits = 0;
+    UINT64 decompressionCacheBytes = 0;
+    std::map<UINT8, UINT64> itemsAdded; // Keyed by item type
+    PARSER_STATS_COUNTER protectedRangesHashing;
+
+private:
+    bool enabledFlag;
+};
+
+// Adds time spent in the scope to a counter, if stats are enabled
+class ParserStatsTimer
+{
+public:
+    ParserStatsTimer(ParserStats & stats, PARSER_STATS_COUNTER & counter);
+    ParserStatsTimer(ParserStats & stats, const char* routine);
+    ~ParserStatsTimer();
+
+private:
+    void start();
+
+    const ParserStats & stats;
+    PARSER_STATS_COUNTER* counter;
+    UINT64 started;
+};
+
+#endif // PARSERSTATS_H
@@ -66,4 +66,31 @@ typedef struct NVAR_ENTRY_PARSING_DATA_ {
     UINT32  next;
 } NVAR_ENTRY_PARSING_DATA;
 
+// Parsing data is stored in tree items as a tagged union
+namespace ParsingDataTypes {
+    enum ParsingDataType {
+        None = 0,
+        Volume,
+        File,
+        GuidedSection,
+        FreeformGuidedSection,
+        CompressedSection,
+        TeImageSection,
+        NvarEntry
+    };
+}
+
+typedef struct PARSING_DATA_ {
+    UINT8 type;
+    union {
+        VOLUME_PARSING_DATA                  volume;
+        FILE_PARSING_DATA                    file;
+        GUIDED_SECTION_PARSING_DATA          guidedSection;
+        FREEFORM_GUIDED_SECTION_PARSING_DATA freeformGuidedSection;
+        COMPRESSED_SECTION_PARSING_DATA      compressedSection;
+        TE_IMAGE_SECTION_PARSING_DATA        teImageSection;
+        NVAR_ENTRY_PARSING_DATA              nvarEntry;
+    };
+} PARSING_DATA;
+
 #endif // PARSINGDATA_H
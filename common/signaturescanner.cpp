@@ -0,0 +1,185 @@
+/* signaturescanner.cpp
+
+Copyright (c) 2026, Nikolaj Schlej. All rights reserved.
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+*/
+
+#include <string.h>
+
+#include "signaturescanner.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIGNATURE_SCANNER_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__)
+#define SIGNATURE_SCANNER_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
+#if defined(SIGNATURE_SCANNER_SSE2)
+#if defined(_MSC_VER)
+#include <intrin.h>
+static inline UINT32 lowestSetBit(const UINT32 mask)
+{
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (UINT32)index;
+}
+#else
+static inline UINT32 lowestSetBit(const UINT32 mask)
+{
+    return (UINT32)__builtin_ctz(mask);
+}
+#endif
+
+// Byte masks of every signature, each byte of a signature is compared against the same byte of all candidate offsets in a vector
+typedef struct SIGNATURE_SCANNER_BYTES_ {
+    UINT8 bytes[SIGNATURE_SCANNER_MAX_SIGNATURES][sizeof(UINT32)];
+} SIGNATURE_SCANNER_BYTES;
+
+static void signatureBytes(const UINT32* signatures, const INT32 count, SIGNATURE_SCANNER_BYTES & result)
+{
+    for (INT32 i = 0; i < count; i++)
+        memcpy(result.bytes[i], &signatures[i], sizeof(UINT32));
+}
+
+// Returns the first offset in [from, end) where any of the signatures is located, or the offset where the vector part stopped
+static UINT32 findNextSse2(const UINT8* data, const UINT32 size, const UINT32 from, const UINT32 end, const SIGNATURE_SCANNER_BYTES & signature, const INT32 count, bool & found)
+{
+    __m128i b0[SIGNATURE_SCANNER_MAX_SIGNATURES], b1[SIGNATURE_SCANNER_MAX_SIGNATURES], b2[SIGNATURE_SCANNER_MAX_SIGNATURES], b3[SIGNATURE_SCANNER_MAX_SIGNATURES];
+    for (INT32 i = 0; i < count; i++) {
+        b0[i] = _mm_set1_epi8((char)signature.bytes[i][0]);
+        b1[i] = _mm_set1_epi8((char)signature.bytes[i][1]);
+        b2[i] = _mm_set1_epi8((char)signature.bytes[i][2]);
+        b3[i] = _mm_set1_epi8((char)signature.bytes[i][3]);
+    }
+
+    found = false;
+    UINT32 offset = from;
+    // Every vector covers 16 candidate offsets, the last one needs 3 more bytes
+    while (offset < end && size - offset >= sizeof(__m128i) + sizeof(UINT32) - 1) {
+        const __m128i x0 = _mm_loadu_si128((const __m128i*)(data + offset));
+        const __m128i x1 = _mm_loadu_si128((const __m128i*)(data + offset + 1));
+        const __m128i x2 = _mm_loadu_si128((const __m128i*)(data + offset + 2));
+        const __m128i x3 = _mm_loadu_si128((const __m128i*)(data + offset + 3));
+        __m128i hits = _mm_setzero_si128();
+        for (INT32 i = 0; i < count; i++) {
+            hits = _mm_or_si128(hits, _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi8(x0, b0[i]), _mm_cmpeq_epi8(x1, b1[i])),
+                                                    _mm_and_si128(_mm_cmpeq_epi8(x2, b2[i]), _mm_cmpeq_epi8(x3, b3[i]))));
+        }
+        const UINT32 mask = (UINT32)_mm_movemask_epi8(hits);
+        if (mask) {
+            const UINT32 candidate = offset + lowestSetBit(mask);
+            found = candidate < end;
+            return found ? candidate : end;
+        }
+        offset += sizeof(__m128i);
+    }
+    return offset;
+}
+
+#if defined(SIGNATURE_SCANNER_AVX2)
+__attribute__((target("avx2")))
+static UINT32 findNextAvx2(const UINT8* data, const UINT32 size, const UINT32 from, const UINT32 end, const SIGNATURE_SCANNER_BYTES & signature, const INT32 count, bool & found)
+{
+    __m256i b0[SIGNATURE_SCANNER_MAX_SIGNATURES], b1[SIGNATURE_SCANNER_MAX_SIGNATURES], b2[SIGNATURE_SCANNER_MAX_SIGNATURES], b3[SIGNATURE_SCANNER_MAX_SIGNATURES];
+    for (INT32 i = 0; i < count; i++) {
+        b0[i] = _mm256_set1_epi8((char)signature.bytes[i][0]);
+        b1[i] = _mm256_set1_epi8((char)signature.bytes[i][1]);
+        b2[i] = _mm256_set1_epi8((char)signature.bytes[i][2]);
+        b3[i] = _mm256_set1_epi8((char)signature.bytes[i][3]);
+    }
+
+    found = false;
+    UINT32 offset = from;
+    while (offset < end && size - offset >= sizeof(__m256i) + sizeof(UINT32) - 1) {
+        const __m256i x0 = _mm256_loadu_si256((const __m256i*)(data + offset));
+        const __m256i x1 = _mm256_loadu_si256((const __m256i*)(data + offset + 1));
+        const __m256i x2 = _mm256_loadu_si256((const __m256i*)(data + offset + 2));
+        const __m256i x3 = _mm256_loadu_si256((const __m256i*)(data + offset + 3));
+        __m256i hits = _mm256_setzero_si256();
+        for (INT32 i = 0; i < count; i++) {
+            hits = _mm256_or_si256(hits, _mm256_and_si256(_mm256_and_si256(_mm256_cmpeq_epi8(x0, b0[i]), _mm256_cmpeq_epi8(x1, b1[i])),
+                                                          _mm256_and_si256(_mm256_cmpeq_epi8(x2, b2[i]), _mm256_cmpeq_epi8(x3, b3[i]))));
+        }
+        const UINT32 mask = (UINT32)_mm256_movemask_epi8(hits);
+        if (mask) {
+            const UINT32 candidate = offset + lowestSetBit(mask);
+            found = candidate < end;
+            return found ? candidate : end;
+        }
+        offset += sizeof(__m256i);
+    }
+    return offset;
+}
+
+static bool avx2Supported()
+{
+    static const bool supported = __builtin_cpu_supports("avx2") != 0;
+    return supported;
+}
+#endif
+#endif
+
+INT32 SignatureScanner::add(const UINT32 signature)
+{
+    if (count == SIGNATURE_SCANNER_MAX_SIGNATURES)
+        return -1;
+
+    signatures[count] = signature;
+    return count++;
+}
+
+INT32 SignatureScanner::match(const UINT8* data) const
+{
+    UINT32 value;
+    memcpy(&value, data, sizeof(UINT32));
+    for (INT32 i = 0; i < count; i++) {
+        if (value == signatures[i])
+            return i;
+    }
+    return -1;
+}
+
+UINT32 SignatureScanner::findNext(const UINT8* data, const UINT32 size, const UINT32 from, const UINT32 end, INT32 & id) const
+{
+    id = -1;
+    if (count == 0 || size < sizeof(UINT32))
+        return end;
+
+    // Signatures must fit into data
+    const UINT32 limit = end < size - sizeof(UINT32) + 1 ? end : size - sizeof(UINT32) + 1;
+    UINT32 offset = from;
+#if defined(SIGNATURE_SCANNER_SSE2)
+    // Vector part stops either at the first candidate or near the end of data
+    SIGNATURE_SCANNER_BYTES bytes;
+    signatureBytes(signatures, count, bytes);
+    bool found = false;
+#if defined(SIGNATURE_SCANNER_AVX2)
+    if (avx2Supported() && offset < limit)
+        offset = findNextAvx2(data, size, offset, limit, bytes, count, found);
+#endif
+    if (!found && offset < limit)
+        offset = findNextSse2(data, size, offset, limit, bytes, count, found);
+    if (found) {
+        id = match(data + offset);
+        return offset;
+    }
+#endif
+
+    // Scalar tail
+    for (; offset < limit; offset++) {
+        id = match(data + offset);
+        if (id >= 0)
+            return offset;
+    }
+    return end;
+}
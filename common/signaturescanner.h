@@ -0,0 +1,43 @@
+/* signaturescanner.h
+
+Copyright (c) 2026, Nikolaj Schlej. All rights reserved.
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+*/
+
+#ifndef SIGNATURESCANNER_H
+#define SIGNATURESCANNER_H
+
+#include "basetypes.h"
+
+#define SIGNATURE_SCANNER_MAX_SIGNATURES 16
+
+// Finds the first offset where any of the registered 32-bit signatures is located, checking all of them in one sweep
+// SSE2 and AVX2 are used when available, with scalar fallback
+class SignatureScanner
+{
+public:
+    SignatureScanner() : count(0) {}
+    ~SignatureScanner() {}
+
+    // Register a signature, returns its number or -1 if there are already too many
+    INT32 add(const UINT32 signature);
+
+    // Returns the first offset in [from, end) where a signature is located, or end if there is none
+    // Signature number is returned in id, or -1 if nothing is found
+    UINT32 findNext(const UINT8* data, const UINT32 size, const UINT32 from, const UINT32 end, INT32 & id) const;
+
+private:
+    INT32 match(const UINT8* data) const;
+
+    UINT32 signatures[SIGNATURE_SCANNER_MAX_SIGNATURES];
+    INT32 count;
+};
+
+#endif // SIGNATURESCANNER_H
@@ -0,0 +1,193 @@
+/* taskpool.cpp
+
+Copyright (c) 2026, Nikolaj Schlej. All rights reserved.
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+*/
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <system_error>
+
+#include "taskpool.h"
+
+// Queue of the pool worker running on the current thread, if any
+static thread_local const TaskPool* workerPool = NULL;
+static thread_local size_t workerQueue = 0;
+
+TaskPool::TaskPool(const UINT32 threadCount) : queued(0), stopping(false)
+{
+    UINT32 count = std::max(std::min(threadCount, maxThreadCount()), (UINT32)1);
+    // All queues are created before any thread can access them
+    for (UINT32 i = 0; i < count; i++)
+        queues.push_back(std::unique_ptr<TASK_QUEUE>(new TASK_QUEUE()));
+    threads.reserve(count - 1);
+    for (UINT32 i = 1; i < count; i++) {
+        try {
+            threads.push_back(std::thread(&TaskPool::worker, this, (size_t)i));
+        }
+        catch (const std::system_error &) {
+            break; // Continue with already created threads, queues of missing ones stay empty
+        }
+    }
+}
+
+UINT32 TaskPool::maxThreadCount()
+{
+    UINT32 cores = std::thread::hardware_concurrency();
+    return cores ? 4 * cores : 64;
+}
+
+bool TaskPool::parseThreadCount(const char* text, UINT32 & count)
+{
+    if (!text || !isdigit((unsigned char)text[0]))
+        return false;
+    char* end = NULL;
+    unsigned long value = strtoul(text, &end, 10);
+    if (*end != '\0' || value == 0)
+        return false;
+    count = (UINT32)std::min(value, (unsigned long)maxThreadCount());
+    return true;
+}
+
+TaskPool::~TaskPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    for (size_t i = 0; i < threads.size(); i++)
+        threads[i].join();
+}
+
+size_t TaskPool::ownQueue() const
+{
+    return workerPool == this ? workerQueue : 0;
+}
+
+bool TaskPool::takeOwn(const size_t queue, QUEUED_TASK & task)
+{
+    // Newest task is taken first, it's the next one of the batch the thread is waiting for
+    TASK_QUEUE & own = *queues[queue];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (own.tasks.empty())
+        return false;
+    task = own.tasks.back();
+    own.tasks.pop_back();
+    queued--;
+    return true;
+}
+
+bool TaskPool::steal(const size_t thief, QUEUED_TASK & task)
+{
+    // Oldest tasks are stolen, they are the last ones their owners would take
+    for (size_t i = 1; i <= queues.size(); i++) {
+        TASK_QUEUE & victim = *queues[(thief + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.tasks.empty())
+            continue;
+        task = victim.tasks.front();
+        victim.tasks.pop_front();
+        queued--;
+        return true;
+    }
+    return false;
+}
+
+void TaskPool::execute(const QUEUED_TASK & task)
+{
+    std::exception_ptr error;
+    try {
+        (*task.task)();
+    }
+    catch (...) {
+        error = std::current_exception();
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    if (error && !*task.error)
+        *task.error = error;
+    
+    // Waiting threads check their batches on every finished one, the lock ensures they don't miss it
+    if (--*task.remaining == 0)
+        changed.notify_all();
+}
+
+void TaskPool::worker(const size_t queue)
+{
+    workerPool = this;
+    workerQueue = queue;
+    
+    QUEUED_TASK task;
+    for (;;) {
+        if (takeOwn(queue, task) || steal(queue, task)) {
+            execute(task);
+            continue;
+        }
+        
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this]() { return stopping || queued > 0; });
+        if (stopping && queued == 0)
+            return;
+    }
+}
+
+void TaskPool::run(const std::vector<std::function<void()> > & tasks)
+{
+    std::exception_ptr error;
+    if (threads.empty() || tasks.size() < 2) {
+        for (size_t i = 0; i < tasks.size(); i++) {
+            try {
+                tasks[i]();
+            }
+            catch (...) {
+                if (!error)
+                    error = std::current_exception();
+            }
+        }
+        if (error)
+            std::rethrow_exception(error);
+        return;
+    }
+    
+    const size_t queue = ownQueue();
+    std::atomic<size_t> remaining(tasks.size());
+    {
+        // Tasks are queued in reverse, so the calling thread takes them in order from the back
+        TASK_QUEUE & own = *queues[queue];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        for (size_t i = tasks.size(); i > 0; i--) {
+            QUEUED_TASK task = { &tasks[i - 1], &remaining, &error };
+            own.tasks.push_back(task);
+        }
+        queued += tasks.size();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        changed.notify_all();
+    }
+    
+    QUEUED_TASK task;
+    while (remaining > 0) {
+        if (takeOwn(queue, task) || steal(queue, task)) {
+            execute(task);
+            continue;
+        }
+        
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this, &remaining]() { return remaining == 0 || queued > 0; });
+    }
+    
+    // Errors are set under the lock by other threads
+    std::lock_guard<std::mutex> lock(mutex);
+    if (error)
+        std::rethrow_exception(error);
+}
@@ -0,0 +1,79 @@
+/* taskpool.h
+
+Copyright (c) 2026, Nikolaj Schlej. All rights reserved.
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+*/
+
+#ifndef TASKPOOL_H
+#define TASKPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "basetypes.h"
+
+// Fixed set of threads executing independent tasks
+// Every thread queues its batches into its own queue, threads calling run from outside of the pool share one
+// A thread waiting for its tasks executes the newest ones from its queue meanwhile, while idle threads steal the oldest ones
+// from queues of other threads, so tasks can run nested batches of tasks without deadlocks
+class TaskPool
+{
+public:
+    // Number of threads includes the ones calling run, it's limited by maxThreadCount()
+    // Fewer threads are used if the system can't create all of them
+    explicit TaskPool(const UINT32 threads);
+    ~TaskPool();
+
+    UINT32 threadCount() const { return (UINT32)threads.size() + 1; }
+    static UINT32 maxThreadCount();
+    // Parses a positive decimal number of threads, larger numbers are limited by maxThreadCount()
+    static bool parseThreadCount(const char* text, UINT32 & count);
+
+    // Execute all tasks and return when all of them are finished
+    // If tasks throw, the first exception is rethrown after all tasks of the batch are finished
+    void run(const std::vector<std::function<void()> > & tasks);
+
+private:
+    TaskPool(const TaskPool &);
+    TaskPool & operator=(const TaskPool &);
+
+    typedef struct QUEUED_TASK_ {
+        const std::function<void()>* task;
+        std::atomic<size_t>* remaining; // Unfinished tasks of the same batch
+        std::exception_ptr* error; // First exception thrown by a task of the same batch
+    } QUEUED_TASK;
+
+    typedef struct TASK_QUEUE_ {
+        std::mutex mutex;
+        std::deque<QUEUED_TASK> tasks;
+    } TASK_QUEUE;
+
+    size_t ownQueue() const;
+    bool takeOwn(const size_t queue, QUEUED_TASK & task);
+    bool steal(const size_t thief, QUEUED_TASK & task);
+    void execute(const QUEUED_TASK & task);
+    void worker(const size_t queue);
+
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<TASK_QUEUE> > queues; // The first one is used by threads outside of the pool
+    std::atomic<size_t> queued; // Tasks in all queues
+    std::mutex mutex; // Guards waiting, stopping and errors of batches
+    std::condition_variable changed;
+    bool stopping;
+};
+
+#endif // TASKPOOL_H
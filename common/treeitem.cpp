@@ -11,14 +11,22 @@
  
  */
 
+#include <algorithm>
+#include <mutex>
+#include <new>
+#include <stdint.h>
+#include <string.h>
+
 #include "treeitem.h"
 #include "types.h"
+#include "utility.h"
 
 TreeItem::TreeItem(const UINT32 offset, const UINT8 type, const UINT8 subtype,
                    const UString & name, const UString & text, const UString & info,
                    const UByteArray & header, const UByteArray & body, const UByteArray & tail,
                    const bool fixed, const bool compressed,
                    TreeItem *parent) :
+itemRow(0),
 itemOffset(offset),
 itemAction(Actions::NoAction),
 itemType(type),
@@ -27,41 +35,257 @@ itemMarking(0),
 itemName(name),
 itemText(text),
 itemInfo(info),
+itemLocationInfo(false),
 itemHeader(header),
 itemBody(body),
+itemBodyFillSize(0),
+itemBodyFill(0),
 itemTail(tail),
 itemFixed(fixed),
 itemCompressed(compressed),
+itemFetchPending(false),
+itemCrc32Valid(false),
+itemCrc32(0),
 parentItem(parent)
 {
+    // Absolute base is the sum of offsets of all parents, it's only meaningful for uncompressed items and compressed items with uncompressed parent
+    itemBase = (parentItem ? parentItem->itemBase : 0) + itemOffset;
+    updateMeaningfulBase();
+    
+    memset(&itemParsingData, 0, sizeof(itemParsingData));
+    
+    // Free space and uniform padding can take megabytes, so their bodies are produced on request
+    // Qt slices are copies, own slices share storage with the image and cost no memory of their own
+#if defined(QT_CORE_LIB)
+    const bool bodyHasOwnStorage = true;
+#else
+    const bool bodyHasOwnStorage = !itemBody.isView();
+#endif
+    if (bodyHasOwnStorage
+        && (itemType == Types::FreeSpace || (itemType == Types::Padding && itemSubtype != Subtypes::DataPadding))
+        && !itemBody.isEmpty() && isFilledWith(itemBody, (UINT8)itemBody.at(0))) {
+        itemBodyFillSize = (UINT32)itemBody.size();
+        itemBodyFill = (UINT8)itemBody.at(0);
+        itemBody = UByteArray();
+    }
 }
 
-TreeItem::~TreeItem() {
-    std::list<TreeItem*>::iterator begin = childItems.begin();
-    while (begin != childItems.end()) {
-        delete *begin;
-        ++begin;
+void TreeItem::setOffset(const UINT32 offset)
+{
+    itemOffset = offset;
+    updateBase();
+}
+
+void TreeItem::updateBase()
+{
+    // Recalculate bases of this item and all its children
+    std::vector<TreeItem*> stack(1, this);
+    while (!stack.empty()) {
+        TreeItem* item = stack.back();
+        stack.pop_back();
+        item->itemBase = (item->parentItem ? item->parentItem->itemBase : 0) + item->itemOffset;
+        stack.insert(stack.end(), item->childItems.begin(), item->childItems.end());
     }
 }
 
+void TreeItem::setCompressed(const bool compressed)
+{
+    itemCompressed = compressed;
+    
+    // Only direct children depend on compressed state of this item
+    updateMeaningfulBase();
+    for (size_t i = 0; i < childItems.size(); i++)
+        childItems[i]->updateMeaningfulBase();
+}
+
+void TreeItem::updateRows(const size_t from)
+{
+    for (size_t i = from; i < childItems.size(); i++)
+        childItems[i]->itemRow = (int)i;
+}
+
 UINT8 TreeItem::insertChildBefore(TreeItem *item, TreeItem *newItem)
 {
-    std::list<TreeItem*>::iterator found = std::find(childItems.begin(), childItems.end(), item);
-    if (found == childItems.end())
+    if (!item || item->parentItem != this || item->row() >= (int)childItems.size() || childItems[item->row()] != item)
         return U_ITEM_NOT_FOUND;
-    childItems.insert(found, newItem);
+    size_t row = (size_t)item->itemRow;
+    childItems.insert(childItems.begin() + row, newItem);
+    updateRows(row);
     return U_SUCCESS;
 }
 
 UINT8 TreeItem::insertChildAfter(TreeItem *item, TreeItem *newItem)
 {
-    std::list<TreeItem*>::iterator found = std::find(childItems.begin(), childItems.end(), item);
-    if (found == childItems.end())
+    if (!item || item->parentItem != this || item->row() >= (int)childItems.size() || childItems[item->row()] != item)
         return U_ITEM_NOT_FOUND;
-    childItems.insert(++found, newItem);
+    size_t row = (size_t)item->itemRow + 1;
+    childItems.insert(childItems.begin() + row, newItem);
+    updateRows(row);
     return U_SUCCESS;
 }
 
+void TreeItem::copyParameters(const TreeItem & other)
+{
+    itemAction = other.itemAction;
+    itemType = other.itemType;
+    itemSubtype = other.itemSubtype;
+    itemMarking = other.itemMarking;
+    itemName = other.itemName;
+    itemText = other.itemText;
+    itemInfo = other.itemInfo;
+    itemInfoFormatter = other.itemInfoFormatter;
+    itemLocationInfo = other.itemLocationInfo;
+    itemHeader = other.itemHeader;
+    itemBody = other.itemBody;
+    itemBodyFillSize = other.itemBodyFillSize;
+    itemBodyFill = other.itemBodyFill;
+    itemTail = other.itemTail;
+    itemFixed = other.itemFixed;
+    itemFetchPending = other.itemFetchPending;
+    itemCrc32Valid = other.itemCrc32Valid;
+    itemCrc32 = other.itemCrc32;
+    itemParsingData = other.itemParsingData;
+    itemUncompressedData = other.itemUncompressedData;
+    
+    if (itemOffset != other.itemOffset)
+        setOffset(other.itemOffset);
+    if (itemCompressed != other.itemCompressed)
+        setCompressed(other.itemCompressed);
+}
+
+static bool sameData(const UByteArray & first, const UByteArray & second)
+{
+    // Copies of an item share its data, so bytes are rarely compared
+    return first.size() == second.size() && (first.constData() == second.constData() || first == second);
+}
+
+bool TreeItem::hasSameParameters(const TreeItem & other) const
+{
+    // Fixed state, position among children and cached CRC32 are not compared, info is formatted if it's deferred
+    return itemOffset == other.itemOffset
+        && itemAction == other.itemAction
+        && itemType == other.itemType
+        && itemSubtype == other.itemSubtype
+        && itemMarking == other.itemMarking
+        && itemName == other.itemName
+        && itemText == other.itemText
+        && itemLocationInfo == other.itemLocationInfo
+        && sameData(itemHeader, other.itemHeader)
+        && itemBodyFillSize == other.itemBodyFillSize
+        && itemBodyFill == other.itemBodyFill
+        && sameData(itemBody, other.itemBody)
+        && sameData(itemTail, other.itemTail)
+        && itemCompressed == other.itemCompressed
+        && itemFetchPending == other.itemFetchPending
+        && memcmp(&itemParsingData, &other.itemParsingData, sizeof(itemParsingData)) == 0
+        && sameData(itemUncompressedData, other.itemUncompressedData)
+        && info() == other.info();
+}
+
+// Deferred info is formatted by a const getter, that can be called from several threads
+// Items are spread over a set of locks, so formatting info of different items rarely waits
+static std::mutex deferredInfoMutexes[64];
+
+UString TreeItem::info() const
+{
+    // Deferred info is formatted once, on the first request, and kept for subsequent ones
+    std::lock_guard<std::mutex> lock(deferredInfoMutexes[((uintptr_t)this / sizeof(TreeItem)) % 64]);
+    if (itemInfoFormatter) {
+        itemInfo = itemInfoFormatter();
+        itemInfoFormatter = ItemInfoFormatter();
+    }
+    return itemInfo;
+}
+
+void TreeItem::addInfo(const UString &info, const bool append)
+{
+    if (!itemInfoFormatter) {
+        if (append)
+            itemInfo += info;
+        else
+            itemInfo = info + itemInfo;
+        return;
+    }
+    
+    // Added text is kept in order with deferred info without formatting it
+    const ItemInfoFormatter previous = itemInfoFormatter;
+    if (append)
+        itemInfoFormatter = [previous, info]() { return previous() + info; };
+    else
+        itemInfoFormatter = [previous, info]() { return info + previous(); };
+}
+
+void TreeItem::addInfo(const ItemInfoFormatter &formatter, const bool append)
+{
+    if (!itemInfoFormatter && itemInfo.isEmpty()) {
+        itemInfoFormatter = formatter;
+        return;
+    }
+    
+    const ItemInfoFormatter previous = itemInfoFormatter;
+    const UString text = itemInfo;
+    itemInfo = UString();
+    if (append)
+        itemInfoFormatter = [previous, text, formatter]() { return (previous ? previous() : text) + formatter(); };
+    else
+        itemInfoFormatter = [previous, text, formatter]() { return formatter() + (previous ? previous() : text); };
+}
+
+const char* TreeItem::contiguousData() const
+{
+    // Header, body and tail must follow each other in the same storage, uniform bodies are not stored at all
+    if (itemBodyFillSize)
+        return NULL;
+    const UByteArray* parts[3] = { &itemHeader, &itemBody, &itemTail };
+    const char* start = NULL;
+    const char* end = NULL;
+    for (int i = 0; i < 3; i++) {
+        if (parts[i]->isEmpty())
+            continue;
+        if (start && parts[i]->constData() != end)
+            return NULL;
+        if (!start)
+            start = parts[i]->constData();
+        end = parts[i]->constData() + parts[i]->size();
+    }
+    return start;
+}
+
+UINT32 TreeItem::dataCrc32()
+{
+    if (itemCrc32Valid)
+        return itemCrc32;
+
+    uLong crc = crc32(0, (const Bytef*)itemHeader.constData(), (uInt)itemHeader.size());
+    if (itemBodyFillSize) {
+        Bytef fill[4096];
+        memset(fill, itemBodyFill, sizeof(fill));
+        for (UINT32 done = 0; done < itemBodyFillSize; done += (UINT32)sizeof(fill))
+            crc = crc32(crc, fill, (uInt)std::min((UINT32)sizeof(fill), itemBodyFillSize - done));
+    }
+    else {
+        // Children that share storage with the body have their data in it, so their CRC32 values are combined instead of hashing their bytes again
+        // Bytes between such children and data of children stored elsewhere, i.e. decompressed, are hashed directly
+        const char* current = itemBody.constData();
+        const char* end = current + itemBody.size();
+        for (size_t i = 0; i < childItems.size(); i++) {
+            const char* start = childItems[i]->contiguousData();
+            if (!start || (uintptr_t)start < (uintptr_t)current || (uintptr_t)start > (uintptr_t)end
+                || (uintptr_t)(end - start) < childItems[i]->dataSize())
+                continue;
+            crc = crc32(crc, (const Bytef*)current, (uInt)(start - current));
+            crc = crc32_combine(crc, childItems[i]->dataCrc32(), (z_off_t)childItems[i]->dataSize());
+            current = start + childItems[i]->dataSize();
+        }
+        crc = crc32(crc, (const Bytef*)current, (uInt)(end - current));
+    }
+    crc = crc32(crc, (const Bytef*)itemTail.constData(), (uInt)itemTail.size());
+
+    itemCrc32 = (UINT32)crc;
+    itemCrc32Valid = true;
+    return itemCrc32;
+}
+
 UString TreeItem::data(int column) const
 {
     switch (column)
@@ -81,21 +305,40 @@ UString TreeItem::data(int column) const
     }
 }
 
-int TreeItem::row() const
+TreeItem* TreeItemPool::create(const UINT32 offset, const UINT8 type, const UINT8 subtype,
+                               const UString & name, const UString & text, const UString & info,
+                               const UByteArray & header, const UByteArray & body, const UByteArray & tail,
+                               const bool fixed, const bool compressed,
+                               TreeItem *parent)
+{
+    if (blocks.empty() || blocks.back().used == ItemsPerBlock) {
+        BLOCK block;
+        block.items = static_cast<TreeItem*>(::operator new(ItemsPerBlock * sizeof(TreeItem)));
+        block.used = 0;
+        blocks.push_back(block);
+    }
+    
+    BLOCK & block = blocks.back();
+    TreeItem *item = new (block.items + block.used) TreeItem(offset, type, subtype, name, text, info, header, body, tail, fixed, compressed, parent);
+    block.used++;
+    return item;
+}
+
+void TreeItemPool::clear()
 {
-    if (parentItem) {
-        std::list<TreeItem*>::const_iterator iter = parentItem->childItems.begin();
-        for (int i = 0; i < (int)parentItem->childItems.size(); ++i, ++iter) {
-            if (const_cast<TreeItem*>(this) == *iter)
-                return i;
+    for (size_t i = 0; i < blocks.size(); i++) {
+        for (size_t j = 0; j < blocks[i].used; j++) {
+            blocks[i].items[j].~TreeItem();
         }
+        ::operator delete(blocks[i].items);
     }
-    return 0;
+    blocks.clear();
 }
 
-TreeItem* TreeItem::child(int row)
+void TreeItemPool::take(TreeItemPool & other)
 {
-    std::list<TreeItem*>::iterator child = childItems.begin();
-    std::advance(child, row);
-    return *child;
+    // Items of the other pool are kept in place, only ownership of their blocks changes
+    // Unused space of the last block of this pool is left as is, new items are created in the taken blocks
+    blocks.insert(blocks.end(), other.blocks.begin(), other.blocks.end());
+    other.blocks.clear();
 }
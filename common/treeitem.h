@@ -14,12 +14,16 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #ifndef TREEITEM_H
 #define TREEITEM_H
 
-#include <list>
-#include <iterator>
+#include <functional>
+#include <vector>
 
 #include "basetypes.h"
 #include "ubytearray.h"
 #include "ustring.h"
+#include "parsingdata.h"
+
+// Item info formatted on the first request from values captured by the parser, so items never looked at cost no formatting
+typedef std::function<UString()> ItemInfoFormatter;
 
 class TreeItem
 {
@@ -28,25 +32,32 @@ public:
         const UByteArray & header, const UByteArray & body, const UByteArray & tail,
         const bool fixed, const bool compressed,
         TreeItem *parent = 0);
-    ~TreeItem();                                                               // Non-trivial implementation in CPP file
+    ~TreeItem() {}                                                             // Children are owned by TreeItemPool, not by their parent
 
     // Operations with items
-    void appendChild(TreeItem *item) { childItems.push_back(item); }
-    void prependChild(TreeItem *item) { childItems.push_front(item); };
+    void appendChild(TreeItem *item) { item->itemRow = (int)childItems.size(); childItems.push_back(item); }
+    void prependChild(TreeItem *item) { childItems.insert(childItems.begin(), item); updateRows(0); };
     UINT8 insertChildBefore(TreeItem *item, TreeItem *newItem);                // Non-trivial implementation in CPP file
     UINT8 insertChildAfter(TreeItem *item, TreeItem *newItem);                 // Non-trivial implementation in CPP file
+    void adoptChild(TreeItem *item) { item->parentItem = this; appendChild(item); }  // Item must already be removed from its previous parent
+    std::vector<TreeItem*> takeChildren() { std::vector<TreeItem*> children; children.swap(childItems); return children; }
+    void copyParameters(const TreeItem &other);                                // Non-trivial implementation in CPP file
+    bool hasSameParameters(const TreeItem &other) const;                       // Non-trivial implementation in CPP file
 
     // Model support operations
-    TreeItem *child(int row);                                                  // Non-trivial implementation in CPP file
+    TreeItem *child(int row) { return (row >= 0 && row < (int)childItems.size()) ? childItems[row] : NULL; }
     int childCount() const {return (int)childItems.size(); }
     int columnCount() const { return 5; }
     UString data(int column) const;                                            // Non-trivial implementation in CPP file
-    int row() const;                                                           // Non-trivial implementation in CPP file
+    int row() const { return parentItem ? itemRow : 0; }
     TreeItem *parent() { return parentItem; }
 
     // Getters and setters for item parameters
     UINT32 offset() const { return itemOffset; }
-    void setOffset(const UINT32 offset) { itemOffset = offset; }
+    void setOffset(const UINT32 offset);                                       // Non-trivial implementation in CPP file
+
+    UINT32 base() const { return itemBase; }
+    bool hasMeaningfulBase() const { return itemMeaningfulBase; }
 
     UINT8 type() const  { return itemType; }
     void setType(const UINT8 type) { itemType = type; }
@@ -63,15 +74,24 @@ public:
     UByteArray header() const { return itemHeader; }
     bool hasEmptyHeader() const { return itemHeader.isEmpty(); }
 
-    UByteArray body() const { return itemBody; };
-    bool hasEmptyBody() const { return itemBody.isEmpty(); }
+    UByteArray body() const { return itemBodyFillSize ? UByteArray((int)itemBodyFillSize, (char)itemBodyFill) : itemBody; };
+    bool hasEmptyBody() const { return itemBody.isEmpty() && itemBodyFillSize == 0; }
+    UINT32 bodySize() const { return itemBodyFillSize ? itemBodyFillSize : (UINT32)itemBody.size(); }
 
     UByteArray tail() const { return itemTail; };
     bool hasEmptyTail() const { return itemTail.isEmpty(); }
 
-    UString info() const { return itemInfo; }
-    void addInfo(const UString &info, const bool append) { if (append) itemInfo += info; else itemInfo = info + itemInfo; }
-    void setInfo(const UString &info) { itemInfo = info; }
+    UINT32 dataSize() const { return (UINT32)itemHeader.size() + bodySize() + (UINT32)itemTail.size(); }
+    UINT32 dataCrc32();                                                        // Non-trivial implementation in CPP file
+
+    UString info() const;                                                      // Non-trivial implementation in CPP file
+    void addInfo(const UString &info, const bool append);                      // Non-trivial implementation in CPP file
+    void addInfo(const ItemInfoFormatter &formatter, const bool append);       // Non-trivial implementation in CPP file
+    void setInfo(const UString &info) { itemInfo = info; itemInfoFormatter = ItemInfoFormatter(); }
+    void setInfo(const ItemInfoFormatter &formatter) { itemInfo = UString(); itemInfoFormatter = formatter; }
+
+    bool hasLocationInfo() const { return itemLocationInfo; }
+    void setLocationInfo(const bool enabled) { itemLocationInfo = enabled; }
     
     UINT8 action() const {return itemAction; }
     void setAction(const UINT8 action) { itemAction = action; }
@@ -80,11 +100,11 @@ public:
     void setFixed(const bool fixed) { itemFixed = fixed; }
 
     bool compressed() const { return itemCompressed; }
-    void setCompressed(const bool compressed) { itemCompressed = compressed; }
+    void setCompressed(const bool compressed);                                 // Non-trivial implementation in CPP file
 
-    UByteArray parsingData() const { return itemParsingData; };
-    bool hasEmptyParsingData() const { return itemParsingData.isEmpty(); }
-    void setParsingData(const UByteArray & pdata) { itemParsingData = pdata; }
+    const PARSING_DATA & parsingData() const { return itemParsingData; };
+    bool hasEmptyParsingData() const { return itemParsingData.type == ParsingDataTypes::None; }
+    void setParsingData(const PARSING_DATA & pdata) { itemParsingData = pdata; }
 
     UByteArray uncompressedData() const { return itemUncompressedData; };
     bool hasEmptyUncompressedData() const { return itemUncompressedData.isEmpty(); }
@@ -93,24 +113,68 @@ public:
     UINT8 marking() const { return itemMarking; }
     void setMarking(const UINT8 marking) { itemMarking = marking; }
 
+    bool fetchPending() const { return itemFetchPending; }
+    void setFetchPending(const bool pending) { itemFetchPending = pending; }
+
 private:
-    std::list<TreeItem*> childItems;
+    void updateRows(const size_t from);                                        // Non-trivial implementation in CPP file
+    void updateBase();                                                         // Non-trivial implementation in CPP file
+    void updateMeaningfulBase() { itemMeaningfulBase = !itemCompressed || !parentItem || !parentItem->itemCompressed; }
+    const char* contiguousData() const;                                        // Non-trivial implementation in CPP file
+
+    std::vector<TreeItem*> childItems;
+    int        itemRow;
     UINT32     itemOffset;
+    UINT32     itemBase;
+    bool       itemMeaningfulBase;
     UINT8      itemAction;
     UINT8      itemType;
     UINT8      itemSubtype;
     UINT8      itemMarking;
     UString    itemName;
     UString    itemText;
-    UString    itemInfo;
+    mutable UString itemInfo;
+    mutable ItemInfoFormatter itemInfoFormatter;                               // Deferred info, replaced by its text once formatted
+    bool       itemLocationInfo;
     UByteArray itemHeader;
     UByteArray itemBody;
+    UINT32     itemBodyFillSize;                                               // Uniform bodies are stored as fill byte and size
+    UINT8      itemBodyFill;
     UByteArray itemTail;
     bool       itemFixed;
     bool       itemCompressed;
-    UByteArray itemParsingData;
+    bool       itemFetchPending;
+    bool       itemCrc32Valid;                                                 // CRC32 of header, body and tail is calculated once on request
+    UINT32     itemCrc32;
+    PARSING_DATA itemParsingData;
     UByteArray itemUncompressedData;
     TreeItem*  parentItem;
 };
 
+// Storage for all items of a single tree, allocated in blocks and freed at once
+class TreeItemPool
+{
+public:
+    TreeItemPool() {}
+    ~TreeItemPool() { clear(); }
+
+    TreeItem *create(const UINT32 offset, const UINT8 type, const UINT8 subtype, const UString &name, const UString &text, const UString &info,
+        const UByteArray & header, const UByteArray & body, const UByteArray & tail,
+        const bool fixed, const bool compressed,
+        TreeItem *parent = 0);                                                 // Non-trivial implementation in CPP file
+    void clear();                                                              // Non-trivial implementation in CPP file
+    void take(TreeItemPool &other);                                            // Non-trivial implementation in CPP file
+
+private:
+    TreeItemPool(const TreeItemPool &);
+    TreeItemPool & operator=(const TreeItemPool &);
+
+    static const size_t ItemsPerBlock = 256;
+    struct BLOCK {
+        TreeItem *items;
+        size_t used;
+    };
+    std::vector<BLOCK> blocks;
+};
+
 #endif // TREEITEM_H
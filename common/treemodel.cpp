@@ -14,6 +14,7 @@
 #include "treemodel.h"
 
 #include "stack"
+#include <algorithm>
 
 #if defined(QT_CORE_LIB)
 QVariant TreeModel::data(const UModelIndex &index, int role) const
@@ -38,7 +39,7 @@ QVariant TreeModel::data(const UModelIndex &index, int role) const
     }
 #endif
     else if (role == Qt::UserRole) {
-        return item->info().toLocal8Bit();
+        return info(index).toLocal8Bit();
     }
     
     return QVariant();
@@ -81,7 +82,7 @@ UString TreeModel::data(const UModelIndex &index, int role) const
     if (role == 0)
         return item->data(index.column());
     else
-        return item->info();
+        return info(index);
 }
 
 UString TreeModel::headerData(int section, int orientation,
@@ -160,18 +161,68 @@ int TreeModel::rowCount(const UModelIndex &parent) const
     return parentItem->childCount();
 }
 
-UINT32 TreeModel::base(const UModelIndex &current) const
+bool TreeModel::hasChildren(const UModelIndex &parent) const
 {
-    // Rewrite this as loop if we ever see an image that is too deep for this naive implementation
-    if (!current.isValid())
-        return 0;
+    return rowCount(parent) > 0 || canFetchMore(parent);
+}
+
+bool TreeModel::canFetchMore(const UModelIndex &parent) const
+{
+    return fetchHandler && fetchPending(parent);
+}
+
+void TreeModel::fetchMore(const UModelIndex &parent)
+{
+    if (!canFetchMore(parent))
+        return;
     
-    UModelIndex parent = current.parent();
-    if (!parent.isValid())
-        return offset(current);
-    else {
-        return offset(current) + base(parent);
-    }
+    // Handler parses contents of the item while it's still pending, so it doesn't get deferred again
+    fetchHandler(parent);
+    setFetchPending(parent, false);
+}
+
+void TreeModel::fetchAll(const UModelIndex &index)
+{
+    if (index.isValid() && canFetchMore(index))
+        fetchMore(index);
+    
+    for (int i = 0; i < rowCount(index); i++)
+        fetchAll(this->index(i, 0, index));
+}
+
+bool TreeModel::fetchPending(const UModelIndex &index) const
+{
+    if (!index.isValid())
+        return false;
+    TreeItem *item = static_cast<TreeItem*>(index.internalPointer());
+    return item->fetchPending();
+}
+
+void TreeModel::setFetchPending(const UModelIndex &index, const bool pending)
+{
+    if (!index.isValid())
+        return;
+    
+    TreeItem *item = static_cast<TreeItem*>(index.internalPointer());
+    item->setFetchPending(pending);
+    
+    emit dataChanged(index, index);
+}
+
+UINT32 TreeModel::base(const UModelIndex &index) const
+{
+    if (!index.isValid())
+        return 0;
+    TreeItem *item = static_cast<TreeItem*>(index.internalPointer());
+    return item->base();
+}
+
+bool TreeModel::hasMeaningfulBase(const UModelIndex &index) const
+{
+    if (!index.isValid())
+        return false;
+    TreeItem *item = static_cast<TreeItem*>(index.internalPointer());
+    return item->hasMeaningfulBase();
 }
 
 UINT32 TreeModel::offset(const UModelIndex &index) const
@@ -238,6 +289,14 @@ bool TreeModel::hasEmptyBody(const UModelIndex &index) const
     return item->hasEmptyBody();
 }
 
+UINT32 TreeModel::bodySize(const UModelIndex &index) const
+{
+    if (!index.isValid())
+        return 0;
+    TreeItem *item = static_cast<TreeItem*>(index.internalPointer());
+    return item->bodySize();
+}
+
 UByteArray TreeModel::tail(const UModelIndex &index) const
 {
     if (!index.isValid())
@@ -254,6 +313,22 @@ bool TreeModel::hasEmptyTail(const UModelIndex &index) const
     return item->hasEmptyTail();
 }
 
+UINT32 TreeModel::dataSize(const UModelIndex &index) const
+{
+    if (!index.isValid())
+        return 0;
+    TreeItem *item = static_cast<TreeItem*>(index.internalPointer());
+    return item->dataSize();
+}
+
+UINT32 TreeModel::dataCrc32(const UModelIndex &index) const
+{
+    if (!index.isValid())
+        return 0;
+    TreeItem *item = static_cast<TreeItem*>(index.internalPointer());
+    return item->dataCrc32();
+}
+
 UString TreeModel::name(const UModelIndex &index) const
 {
     if (!index.isValid())
@@ -275,7 +350,35 @@ UString TreeModel::info(const UModelIndex &index) const
     if (!index.isValid())
         return UString();
     TreeItem *item = static_cast<TreeItem*>(index.internalPointer());
-    return item->info();
+    if (!item->hasLocationInfo())
+        return item->info();
+    return locationInfo(item) + item->info();
+}
+
+UString TreeModel::locationInfo(const TreeItem *item) const
+{
+    // Location info is generated on request from item fields instead of being stored for every item
+    UString info = usprintf("Fixed: %s\n", item->fixed() ? "Yes" : "No");
+    
+    // Add current base if the element is not compressed
+    // or it's compressed, but its parent isn't
+    if (item->hasMeaningfulBase()) {
+        info += usprintf("Base: %Xh\n", item->base());
+        
+        // Add physical address of the whole item or its header and data portions separately
+        UINT64 address = addressDiff + item->base();
+        if (address <= 0xFFFFFFFFUL) {
+            UINT32 headerSize = (UINT32)item->header().size();
+            if (headerSize) {
+                info += usprintf("Header address: %08Xh\nData address: %08Xh\n", (UINT32)address, (UINT32)address + headerSize);
+            }
+            else {
+                info += usprintf("Address: %08Xh\n", (UINT32)address);
+            }
+        }
+    }
+    
+    return info + usprintf("Offset: %Xh\n", item->offset());
 }
 
 UINT8 TreeModel::action(const UModelIndex &index) const
@@ -334,6 +437,7 @@ void TreeModel::setCompressed(const UModelIndex &index, const bool compressed)
     
     TreeItem *item = static_cast<TreeItem*>(index.internalPointer());
     item->setCompressed(compressed);
+    invalidateBaseIndex();
     
     emit dataChanged(index, index);
 }
@@ -370,6 +474,7 @@ void TreeModel::setOffset(const UModelIndex &index, const UINT32 offset)
     
     TreeItem *item = static_cast<TreeItem*>(index.internalPointer());
     item->setOffset(offset);
+    invalidateBaseIndex();
     emit dataChanged(index, index);
 }
 
@@ -415,7 +520,7 @@ void TreeModel::setText(const UModelIndex &index, const UString &data)
 
 void TreeModel::setInfo(const UModelIndex &index, const UString &data)
 {
-    if (!index.isValid())
+    if (!index.isValid() || !infoEnabledFlag)
         return;
     
     TreeItem *item = static_cast<TreeItem*>(index.internalPointer());
@@ -423,9 +528,19 @@ void TreeModel::setInfo(const UModelIndex &index, const UString &data)
     emit dataChanged(index, index);
 }
 
+void TreeModel::setInfo(const UModelIndex &index, const ItemInfoFormatter &formatter)
+{
+    if (!index.isValid() || !infoEnabledFlag)
+        return;
+    
+    TreeItem *item = static_cast<TreeItem*>(index.internalPointer());
+    item->setInfo(formatter);
+    emit dataChanged(index, index);
+}
+
 void TreeModel::addInfo(const UModelIndex &index, const UString &data, const bool append)
 {
-    if (!index.isValid())
+    if (!index.isValid() || !infoEnabledFlag)
         return;
     
     TreeItem *item = static_cast<TreeItem*>(index.internalPointer());
@@ -433,6 +548,26 @@ void TreeModel::addInfo(const UModelIndex &index, const UString &data, const boo
     emit dataChanged(index, index);
 }
 
+void TreeModel::addInfo(const UModelIndex &index, const ItemInfoFormatter &formatter, const bool append)
+{
+    if (!index.isValid() || !infoEnabledFlag)
+        return;
+    
+    TreeItem *item = static_cast<TreeItem*>(index.internalPointer());
+    item->addInfo(formatter, append);
+    emit dataChanged(index, index);
+}
+
+void TreeModel::setLocationInfo(const UModelIndex &index, const bool enabled)
+{
+    if (!index.isValid() || !infoEnabledFlag)
+        return;
+    
+    TreeItem *item = static_cast<TreeItem*>(index.internalPointer());
+    item->setLocationInfo(enabled);
+    emit dataChanged(index, index);
+}
+
 void TreeModel::setAction(const UModelIndex &index, const UINT8 action)
 {
     if (!index.isValid())
@@ -443,13 +578,15 @@ void TreeModel::setAction(const UModelIndex &index, const UINT8 action)
     emit dataChanged(index, index);
 }
 
-UByteArray TreeModel::parsingData(const UModelIndex &index) const
+const PARSING_DATA* TreeModel::parsingData(const UModelIndex &index, const UINT8 type) const
 {
     if (!index.isValid())
-        return UByteArray();
+        return NULL;
     
     TreeItem *item = static_cast<TreeItem*>(index.internalPointer());
-    return item->parsingData();
+    if (item->parsingData().type != type)
+        return NULL;
+    return &item->parsingData();
 }
 
 bool TreeModel::hasEmptyParsingData(const UModelIndex &index) const
@@ -461,7 +598,105 @@ bool TreeModel::hasEmptyParsingData(const UModelIndex &index) const
     return item->hasEmptyParsingData();
 }
 
-void TreeModel::setParsingData(const UModelIndex &index, const UByteArray &data)
+const VOLUME_PARSING_DATA* TreeModel::volumeParsingData(const UModelIndex &index) const
+{
+    const PARSING_DATA* pdata = parsingData(index, ParsingDataTypes::Volume);
+    return pdata ? &pdata->volume : NULL;
+}
+
+const FILE_PARSING_DATA* TreeModel::fileParsingData(const UModelIndex &index) const
+{
+    const PARSING_DATA* pdata = parsingData(index, ParsingDataTypes::File);
+    return pdata ? &pdata->file : NULL;
+}
+
+const GUIDED_SECTION_PARSING_DATA* TreeModel::guidedSectionParsingData(const UModelIndex &index) const
+{
+    const PARSING_DATA* pdata = parsingData(index, ParsingDataTypes::GuidedSection);
+    return pdata ? &pdata->guidedSection : NULL;
+}
+
+const FREEFORM_GUIDED_SECTION_PARSING_DATA* TreeModel::freeformGuidedSectionParsingData(const UModelIndex &index) const
+{
+    const PARSING_DATA* pdata = parsingData(index, ParsingDataTypes::FreeformGuidedSection);
+    return pdata ? &pdata->freeformGuidedSection : NULL;
+}
+
+const COMPRESSED_SECTION_PARSING_DATA* TreeModel::compressedSectionParsingData(const UModelIndex &index) const
+{
+    const PARSING_DATA* pdata = parsingData(index, ParsingDataTypes::CompressedSection);
+    return pdata ? &pdata->compressedSection : NULL;
+}
+
+const TE_IMAGE_SECTION_PARSING_DATA* TreeModel::teImageSectionParsingData(const UModelIndex &index) const
+{
+    const PARSING_DATA* pdata = parsingData(index, ParsingDataTypes::TeImageSection);
+    return pdata ? &pdata->teImageSection : NULL;
+}
+
+const NVAR_ENTRY_PARSING_DATA* TreeModel::nvarEntryParsingData(const UModelIndex &index) const
+{
+    const PARSING_DATA* pdata = parsingData(index, ParsingDataTypes::NvarEntry);
+    return pdata ? &pdata->nvarEntry : NULL;
+}
+
+void TreeModel::setParsingData(const UModelIndex &index, const VOLUME_PARSING_DATA &pdata)
+{
+    PARSING_DATA data = {};
+    data.type = ParsingDataTypes::Volume;
+    data.volume = pdata;
+    setParsingData(index, data);
+}
+
+void TreeModel::setParsingData(const UModelIndex &index, const FILE_PARSING_DATA &pdata)
+{
+    PARSING_DATA data = {};
+    data.type = ParsingDataTypes::File;
+    data.file = pdata;
+    setParsingData(index, data);
+}
+
+void TreeModel::setParsingData(const UModelIndex &index, const GUIDED_SECTION_PARSING_DATA &pdata)
+{
+    PARSING_DATA data = {};
+    data.type = ParsingDataTypes::GuidedSection;
+    data.guidedSection = pdata;
+    setParsingData(index, data);
+}
+
+void TreeModel::setParsingData(const UModelIndex &index, const FREEFORM_GUIDED_SECTION_PARSING_DATA &pdata)
+{
+    PARSING_DATA data = {};
+    data.type = ParsingDataTypes::FreeformGuidedSection;
+    data.freeformGuidedSection = pdata;
+    setParsingData(index, data);
+}
+
+void TreeModel::setParsingData(const UModelIndex &index, const COMPRESSED_SECTION_PARSING_DATA &pdata)
+{
+    PARSING_DATA data = {};
+    data.type = ParsingDataTypes::CompressedSection;
+    data.compressedSection = pdata;
+    setParsingData(index, data);
+}
+
+void TreeModel::setParsingData(const UModelIndex &index, const TE_IMAGE_SECTION_PARSING_DATA &pdata)
+{
+    PARSING_DATA data = {};
+    data.type = ParsingDataTypes::TeImageSection;
+    data.teImageSection = pdata;
+    setParsingData(index, data);
+}
+
+void TreeModel::setParsingData(const UModelIndex &index, const NVAR_ENTRY_PARSING_DATA &pdata)
+{
+    PARSING_DATA data = {};
+    data.type = ParsingDataTypes::NvarEntry;
+    data.nvarEntry = pdata;
+    setParsingData(index, data);
+}
+
+void TreeModel::setParsingData(const UModelIndex &index, const PARSING_DATA &data)
 {
     if (!index.isValid())
         return;
@@ -524,7 +759,10 @@ UModelIndex TreeModel::addItem(const UINT32 offset, const UINT8 type, const UINT
         }
     }
     
-    TreeItem *newItem = new TreeItem(offset, type, subtype, name, text, info, header, body, tail, Movable, this->compressed(parent), parentItem);
+    if (mode != CREATE_MODE_APPEND && mode != CREATE_MODE_PREPEND && mode != CREATE_MODE_BEFORE && mode != CREATE_MODE_AFTER)
+        return UModelIndex();
+    
+    TreeItem *newItem = itemPool.create(offset, type, subtype, name, text, infoEnabledFlag ? info : UString(), header, body, tail, Movable, this->compressed(parent), parentItem);
     
     if (mode == CREATE_MODE_APPEND) {
         emit layoutAboutToBeChanged();
@@ -538,15 +776,12 @@ UModelIndex TreeModel::addItem(const UINT32 offset, const UINT8 type, const UINT
         emit layoutAboutToBeChanged();
         parentItem->insertChildBefore(item, newItem);
     }
-    else if (mode == CREATE_MODE_AFTER) {
+    else { // CREATE_MODE_AFTER
         emit layoutAboutToBeChanged();
         parentItem->insertChildAfter(item, newItem);
     }
-    else {
-        delete newItem;
-        return UModelIndex();
-    }
     
+    invalidateBaseIndex();
     emit layoutChanged();
     
     UModelIndex created = createIndex(newItem->row(), parentColumn, newItem);
@@ -554,6 +789,18 @@ UModelIndex TreeModel::addItem(const UINT32 offset, const UINT8 type, const UINT
     return created;
 }
 
+UModelIndex TreeModel::addItem(const UINT32 offset, const UINT8 type, const UINT8 subtype,
+                               const UString & name, const UString & text, const ItemInfoFormatter & info,
+                               const UByteArray & header, const UByteArray & body, const UByteArray & tail,
+                               const ItemFixedState fixed,
+                               const UModelIndex & parent, const UINT8 mode)
+{
+    UModelIndex created = addItem(offset, type, subtype, name, text, UString(), header, body, tail, fixed, parent, mode);
+    if (created.isValid() && infoEnabledFlag)
+        static_cast<TreeItem*>(created.internalPointer())->setInfo(info);
+    return created;
+}
+
 UModelIndex TreeModel::findParentOfType(const UModelIndex& index, UINT8 type) const
 {
     if (!index.isValid() || !index.parent().isValid())
@@ -591,24 +838,219 @@ UModelIndex TreeModel::findLastParentOfType(const UModelIndex& index, UINT8 type
     return lastParentOfType;
 }
 
+void TreeModel::buildBaseIndex() const
+{
+    baseIndex.clear();
+    
+    // Walk the tree in pre-order, items without meaningful base are skipped with their children
+    std::vector<TreeItem*> stack;
+    for (int i = rootItem->childCount() - 1; i >= 0; i--)
+        stack.push_back(rootItem->child(i));
+    
+    while (!stack.empty()) {
+        TreeItem* item = stack.back();
+        stack.pop_back();
+        
+        if (!item->hasMeaningfulBase())
+            continue;
+        
+        BASE_INDEX_ENTRY entry;
+        entry.base = item->base();
+        entry.size = item->dataSize();
+        entry.item = item;
+        baseIndex.push_back(entry);
+        
+        for (int i = item->childCount() - 1; i >= 0; i--)
+            stack.push_back(item->child(i));
+    }
+    
+    // Pre-order is already sorted by base for well-formed trees, stable sort keeps parents before their children otherwise
+    std::stable_sort(baseIndex.begin(), baseIndex.end(), [](const BASE_INDEX_ENTRY & a, const BASE_INDEX_ENTRY & b) { return a.base < b.base; });
+    
+    // Build implicit search tree over the sorted entries, every middle element of a subrange holds the maximal end of that subrange
+    baseIndexMaxEnd.assign(baseIndex.size(), 0);
+    std::vector<std::pair<size_t, size_t> > ranges;
+    if (!baseIndex.empty())
+        ranges.push_back(std::make_pair((size_t)0, baseIndex.size()));
+    // Process ranges top-down, then compute maximums bottom-up in reverse order
+    for (size_t i = 0; i < ranges.size(); i++) {
+        size_t low = ranges[i].first, high = ranges[i].second, middle = low + (high - low) / 2;
+        if (low < middle)
+            ranges.push_back(std::make_pair(low, middle));
+        if (middle + 1 < high)
+            ranges.push_back(std::make_pair(middle + 1, high));
+    }
+    for (size_t i = ranges.size(); i > 0; i--) {
+        size_t low = ranges[i - 1].first, high = ranges[i - 1].second, middle = low + (high - low) / 2;
+        UINT64 maxEnd = (UINT64)baseIndex[middle].base + baseIndex[middle].size;
+        if (low < middle)
+            maxEnd = std::max(maxEnd, baseIndexMaxEnd[low + (middle - low) / 2]);
+        if (middle + 1 < high)
+            maxEnd = std::max(maxEnd, baseIndexMaxEnd[middle + 1 + (high - middle - 1) / 2]);
+        baseIndexMaxEnd[middle] = maxEnd;
+    }
+    
+    baseIndexValid = true;
+}
+
+void TreeModel::findOverlappingRecursive(const size_t low, const size_t high, const UINT64 begin, const UINT64 end, std::vector<TreeItem*> & found) const
+{
+    if (low >= high)
+        return;
+    
+    size_t middle = low + (high - low) / 2;
+    if (baseIndexMaxEnd[middle] <= begin) // Nothing in this subrange ends after the beginning of the requested range
+        return;
+    
+    findOverlappingRecursive(low, middle, begin, end, found);
+    
+    const BASE_INDEX_ENTRY & entry = baseIndex[middle];
+    if (entry.base < end) {
+        if ((UINT64)entry.base + entry.size > begin)
+            found.push_back(entry.item);
+        findOverlappingRecursive(middle + 1, high, begin, end, found);
+    }
+}
+
+std::vector<UModelIndex> TreeModel::findOverlapping(const UINT32 base, const UINT32 size) const
+{
+    std::vector<UModelIndex> result;
+    if (size == 0)
+        return result;
+    
+    if (!baseIndexValid)
+        buildBaseIndex();
+    
+    std::vector<TreeItem*> found;
+    findOverlappingRecursive(0, baseIndex.size(), base, (UINT64)base + size, found);
+    for (size_t i = 0; i < found.size(); i++)
+        result.push_back(createIndex(found[i]->row(), 0, found[i]));
+    
+    return result;
+}
+
 UModelIndex TreeModel::findByBase(UINT32 base) const
 {
-    UModelIndex parentIndex = index(0,0);
+    UModelIndex topIndex = index(0, 0);
+    if (!topIndex.isValid())
+        return UModelIndex();
+    
+    if (!baseIndexValid)
+        buildBaseIndex();
+    
+    std::vector<TreeItem*> found;
+    findOverlappingRecursive(0, baseIndex.size(), base, (UINT64)base + 1, found);
+    
+    // Descend from the first top-level item, choosing the first child that contains the base on every level
+    TreeItem* current = static_cast<TreeItem*>(topIndex.internalPointer());
+    for (;;) {
+        TreeItem* candidate = NULL;
+        for (size_t i = 0; i < found.size(); i++) {
+            if (found[i]->parent() == current && (candidate == NULL || found[i]->row() < candidate->row()))
+                candidate = found[i];
+        }
+        if (candidate == NULL)
+            break;
+        current = candidate;
+    }
+    
+    if (current == topIndex.internalPointer())
+        return UModelIndex();
+    return createIndex(current->row(), 0, current);
+}
+
+UModelIndex TreeModel::copyFrom(const TreeModel & source, const UModelIndex & sourceIndex, const bool exclusive)
+{
+    if (detachedCopies.empty()) {
+        DETACHED_COPY root = { rootItem, source.rootItem, false };
+        detachedCopies.push_back(root);
+        detachedCopyByOriginal[source.rootItem] = 0;
+        detachedOriginalByCopy[rootItem] = source.rootItem;
+    }
+    
+    // Collect the item and all its parents up to the root
+    std::vector<TreeItem*> path;
+    TreeItem *item = sourceIndex.isValid() ? static_cast<TreeItem*>(sourceIndex.internalPointer()) : source.rootItem;
+    for (; item != source.rootItem; item = item->parent())
+        path.push_back(item);
+    
+    // Copy them starting from the root, without other children
+    TreeItem *copy = rootItem;
+    size_t copyNumber = 0;
+    for (size_t i = path.size(); i > 0; i--) {
+        TreeItem *original = path[i - 1];
+        std::map<const TreeItem*, size_t>::const_iterator found = detachedCopyByOriginal.find(original);
+        if (found != detachedCopyByOriginal.end()) {
+            copyNumber = found->second;
+            copy = detachedCopies[copyNumber].copy;
+            continue;
+        }
+        
+        TreeItem *parentCopy = copy;
+        copy = itemPool.create(original->offset(), original->type(), original->subtype(), UString(), UString(), UString(),
+                               UByteArray(), UByteArray(), UByteArray(), original->fixed(), original->compressed(), parentCopy);
+        copy->copyParameters(*original);
+        parentCopy->appendChild(copy);
+        
+        DETACHED_COPY entry = { copy, original, false };
+        copyNumber = detachedCopies.size();
+        detachedCopies.push_back(entry);
+        detachedCopyByOriginal[original] = copyNumber;
+        detachedOriginalByCopy[copy] = original;
+    }
+    
+    if (copy == rootItem)
+        return UModelIndex();
+    
+    if (exclusive)
+        detachedCopies[copyNumber].exclusive = true;
+    return createIndex(copy->row(), sourceIndex.column(), copy);
+}
+
+void TreeModel::attachDetached(TreeModel & detached)
+{
+    emit layoutAboutToBeChanged();
     
-goDeeper:
-    int n = rowCount(parentIndex);
-    for (int i = 0; i < n; i++) {
-        UModelIndex currentIndex = parentIndex.model()->index(i, 0, parentIndex);
+    for (size_t i = 0; i < detached.detachedCopies.size(); i++) {
+        const DETACHED_COPY & entry = detached.detachedCopies[i];
+        
+        // New children are appended after existing ones, copies are already there
+        std::vector<TreeItem*> children = entry.copy->takeChildren();
+        for (size_t j = 0; j < children.size(); j++) {
+            if (detached.detachedOriginalByCopy.count(children[j]) == 0)
+                entry.original->adoptChild(children[j]);
+        }
         
-        UINT32 currentBase = this->base(currentIndex);
-        UINT32 fullSize = (UINT32)(header(currentIndex).size() + body(currentIndex).size() + tail(currentIndex).size());
-        if ((compressed(currentIndex) == false || (compressed(currentIndex) == true && compressed(currentIndex.parent()) == false)) // Base is meaningful only for true uncompressed items
-            && currentBase <= base && base < currentBase + fullSize) { // Base must be in range [currentBase, currentBase + fullSize)
-            // Found a better candidate
-            parentIndex = currentIndex;
-            goto goDeeper;
+        // Exclusive items are owned by the detached model, other items are shared with other detached models
+        // Shared items are expected to only become fixed, any other change is still copied back, so it isn't lost
+        if (entry.exclusive) {
+            entry.original->copyParameters(*entry.copy);
+        }
+        else {
+            const bool fixed = entry.original->fixed() || entry.copy->fixed();
+            if (!entry.copy->hasSameParameters(*entry.original))
+                entry.original->copyParameters(*entry.copy);
+            entry.original->setFixed(fixed);
         }
     }
     
-    return (parentIndex == index(0, 0) ? UModelIndex() : parentIndex);
+    itemPool.take(detached.itemPool);
+    
+    invalidateBaseIndex();
+    emit layoutChanged();
+}
+
+UModelIndex TreeModel::mapFromDetached(const TreeModel & detached, const UModelIndex & index) const
+{
+    if (!index.isValid())
+        return UModelIndex();
+    
+    TreeItem *item = static_cast<TreeItem*>(index.internalPointer());
+    std::map<const TreeItem*, TreeItem*>::const_iterator found = detached.detachedOriginalByCopy.find(item);
+    if (found != detached.detachedOriginalByCopy.end())
+        item = found->second;
+    
+    if (item == rootItem)
+        return UModelIndex();
+    return createIndex(item->row(), index.column(), item);
 }
@@ -14,6 +14,10 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #ifndef TREEMODEL_H
 #define TREEMODEL_H
 
+#include <functional>
+#include <map>
+#include <vector>
+
 enum ItemFixedState {
     Movable,
     Fixed
@@ -41,6 +45,7 @@ enum BootGuardMarking {
 #include "basetypes.h"
 #include "types.h"
 #include "treeitem.h"
+#include "parsingdata.h"
 
 #define UModelIndex QModelIndex
 #else
@@ -50,6 +55,7 @@ enum BootGuardMarking {
 #include "basetypes.h"
 #include "types.h"
 #include "treeitem.h"
+#include "parsingdata.h"
 
 class TreeModel;
 
@@ -94,17 +100,20 @@ private:
 class TreeModel : public QAbstractItemModel
 {
 private:
+    TreeItemPool itemPool;
     TreeItem *rootItem;
     bool markingEnabledFlag;
     bool markingDarkModeFlag;
+    bool infoEnabledFlag;
+    UINT64 addressDiff;
 
 public:
     QVariant data(const UModelIndex &index, int role) const;
     Qt::ItemFlags flags(const UModelIndex &index) const;
     QVariant headerData(int section, Qt::Orientation orientation,
         int role = Qt::DisplayRole) const;
-    TreeModel(QObject *parent = 0) : QAbstractItemModel(parent), markingEnabledFlag(true), markingDarkModeFlag(false) {
-        rootItem = new TreeItem(0, Types::Root, 0, UString(), UString(), UString(), UByteArray(), UByteArray(), UByteArray(), true, false);
+    TreeModel(QObject *parent = 0) : QAbstractItemModel(parent), markingEnabledFlag(true), markingDarkModeFlag(false), infoEnabledFlag(true), addressDiff(0x100000000ULL), baseIndexValid(false) {
+        rootItem = itemPool.create(0, Types::Root, 0, UString(), UString(), UString(), UByteArray(), UByteArray(), UByteArray(), true, false);
     }
 
 #else
@@ -113,9 +122,12 @@ public:
 class TreeModel
 {
 private:
+    TreeItemPool itemPool;
     TreeItem *rootItem;
     bool markingEnabledFlag;
     bool markingDarkModeFlag;
+    bool infoEnabledFlag;
+    UINT64 addressDiff;
 
     void dataChanged(const UModelIndex &, const UModelIndex &) {}
     void layoutAboutToBeChanged() {}
@@ -125,8 +137,8 @@ public:
     UString data(const UModelIndex &index, int role) const;
     UString headerData(int section, int orientation, int role = 0) const;
 
-    TreeModel() : markingEnabledFlag(false), markingDarkModeFlag(false) {
-        rootItem = new TreeItem(0, Types::Root, 0, UString(), UString(), UString(), UByteArray(), UByteArray(), UByteArray(), true, false);
+    TreeModel() : markingEnabledFlag(false), markingDarkModeFlag(false), infoEnabledFlag(true), addressDiff(0x100000000ULL), baseIndexValid(false) {
+        rootItem = itemPool.create(0, Types::Root, 0, UString(), UString(), UString(), UByteArray(), UByteArray(), UByteArray(), true, false);
     }
 
     bool hasIndex(int row, int column, const UModelIndex &parent = UModelIndex()) const {
@@ -138,9 +150,7 @@ public:
     UModelIndex createIndex(int row, int column, void *data) const { return UModelIndex(row, column, data, this); }
 #endif
 
-    ~TreeModel() {
-        delete rootItem;
-    }
+    ~TreeModel() {} // All items are freed by itemPool
 
     bool markingEnabled() { return markingEnabledFlag; }
     void setMarkingEnabled(const bool enabled);
@@ -148,15 +158,34 @@ public:
     bool markingDarkMode() { return markingDarkModeFlag; }
     void setMarkingDarkMode(const bool enabled);
 
+    // Disabled info is neither stored nor generated, to be used by tools that never show it
+    bool infoEnabled() const { return infoEnabledFlag; }
+    void setInfoEnabled(const bool enabled) { infoEnabledFlag = enabled; }
+
+    // Difference between physical addresses and image offsets, used to generate location info
+    void setAddressDiff(const UINT64 diff) { addressDiff = diff; }
+
     UModelIndex index(int row, int column, const UModelIndex &parent = UModelIndex()) const;
     UModelIndex parent(const UModelIndex &index) const;
     int rowCount(const UModelIndex &parent = UModelIndex()) const;
     int columnCount(const UModelIndex &parent = UModelIndex()) const;
 
+    // Children of pending items are parsed on demand by the fetch handler, i.e. contents of lazily decompressed sections
+    bool hasChildren(const UModelIndex &parent = UModelIndex()) const;
+    bool canFetchMore(const UModelIndex &parent) const;
+    void fetchMore(const UModelIndex &parent);
+    // Fetch all pending items of the subtree, to be called before traversing all of it
+    void fetchAll(const UModelIndex &index = UModelIndex());
+    void setFetchHandler(const std::function<void(const UModelIndex &)> &handler) { fetchHandler = handler; }
+
+    bool fetchPending(const UModelIndex &index) const;
+    void setFetchPending(const UModelIndex &index, const bool pending);
+
     UINT8 action(const UModelIndex &index) const;
     void setAction(const UModelIndex &index, const UINT8 action);
 
     UINT32 base(const UModelIndex &index) const;
+    bool hasMeaningfulBase(const UModelIndex &index) const;
     UINT32 offset(const UModelIndex &index) const;
     void setOffset(const UModelIndex &index, const UINT32 offset);
 
@@ -172,9 +201,13 @@ public:
     UString text(const UModelIndex &index) const;
     void setText(const UModelIndex &index, const UString &text);
 
+    // Info can also be given as a formatter, called on the first request of info of the item
     UString info(const UModelIndex &index) const;
     void setInfo(const UModelIndex &index, const UString &info);
+    void setInfo(const UModelIndex &index, const ItemInfoFormatter &formatter);
     void addInfo(const UModelIndex &index, const UString &info, const bool append = true);
+    void addInfo(const UModelIndex &index, const ItemInfoFormatter &formatter, const bool append = true);
+    void setLocationInfo(const UModelIndex &index, const bool enabled);
 
     bool fixed(const UModelIndex &index) const;
     void setFixed(const UModelIndex &index, const bool fixed);
@@ -194,23 +227,87 @@ public:
 
     UByteArray body(const UModelIndex &index) const;
     bool hasEmptyBody(const UModelIndex &index) const;
+    UINT32 bodySize(const UModelIndex &index) const;
 
     UByteArray tail(const UModelIndex &index) const;
     bool hasEmptyTail(const UModelIndex &index) const;
 
-    UByteArray parsingData(const UModelIndex &index) const;
+    // Size and CRC32 of header, body and tail together, CRC32 is calculated once and cached in the item
+    UINT32 dataSize(const UModelIndex &index) const;
+    UINT32 dataCrc32(const UModelIndex &index) const;
+
     bool hasEmptyParsingData(const UModelIndex &index) const;
-    void setParsingData(const UModelIndex &index, const UByteArray &pdata);
+    const VOLUME_PARSING_DATA* volumeParsingData(const UModelIndex &index) const;
+    const FILE_PARSING_DATA* fileParsingData(const UModelIndex &index) const;
+    const GUIDED_SECTION_PARSING_DATA* guidedSectionParsingData(const UModelIndex &index) const;
+    const FREEFORM_GUIDED_SECTION_PARSING_DATA* freeformGuidedSectionParsingData(const UModelIndex &index) const;
+    const COMPRESSED_SECTION_PARSING_DATA* compressedSectionParsingData(const UModelIndex &index) const;
+    const TE_IMAGE_SECTION_PARSING_DATA* teImageSectionParsingData(const UModelIndex &index) const;
+    const NVAR_ENTRY_PARSING_DATA* nvarEntryParsingData(const UModelIndex &index) const;
+    void setParsingData(const UModelIndex &index, const VOLUME_PARSING_DATA &pdata);
+    void setParsingData(const UModelIndex &index, const FILE_PARSING_DATA &pdata);
+    void setParsingData(const UModelIndex &index, const GUIDED_SECTION_PARSING_DATA &pdata);
+    void setParsingData(const UModelIndex &index, const FREEFORM_GUIDED_SECTION_PARSING_DATA &pdata);
+    void setParsingData(const UModelIndex &index, const COMPRESSED_SECTION_PARSING_DATA &pdata);
+    void setParsingData(const UModelIndex &index, const TE_IMAGE_SECTION_PARSING_DATA &pdata);
+    void setParsingData(const UModelIndex &index, const NVAR_ENTRY_PARSING_DATA &pdata);
 
     UModelIndex addItem(const UINT32 offset, const UINT8 type, const UINT8 subtype,
         const UString & name, const UString & text, const UString & info,
         const UByteArray & header, const UByteArray & body, const UByteArray & tail,
         const ItemFixedState fixed,
         const UModelIndex & parent = UModelIndex(), const UINT8 mode = CREATE_MODE_APPEND);
+    UModelIndex addItem(const UINT32 offset, const UINT8 type, const UINT8 subtype,
+        const UString & name, const UString & text, const ItemInfoFormatter & info,
+        const UByteArray & header, const UByteArray & body, const UByteArray & tail,
+        const ItemFixedState fixed,
+        const UModelIndex & parent = UModelIndex(), const UINT8 mode = CREATE_MODE_APPEND);
 
     UModelIndex findParentOfType(const UModelIndex & index, UINT8 type) const;
     UModelIndex findLastParentOfType(const UModelIndex & index, UINT8 type) const;
     UModelIndex findByBase(UINT32 base) const;
+    std::vector<UModelIndex> findOverlapping(const UINT32 base, const UINT32 size) const;
+
+    // Detached models hold copies of items of another model, so parts of it can be parsed independently
+    // Copy an item of the source model with all its parents into this detached model, reusing already copied ones
+    // Exclusive items are owned by the detached model, so their parameters are copied back on attach
+    UModelIndex copyFrom(const TreeModel & source, const UModelIndex & sourceIndex, const bool exclusive);
+    // Move all new items of the detached model under their original parents, in order of copying
+    // Detached model can only be used to map indexes afterwards
+    void attachDetached(TreeModel & detached);
+    // Index in this model of an item of the attached model
+    UModelIndex mapFromDetached(const TreeModel & detached, const UModelIndex & index) const;
+
+private:
+    const PARSING_DATA* parsingData(const UModelIndex &index, const UINT8 type) const;
+    void setParsingData(const UModelIndex &index, const PARSING_DATA &pdata);
+    UString locationInfo(const TreeItem *item) const;
+
+    std::function<void(const UModelIndex &)> fetchHandler;
+
+    // Interval index over items with meaningful base, sorted by base and rebuilt on demand after structural changes
+    struct BASE_INDEX_ENTRY {
+        UINT32 base;
+        UINT32 size;
+        TreeItem* item;
+    };
+    mutable std::vector<BASE_INDEX_ENTRY> baseIndex;
+    mutable std::vector<UINT64> baseIndexMaxEnd;
+    mutable bool baseIndexValid;
+
+    void invalidateBaseIndex() { baseIndexValid = false; }
+    void buildBaseIndex() const;
+    void findOverlappingRecursive(const size_t low, const size_t high, const UINT64 begin, const UINT64 end, std::vector<TreeItem*> & found) const;
+
+    // Copies of items of the source model, in order of copying
+    struct DETACHED_COPY {
+        TreeItem* copy;
+        TreeItem* original;
+        bool exclusive;
+    };
+    std::vector<DETACHED_COPY> detachedCopies;
+    std::map<const TreeItem*, size_t> detachedCopyByOriginal;
+    std::map<const TreeItem*, TreeItem*> detachedOriginalByCopy;
 };
 
 #if defined(QT_CORE_LIB)
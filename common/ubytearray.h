@@ -20,64 +20,107 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #else
 // Use own implementation
 #include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <memory>
+#include <stdexcept>
 
+// Implicitly shared byte array, copy is made on first write to a shared storage.
+// Slices obtained with left(), right() and mid() share storage with the original array.
+// Storage can also be external read-only memory, i.e. a mapped file, kept alive by a shared pointer.
 class UByteArray
 {
 public:
-    UByteArray() : d() {}
-    UByteArray(const UByteArray & ba) : d(ba.d) {}
-    UByteArray(const std::basic_string<char> & bs) : d(bs) {}
-    UByteArray(const std::vector<char> & bc) : d(bc.data(), bc.size()) {}
-    UByteArray(const char* bytes, int32_t size) : d(bytes, size) {}
-    UByteArray(const size_t n, char c) : d(n, c) {}
+    UByteArray() : d(), e(), o(0), n(0) {}
+    UByteArray(const UByteArray & ba) : d(ba.d), e(ba.e), o(ba.o), n(ba.n) {}
+    UByteArray(const std::basic_string<char> & bs) : d(), e(), o(0), n(bs.size()) { if (n) d = std::make_shared<std::basic_string<char> >(bs); }
+    UByteArray(const std::vector<char> & bc) : d(), e(), o(0), n(bc.size()) { if (n) d = std::make_shared<std::basic_string<char> >(bc.data(), bc.size()); }
+    UByteArray(const char* bytes, int32_t size) : d(), e(), o(0), n(0) { std::basic_string<char> s(bytes, size); n = s.size(); if (n) d = std::make_shared<std::basic_string<char> >(s); }
+    UByteArray(const size_t len, char c) : d(), e(), o(0), n(len) { if (n) d = std::make_shared<std::basic_string<char> >(n, c); }
+    UByteArray(const std::shared_ptr<const char> & external, const size_t len) : d(), e(external), o(0), n(len) { if (n == 0) e.reset(); }
     ~UByteArray() {}
 
-    bool isEmpty() const { return d.length() == 0; }
-       
-    char* data() { return d.length() == 0 ? NULL : &(d.at(0)); /* Feels dirty, but works for all basic_string implementations I know, is fully OK in C++11 and later*/ }
-    const char* data() const { return d.c_str(); }
-    const char* constData() const { return d.c_str(); }
-    void clear() { d.clear(); }
+    bool isEmpty() const { return n == 0; }
+    // Slices and arrays over external memory don't have storage of their own
+    bool isView() const { return n != 0 && (e || o != 0 || n != d->size()); }
 
-    UByteArray toUpper() { std::basic_string<char> s = d; std::transform(s.begin(), s.end(), s.begin(), ::toupper); return UByteArray(s); }
-    uint32_t toUInt(bool* ok = NULL, const uint8_t base = 10) { return (uint32_t)strtoul(d.c_str(), NULL, base); }
+    // Slices are not guaranteed to be null-terminated, use size() to get the length
+    char* data() { if (n == 0) return NULL; detach(); return &(*d)[0]; }
+    const char* data() const { return constData(); }
+    const char* constData() const { return n == 0 ? "" : storage() + o; }
+    void clear() { d.reset(); e.reset(); o = 0; n = 0; }
 
-    int32_t size() const { return (int32_t)d.size();  }
-    int32_t count(char ch) const { return (int32_t)std::count(d.begin(), d.end(), ch); }
-    char at(uint32_t i) const { return d.at(i); }
-    char operator[](uint32_t i) const { return d[i]; }
-    char& operator[](uint32_t i) { return d[i]; }
+    UByteArray toUpper() { std::basic_string<char> s(constData(), n); std::transform(s.begin(), s.end(), s.begin(), ::toupper); return UByteArray(s); }
+    uint32_t toUInt(bool* ok = NULL, const uint8_t base = 10) { std::basic_string<char> s(constData(), n); return (uint32_t)strtoul(s.c_str(), NULL, base); }
 
-    bool startsWith(const UByteArray & ba) const { return 0 == d.find(ba.d, 0); }
-    int indexOf(const UByteArray & ba, int from = 0) const { return (int)d.find(ba.d, from); }
+    int32_t size() const { return (int32_t)n; }
+    int32_t count(char ch) const { return (int32_t)std::count(begin(), end(), ch); }
+    char at(uint32_t i) const { if (i >= n) throw std::out_of_range("UByteArray::at"); return constData()[i]; }
+    char operator[](uint32_t i) const { return constData()[i]; }
+    char& operator[](uint32_t i) { if (i >= n) throw std::out_of_range("UByteArray::operator[]"); detach(); return (*d)[i]; }
+
+    bool startsWith(const UByteArray & ba) const { return ba.n <= n && 0 == memcmp(constData(), ba.constData(), ba.n); }
+    int indexOf(const UByteArray & ba, int from = 0) const {
+        if (from < 0 || (size_t)from > n)
+            return -1;
+        const char* found = std::search(begin() + from, end(), ba.begin(), ba.end());
+        if (found == end() && ba.n > 0)
+            return -1;
+        return (int)(found - begin());
+    }
     int lastIndexOf(const UByteArray & ba, int from = 0) const {
-        size_t old_index = d.npos;
-        size_t index = d.find(ba.d, from);
-        while (index != d.npos) {
+        int old_index = -1;
+        int index = indexOf(ba, from);
+        while (index != -1) {
             old_index = index;
-            index = d.find(ba.d, index + 1);
+            index = indexOf(ba, index + 1);
         }
-        return (int)old_index;
+        return old_index;
     }
 
-    UByteArray left(int32_t len) const { return d.substr(0, len); }
-    UByteArray right(int32_t len) const { return d.substr(d.size() - len, len); }
-    UByteArray mid(int32_t pos, int32_t len = -1) const { return d.substr(pos, len); }
-
-    UByteArray & operator=(const UByteArray & ba) { d = ba.d; return *this; }
-    UByteArray & operator+=(const UByteArray & ba) { d += ba.d; return *this; }
-    UByteArray & operator+=(const char c) { d += c; return *this; }
-    bool operator== (const UByteArray & ba) const { return d == ba.d; }
-    bool operator!= (const UByteArray & ba) const { return d != ba.d; }
-    inline void swap(UByteArray &other) { std::swap(d, other.d); }
-    UByteArray toHex() {
+    UByteArray left(int32_t len) const { return mid(0, len); }
+    UByteArray right(int32_t len) const { return mid((int32_t)(n - (size_t)len), len); }
+    UByteArray mid(int32_t pos, int32_t len = -1) const {
+        // Same semantics as std::basic_string::substr
+        if ((size_t)pos > n)
+            throw std::out_of_range("UByteArray::mid");
+        UByteArray ba(*this);
+        ba.o = o + (size_t)pos;
+        ba.n = std::min((size_t)len, n - (size_t)pos);
+        if (ba.n == 0)
+            ba.clear();
+        return ba;
+    }
+
+    UByteArray & operator=(const UByteArray & ba) { d = ba.d; e = ba.e; o = ba.o; n = ba.n; return *this; }
+    UByteArray & operator+=(const UByteArray & ba) {
+        if (n == 0) { return *this = ba; }
+        if (ba.n == 0) { return *this; }
+        UByteArray tail(ba); // ba might share storage with this array
+        detach();
+        d->append(tail.constData(), tail.n);
+        n = d->size();
+        return *this;
+    }
+    UByteArray & operator+=(const char c) {
+        if (n == 0) { d = std::make_shared<std::basic_string<char> >(1, c); e.reset(); o = 0; n = 1; return *this; }
+        detach();
+        *d += c;
+        n = d->size();
+        return *this;
+    }
+    bool operator== (const UByteArray & ba) const { return n == ba.n && (n == 0 || 0 == memcmp(constData(), ba.constData(), n)); }
+    bool operator!= (const UByteArray & ba) const { return !(*this == ba); }
+    inline void swap(UByteArray &other) { std::swap(d, other.d); std::swap(e, other.e); std::swap(o, other.o); std::swap(n, other.n); }
+    UByteArray toHex() const {
+        const char* p = constData();
         std::basic_string<char> hex(size() * 2, '\x00');
         for (int32_t i = 0; i < size(); i++) {
-            uint8_t low  = d[i] & 0x0F;
-            uint8_t high = (d[i] & 0xF0) >> 4;
+            uint8_t low  = p[i] & 0x0F;
+            uint8_t high = (p[i] & 0xF0) >> 4;
             low += (low < 10 ? '0' : 'a' - 10);
             high += (high < 10 ? '0' : 'a' - 10);
             hex[2*i] = high;
@@ -86,13 +129,27 @@ public:
         return UByteArray(hex);
     }
 
-    std::basic_string<char>::iterator begin() {return d.begin();}
-    std::basic_string<char>::iterator end() {return d.end();}
-    std::basic_string<char>::const_iterator begin() const {return d.begin();}
-    std::basic_string<char>::const_iterator end() const {return d.end();}
-    
+    char* begin() { return n == 0 ? NULL : data(); }
+    char* end() { return begin() + n; }
+    const char* begin() const { return constData(); }
+    const char* end() const { return constData() + n; }
+
 private:
-    std::basic_string<char> d;
+    const char* storage() const { return d ? d->data() : e.get(); }
+
+    // Make storage exclusively owned by this array and trimmed to its bounds, external storage is always copied
+    void detach() {
+        if (n == 0 || (d && d.use_count() == 1 && o == 0 && d->size() == n))
+            return;
+        d = std::make_shared<std::basic_string<char> >(storage() + o, n);
+        e.reset();
+        o = 0;
+    }
+
+    std::shared_ptr<std::basic_string<char> > d;
+    std::shared_ptr<const char> e;
+    size_t o;
+    size_t n;
 };
 
 inline const UByteArray operator+(const UByteArray &a1, const UByteArray &a2)
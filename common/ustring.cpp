@@ -113,7 +113,7 @@ UString uFromUcs2(const char* str, size_t max_len)
     UString msg;
     const char *str8 = str;
     size_t rest = (max_len == 0) ? SIZE_MAX : max_len;
-    while (str8[0] && rest) {
+    while (rest && str8[0]) {
         msg += str8[0];
         str8 += 2;
         rest--;
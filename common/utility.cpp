@@ -11,9 +11,13 @@
  
  */
 
+#include <algorithm>
 #include <cstdio>
 #include <cctype>
 #include <cstring>
+#include <memory>
+#include <new>
+#include <vector>
 
 #include "treemodel.h"
 #include "utility.h"
@@ -23,6 +27,14 @@
 #include "LZMA/LzmaCompress.h"
 #include "LZMA/LzmaDecompress.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FILL_BYTE_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define FILL_BYTE_NEON
+#endif
+
 // Returns bytes as string when all bytes are ascii visible, hex representation otherwise
 UString visibleAsciiOrHex(UINT8* bytes, UINT32 length)
 {
@@ -196,12 +208,67 @@ UString errorCodeToUString(USTATUS errorCode)
 }
 
 // Compression routines
-USTATUS decompress(const UByteArray & compressedData, const UINT8 compressionType, UINT8 & algorithm, UINT32 & dictionarySize, UByteArray & decompressedData, UByteArray & efiDecompressedData)
+// Scratch buffers are reused by all decompressions done by the same thread
+// Sizes come from headers of compressed data, so NULL is returned if there is no memory for them
+static UINT8* scratchBuffer(const UINT32 size)
+{
+    static thread_local std::vector<UINT8> buffer;
+    if (buffer.size() < size) {
+        try {
+            buffer.resize(size);
+        }
+        catch (const std::bad_alloc &) {
+            return NULL;
+        }
+    }
+    return buffer.data();
+}
+
+// Decompressed data is written directly into the output array, allocated once with the size from the header
+// The array is left uninitialized, decoders overwrite all of it, and untouched pages of oversized arrays are not committed
+// NULL is returned and the array is cleared if there is no memory for it
+static UINT8* outputBuffer(UByteArray & output, const UINT32 size)
+{
+#if defined(QT_CORE_LIB)
+    try {
+        output = UByteArray((int)size, Qt::Uninitialized);
+    }
+    catch (const std::bad_alloc &) {
+        output.clear();
+        return NULL;
+    }
+    return (UINT8*)output.data();
+#else
+    char* buffer = new (std::nothrow) char[size];
+    if (!buffer) {
+        output.clear();
+        return NULL;
+    }
+    output = UByteArray(std::shared_ptr<const char>(buffer, std::default_delete<char[]>()), size);
+    return (UINT8*)buffer;
+#endif
+}
+
+// Data produced into a larger buffer is trimmed to its size, with a copy only made if much of the buffer would be wasted
+static void trimOutput(UByteArray & output, const UINT32 produced)
+{
+    const UINT32 slack = (UINT32)output.size() - produced;
+    if (slack == 0)
+        return;
+    if (slack > std::max(produced / 4, (UINT32)0x10000))
+        output = UByteArray(output.constData(), (int)produced);
+    else
+#if defined(QT_CORE_LIB)
+        output.truncate((int)produced);
+#else
+        output = output.left((int)produced);
+#endif
+}
+
+USTATUS decompress(const UByteArray & compressedData, const UINT8 compressionType, UINT8 & algorithm, UINT32 & dictionarySize, UByteArray & decompressedData, UByteArray & efiDecompressedData, const bool tryBothAlgorithms)
 {
     const UINT8* data;
     UINT32 dataSize;
-    UINT8* decompressed;
-    UINT8* efiDecompressed;
     UINT32 decompressedSize = 0;
     UINT8* scratch;
     UINT32 scratchSize = 0;
@@ -222,10 +289,12 @@ USTATUS decompress(const UByteArray & compressedData, const UINT8 compressionTyp
             algorithm = COMPRESSION_ALGORITHM_UNKNOWN;
             
             // Get buffer sizes
-            data = (UINT8*)compressedData.data();
+            data = (const UINT8*)compressedData.constData();
             dataSize = (UINT32)compressedData.size();
             
             // Check header to be valid
+            if (dataSize < sizeof(EFI_TIANO_HEADER))
+                return U_STANDARD_DECOMPRESSION_FAILED;
             header = (const EFI_TIANO_HEADER*)data;
             if (header->CompSize + sizeof(EFI_TIANO_HEADER) != dataSize)
                 return U_STANDARD_DECOMPRESSION_FAILED;
@@ -234,48 +303,57 @@ USTATUS decompress(const UByteArray & compressedData, const UINT8 compressionTyp
             if (U_SUCCESS != EfiTianoGetInfo(data, dataSize, &decompressedSize, &scratchSize))
                 return U_STANDARD_DECOMPRESSION_FAILED;
             
-            // Allocate memory
-            decompressed = (UINT8*)malloc(decompressedSize);
-            efiDecompressed = (UINT8*)malloc(decompressedSize);
-            scratch = (UINT8*)malloc(scratchSize);
-            if (!decompressed || !efiDecompressed || !scratch) {
-                free(decompressed);
-                free(efiDecompressed);
-                free(scratch);
+            if (decompressedSize > INT32_MAX)
                 return U_STANDARD_DECOMPRESSION_FAILED;
-            }
             
-            // Decompress section data using both algorithms
-            USTATUS result = U_SUCCESS;
-            // Try Tiano
-            USTATUS TianoResult = TianoDecompress(data, dataSize, decompressed, decompressedSize, scratch, scratchSize);
-            // Try EFI 1.1
-            USTATUS EfiResult = EfiDecompress(data, dataSize, efiDecompressed, decompressedSize, scratch, scratchSize);
+            scratch = scratchBuffer(scratchSize);
+            if (!scratch)
+                return U_STANDARD_DECOMPRESSION_FAILED;
             
-            if (decompressedSize > INT32_MAX) {
-                result = U_STANDARD_DECOMPRESSION_FAILED;
+            // Detect the algorithm from the first block header, unless both are requested explicitly
+            UINT8 versions = 0;
+            if (tryBothAlgorithms || U_SUCCESS != EfiTianoProbe(data, dataSize, scratch, scratchSize, &versions) || versions == 0)
+                versions = 3; // EFI 1.1 and Tiano
+            
+            // Decompress section data with the detected algorithm, the other one is only tried if it fails or both are possible
+            USTATUS TianoResult = U_STANDARD_DECOMPRESSION_FAILED;
+            USTATUS EfiResult = U_STANDARD_DECOMPRESSION_FAILED;
+            bool TianoTried = false;
+            UINT8* output;
+            if (versions & 2) {
+                TianoTried = true;
+                if ((output = outputBuffer(decompressedData, decompressedSize)) != NULL)
+                    TianoResult = TianoDecompress(data, dataSize, output, decompressedSize, scratch, scratchSize);
+            }
+            if (versions & 1 || TianoResult != U_SUCCESS) {
+                if ((output = outputBuffer(efiDecompressedData, decompressedSize)) != NULL)
+                    EfiResult = EfiDecompress(data, dataSize, output, decompressedSize, scratch, scratchSize);
             }
-            else if (EfiResult == U_SUCCESS && TianoResult == U_SUCCESS) { // Both decompressions are OK
+            if (EfiResult != U_SUCCESS && !TianoTried) {
+                if ((output = outputBuffer(decompressedData, decompressedSize)) != NULL)
+                    TianoResult = TianoDecompress(data, dataSize, output, decompressedSize, scratch, scratchSize);
+            }
+            
+            if (EfiResult == U_SUCCESS && TianoResult == U_SUCCESS) { // Both decompressions are OK
                 algorithm = COMPRESSION_ALGORITHM_UNDECIDED;
-                decompressedData = UByteArray((const char*)decompressed, (int)decompressedSize);
-                efiDecompressedData = UByteArray((const char*)efiDecompressed, (int)decompressedSize);
+                return U_SUCCESS;
             }
             else if (TianoResult == U_SUCCESS) { // Only Tiano is OK
                 algorithm = COMPRESSION_ALGORITHM_TIANO;
-                decompressedData = UByteArray((const char*)decompressed, (int)decompressedSize);
+                efiDecompressedData.clear();
+                return U_SUCCESS;
             }
             else if (EfiResult == U_SUCCESS) { // Only EFI 1.1 is OK
                 algorithm = COMPRESSION_ALGORITHM_EFI11;
-                decompressedData = UByteArray((const char*)efiDecompressed, (int)decompressedSize);
-            }
-            else { // Both decompressions failed
-                result = U_STANDARD_DECOMPRESSION_FAILED;
+                decompressedData = efiDecompressedData;
+                efiDecompressedData.clear();
+                return U_SUCCESS;
             }
             
-            free(decompressed);
-            free(efiDecompressed);
-            free(scratch);
-            return result;
+            // Both decompressions failed
+            decompressedData.clear();
+            efiDecompressedData.clear();
+            return U_STANDARD_DECOMPRESSION_FAILED;
         }
         case EFI_CUSTOMIZED_COMPRESSION: {
             // Set default algorithm to unknown
@@ -286,9 +364,14 @@ USTATUS decompress(const UByteArray & compressedData, const UINT8 compressionTyp
             dataSize = (UINT32)compressedData.size();
             
             // Get info as normal LZMA section
+            if (dataSize < LZMA_HEADER_SIZE)
+                return U_CUSTOMIZED_DECOMPRESSION_FAILED;
             if (U_SUCCESS != LzmaGetInfo(data, dataSize, &decompressedSize)) {
-                // Get info as Intel legacy LZMA section
+                // Get info as Intel legacy LZMA section, it has a 4-byte prefix
+                if (dataSize < sizeof(UINT32) + LZMA_HEADER_SIZE)
+                    return U_CUSTOMIZED_DECOMPRESSION_FAILED;
                 data += sizeof(UINT32);
+                dataSize -= sizeof(UINT32);
                 if (U_SUCCESS != LzmaGetInfo(data, dataSize, &decompressedSize)) {
                     return U_CUSTOMIZED_DECOMPRESSION_FAILED;
                 }
@@ -300,26 +383,18 @@ USTATUS decompress(const UByteArray & compressedData, const UINT8 compressionTyp
                 algorithm = COMPRESSION_ALGORITHM_LZMA;
             }
             
-            // Allocate memory
-            decompressed = (UINT8*)malloc(decompressedSize);
-            if (!decompressed) {
-                return U_OUT_OF_MEMORY;
-            }
-            
-            // Decompress section data
-            if (U_SUCCESS != LzmaDecompress(data, dataSize, decompressed)) {
-                free(decompressed);
+            if (decompressedSize > INT32_MAX) {
                 return U_CUSTOMIZED_DECOMPRESSION_FAILED;
             }
             
-            if (decompressedSize > INT32_MAX) {
-                free(decompressed);
+            // Decompress section data
+            UINT8* decompressed = outputBuffer(decompressedData, decompressedSize);
+            if (!decompressed || U_SUCCESS != LzmaDecompress(data, dataSize, decompressed)) {
+                decompressedData.clear();
                 return U_CUSTOMIZED_DECOMPRESSION_FAILED;
             }
             
             dictionarySize = readUnaligned((UINT32*)(data + 1)); // LZMA dictionary size is stored in bytes 1-4 of LZMA properties header
-            decompressedData = UByteArray((const char*)decompressed, (int)decompressedSize);
-            free(decompressed);
             return U_SUCCESS;
         }
         case EFI_CUSTOMIZED_COMPRESSION_LZMAF86: {
@@ -331,25 +406,19 @@ USTATUS decompress(const UByteArray & compressedData, const UINT8 compressionTyp
             dataSize = (UINT32)compressedData.size();
             
             // Get info as normal LZMA section
-            if (U_SUCCESS != LzmaGetInfo(data, dataSize, &decompressedSize)) {
+            if (dataSize < LZMA_HEADER_SIZE || U_SUCCESS != LzmaGetInfo(data, dataSize, &decompressedSize)) {
                 return U_CUSTOMIZED_DECOMPRESSION_FAILED;
             }
             algorithm = COMPRESSION_ALGORITHM_LZMAF86;
             
-            // Allocate memory
-            decompressed = (UINT8*)malloc(decompressedSize);
-            if (!decompressed) {
-                return U_OUT_OF_MEMORY;
-            }
-            
-            // Decompress section data
-            if (U_SUCCESS != LzmaDecompress(data, dataSize, decompressed)) {
-                free(decompressed);
+            if (decompressedSize > INT32_MAX) {
                 return U_CUSTOMIZED_DECOMPRESSION_FAILED;
             }
             
-            if (decompressedSize > INT32_MAX) {
-                free(decompressed);
+            // Decompress section data
+            UINT8* decompressed = outputBuffer(decompressedData, decompressedSize);
+            if (!decompressed || U_SUCCESS != LzmaDecompress(data, dataSize, decompressed)) {
+                decompressedData.clear();
                 return U_CUSTOMIZED_DECOMPRESSION_FAILED;
             }
             
@@ -359,8 +428,6 @@ USTATUS decompress(const UByteArray & compressedData, const UINT8 compressionTyp
             z7_BranchConvSt_X86_Dec(decompressed, decompressedSize, 0, &state);
             
             dictionarySize = readUnaligned((UINT32*)(data + 1)); // LZMA dictionary size is stored in bytes 1-4 of LZMA properties header
-            decompressedData = UByteArray((const char*)decompressed, (int)decompressedSize);
-            free(decompressed);
             return U_SUCCESS;
         }
         default: {
@@ -432,13 +499,76 @@ UINT32 calculateChecksum32(const UINT32* buffer, UINT32 bufferSize)
 // Get padding type for a given padding
 UINT8 getPaddingType(const UByteArray & padding)
 {
-    if (padding.count('\x00') == padding.size())
+    // Empty padding is zero padding
+    if (padding.isEmpty())
         return Subtypes::ZeroPadding;
-    if (padding.count('\xFF') == padding.size())
-        return Subtypes::OnePadding;
+    
+    // Uniform padding is filled with its first byte, so a single pass is enough
+    const UINT8 first = (UINT8)padding.at(0);
+    if ((first == 0x00 || first == 0xFF) && isFilledWith(padding, first))
+        return first ? Subtypes::OnePadding : Subtypes::ZeroPadding;
     return Subtypes::DataPadding;
 }
 
+// Returns info of items described by their size alone
+ItemInfoFormatter fullSizeInfo(const UINT32 size)
+{
+    return [size]() { return usprintf("Full size: %Xh (%u)", size, size); };
+}
+
+UINT32 findNonFillByte(const UINT8* buffer, UINT32 bufferSize, UINT8 fill)
+{
+    UINT32 i = 0;
+    
+    // Skip blocks of fill bytes, the exact position of a different byte is found by the scalar loop below
+#if defined(FILL_BYTE_SSE2)
+    const __m128i pattern = _mm_set1_epi8((char)fill);
+    for (; bufferSize - i >= 64; i += 64) {
+        __m128i eq = _mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(buffer + i)), pattern),
+                                   _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(buffer + i + 16)), pattern));
+        eq = _mm_and_si128(eq, _mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(buffer + i + 32)), pattern),
+                                             _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(buffer + i + 48)), pattern)));
+        if (_mm_movemask_epi8(eq) != 0xFFFF)
+            break;
+    }
+    for (; bufferSize - i >= 16; i += 16) {
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(buffer + i)), pattern)) != 0xFFFF)
+            break;
+    }
+#elif defined(FILL_BYTE_NEON)
+    const uint8x16_t pattern = vdupq_n_u8(fill);
+    for (; bufferSize - i >= 64; i += 64) {
+        uint8x16_t eq = vandq_u8(vceqq_u8(vld1q_u8(buffer + i), pattern), vceqq_u8(vld1q_u8(buffer + i + 16), pattern));
+        eq = vandq_u8(eq, vandq_u8(vceqq_u8(vld1q_u8(buffer + i + 32), pattern), vceqq_u8(vld1q_u8(buffer + i + 48), pattern)));
+        if (vminvq_u8(eq) != 0xFF)
+            break;
+    }
+    for (; bufferSize - i >= 16; i += 16) {
+        if (vminvq_u8(vceqq_u8(vld1q_u8(buffer + i), pattern)) != 0xFF)
+            break;
+    }
+#else
+    const UINT64 pattern = 0x0101010101010101ULL * fill;
+    for (; bufferSize - i >= 8; i += 8) {
+        UINT64 word;
+        memcpy(&word, buffer + i, sizeof(word));
+        if (word != pattern)
+            break;
+    }
+#endif
+    
+    for (; i < bufferSize; i++) {
+        if (buffer[i] != fill)
+            break;
+    }
+    return i;
+}
+
+bool isFilledWith(const UByteArray & data, UINT8 fill)
+{
+    return findNonFillByte((const UINT8*)data.constData(), (UINT32)data.size(), fill) == (UINT32)data.size();
+}
+
 static inline int char2hex(char c)
 {
     if (c >= '0' && c <= '9')
@@ -507,37 +637,80 @@ bool makePattern(const CHAR8 *textPattern, std::vector<UINT8> &pattern, std::vec
     return true;
 }
 
-USTATUS gzipDecompress(const UByteArray & input, UByteArray & output)
+// Deflate can't compress data better than 1032:1
+#define MAX_DEFLATE_RATIO 1032
+
+// Inflate into a single output buffer of expected size, it is only reallocated if the size turns out to be wrong
+static bool inflateToBuffer(const UByteArray & input, UByteArray & output, const int windowBits, UINT32 expectedSize)
 {
-    output.clear();
-    
-    if (input.size() == 0)
-        return U_SUCCESS;
-    
     z_stream stream = {};
-    stream.next_in = (z_const Bytef *)input.data();
+    stream.next_in = (z_const Bytef *)input.constData();
     stream.avail_in = (uInt)input.size();
     stream.zalloc = Z_NULL;
     stream.zfree = Z_NULL;
     stream.opaque = Z_NULL;
     
-    // 15 for the maximum history buffer, 16 for gzip only input
-    int ret = inflateInit2(&stream, 15U | 16U);
+    int ret = inflateInit2(&stream, windowBits);
     if (ret != Z_OK)
-        return U_GZIP_DECOMPRESSION_FAILED;
+        return false;
     
+    UINT32 produced = 0;
+    UINT32 capacity = std::max(expectedSize, (UINT32)0x1000);
+    UINT8* buffer = outputBuffer(output, capacity);
+    if (!buffer)
+        ret = Z_MEM_ERROR;
     while (ret == Z_OK) {
-        Bytef out[0x1000] = {};
-        stream.next_out = out;
-        stream.avail_out = sizeof(out);
+        // Grow the buffer twice, keeping already inflated data
+        if (produced == capacity) {
+            if (capacity > INT32_MAX / 2) {
+                ret = Z_MEM_ERROR;
+                break;
+            }
+            UByteArray inflated = output;
+            capacity *= 2;
+            buffer = outputBuffer(output, capacity);
+            if (!buffer) {
+                ret = Z_MEM_ERROR;
+                break;
+            }
+            memcpy(buffer, inflated.constData(), produced);
+        }
         
+        stream.next_out = (Bytef *)buffer + produced;
+        stream.avail_out = capacity - produced;
         ret = inflate(&stream, Z_NO_FLUSH);
-        if ((ret == Z_OK || ret == Z_STREAM_END) && stream.avail_out != sizeof(out))
-            output += UByteArray((char *)out, sizeof(out) - stream.avail_out);
+        produced = capacity - stream.avail_out;
     }
     
     inflateEnd(&stream);
-    return ret == Z_STREAM_END ? U_SUCCESS : U_GZIP_DECOMPRESSION_FAILED;
+    if (ret != Z_STREAM_END) {
+        output.clear();
+        return false;
+    }
+    
+    trimOutput(output, produced);
+    return true;
+}
+
+USTATUS gzipDecompress(const UByteArray & input, UByteArray & output)
+{
+    output.clear();
+    
+    if (input.size() == 0)
+        return U_SUCCESS;
+    
+    // Size of uncompressed data modulo 2^32 is stored in the last 4 bytes of gzip stream
+    UINT32 expectedSize = 0;
+    if (input.size() >= 4)
+        expectedSize = readUnaligned((const UINT32*)(input.constData() + input.size() - 4));
+    // The value is not trusted, it is limited by the maximum deflate compression ratio and the buffer grows if it is still too small
+    expectedSize = (UINT32)std::min((UINT64)expectedSize, std::min((UINT64)input.size() * MAX_DEFLATE_RATIO, (UINT64)INT32_MAX / 2));
+    
+    // 15 for the maximum history buffer, 16 for gzip only input
+    if (!inflateToBuffer(input, output, 15 | 16, expectedSize))
+        return U_GZIP_DECOMPRESSION_FAILED;
+    
+    return U_SUCCESS;
 }
 
 USTATUS zlibDecompress(const UByteArray& input, UByteArray& output)
@@ -547,30 +720,14 @@ USTATUS zlibDecompress(const UByteArray& input, UByteArray& output)
     if (input.size() == 0)
         return U_SUCCESS;
 
-    z_stream stream = {};
-    stream.next_in = (z_const Bytef*)input.data();
-    stream.avail_in = (uInt)input.size();
-    stream.zalloc = Z_NULL;
-    stream.zfree = Z_NULL;
-    stream.opaque = Z_NULL;
+    // Zlib stream has no uncompressed size, assume typical compression ratio
+    UINT32 expectedSize = (UINT32)std::min((UINT64)input.size() * 4, (UINT64)INT32_MAX / 2);
 
     // 15 for the maximum history buffer
-    int ret = inflateInit2(&stream, 15U);
-    if (ret != Z_OK)
+    if (!inflateToBuffer(input, output, 15, expectedSize))
         return U_ZLIB_DECOMPRESSION_FAILED;
 
-    while (ret == Z_OK) {
-        Bytef out[0x1000] = {};
-        stream.next_out = out;
-        stream.avail_out = sizeof(out);
-
-        ret = inflate(&stream, Z_NO_FLUSH);
-        if ((ret == Z_OK || ret == Z_STREAM_END) && stream.avail_out != sizeof(out))
-            output += UByteArray((char*)out, sizeof(out) - stream.avail_out);
-    }
-
-    inflateEnd(&stream);
-    return ret == Z_STREAM_END ? U_SUCCESS : U_ZLIB_DECOMPRESSION_FAILED;
+    return U_SUCCESS;
 }
 
 UString fourCC(const UINT32 value)
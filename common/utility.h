@@ -39,7 +39,9 @@ void fixFileName(UString &name, bool replaceSpaces);
 UString errorCodeToUString(USTATUS errorCode);
 
 // EFI/Tiano/LZMA decompression routine
-USTATUS decompress(const UByteArray & compressed, const UINT8 compressionType, UINT8 & algorithm, UINT32 & dictionarySize, UByteArray & decompressed, UByteArray & efiDecompressed);
+// Standard compression algorithm is detected from the data, both EFI 1.1 and Tiano algorithms are only tried if the detection is ambiguous or explicitly requested
+// Undecided algorithm is returned if both succeed, with EFI 1.1 results in efiDecompressed
+USTATUS decompress(const UByteArray & compressed, const UINT8 compressionType, UINT8 & algorithm, UINT32 & dictionarySize, UByteArray & decompressed, UByteArray & efiDecompressed, const bool tryBothAlgorithms = false);
 
 // GZIP decompression routine
 USTATUS gzipDecompress(const UByteArray & compressed, UByteArray & decompressed);
@@ -62,6 +64,15 @@ UINT32 calculateChecksum32(const UINT32* buffer, UINT32 bufferSize);
 // Return padding type from it's contents
 UINT8 getPaddingType(const UByteArray & padding);
 
+// Returns info of items described by their size alone, i.e. padding and free space
+ItemInfoFormatter fullSizeInfo(const UINT32 size);
+
+// Returns offset of the first byte not equal to fill byte, or bufferSize if there is none
+UINT32 findNonFillByte(const UINT8* buffer, UINT32 bufferSize, UINT8 fill);
+
+// Checks all bytes of data to be equal to fill byte
+bool isFilledWith(const UByteArray & data, UINT8 fill);
+
 // Make pattern from a hexstring with an assumption of . being any char
 bool makePattern(const CHAR8 *textPattern, std::vector<UINT8> &pattern, std::vector<UINT8> &patternMask);
 
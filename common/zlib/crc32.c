@@ -103,6 +103,34 @@
 #  define ARMCRC32
 #endif
 
+/* Otherwise, on Linux, use the ARM processor CRC32 instruction if it is
+   available at run time. Z_NO_ARMCRC can be #defined to use the braided
+   calculation only. */
+#if defined(__aarch64__) && !defined(ARMCRC32) && defined(__linux__) && \
+    defined(__GNUC__) && W == 8 && !defined(Z_NO_ARMCRC) && !defined(MAKECRCH)
+#  define ARMCRC32_DYNAMIC
+#endif
+
+/* If available at run time, use the x86 carry-less multiplication instruction.
+   Z_NO_PCLMUL can be #defined to use the braided calculation only. */
+#if (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || \
+     defined(_M_IX86)) && !defined(Z_NO_PCLMUL) && !defined(MAKECRCH)
+#  define PCLMULCRC32
+#endif
+
+/* Instruction sets detected at run time are cached in a static int, which is
+   read and written atomically since crc32_z() can be called from several
+   threads at once. Aligned volatile int accesses are atomic with MSVC. */
+#if defined(PCLMULCRC32) || defined(ARMCRC32_DYNAMIC)
+#  if defined(__GNUC__) || defined(__clang__)
+#    define Z_LOAD_FEATURES(f) __atomic_load_n(&(f), __ATOMIC_RELAXED)
+#    define Z_STORE_FEATURES(f, v) __atomic_store_n(&(f), (v), __ATOMIC_RELAXED)
+#  else
+#    define Z_LOAD_FEATURES(f) (f)
+#    define Z_STORE_FEATURES(f, v) ((f) = (v))
+#  endif
+#endif
+
 #if defined(W) && (!defined(ARMCRC32) || defined(DYNAMIC_CRC_TABLE))
 /*
   Swap the bytes in a z_word_t to convert between little and big endian. Any
@@ -555,14 +583,23 @@ const z_crc_t FAR * ZEXPORT get_crc_table(void) {
 
 /* =========================================================================
  * Use ARM machine instructions if available. This will compute the CRC about
- * ten times faster than the braided calculation. This code does not check for
- * the presence of the CRC instruction at run time. __ARM_FEATURE_CRC32 will
+ * ten times faster than the braided calculation. __ARM_FEATURE_CRC32 will
  * only be defined if the compilation specifies an ARM processor architecture
  * that has the instructions. For example, compiling with -march=armv8.1-a or
  * -march=armv8-a+crc, or -march=native if the compile machine has the crc32
- * instructions.
+ * instructions. Otherwise, on Linux, the instructions are compiled for this
+ * function only, and crc32_z() uses it if the kernel reports HWCAP_CRC32.
  */
+#if defined(ARMCRC32) || defined(ARMCRC32_DYNAMIC)
+
+#include <arm_acle.h>
 #ifdef ARMCRC32
+#  define ARMCRC_TARGET
+#elif defined(__clang__)
+#  define ARMCRC_TARGET __attribute__((target("crc")))
+#else
+#  define ARMCRC_TARGET __attribute__((target("+crc")))
+#endif
 
 /*
    Constants empirically determined to maximize speed. These values are from
@@ -572,30 +609,22 @@ const z_crc_t FAR * ZEXPORT get_crc_table(void) {
 #define Z_BATCH_ZEROS 0xa10d3d0c    /* computed from Z_BATCH = 3990 */
 #define Z_BATCH_MIN 800             /* fewest words in a final batch */
 
-unsigned long ZEXPORT crc32_z(unsigned long crc, const unsigned char FAR *buf,
-                              z_size_t len) {
-    z_crc_t val;
-    z_word_t crc1, crc2;
+/*
+  Return the CRC of len bytes at buf, without any pre or post conditioning.
+ */
+ARMCRC_TARGET
+local z_crc_t crc32_armv8(z_crc_t crc, const unsigned char FAR *buf,
+                          z_size_t len) {
+    z_crc_t crc1, crc2, val;
     const z_word_t *word;
     z_word_t val0, val1, val2;
     z_size_t last, last2, i;
     z_size_t num;
 
-    /* Return initial CRC, if requested. */
-    if (buf == Z_NULL) return 0;
-
-#ifdef DYNAMIC_CRC_TABLE
-    once(&made, make_crc_table);
-#endif /* DYNAMIC_CRC_TABLE */
-
-    /* Pre-condition the CRC */
-    crc = (~crc) & 0xffffffff;
-
     /* Compute the CRC up to a word boundary. */
     while (len && ((z_size_t)buf & 7) != 0) {
         len--;
-        val = *buf++;
-        __asm__ volatile("crc32b %w0, %w0, %w1" : "+r"(crc) : "r"(val));
+        crc = __crc32b(crc, *buf++);
     }
 
     /* Prepare to compute the CRC on full 64-bit words word[0..num-1]. */
@@ -613,9 +642,9 @@ unsigned long ZEXPORT crc32_z(unsigned long crc, const unsigned char FAR *buf,
             val0 = word[i];
             val1 = word[i + Z_BATCH];
             val2 = word[i + 2 * Z_BATCH];
-            __asm__ volatile("crc32x %w0, %w0, %x1" : "+r"(crc) : "r"(val0));
-            __asm__ volatile("crc32x %w0, %w0, %x1" : "+r"(crc1) : "r"(val1));
-            __asm__ volatile("crc32x %w0, %w0, %x1" : "+r"(crc2) : "r"(val2));
+            crc = __crc32d(crc, val0);
+            crc1 = __crc32d(crc1, val1);
+            crc2 = __crc32d(crc2, val2);
         }
         word += 3 * Z_BATCH;
         num -= 3 * Z_BATCH;
@@ -634,9 +663,9 @@ unsigned long ZEXPORT crc32_z(unsigned long crc, const unsigned char FAR *buf,
             val0 = word[i];
             val1 = word[i + last];
             val2 = word[i + last2];
-            __asm__ volatile("crc32x %w0, %w0, %x1" : "+r"(crc) : "r"(val0));
-            __asm__ volatile("crc32x %w0, %w0, %x1" : "+r"(crc1) : "r"(val1));
-            __asm__ volatile("crc32x %w0, %w0, %x1" : "+r"(crc2) : "r"(val2));
+            crc = __crc32d(crc, val0);
+            crc1 = __crc32d(crc1, val1);
+            crc2 = __crc32d(crc2, val2);
         }
         word += 3 * last;
         num -= 3 * last;
@@ -648,7 +677,7 @@ unsigned long ZEXPORT crc32_z(unsigned long crc, const unsigned char FAR *buf,
     /* Compute the CRC on any remaining words. */
     for (i = 0; i < num; i++) {
         val0 = word[i];
-        __asm__ volatile("crc32x %w0, %w0, %x1" : "+r"(crc) : "r"(val0));
+        crc = __crc32d(crc, val0);
     }
     word += num;
 
@@ -656,12 +685,50 @@ unsigned long ZEXPORT crc32_z(unsigned long crc, const unsigned char FAR *buf,
     buf = (const unsigned char FAR *)word;
     while (len) {
         len--;
-        val = *buf++;
-        __asm__ volatile("crc32b %w0, %w0, %w1" : "+r"(crc) : "r"(val));
+        crc = __crc32b(crc, *buf++);
     }
+    return crc;
+}
 
-    /* Return the CRC, post-conditioned. */
-    return crc ^ 0xffffffff;
+#endif
+
+#ifdef ARMCRC32_DYNAMIC
+
+#include <sys/auxv.h>
+#ifndef HWCAP_CRC32
+#  define HWCAP_CRC32 (1 << 7)
+#endif
+
+/*
+  Return true if the processor has the CRC32 instructions. The result is
+  determined once, and is the same for all threads.
+ */
+local int armcrc_supported(void) {
+    static int volatile supported = -1;
+    int result = Z_LOAD_FEATURES(supported);
+    if (result < 0) {
+        result = (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+        Z_STORE_FEATURES(supported, result);
+    }
+    return result;
+}
+
+#endif
+
+#ifdef ARMCRC32
+
+unsigned long ZEXPORT crc32_z(unsigned long crc, const unsigned char FAR *buf,
+                              z_size_t len) {
+    /* Return initial CRC, if requested. */
+    if (buf == Z_NULL) return 0;
+
+#ifdef DYNAMIC_CRC_TABLE
+    once(&made, make_crc_table);
+#endif /* DYNAMIC_CRC_TABLE */
+
+    /* Pre-condition the CRC, compute it, and post-condition it. */
+    crc = (~crc) & 0xffffffff;
+    return crc32_armv8((z_crc_t)crc, buf, len) ^ 0xffffffff;
 }
 
 #else
@@ -690,6 +757,253 @@ local z_word_t crc_word_big(z_word_t data) {
 
 #endif
 
+/* =========================================================================
+ * Use x86 carry-less multiplication instructions if available. The CRC is
+ * computed by folding 128-bit blocks of data with PCLMULQDQ, or pairs of them
+ * with VPCLMULQDQ and AVX2, as described in "Fast CRC Computation for Generic
+ * Polynomials Using PCLMULQDQ Instruction" by Gopal et al. The instructions
+ * are detected at run time, and the braided calculation is used without them.
+ */
+#ifdef PCLMULCRC32
+
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#  include <intrin.h>
+#  define PCLMUL_TARGET
+#  define VPCLMUL_TARGET
+#else
+#  include <cpuid.h>
+#  define PCLMUL_TARGET __attribute__((target("pclmul,sse2")))
+#  define VPCLMUL_TARGET __attribute__((target("vpclmulqdq,pclmul,avx2")))
+#endif
+
+/*
+  Folding constants are x^(d+32) and x^(d-32) modulo p(x) for a distance of d
+  bits, bit-reflected and shifted left by one, followed by x^64 modulo p(x), and
+  p(x) with floor(x^64 / p(x)) for the final Barrett reduction.
+ */
+#define Z_FOLD(k1, k2) _mm_set_epi64x((long long)(k2), (long long)(k1))
+#define Z_FOLD1024 Z_FOLD(0x1e88ef372, 0x14a7fe880)
+#define Z_FOLD512  Z_FOLD(0x154442bd4, 0x1c6e41596)
+#define Z_FOLD256  Z_FOLD(0x0f1da05aa, 0x15a546366)
+#define Z_FOLD128  Z_FOLD(0x1751997d0, 0x0ccaa009e)
+#define Z_FOLD64   Z_FOLD(0x163cd6124, 0)
+#define Z_POLY     Z_FOLD(0x1db710641, 0x1f7011641)
+
+#define PCLMUL_SUPPORTED 1
+#define VPCLMUL_SUPPORTED 2
+
+/*
+  Return the supported instruction sets. The result is determined once, and is
+  the same for all threads.
+ */
+local int pclmul_features(void) {
+    static int volatile features = -1;
+    int result = Z_LOAD_FEATURES(features);
+    if (result < 0) {
+        unsigned ecx1 = 0, edx1 = 0, ebx7 = 0, ecx7 = 0, max;
+        unsigned long long xcr0 = 0;
+#if defined(_MSC_VER) && !defined(__clang__)
+        int regs[4];
+        __cpuid(regs, 0);
+        max = (unsigned)regs[0];
+        if (max >= 1) {
+            __cpuid(regs, 1);
+            ecx1 = (unsigned)regs[2];
+            edx1 = (unsigned)regs[3];
+        }
+        if (max >= 7) {
+            __cpuidex(regs, 7, 0);
+            ebx7 = (unsigned)regs[1];
+            ecx7 = (unsigned)regs[2];
+        }
+        if (ecx1 & (1u << 27))
+            xcr0 = _xgetbv(0);
+#else
+        unsigned eax, ebx, ecx, edx;
+        max = __get_cpuid_max(0, 0);
+        if (max >= 1 && __get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+            ecx1 = ecx;
+            edx1 = edx;
+        }
+        if (max >= 7) {
+            __cpuid_count(7, 0, eax, ebx, ecx, edx);
+            ebx7 = ebx;
+            ecx7 = ecx;
+        }
+        if (ecx1 & (1u << 27)) {
+            unsigned lo, hi;
+            __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+            xcr0 = ((unsigned long long)hi << 32) | lo;
+        }
+#endif
+        result = 0;
+        /* PCLMULQDQ and SSE2 */
+        if ((ecx1 & (1u << 1)) && (edx1 & (1u << 26)))
+            result |= PCLMUL_SUPPORTED;
+        /* VPCLMULQDQ and AVX2, with YMM state enabled by the OS */
+        if ((result & PCLMUL_SUPPORTED) && (ecx7 & (1u << 10)) &&
+            (ebx7 & (1u << 5)) && (ecx1 & (1u << 28)) && (xcr0 & 6) == 6)
+            result |= VPCLMUL_SUPPORTED;
+        Z_STORE_FEATURES(features, result);
+    }
+    return result;
+}
+
+/*
+  Fold the 128-bit remainder x with len bytes at buf, a multiple of 16, and
+  reduce it to the CRC, without any pre or post conditioning.
+ */
+PCLMUL_TARGET
+local z_crc_t crc32_pclmul_final(__m128i x, const unsigned char FAR *buf,
+                                 z_size_t len) {
+    __m128i k, t, mask;
+
+    k = Z_FOLD128;
+    while (len >= 16) {
+        t = _mm_clmulepi64_si128(x, k, 0x00);
+        x = _mm_clmulepi64_si128(x, k, 0x11);
+        x = _mm_xor_si128(_mm_xor_si128(x, t),
+                          _mm_loadu_si128((const __m128i *)buf));
+        buf += 16;
+        len -= 16;
+    }
+
+    /* Fold 128 bits to 64 bits. */
+    mask = _mm_set_epi32(0, ~0, 0, ~0);
+    t = _mm_clmulepi64_si128(x, k, 0x10);
+    x = _mm_xor_si128(_mm_srli_si128(x, 8), t);
+    k = Z_FOLD64;
+    t = _mm_srli_si128(x, 4);
+    x = _mm_clmulepi64_si128(_mm_and_si128(x, mask), k, 0x00);
+    x = _mm_xor_si128(x, t);
+
+    /* Barrett reduction to 32 bits. */
+    k = Z_POLY;
+    t = _mm_clmulepi64_si128(_mm_and_si128(x, mask), k, 0x10);
+    t = _mm_clmulepi64_si128(_mm_and_si128(t, mask), k, 0x00);
+    x = _mm_xor_si128(x, t);
+    return (z_crc_t)_mm_cvtsi128_si32(_mm_srli_si128(x, 4));
+}
+
+/*
+  Return the CRC of len bytes at buf, at least 64 and a multiple of 16, using
+  four 128-bit folding streams. crc is pre-conditioned.
+ */
+PCLMUL_TARGET
+local z_crc_t crc32_pclmul(z_crc_t crc, const unsigned char FAR *buf,
+                           z_size_t len) {
+    __m128i x1, x2, x3, x4, t1, t2, t3, t4, k;
+
+    x1 = _mm_loadu_si128((const __m128i *)buf);
+    x2 = _mm_loadu_si128((const __m128i *)(buf + 16));
+    x3 = _mm_loadu_si128((const __m128i *)(buf + 32));
+    x4 = _mm_loadu_si128((const __m128i *)(buf + 48));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)crc));
+    buf += 64;
+    len -= 64;
+
+    k = Z_FOLD512;
+    while (len >= 64) {
+        t1 = _mm_clmulepi64_si128(x1, k, 0x00);
+        t2 = _mm_clmulepi64_si128(x2, k, 0x00);
+        t3 = _mm_clmulepi64_si128(x3, k, 0x00);
+        t4 = _mm_clmulepi64_si128(x4, k, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, k, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, k, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, k, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, k, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, t1),
+                           _mm_loadu_si128((const __m128i *)buf));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, t2),
+                           _mm_loadu_si128((const __m128i *)(buf + 16)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, t3),
+                           _mm_loadu_si128((const __m128i *)(buf + 32)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, t4),
+                           _mm_loadu_si128((const __m128i *)(buf + 48)));
+        buf += 64;
+        len -= 64;
+    }
+
+    /* Fold the four streams into one. */
+    k = Z_FOLD128;
+    t1 = _mm_clmulepi64_si128(x1, k, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, t1), x2);
+    t1 = _mm_clmulepi64_si128(x1, k, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, t1), x3);
+    t1 = _mm_clmulepi64_si128(x1, k, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, t1), x4);
+
+    return crc32_pclmul_final(x1, buf, len);
+}
+
+/*
+  Return the CRC of len bytes at buf, at least 128 and a multiple of 16, using
+  four 256-bit folding streams. crc is pre-conditioned.
+ */
+VPCLMUL_TARGET
+local z_crc_t crc32_vpclmul(z_crc_t crc, const unsigned char FAR *buf,
+                            z_size_t len) {
+    __m256i y1, y2, y3, y4, t1, t2, t3, t4, k;
+    __m128i x, lo, hi;
+
+    y1 = _mm256_loadu_si256((const __m256i *)buf);
+    y2 = _mm256_loadu_si256((const __m256i *)(buf + 32));
+    y3 = _mm256_loadu_si256((const __m256i *)(buf + 64));
+    y4 = _mm256_loadu_si256((const __m256i *)(buf + 96));
+    y1 = _mm256_xor_si256(y1, _mm256_inserti128_si256(_mm256_setzero_si256(),
+                                  _mm_cvtsi32_si128((int)crc), 0));
+    buf += 128;
+    len -= 128;
+
+    k = _mm256_broadcastsi128_si256(Z_FOLD1024);
+    while (len >= 128) {
+        t1 = _mm256_clmulepi64_epi128(y1, k, 0x00);
+        t2 = _mm256_clmulepi64_epi128(y2, k, 0x00);
+        t3 = _mm256_clmulepi64_epi128(y3, k, 0x00);
+        t4 = _mm256_clmulepi64_epi128(y4, k, 0x00);
+        y1 = _mm256_clmulepi64_epi128(y1, k, 0x11);
+        y2 = _mm256_clmulepi64_epi128(y2, k, 0x11);
+        y3 = _mm256_clmulepi64_epi128(y3, k, 0x11);
+        y4 = _mm256_clmulepi64_epi128(y4, k, 0x11);
+        y1 = _mm256_xor_si256(_mm256_xor_si256(y1, t1),
+                              _mm256_loadu_si256((const __m256i *)buf));
+        y2 = _mm256_xor_si256(_mm256_xor_si256(y2, t2),
+                              _mm256_loadu_si256((const __m256i *)(buf + 32)));
+        y3 = _mm256_xor_si256(_mm256_xor_si256(y3, t3),
+                              _mm256_loadu_si256((const __m256i *)(buf + 64)));
+        y4 = _mm256_xor_si256(_mm256_xor_si256(y4, t4),
+                              _mm256_loadu_si256((const __m256i *)(buf + 96)));
+        buf += 128;
+        len -= 128;
+    }
+
+    /* Fold the four streams into one, and then its two halves together. */
+    k = _mm256_broadcastsi128_si256(Z_FOLD256);
+    t1 = _mm256_clmulepi64_epi128(y1, k, 0x00);
+    y1 = _mm256_clmulepi64_epi128(y1, k, 0x11);
+    y1 = _mm256_xor_si256(_mm256_xor_si256(y1, t1), y2);
+    t1 = _mm256_clmulepi64_epi128(y1, k, 0x00);
+    y1 = _mm256_clmulepi64_epi128(y1, k, 0x11);
+    y1 = _mm256_xor_si256(_mm256_xor_si256(y1, t1), y3);
+    t1 = _mm256_clmulepi64_epi128(y1, k, 0x00);
+    y1 = _mm256_clmulepi64_epi128(y1, k, 0x11);
+    y1 = _mm256_xor_si256(_mm256_xor_si256(y1, t1), y4);
+
+    lo = _mm256_castsi256_si128(y1);
+    hi = _mm256_extracti128_si256(y1, 1);
+    x = Z_FOLD128;
+    x = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(lo, x, 0x00),
+                                    _mm_clmulepi64_si128(lo, x, 0x11)), hi);
+
+    return crc32_pclmul_final(x, buf, len);
+}
+
+#endif /* PCLMULCRC32 */
+
 /* ========================================================================= */
 unsigned long ZEXPORT crc32_z(unsigned long crc, const unsigned char FAR *buf,
                               z_size_t len) {
@@ -703,6 +1017,28 @@ unsigned long ZEXPORT crc32_z(unsigned long crc, const unsigned char FAR *buf,
     /* Pre-condition the CRC */
     crc = (~crc) & 0xffffffff;
 
+#ifdef ARMCRC32_DYNAMIC
+    /* Use the CRC instructions for all of the data, if available. */
+    if (armcrc_supported())
+        return crc32_armv8((z_crc_t)crc, buf, len) ^ 0xffffffff;
+#endif
+
+#ifdef PCLMULCRC32
+    /* Fold all complete 16-byte blocks, if provided enough bytes. */
+    if (len >= 64) {
+        int features = pclmul_features();
+        if (features & PCLMUL_SUPPORTED) {
+            z_size_t blks = len & ~(z_size_t)15;
+            if ((features & VPCLMUL_SUPPORTED) && blks >= 256)
+                crc = crc32_vpclmul((z_crc_t)crc, buf, blks);
+            else
+                crc = crc32_pclmul((z_crc_t)crc, buf, blks);
+            buf += blks;
+            len -= blks;
+        }
+    }
+#endif
+
 #ifdef W
 
     /* If provided enough bytes, do a braided CRC calculation. */
@@ -0,0 +1,130 @@
+/* crc32_test.c
+
+Copyright (c) 2026, Nikolaj Schlej. All rights reserved.
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+*/
+
+// Checks PCLMULQDQ, VPCLMULQDQ and ARMv8 CRC32 kernels against the braided implementation
+// The source is included to reach its local kernels, the braided one is built separately with Z_PREFIX, Z_NO_PCLMUL and Z_NO_ARMCRC
+#include <stdio.h>
+#include "../common/zlib/crc32.c"
+
+#define SKIP_RETURN_CODE 77
+
+#ifndef PCLMULCRC32
+#define PCLMUL_SUPPORTED 1
+#define VPCLMUL_SUPPORTED 2
+#endif
+#define ARMCRC_SUPPORTED 4
+
+unsigned long ZEXPORT z_crc32_z(unsigned long crc, const unsigned char FAR *buf, z_size_t len);
+uLong ZEXPORT z_crc32_combine(uLong crc1, uLong crc2, z_off_t len2);
+
+static unsigned char buffer[70000];
+static unsigned long seed = 0x12345678UL;
+
+static unsigned long next_random(void)
+{
+    seed = (seed * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+    return seed >> 1;
+}
+
+static int check(const char* what, unsigned long iteration, size_t offset, size_t len, unsigned long actual, unsigned long expected)
+{
+    if (actual == expected)
+        return 1;
+    printf("%s mismatch at iteration %lu, offset %u, length %u: %08lX instead of %08lX\n",
+           what, iteration, (unsigned)offset, (unsigned)len, actual, expected);
+    return 0;
+}
+
+int main(void)
+{
+    unsigned long i;
+    int features = 0;
+
+    for (i = 0; i < sizeof(buffer); i++)
+        buffer[i] = (unsigned char)next_random();
+
+    // Both implementations must give the check value of the CRC32 specification
+    if (!check("crc32_z check value", 0, 0, 9, crc32_z(0, (const unsigned char*)"123456789", 9), 0xCBF43926UL)
+        || !check("braided check value", 0, 0, 9, z_crc32_z(0, (const unsigned char*)"123456789", 9), 0xCBF43926UL))
+        return 1;
+
+#if defined(PCLMULCRC32)
+    features = pclmul_features();
+    printf("PCLMULQDQ: %s, VPCLMULQDQ: %s\n",
+           (features & PCLMUL_SUPPORTED) ? "supported" : "not supported", (features & VPCLMUL_SUPPORTED) ? "supported" : "not supported");
+#elif defined(ARMCRC32_DYNAMIC)
+    features = armcrc_supported() ? ARMCRC_SUPPORTED : 0;
+    printf("ARMv8 CRC32: %s\n", (features & ARMCRC_SUPPORTED) ? "supported" : "not supported");
+#elif defined(ARMCRC32)
+    features = ARMCRC_SUPPORTED;
+    printf("ARMv8 CRC32: enabled at compile time\n");
+#endif
+
+    for (i = 0; i < 20000; i++) {
+        // All short lengths first, then random ones with some up to the buffer size
+        const size_t offset = next_random() % 64;
+        const size_t len = i < 2000 ? (size_t)i : next_random() % (i % 10 ? 2000 : sizeof(buffer) - 64);
+        const unsigned long initial = i & 1 ? 0 : next_random();
+        const unsigned char* data = buffer + offset;
+        const unsigned long expected = z_crc32_z(initial, data, len);
+
+        // Dispatching function, with any kernel selected at runtime
+        if (!check("crc32_z", i, offset, len, crc32_z(initial, data, len), expected))
+            return 1;
+
+        // Combination of the CRCs of two parts of the data
+        {
+            const size_t split = len ? next_random() % (len + 1) : 0;
+            const unsigned long first = z_crc32_z(initial, data, split);
+            const unsigned long second = z_crc32_z(0, data + split, len - split);
+            if (!check("crc32_combine", i, offset, len, crc32_combine(first, second, (z_off_t)(len - split)), expected)
+                || !check("braided crc32_combine", i, offset, len, z_crc32_combine(first, second, (z_off_t)(len - split)), expected))
+                return 1;
+        }
+
+#ifdef PCLMULCRC32
+        // Kernels take pre-conditioned CRC and process whole 16-byte blocks of at least 64 bytes
+        if (len >= 64) {
+            const size_t blocks = len & ~(size_t)15;
+            const z_crc_t conditioned = (z_crc_t)(~initial & 0xFFFFFFFFUL);
+            const unsigned long blocksExpected = z_crc32_z(initial, data, blocks);
+            if ((features & PCLMUL_SUPPORTED)
+                && !check("crc32_pclmul", i, offset, blocks, crc32_pclmul(conditioned, data, blocks) ^ 0xFFFFFFFFUL, blocksExpected))
+                return 1;
+            if ((features & VPCLMUL_SUPPORTED) && blocks >= 128
+                && !check("crc32_vpclmul", i, offset, blocks, crc32_vpclmul(conditioned, data, blocks) ^ 0xFFFFFFFFUL, blocksExpected))
+                return 1;
+        }
+#endif
+
+#if defined(ARMCRC32) || defined(ARMCRC32_DYNAMIC)
+        // Kernel takes pre-conditioned CRC and processes any length
+        if ((features & ARMCRC_SUPPORTED)
+            && !check("crc32_armv8", i, offset, len, crc32_armv8((z_crc_t)(~initial & 0xFFFFFFFFUL), data, len) ^ 0xFFFFFFFFUL, expected))
+            return 1;
+#endif
+    }
+
+    // Kernels that can't run on this CPU are reported as skipped
+#if defined(ARMCRC32) || defined(ARMCRC32_DYNAMIC)
+    if (!(features & ARMCRC_SUPPORTED)) {
+#else
+    if ((features & (PCLMUL_SUPPORTED | VPCLMUL_SUPPORTED)) != (PCLMUL_SUPPORTED | VPCLMUL_SUPPORTED)) {
+#endif
+        printf("Some kernels are not tested\n");
+        return SKIP_RETURN_CODE;
+    }
+
+    printf("All checks passed\n");
+    return 0;
+}
@@ -0,0 +1,71 @@
+/* sha_benchmark.c
+
+Copyright (c) 2026, Nikolaj Schlej. All rights reserved.
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+*/
+
+// Measures SHA-1 and SHA-256 throughput of the default implementation against the portable one
+// Usage: sha_benchmark [size in MiB, 64 by default]
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../common/digest/shaext.h"
+#include "sha_portable.h"
+
+static double measure(void (*digest)(const void*, unsigned long, void*), const unsigned char* data, unsigned long size)
+{
+    unsigned char out[32];
+    const clock_t start = clock();
+    digest(data, size, out);
+    const clock_t end = clock();
+    const double seconds = (double)(end - start) / CLOCKS_PER_SEC;
+    return seconds > 0 ? (double)size / (1024.0 * 1024.0) / seconds : 0;
+}
+
+static void report(const char* name, void (*digest)(const void*, unsigned long, void*), void (*portable)(const void*, unsigned long, void*), const unsigned char* data, unsigned long size)
+{
+    const double speed = measure(digest, data, size);
+    const double portableSpeed = measure(portable, data, size);
+    printf("%-8s default: %8.1f MiB/s, portable: %8.1f MiB/s, speedup: %.2fx\n",
+           name, speed, portableSpeed, portableSpeed > 0 ? speed / portableSpeed : 0);
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned long size = 64;
+    unsigned char* data;
+    unsigned long i;
+    int supported = 0;
+
+    if (argc > 1)
+        size = strtoul(argv[1], NULL, 10);
+    if (size == 0 || size > 1024) {
+        printf("Size must be from 1 to 1024 MiB\n");
+        return 1;
+    }
+    size *= 1024 * 1024;
+
+    data = (unsigned char*)malloc(size);
+    if (!data)
+        return 1;
+    for (i = 0; i < size; i++)
+        data[i] = (unsigned char)(i * 2654435761UL >> 24);
+
+#ifdef DIGEST_SHA_EXTENSIONS
+    supported = sha_extensions_supported();
+#endif
+    printf("SHA extensions: %s\n", supported ? "supported" : "not supported");
+
+    report("SHA-1", sha1, portable_sha1, data, size);
+    report("SHA-256", sha256, portable_sha256, data, size);
+
+    free(data);
+    return 0;
+}
@@ -0,0 +1,31 @@
+/* sha_portable.h
+
+Copyright (c) 2026, Nikolaj Schlej. All rights reserved.
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+*/
+
+#ifndef SHA_PORTABLE_H
+#define SHA_PORTABLE_H
+
+#include "../common/digest/sha1.h"
+#include "../common/digest/sha2.h"
+
+// Portable SHA-1 and SHA-256, built from the same sources with DIGEST_NO_SHA_EXTENSIONS and renamed public functions
+int portable_sha1_init(struct sha1_state * md);
+int portable_sha1_process(struct sha1_state * md, const unsigned char *in, unsigned long inlen);
+int portable_sha1_done(struct sha1_state * md, unsigned char *out);
+void portable_sha1(const void *in, unsigned long inlen, void* out);
+
+int portable_sha256_init(struct sha256_state * md);
+int portable_sha256_process(struct sha256_state * md, const unsigned char *in, unsigned long inlen);
+int portable_sha256_done(struct sha256_state * md, unsigned char *out);
+void portable_sha256(const void *in, unsigned long inlen, void* out);
+
+#endif // SHA_PORTABLE_H
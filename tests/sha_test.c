@@ -0,0 +1,119 @@
+/* sha_test.c
+
+Copyright (c) 2026, Nikolaj Schlej. All rights reserved.
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+*/
+
+// Checks SHA-1 and SHA-256 digests computed with SHA extensions against the portable implementation
+#include <stdio.h>
+#include <string.h>
+#include "../common/digest/shaext.h"
+#include "sha_portable.h"
+
+#define SKIP_RETURN_CODE 77
+
+static unsigned char buffer[20000];
+static unsigned long seed = 0x12345678UL;
+
+static unsigned long next_random(void)
+{
+    seed = (seed * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+    return seed >> 1;
+}
+
+static int check(const char* what, unsigned long iteration, unsigned long len, const unsigned char* actual, const unsigned char* expected, size_t size)
+{
+    if (!memcmp(actual, expected, size))
+        return 1;
+    printf("%s mismatch at iteration %lu, length %lu\n", what, iteration, len);
+    return 0;
+}
+
+int main(void)
+{
+    static const unsigned char abcSha1[20] = {
+        0xA9, 0x99, 0x3E, 0x36, 0x47, 0x06, 0x81, 0x6A, 0xBA, 0x3E, 0x25, 0x71, 0x78, 0x50, 0xC2, 0x6C, 0x9C, 0xD0, 0xD8, 0x9D
+    };
+    static const unsigned char abcSha256[32] = {
+        0xBA, 0x78, 0x16, 0xBF, 0x8F, 0x01, 0xCF, 0xEA, 0x41, 0x41, 0x40, 0xDE, 0x5D, 0xAE, 0x22, 0x23,
+        0xB0, 0x03, 0x61, 0xA3, 0x96, 0x17, 0x7A, 0x9C, 0xB4, 0x10, 0xFF, 0x61, 0xF2, 0x00, 0x15, 0xAD
+    };
+    unsigned char actual[32], expected[32];
+    unsigned long i;
+    int supported = 0;
+
+#ifdef DIGEST_SHA_EXTENSIONS
+    supported = sha_extensions_supported();
+#endif
+    printf("SHA extensions: %s\n", supported ? "supported" : "not supported");
+
+    // Both implementations must give the digests of FIPS 180 examples
+    sha1("abc", 3, actual);
+    portable_sha1("abc", 3, expected);
+    if (!check("SHA-1 example", 0, 3, actual, abcSha1, sizeof(abcSha1))
+        || !check("portable SHA-1 example", 0, 3, expected, abcSha1, sizeof(abcSha1)))
+        return 1;
+    sha256("abc", 3, actual);
+    portable_sha256("abc", 3, expected);
+    if (!check("SHA-256 example", 0, 3, actual, abcSha256, sizeof(abcSha256))
+        || !check("portable SHA-256 example", 0, 3, expected, abcSha256, sizeof(abcSha256)))
+        return 1;
+
+    for (i = 0; i < sizeof(buffer); i++)
+        buffer[i] = (unsigned char)next_random();
+
+    for (i = 0; i < 5000; i++) {
+        // All short lengths first, then random ones, at random offsets
+        const unsigned long offset = next_random() % 64;
+        const unsigned long len = i < 1000 ? i : next_random() % (sizeof(buffer) - 64);
+        const unsigned char* data = buffer + offset;
+        struct sha1_state sha1State;
+        struct sha256_state sha256State;
+        unsigned long done, chunk;
+
+        // Single call
+        sha1(data, len, actual);
+        portable_sha1(data, len, expected);
+        if (!check("SHA-1", i, len, actual, expected, 20))
+            return 1;
+        sha256(data, len, actual);
+        portable_sha256(data, len, expected);
+        if (!check("SHA-256", i, len, actual, expected, 32))
+            return 1;
+
+        // Incremental calls with random chunks, so partial and multiple blocks are mixed
+        sha1_init(&sha1State);
+        sha256_init(&sha256State);
+        for (done = 0; done < len; done += chunk) {
+            chunk = next_random() % 300;
+            if (chunk > len - done)
+                chunk = len - done;
+            sha1_process(&sha1State, data + done, chunk);
+            sha256_process(&sha256State, data + done, chunk);
+        }
+        sha1_done(&sha1State, actual);
+        portable_sha1(data, len, expected);
+        if (!check("incremental SHA-1", i, len, actual, expected, 20))
+            return 1;
+        sha256_done(&sha256State, actual);
+        portable_sha256(data, len, expected);
+        if (!check("incremental SHA-256", i, len, actual, expected, 32))
+            return 1;
+    }
+
+    // Without SHA extensions both implementations are the same code
+    if (!supported) {
+        printf("SHA extensions are not tested\n");
+        return SKIP_RETURN_CODE;
+    }
+
+    printf("All checks passed\n");
+    return 0;
+}
@@ -0,0 +1,285 @@
+/* threads_image.c
+
+Copyright (c) 2026, Nikolaj Schlej. All rights reserved.
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+*/
+
+// Writes a synthetic firmware image for comparing serial and parallel parsing
+// Image has several volumes with nested ones, GZip and Zlib compressed sections, some of them identical,
+// files with invalid checksums, free space and padding between volumes, all generated from a fixed seed
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../common/zlib/zlib.h"
+
+typedef struct BUFFER_ {
+    unsigned char* data;
+    size_t size;
+    size_t capacity;
+} BUFFER;
+
+static unsigned long seed = 0x12345678UL;
+
+static unsigned long next_random(void)
+{
+    seed = (seed * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+    return seed >> 1;
+}
+
+static unsigned long random_range(unsigned long first, unsigned long last)
+{
+    return first + next_random() % (last - first + 1);
+}
+
+static void append(BUFFER* buffer, const void* data, size_t size)
+{
+    if (buffer->size + size > buffer->capacity) {
+        buffer->capacity = (buffer->size + size) * 2;
+        buffer->data = (unsigned char*)realloc(buffer->data, buffer->capacity);
+        if (!buffer->data) {
+            fprintf(stderr, "Out of memory\n");
+            exit(1);
+        }
+    }
+    if (size)
+        memcpy(buffer->data + buffer->size, data, size);
+    buffer->size += size;
+}
+
+static void append_fill(BUFFER* buffer, unsigned char fill, size_t size)
+{
+    size_t i;
+    for (i = 0; i < size; i++)
+        append(buffer, &fill, 1);
+}
+
+static void put16(unsigned char* p, unsigned long value)
+{
+    p[0] = (unsigned char)value;
+    p[1] = (unsigned char)(value >> 8);
+}
+
+static void put32(unsigned char* p, unsigned long value)
+{
+    put16(p, value & 0xFFFF);
+    put16(p + 2, (value >> 16) & 0xFFFF);
+}
+
+static void random_guid(unsigned char* guid)
+{
+    int i;
+    for (i = 0; i < 16; i++)
+        guid[i] = (unsigned char)next_random();
+}
+
+// GUIDs are stored in their in-memory form
+static const unsigned char ffs2_guid[16] = { 0x78, 0xE5, 0x8C, 0x8C, 0x3D, 0x8A, 0x1C, 0x4F, 0x99, 0x35, 0x89, 0x61, 0x85, 0xC3, 0x2D, 0xD3 };
+static const unsigned char gzip_guid[16] = { 0xE9, 0x1F, 0x30, 0x1D, 0x79, 0xBE, 0x53, 0x43, 0x91, 0xC2, 0xD2, 0x3B, 0xC9, 0x59, 0xAE, 0x0C };
+static const unsigned char zlib_amd_guid[16] = { 0xF5, 0x33, 0x32, 0xCE, 0xD6, 0x2C, 0x87, 0x4D, 0x91, 0x52, 0x4A, 0x23, 0x8B, 0xB6, 0xD1, 0xC4 };
+
+// Sections are 4-byte aligned in section streams
+static void append_section(BUFFER* stream, unsigned char type, const unsigned char* data, size_t size)
+{
+    unsigned char header[4];
+    put32(header, (unsigned long)(size + sizeof(header)));
+    header[3] = type;
+    append_fill(stream, 0, (4 - stream->size % 4) % 4);
+    append(stream, header, sizeof(header));
+    append(stream, data, size);
+}
+
+static void append_random_data(BUFFER* buffer, const char* alphabet, size_t size)
+{
+    size_t i;
+    size_t count = strlen(alphabet) + 1; // Terminating zero is a part of the alphabet
+    for (i = 0; i < size; i++) {
+        unsigned char c = (unsigned char)alphabet[next_random() % count];
+        append(buffer, &c, 1);
+    }
+}
+
+static void append_file(BUFFER* files, unsigned char type, const BUFFER* body, int invalid_checksum)
+{
+    unsigned char header[24];
+    unsigned char sum = 0;
+    size_t i;
+
+    memset(header, 0, sizeof(header));
+    random_guid(header);
+    header[18] = type;
+    put32(header + 20, (unsigned long)(sizeof(header) + body->size));
+    header[23] = 0;
+    for (i = 0; i < sizeof(header); i++)
+        sum = (unsigned char)(sum + header[i]);
+    header[16] = (unsigned char)(0x100 - sum);
+    header[17] = invalid_checksum ? 0x55 : 0xAA;
+    header[23] = 0xF8;
+
+    // Files are 8-byte aligned in volumes, the gap is filled with erase polarity
+    append_fill(files, 0xFF, (8 - files->size % 8) % 8);
+    append(files, header, sizeof(header));
+    append(files, body->data, body->size);
+}
+
+static void append_volume(BUFFER* image, const BUFFER* files)
+{
+    unsigned char header[0x48];
+    size_t total = (sizeof(header) + files->size + 0xFFF) & ~(size_t)0xFFF;
+    unsigned long sum = 0;
+    size_t i;
+
+    memset(header, 0, sizeof(header));
+    memcpy(header + 16, ffs2_guid, sizeof(ffs2_guid));
+    put32(header + 32, (unsigned long)total);
+    memcpy(header + 40, "_FVH", 4);
+    put32(header + 44, 0x0004FEFFUL);
+    put16(header + 48, sizeof(header));
+    header[55] = 2;
+    put32(header + 56, (unsigned long)(total / 0x1000));
+    put32(header + 60, 0x1000);
+    for (i = 0; i < sizeof(header); i += 2)
+        sum += header[i] | (header[i + 1] << 8);
+    put16(header + 50, (0x10000 - (sum & 0xFFFF)) & 0xFFFF);
+
+    append(image, header, sizeof(header));
+    append(image, files->data, files->size);
+    append_fill(image, 0xFF, total - sizeof(header) - files->size);
+}
+
+static void append_compressed_sections(BUFFER* body)
+{
+    BUFFER inner = { NULL, 0, 0 };
+    BUFFER data = { NULL, 0, 0 };
+    BUFFER section = { NULL, 0, 0 };
+    unsigned char attributes[4];
+    unsigned long count = random_range(1, 3);
+    unsigned long i;
+    uLongf compressedSize;
+    unsigned char* compressed;
+
+    for (i = 0; i < count; i++) {
+        data.size = 0;
+        append_random_data(&data, "EFGH", random_range(1, 6000));
+        append_section(&inner, 0x19, data.data, data.size);
+    }
+
+    compressedSize = compressBound((uLong)inner.size) + 32;
+    compressed = (unsigned char*)malloc(compressedSize);
+    if (!compressed) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+
+    put16(attributes, 24);
+    put16(attributes + 2, 1); // Processing required
+    if (next_random() % 2) {
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+        stream.next_in = inner.data;
+        stream.avail_in = (uInt)inner.size;
+        stream.next_out = compressed;
+        stream.avail_out = (uInt)compressedSize;
+        deflate(&stream, Z_FINISH);
+        compressedSize = stream.total_out;
+        deflateEnd(&stream);
+
+        append(&section, gzip_guid, sizeof(gzip_guid));
+        append(&section, attributes, sizeof(attributes));
+    }
+    else {
+        unsigned char amdHeader[0x100];
+        compress2(compressed, &compressedSize, inner.data, (uLong)inner.size, Z_BEST_COMPRESSION);
+        memset(amdHeader, 0, sizeof(amdHeader));
+        put32(amdHeader + 0x14, (unsigned long)compressedSize);
+
+        append(&section, zlib_amd_guid, sizeof(zlib_amd_guid));
+        append(&section, attributes, sizeof(attributes));
+        append(&section, amdHeader, sizeof(amdHeader));
+    }
+    append(&section, compressed, compressedSize);
+    append_section(body, 0x02, section.data, section.size);
+
+    free(compressed);
+    free(section.data);
+    free(data.data);
+    free(inner.data);
+}
+
+static void append_random_files(BUFFER* files, unsigned long count, int depth)
+{
+    BUFFER body = { NULL, 0, 0 };
+    unsigned long i;
+
+    for (i = 0; i < count; i++) {
+        unsigned long kind = next_random() % 100;
+        body.size = 0;
+        if (depth > 0 && kind < 20) {
+            // Volume nested into a firmware volume image section
+            BUFFER nestedFiles = { NULL, 0, 0 };
+            BUFFER nestedVolume = { NULL, 0, 0 };
+            append_random_files(&nestedFiles, random_range(1, 6), depth - 1);
+            append_volume(&nestedVolume, &nestedFiles);
+            append_section(&body, 0x17, nestedVolume.data, nestedVolume.size);
+            append_file(files, 0x0B, &body, 0);
+            free(nestedVolume.data);
+            free(nestedFiles.data);
+        }
+        else if (kind < 40) {
+            // Identical compressed sections share decompression results
+            append_compressed_sections(&body);
+            append_file(files, 0x07, &body, 0);
+            if (next_random() % 2)
+                append_file(files, 0x07, &body, 0);
+        }
+        else {
+            BUFFER data = { NULL, 0, 0 };
+            size_t size = random_range(1, 3000);
+            size_t j;
+            for (j = 0; j < size; j++) {
+                unsigned char c = (unsigned char)next_random();
+                append(&data, &c, 1);
+            }
+            append_section(&body, 0x19, data.data, data.size);
+            append_file(files, 0x02, &body, next_random() % 10 == 0);
+            free(data.data);
+        }
+    }
+    free(body.data);
+}
+
+int main(int argc, char* argv[])
+{
+    BUFFER image = { NULL, 0, 0 };
+    FILE* file;
+    int i;
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: threads_image FILE\n");
+        return 1;
+    }
+
+    for (i = 0; i < 6; i++) {
+        static const size_t paddings[3] = { 0, 0x100, 0x1000 };
+        BUFFER files = { NULL, 0, 0 };
+        append_random_files(&files, random_range(3, 40), 2);
+        append_volume(&image, &files);
+        append_fill(&image, 0, paddings[next_random() % 3]);
+        free(files.data);
+    }
+
+    file = fopen(argv[1], "wb");
+    if (!file || fwrite(image.data, 1, image.size, file) != image.size || fclose(file) != 0) {
+        fprintf(stderr, "Can't write %s\n", argv[1]);
+        return 1;
+    }
+    free(image.data);
+    return 0;
+}
@@ -0,0 +1,41 @@
+# threads_test.cmake
+#
+# Parses the same image with one and with several threads and checks that report, dump and messages are identical
+# Usage: cmake -DUEFIEXTRACT=<path> -DIMAGE_GENERATOR=<path> -DWORK_DIR=<path> -P threads_test.cmake
+
+FILE(REMOVE_RECURSE ${WORK_DIR})
+FILE(MAKE_DIRECTORY ${WORK_DIR})
+
+EXECUTE_PROCESS(COMMAND ${IMAGE_GENERATOR} ${WORK_DIR}/image.bin RESULT_VARIABLE RESULT)
+IF(NOT RESULT EQUAL 0)
+ MESSAGE(FATAL_ERROR "Can't generate test image")
+ENDIF()
+
+FOREACH(THREADS 1 8)
+ SET(DIR ${WORK_DIR}/threads-${THREADS})
+ FILE(MAKE_DIRECTORY ${DIR})
+ FILE(COPY ${WORK_DIR}/image.bin DESTINATION ${DIR})
+
+ EXECUTE_PROCESS(COMMAND ${UEFIEXTRACT} image.bin report --threads ${THREADS}
+  WORKING_DIRECTORY ${DIR} OUTPUT_VARIABLE REPORT_MESSAGES_${THREADS} ERROR_VARIABLE REPORT_MESSAGES_${THREADS} RESULT_VARIABLE REPORT_RESULT_${THREADS})
+ FILE(READ ${DIR}/image.bin.report.txt REPORT_${THREADS})
+
+ EXECUTE_PROCESS(COMMAND ${UEFIEXTRACT} image.bin dump --threads ${THREADS}
+  WORKING_DIRECTORY ${DIR} OUTPUT_VARIABLE DUMP_MESSAGES_${THREADS} ERROR_VARIABLE DUMP_MESSAGES_${THREADS} RESULT_VARIABLE DUMP_RESULT_${THREADS})
+ FILE(GLOB_RECURSE DUMP_FILES RELATIVE ${DIR}/image.bin.dump ${DIR}/image.bin.dump/*)
+ LIST(SORT DUMP_FILES)
+ SET(DUMP_${THREADS} "")
+ FOREACH(DUMP_FILE ${DUMP_FILES})
+  FILE(SHA256 ${DIR}/image.bin.dump/${DUMP_FILE} HASH)
+  STRING(APPEND DUMP_${THREADS} "${HASH} ${DUMP_FILE}\n")
+ ENDFOREACH()
+ENDFOREACH()
+
+IF(REPORT_1 STREQUAL "" OR DUMP_1 STREQUAL "")
+ MESSAGE(FATAL_ERROR "Serial parsing produced no report or dump")
+ENDIF()
+FOREACH(OUTPUT REPORT_RESULT REPORT_MESSAGES REPORT DUMP_RESULT DUMP_MESSAGES DUMP)
+ IF(NOT "${${OUTPUT}_1}" STREQUAL "${${OUTPUT}_8}")
+  MESSAGE(FATAL_ERROR "${OUTPUT} differs between serial and parallel parsing, see ${WORK_DIR}")
+ ENDIF()
+ENDFOREACH()